@@ -0,0 +1,88 @@
+#ifndef _BITSET_H__
+#define _BITSET_H__
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class BitSet
+ * @file BitSet.h
+ * @brief Dense set of non-negative integers (e.g., identifiers of blocks,
+ * ports or channels) stored as a vector of bits. Membership queries take
+ * constant time and do not chase pointers, unlike std::set.
+ */
+class BitSet
+{
+public:
+
+    /**
+     * @brief Constructor
+     * @param n Size of the universe (elements 0..n-1).
+     */
+    BitSet(int n = 0) {
+        resize(n);
+    }
+
+    /**
+     * @brief Resizes the universe. The new elements are not in the set.
+     * @param n Size of the universe.
+     */
+    void resize(int n) {
+        size_ = n;
+        words.resize((n + 63) / 64, 0);
+    }
+
+    /**
+     * @return The size of the universe.
+     */
+    int size() const {
+        return size_;
+    }
+
+    /**
+     * @brief Removes all the elements of the set (the size is not modified).
+     */
+    void clear() {
+        for (uint64_t& w: words) w = 0;
+    }
+
+    /**
+     * @brief Inserts an element (the universe grows if necessary).
+     * @param i The element.
+     */
+    void insert(int i) {
+        if (i >= size_) resize(i + 1);
+        words[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+
+    /**
+     * @brief Removes an element.
+     * @param i The element.
+     */
+    void erase(int i) {
+        if (i < size_) words[i >> 6] &= ~(uint64_t(1) << (i & 63));
+    }
+
+    /**
+     * @brief Checks whether an element is in the set.
+     * @param i The element (false if out of the universe).
+     */
+    bool contains(int i) const {
+        return i >= 0 and i < size_ and (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    /**
+     * @return The number of elements in the set.
+     */
+    int count() const {
+        int n = 0;
+        for (uint64_t w: words) n += __builtin_popcountll(w);
+        return n;
+    }
+
+private:
+    int size_;                      // Size of the universe
+    std::vector<uint64_t> words;    // Bits of the elements
+};
+
+#endif // _BITSET_H__
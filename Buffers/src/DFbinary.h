@@ -0,0 +1,385 @@
+#ifndef _DFBINARY_H__
+#define _DFBINARY_H__
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file DFbinary.h
+ * @brief Binary format of the dataflow netlists (.dfb files), used to hand
+ * over a netlist between the tools of the flow without writing and parsing
+ * dot files. The file has a header followed by tables of fixed-size records
+ * (blocks, ports, channels, basic blocks and arcs of the BB graph), a table
+ * with the attributes that only a few blocks have (memories, LSQs, calls,
+ * selectors...), a table of integers (orderings and MG numbers) and a string
+ * table. All the sections
+ * are aligned to 8 bytes, so that the file can be mapped in memory and the
+ * records read in place. The references between tables are indices and the
+ * strings are indices of the string table (0 is the empty string).
+ *
+ * The blocks are stored in the order of the dot export (grouped by basic
+ * block), and the ports of each block are contiguous and in the order of the
+ * in/out attributes of the dot export. The file is written in the byte order
+ * of the host, which is checked when it is read.
+ *
+ * The version must be incremented whenever a record changes. Readers reject
+ * files with a different version.
+ */
+namespace DFbinary
+{
+
+const char MAGIC[4] = {'D', 'F', 'N', 'B'};
+const uint32_t VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const uint32_t NONE = 0xffffffff;   // Invalid index
+
+struct Header {
+    char magic[4];              // "DFNB"
+    uint32_t version;           // Version of the format
+    uint32_t byteOrder;         // BYTE_ORDER_MARK in the byte order of the writer
+    uint32_t name;              // Name of the netlist (string)
+    uint32_t numBlocks;
+    uint32_t numPorts;
+    uint32_t numChannels;
+    uint32_t numBasicBlocks;    // 0 if the file has no BB graph
+    uint32_t numArcs;
+    uint32_t numInts;
+    uint32_t numStrings;
+    uint32_t numExtras;
+    int32_t entryBasicBlock;    // Entry BB of the BB graph (-1 if undefined)
+    uint32_t padding;
+    uint64_t blocks;            // Offsets of the sections (from the beginning of the file)
+    uint64_t extras;
+    uint64_t ports;
+    uint64_t channels;
+    uint64_t basicBlocks;
+    uint64_t arcs;
+    uint64_t ints;
+    uint64_t strings;           // Offsets of the strings (uint32_t) in stringData
+    uint64_t stringData;        // Null-terminated strings
+    uint64_t fileSize;
+};
+
+struct Block {
+    uint32_t name;
+    uint32_t type;              // Type as written in the dot files (e.g. "Operator")
+    uint32_t operation;
+    int32_t basicBlock;
+    int32_t latency;
+    int32_t II;
+    int32_t slots;
+    uint32_t firstPort;         // Ports of the block: [firstPort, firstPort + numPorts)
+    uint32_t numPorts;
+    uint32_t extra;             // Other attributes (NONE if all of them are 0 or empty)
+    uint8_t transparent;
+    uint8_t padding[7];
+    int64_t value;
+    double delay;
+    double freq;
+};
+
+struct Extra {
+    uint32_t funcName;
+    uint32_t memName;
+    uint32_t numLoads;          // Configuration of the LSQs (strings)
+    uint32_t numStores;
+    uint32_t loadOffsets;
+    uint32_t storeOffsets;
+    uint32_t loadPorts;
+    uint32_t storePorts;
+    int32_t memPortID;
+    int32_t memOffset;
+    int32_t memBBCount;
+    int32_t memLdCount;
+    int32_t memStCount;
+    int32_t fifoDepth;
+    int32_t getPtrConst;
+    uint32_t firstOrdering;     // Orderings: sequences (bb, n, i_1, ..., i_n) in the ints
+    uint32_t numOrderingInts;
+    uint32_t padding;
+    double trueFrac;
+    double retimingDiff;
+};
+
+enum PortFlags {
+    PORT_INPUT = 1,             // Input port (output otherwise)
+    PORT_EXPORT_ONLY = 2        // Port of the dot export that is not in the netlist (e.g. output of the exit)
+};
+
+struct Port {
+    uint32_t name;
+    uint32_t block;
+    uint32_t memSuffix;         // Suffix of the MC/LSQ ports (e.g. "*l0a")
+    int32_t width;
+    uint8_t flags;              // PortFlags
+    uint8_t type;               // Dataflow::PortType
+    uint8_t padding[6];
+    double delay;
+};
+
+struct Channel {
+    uint32_t src;               // Source port (output)
+    uint32_t dst;               // Destination port (input)
+    int32_t slots;
+    uint8_t transparent;
+    uint8_t backEdge;
+    uint8_t padding[2];
+    double freq;
+};
+
+struct BasicBlock {
+    double freq;
+    double exec;
+    uint32_t exit;              // Is it an exit BB?
+    uint32_t padding;
+};
+
+struct Arc {
+    int32_t src;                // Source BB
+    int32_t dst;                // Destination BB
+    int32_t DSU;                // Number of the disjoint set of MGs
+    uint32_t back;              // Is it a back arc?
+    uint32_t firstMG;           // MG numbers: [firstMG, firstMG + numMGs) in the ints
+    uint32_t numMGs;
+    double prob;
+    double freq;
+};
+
+static_assert(sizeof(Header) == 136, "Unexpected size of DFbinary::Header");
+static_assert(sizeof(Block) == 72, "Unexpected size of DFbinary::Block");
+static_assert(sizeof(Extra) == 88, "Unexpected size of DFbinary::Extra");
+static_assert(sizeof(Port) == 32, "Unexpected size of DFbinary::Port");
+static_assert(sizeof(Channel) == 24, "Unexpected size of DFbinary::Channel");
+static_assert(sizeof(BasicBlock) == 24, "Unexpected size of DFbinary::BasicBlock");
+static_assert(sizeof(Arc) == 40, "Unexpected size of DFbinary::Arc");
+
+/**
+ * @brief Checks whether a file is a binary netlist (by its magic number).
+ * @param filename Name of the file.
+ * @return True if it is a binary netlist, and false otherwise (or if it
+ * cannot be read).
+ */
+inline bool isBinaryFile(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    char magic[sizeof(MAGIC)];
+    bool status = read(fd, magic, sizeof(magic)) == sizeof(magic) and memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    close(fd);
+    return status;
+}
+
+/**
+ * @class File
+ * @file DFbinary.h
+ * @brief Read-only view of a binary netlist mapped in memory. All the
+ * indices of the records are checked when the file is opened, so the
+ * readers can follow them without further checks.
+ */
+class File
+{
+public:
+
+    File() : data(nullptr), size(0) {}
+
+    ~File() {
+        close();
+    }
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    /**
+     * @brief Maps a binary netlist in memory and checks it.
+     * @param filename Name of the file.
+     * @return True if successful, and false otherwise (see getError).
+     */
+    bool open(const std::string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return setError("File " + filename + " could not be opened.");
+        struct stat st;
+        if (fstat(fd, &st) != 0 or st.st_size < (off_t) sizeof(Header)) {
+            ::close(fd);
+            return setError("File " + filename + " is not a binary netlist.");
+        }
+        size = st.st_size;
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            size = 0;
+            return setError("File " + filename + " could not be mapped in memory.");
+        }
+        data = (const char*) p;
+        if (check()) return true;
+        error = "File " + filename + ": " + error;
+        close();
+        return false;
+    }
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close() {
+        if (data != nullptr) munmap((void*) data, size);
+        data = nullptr;
+        size = 0;
+    }
+
+    /**
+     * @return The error message of the last open.
+     */
+    const std::string& getError() const {
+        return error;
+    }
+
+    const Header& header() const {
+        return *(const Header*) data;
+    }
+
+    const Block& block(uint32_t i) const {
+        return ((const Block*) (data + header().blocks))[i];
+    }
+
+    const Extra& extra(uint32_t i) const {
+        return ((const Extra*) (data + header().extras))[i];
+    }
+
+    const Port& port(uint32_t i) const {
+        return ((const Port*) (data + header().ports))[i];
+    }
+
+    const Channel& channel(uint32_t i) const {
+        return ((const Channel*) (data + header().channels))[i];
+    }
+
+    /**
+     * @param bb Basic block (from 1 to numBasicBlocks, as in the BB graph).
+     */
+    const BasicBlock& basicBlock(int32_t bb) const {
+        return ((const BasicBlock*) (data + header().basicBlocks))[bb - 1];
+    }
+
+    const Arc& arc(uint32_t i) const {
+        return ((const Arc*) (data + header().arcs))[i];
+    }
+
+    int32_t getInt(uint32_t i) const {
+        return ((const int32_t*) (data + header().ints))[i];
+    }
+
+    const char* getString(uint32_t s) const {
+        return data + header().stringData + ((const uint32_t*) (data + header().strings))[s];
+    }
+
+private:
+    const char* data;           // File mapped in memory
+    size_t size;                // Size of the file
+    std::string error;          // Error message
+
+    bool setError(const std::string& msg) {
+        error = msg;
+        return false;
+    }
+
+    // Checks that a section of n records of the given size is inside the file
+    bool checkSection(uint64_t offset, uint64_t n, uint64_t record) const {
+        return offset % 8 == 0 and offset <= size and n <= (size - offset) / record;
+    }
+
+    // Checks that a range of the ints is valid
+    bool checkInts(uint32_t first, uint32_t n) const {
+        return first <= header().numInts and n <= header().numInts - first;
+    }
+
+    // Checks the header, the sections and all the indices of the records
+    bool check() {
+        const Header& H = header();
+        if (memcmp(H.magic, MAGIC, sizeof(MAGIC)) != 0) return setError("not a binary netlist.");
+        if (H.byteOrder != BYTE_ORDER_MARK) return setError("wrong byte order.");
+        if (H.version != VERSION) {
+            return setError("version " + std::to_string(H.version) + " is not supported (expected " +
+                            std::to_string(VERSION) + ").");
+        }
+        if (H.fileSize != size) return setError("truncated file.");
+        if (not checkSection(H.blocks, H.numBlocks, sizeof(Block)) or
+            not checkSection(H.extras, H.numExtras, sizeof(Extra)) or
+            not checkSection(H.ports, H.numPorts, sizeof(Port)) or
+            not checkSection(H.channels, H.numChannels, sizeof(Channel)) or
+            not checkSection(H.basicBlocks, H.numBasicBlocks, sizeof(BasicBlock)) or
+            not checkSection(H.arcs, H.numArcs, sizeof(Arc)) or
+            not checkSection(H.ints, H.numInts, sizeof(int32_t)) or
+            not checkSection(H.strings, H.numStrings, sizeof(uint32_t)) or
+            H.stringData > size or H.numStrings == 0) {
+            return setError("corrupted sections.");
+        }
+
+        // Strings (null-terminated inside the string data)
+        uint64_t dataSize = size - H.stringData;
+        if (dataSize == 0 or data[size - 1] != '\0') return setError("corrupted string table.");
+        const uint32_t* offsets = (const uint32_t*) (data + H.strings);
+        for (uint32_t s = 0; s < H.numStrings; ++s) {
+            if (offsets[s] >= dataSize) return setError("corrupted string table.");
+        }
+        if (H.name >= H.numStrings) return setError("corrupted header.");
+
+        for (uint32_t e = 0; e < H.numExtras; ++e) {
+            const Extra& E = extra(e);
+            for (uint32_t s: {E.funcName, E.memName, E.numLoads, E.numStores, E.loadOffsets, E.storeOffsets,
+                              E.loadPorts, E.storePorts}) {
+                if (s >= H.numStrings) return setError("wrong string in extra " + std::to_string(e) + ".");
+            }
+            if (not checkInts(E.firstOrdering, E.numOrderingInts)) {
+                return setError("wrong orderings in extra " + std::to_string(e) + ".");
+            }
+        }
+
+        for (uint32_t b = 0; b < H.numBlocks; ++b) {
+            const Block& B = block(b);
+            if (B.name >= H.numStrings or B.type >= H.numStrings or B.operation >= H.numStrings) {
+                return setError("wrong string in block " + std::to_string(b) + ".");
+            }
+            if (B.firstPort > H.numPorts or B.numPorts > H.numPorts - B.firstPort or
+                (B.extra != NONE and B.extra >= H.numExtras)) {
+                return setError("wrong ports or extra in block " + std::to_string(b) + ".");
+            }
+            for (uint32_t p = B.firstPort; p < B.firstPort + B.numPorts; ++p) {
+                if (port(p).block != b) return setError("wrong block of port " + std::to_string(p) + ".");
+            }
+        }
+
+        for (uint32_t p = 0; p < H.numPorts; ++p) {
+            const Port& P = port(p);
+            if (P.name >= H.numStrings or P.memSuffix >= H.numStrings or P.block >= H.numBlocks) {
+                return setError("wrong port " + std::to_string(p) + ".");
+            }
+        }
+
+        for (uint32_t c = 0; c < H.numChannels; ++c) {
+            const Channel& C = channel(c);
+            if (C.src >= H.numPorts or C.dst >= H.numPorts or
+                (port(C.src).flags & PORT_INPUT) or not (port(C.dst).flags & PORT_INPUT)) {
+                return setError("wrong ports of channel " + std::to_string(c) + ".");
+            }
+        }
+
+        if (H.entryBasicBlock > (int32_t) H.numBasicBlocks) return setError("wrong entry BB.");
+        for (uint32_t a = 0; a < H.numArcs; ++a) {
+            const Arc& A = arc(a);
+            if (A.src < 1 or A.src > (int32_t) H.numBasicBlocks or A.dst < 1 or
+                A.dst > (int32_t) H.numBasicBlocks or not checkInts(A.firstMG, A.numMGs)) {
+                return setError("wrong BB arc " + std::to_string(a) + ".");
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace DFbinary
+
+#endif // _DFBINARY_H__
@@ -1,8 +1,67 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include "DFnetlist.h"
+#include "FileUtil.h"
+#include "ThreadLog.h"
 
 using namespace Dataflow;
 using namespace std;
 
+/*
+ * Buffer of cout while the functions of a library are buffered concurrently.
+ * The output of a thread with a log is appended to it, and the output of the
+ * other threads goes to the original buffer. The logs are printed as a whole,
+ * so that the outputs of the functions do not interleave. The threads started
+ * by a worker (e.g., the MILPs of the MGs with -jobs) write into the log
+ * of the worker (see ThreadLog::Nested).
+ */
+class WorkerLogBuf : public streambuf
+{
+public:
+    WorkerLogBuf(streambuf* out) : out(out) {}
+
+    // Writes a log into the original buffer
+    void print(const string& s) {
+        lock_guard<mutex> guard(lock);
+        out->sputn(s.data(), s.size());
+        out->pubsync();
+    }
+
+protected:
+    int overflow(int c) override {
+        if (c == traits_type::eof()) return traits_type::not_eof(c);
+        char ch = c;
+        xsputn(&ch, 1);
+        return c;
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        string* log = ThreadLog::current();
+        if (log != nullptr) log->append(s, n);
+        else {
+            lock_guard<mutex> guard(lock);
+            out->sputn(s, n);
+        }
+        return n;
+    }
+
+    int sync() override {
+        if (ThreadLog::current() != nullptr) return 0;
+        lock_guard<mutex> guard(lock);
+        return out->pubsync();
+    }
+
+private:
+    streambuf* out;     // Original buffer of cout
+    mutex lock;         // Lock of the original buffer
+};
+
 void DFlib_Impl::init()
 {
     libName.clear();
@@ -66,8 +125,177 @@ bool DFlib_Impl::add(const string& filename)
         }
 
         name2func[newName] = id;
+        allFuncs.insert(id);
+        nFuncs++;
+    }
+
+    fclose(f);
+    return status;
+}
+
+bool DFlib_Impl::addBB(const string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "r");
+    if (f == nullptr) {
+        setError("File " + filename + " could not be opened.");
+        return false;
+    }
+
+    // The BB graphs are matched with the functions in order
+    bool status = true;
+    for (funcID id: allFuncs) {
+        DFnetlist_Impl& DF = *funcs[id].DFI;
+        if (not DF.readBasicBlockGraph(f)) {
+            if (DF.hasError()) setError("Error in the BB graph of function " + DF.getName() + ": " + DF.getError());
+            else setError("Error: no BB graph for function " + DF.getName() + ".");
+            status = false;
+            break;
+        }
     }
 
     fclose(f);
     return status;
 }
+
+bool DFlib_Impl::addElasticBuffers(double Period, double BufferDelay, bool set, int timeout,
+                                   bool first_MG, int jobs, const string& report)
+{
+    // Results of the buffer placement of a function
+    struct FuncReport {
+        bool ok = false;
+        int blocks = 0;
+        int channels = 0;
+        int buffers = 0;
+        int slots = 0;
+        double criticalPath = 0;
+        vector<double> throughput;
+        double time = 0;
+        string error;
+    };
+
+    int n = funcs.size();
+    vector<FuncReport> result(n);
+    if (nFuncs == 0) return true;
+
+    if (jobs <= 0) jobs = thread::hardware_concurrency();
+    jobs = max(1, min(jobs, nFuncs));
+
+    // The largest functions are dealt first, round-robin, so that the
+    // queues are balanced and the longest MILPs do not start at the end.
+    vector<funcID> order(allFuncs.begin(), allFuncs.end());
+    stable_sort(order.begin(), order.end(), [this](funcID a, funcID b) {
+        return funcs[a].DFI->numChannels() > funcs[b].DFI->numChannels();
+    });
+
+    vector<deque<funcID>> queues(jobs);
+    vector<mutex> locks(jobs);
+    for (int i = 0; i < order.size(); ++i) queues[i % jobs].push_back(order[i]);
+
+    // Next function for a worker: front of its own queue or back of another one
+    auto nextFunc = [&](int w) {
+        for (int k = 0; k < jobs; ++k) {
+            int q = (w + k) % jobs;
+            lock_guard<mutex> guard(locks[q]);
+            if (queues[q].empty()) continue;
+            funcID id;
+            if (k == 0) {
+                id = queues[q].front();
+                queues[q].pop_front();
+            } else {
+                id = queues[q].back();
+                queues[q].pop_back();
+            }
+            return id;
+        }
+        return funcID(invalidDataflowID);
+    };
+
+    auto bufferFunc = [&](funcID id) {
+        DFnetlist_Impl& DF = *funcs[id].DFI;
+        FuncReport& R = result[id];
+        auto start = chrono::steady_clock::now();
+
+        R.blocks = DF.numBlocks();
+        R.channels = DF.numChannels();
+        if (set) R.ok = DF.addElasticBuffersBB_sc(Period, BufferDelay, true, 1, timeout, first_MG);
+        else R.ok = DF.addElasticBuffersBB(Period, BufferDelay, true, 1, timeout, first_MG);
+
+        if (R.ok) {
+            for (channelID c: DF.allChannels) {
+                int slots = DF.getChannelBufferSize(c);
+                if (slots == 0) continue;
+                R.buffers++;
+                R.slots += slots;
+            }
+            R.criticalPath = DF.getCriticalPath(BufferDelay);
+
+            vector<ThroughputInfo> th;
+            if (DF.analyzeThroughput(th, set)) {
+                for (const ThroughputInfo& t: th) R.throughput.push_back(t.throughput);
+            } else DF.clearError();
+
+            DF.instantiateElasticBuffers();
+        } else R.error = DF.getError();
+
+        chrono::duration<double> t = chrono::steady_clock::now() - start;
+        R.time = t.count();
+    };
+
+    // The output of each function is printed when it is finished
+    WorkerLogBuf logbuf(cout.rdbuf());
+    streambuf* coutbuf = cout.rdbuf(&logbuf);
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int w = 0; w < jobs; ++w) {
+        workers.emplace_back([&, w]() {
+            string log;
+            ThreadLog::current() = &log;
+            funcID id;
+            while ((id = nextFunc(w)) != invalidDataflowID) {
+                log = "==== Function " + funcs[id].getName() + " ====\n";
+                bufferFunc(id);
+                logbuf.print(log);
+            }
+            ThreadLog::current() = nullptr;
+        });
+    }
+    for (thread& t: workers) t.join();
+    cout.rdbuf(coutbuf);
+    chrono::duration<double> wall = chrono::steady_clock::now() - start;
+
+    // Report
+    ostringstream of;
+    of << "Buffer placement of " << nFuncs << " functions (period " << Period
+       << ", " << jobs << " workers)" << endl;
+    of << left << setw(24) << "Function" << right << setw(8) << "Blocks" << setw(10) << "Channels"
+       << setw(9) << "Buffers" << setw(7) << "Slots" << setw(10) << "CP" << setw(10) << "Time(s)"
+       << "  Throughput of the MGs" << endl;
+
+    bool status = true;
+    double total = 0;
+    for (funcID id: order) {
+        const FuncReport& R = result[id];
+        total += R.time;
+        of << left << setw(24) << funcs[id].getName() << right << setw(8) << R.blocks
+           << setw(10) << R.channels;
+        if (not R.ok) {
+            of << "  Error: " << R.error << endl;
+            if (status) setError("Error in function " + funcs[id].getName() + ": " + R.error);
+            status = false;
+            continue;
+        }
+        of << setw(9) << R.buffers << setw(7) << R.slots << fixed << setprecision(3)
+           << setw(10) << R.criticalPath << setw(10) << R.time << " ";
+        if (R.throughput.empty()) of << " -";
+        for (double th: R.throughput) of << " " << th;
+        of << defaultfloat << setprecision(6) << endl;
+    }
+
+    of << fixed << setprecision(3) << "Wall time: " << wall.count() << "s, sum of the times: "
+       << total << "s, speedup: " << setprecision(2) << (wall.count() > 0 ? total / wall.count() : 0) << endl;
+
+    cout << of.str();
+    if (not report.empty() and not FileUtil::write(of.str(), report, getError())) return false;
+    return status;
+}
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <iomanip>
 #include "DFnetlist.h"
 
 using namespace std;
@@ -52,6 +53,18 @@ void DFnetlist_Impl::init()
     entryControl = invalidDataflowID;
     exitControl.clear();
     setMilpSolver();
+    setMilpJobs();
+    setMilpBudget();
+    setMilpRelaxation();
+    setCFDFCExtraction();
+    setMilpPathPruning();
+    hasMilpStart = false;
+    hasPrevPlacement = false;
+    invalidateGraph();
+
+    // Symbol 0 is the empty string: default operation and memory suffix
+    int empty = symbols.intern("");
+    assert(empty == 0);
 }
 
 void DFnetlist_Impl::setMilpSolver(const std::string& solver)
@@ -59,6 +72,42 @@ void DFnetlist_Impl::setMilpSolver(const std::string& solver)
     milpSolver = solver;
 }
 
+void DFnetlist_Impl::setMilpJobs(int jobs)
+{
+    milpJobs = jobs < 1 ? 1 : jobs;
+}
+
+void DFnetlist_Impl::setMilpBudget(int seconds)
+{
+    milpBudget = seconds;
+}
+
+bool DFnetlist_Impl::setMilpRelaxation(const string& mode, int polish)
+{
+    if (mode != "off" and mode != "fallback" and mode != "always") {
+        setError("Unknown LP relaxation mode " + mode + ".");
+        return false;
+    }
+    milpRelaxation = mode;
+    milpPolish = polish;
+    return true;
+}
+
+bool DFnetlist_Impl::setCFDFCExtraction(const string& method)
+{
+    if (method != "milp" and method != "graph" and method != "compare") {
+        setError("Unknown CFDFC extraction method " + method + ".");
+        return false;
+    }
+    cfdfcExtraction = method;
+    return true;
+}
+
+void DFnetlist_Impl::setMilpPathPruning(bool enable)
+{
+    milpPathPruning = enable;
+}
+
 DFnetlist_Impl::DFnetlist_Impl()
 {
     init();
@@ -67,7 +116,7 @@ DFnetlist_Impl::DFnetlist_Impl()
 DFnetlist_Impl::DFnetlist_Impl(const string& name)
 {
     init();
-    if (not readDataflowDot(name)) return;
+    if (not readNetlist(name)) return;
     check();
 }
 
@@ -80,9 +129,9 @@ DFnetlist_Impl::DFnetlist_Impl(FILE* file)
 
 DFnetlist_Impl::DFnetlist_Impl(const std::string &name, const std::string &name_bb) {
     init();
-    if (not readDataflowDot(name)) return;
+    if (not readNetlist(name)) return;
     check();
-    if (not readDataflowDotBB(name_bb)) return;
+    if (BBG.empty() and not readDataflowDotBB(name_bb)) return;
     //SHAB_note: do error checking
 }
 
@@ -119,27 +168,37 @@ blockID DFnetlist_Impl::createBlock(BlockType type, const string& name)
     } else {
         idx = blocks.size();
         blocks.push_back(Block {});
+        blockArrays.type.push_back(type);
+        blockArrays.basicBlock.push_back(invalidDataflowID);
+        blockArrays.delay.push_back(0);
+        blockArrays.latency.push_back(0);
+        blockArrays.II.push_back(0);
+        blockArrays.freq.push_back(0.0);
     }
-    name2block[gname] = idx;
+    int sym = symbols.intern(gname);
+    if (sym >= symbol2block.size()) symbol2block.resize(sym + 1, invalidDataflowID);
+    symbol2block[sym] = idx;
     allBlocks.insert(idx);
+    invalidateGraph();
 
     // Init the block
     Block& B = blocks[idx];
     B.id = idx;
-    B.name = gname;
-    B.type = type;
+    B.name = sym;
     B.value = 0;
     B.boolValue = false;
     B.nextFree = invalidDataflowID;
-    B.basicBlock = invalidDataflowID;
     B.DFSorder = -1;
-    B.delay = 0;
-    B.latency = 0;
-    B.II = 0;
     B.data = B.portCond = B.portFalse = B.portTrue = B.srcCond = invalidDataflowID;
     B.slots = 0;
     B.transparent = true;
-    B.freq = 0.0;
+    B.coverage = 0;
+    blockArrays.type[idx] = type;
+    blockArrays.basicBlock[idx] = invalidDataflowID;
+    blockArrays.delay[idx] = 0;
+    blockArrays.latency[idx] = 0;
+    blockArrays.II[idx] = 0;
+    blockArrays.freq[idx] = 0.0;
 
     return idx;
 }
@@ -151,32 +210,34 @@ void DFnetlist_Impl::removeBlock(blockID id)
 
     while (not B.allPorts.empty()) removePort(*(B.allPorts.begin()));
 
-    name2block.erase(B.name);
+    symbol2block[B.name] = invalidDataflowID;
+    blockExtras.erase(id);
 
     B = Block {invalidDataflowID};
     nBlocks--;
     B.nextFree = freeBlock;
     freeBlock = id;
     allBlocks.erase(id);
+    invalidateGraph();
 }
 
 blockID DFnetlist_Impl::getBlock(const string& name) const
 {
-    const auto& it = name2block.find(name);
-    if (it == name2block.end()) return invalidDataflowID;
-    return it->second;
+    int sym = symbols.find(name);
+    if (sym < 0 or sym >= symbol2block.size()) return invalidDataflowID;
+    return symbol2block[sym];
 }
 
 const string& DFnetlist_Impl::getBlockName(blockID id) const
 {
     assert (validBlock(id));
-    return blocks[id].name;
+    return symbols.name(blocks[id].name);
 }
 
 BlockType DFnetlist_Impl::getBlockType(blockID id) const
 {
     assert (validBlock(id));
-    return blocks[id].type;
+    return blockArrays.type[id];
 }
 
 std::string DFnetlist_Impl::printBlockType(BlockType type) const {
@@ -248,25 +309,25 @@ bool DFnetlist_Impl::isInnerChannel(channelID c) {
 void DFnetlist_Impl::setBasicBlock(blockID id, bbID bb)
 {
     assert (validBlock(id));
-    blocks[id].basicBlock = bb;
+    blockArrays.basicBlock[id] = bb;
 }
 
 bbID DFnetlist_Impl::getBasicBlock(blockID id) const
 {
     assert (validBlock(id));
-    return blocks[id].basicBlock;
+    return blockArrays.basicBlock[id];
 }
 
 double DFnetlist_Impl::getBlockDelay(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].delay;
+    return blockArrays.delay[id];
 }
 
 void DFnetlist_Impl::setBlockDelay(blockID id, double d)
 {
     assert(validBlock(id));
-    blocks[id].delay = d;
+    blockArrays.delay[id] = d;
 }
 
 double DFnetlist_Impl::getBlockRetimingDiff(blockID id) const
@@ -284,37 +345,37 @@ void DFnetlist_Impl::setBlockRetimingDiff(blockID id, double diff)
 int DFnetlist_Impl::getLatency(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].latency;
+    return blockArrays.latency[id];
 }
 
 void DFnetlist_Impl::setLatency(blockID id, int lat)
 {
     assert(validBlock(id));
-    blocks[id].latency = lat;
+    blockArrays.latency[id] = lat;
 }
 
 int DFnetlist_Impl::getInitiationInterval(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].II;
+    return blockArrays.II[id];
 }
 
 void DFnetlist_Impl::setInitiationInterval(blockID id, int ii)
 {
     assert(validBlock(id));
-    blocks[id].II = ii;
+    blockArrays.II[id] = ii;
 }
 
 int DFnetlist_Impl::getExecutionFrequency(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].freq;
+    return blockArrays.freq[id];
 }
 
 void DFnetlist_Impl::setExecutionFrequency(blockID id, double freq)
 {
     assert(validBlock(id));
-    blocks[id].freq = freq;
+    blockArrays.freq[id] = freq;
     //cout << getBlockName(id) << " " << freq << endl;
 }
 
@@ -342,223 +403,230 @@ void DFnetlist_Impl::setValue(blockID id, long long value)
 void DFnetlist_Impl::setOperation(blockID id, std::string op)
 {
     assert(validBlock(id));
-    blocks[id].operation = op;
+    blocks[id].operation = symbols.intern(op);
 }
 
 // Lana 02/07/19
 const string& DFnetlist_Impl::getOperation(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].operation;
+    return symbols.name(blocks[id].operation);
+}
+
+const DFnetlist_Impl::BlockExtra& DFnetlist_Impl::getBlockExtra(blockID id) const
+{
+    static const BlockExtra none;
+    const auto& it = blockExtras.find(id);
+    return it == blockExtras.end() ? none : it->second;
 }
 
 void DFnetlist_Impl::setFuncName(blockID id, std::string func)
 {
     assert(validBlock(id));
-    blocks[id].funcName = func;
+    blockExtras[id].funcName = func;
 }
 
 // Lana 02/07/19
 const string& DFnetlist_Impl::getFuncName(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].funcName;
+    return getBlockExtra(id).funcName;
 }
 
 // Lana 03.07.19 
 void DFnetlist_Impl::setMemPortID(blockID id, int memPortID)
 {
     assert(validBlock(id));
-    blocks[id].memPortID = memPortID;
+    blockExtras[id].memPortID = memPortID;
 
 }
 
 int DFnetlist_Impl::getMemPortID(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].memPortID;
+    return getBlockExtra(id).memPortID;
 }
 
 void DFnetlist_Impl::setMemOffset(blockID id, int memOffset)
 {
     assert(validBlock(id));
-    blocks[id].memOffset = memOffset;
+    blockExtras[id].memOffset = memOffset;
 
 }
 
 int DFnetlist_Impl::getMemOffset(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].memOffset;
+    return getBlockExtra(id).memOffset;
 }
 
 void DFnetlist_Impl::setMemBBCount(blockID id, int count)
 {
     assert(validBlock(id));
-    blocks[id].memBBCount = count;
+    blockExtras[id].memBBCount = count;
 
 }
 
 int DFnetlist_Impl::getMemBBCount(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].memBBCount;
+    return getBlockExtra(id).memBBCount;
 }
 
 void DFnetlist_Impl::setMemLdCount(blockID id, int count)
 {
     assert(validBlock(id));
-    blocks[id].memLdCount = count;
+    blockExtras[id].memLdCount = count;
 
 }
 
 int DFnetlist_Impl::getMemLdCount(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].memLdCount;
+    return getBlockExtra(id).memLdCount;
 }
 
 void DFnetlist_Impl::setMemStCount(blockID id, int count)
 {
     assert(validBlock(id));
-    blocks[id].memStCount = count;
+    blockExtras[id].memStCount = count;
 
 }
 
 int DFnetlist_Impl::getMemStCount(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].memStCount;
+    return getBlockExtra(id).memStCount;
 }
 
 void DFnetlist_Impl::setMemName(blockID id, std::string name)
 {
     assert(validBlock(id));
-    blocks[id].memName = name;
+    blockExtras[id].memName = name;
 }
 
 const string& DFnetlist_Impl::getMemName(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].memName;
+    return getBlockExtra(id).memName;
 }
 
 void DFnetlist_Impl::setMemPortSuffix(portID port, std::string op)
 {
     assert(validPort(port));
-    ports[port].memPortSuffix = op;
+    ports[port].memPortSuffix = symbols.intern(op);
 
 }
 
 const string& DFnetlist_Impl::getMemPortSuffix(portID port) const
 {
     assert(validPort(port));
-    return ports[port].memPortSuffix;
+    return symbols.name(ports[port].memPortSuffix);
 }
 
 // Lana 04/10/19 LSQ params
 void DFnetlist_Impl::setLSQDepth(blockID id, int depth)
 {
     assert(validBlock(id));
-    blocks[id].fifoDepth = depth;
+    blockExtras[id].fifoDepth = depth;
 
 }
 
 int DFnetlist_Impl::getLSQDepth(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].fifoDepth;
+    return getBlockExtra(id).fifoDepth;
 }
 
 void DFnetlist_Impl::setNumLoads(blockID id, std::string s)
 {
     assert(validPort(id));
-    blocks[id].numLoads = s;
+    blockExtras[id].numLoads = s;
 
 }
 
 const string& DFnetlist_Impl::getNumLoads(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].numLoads;
+    return getBlockExtra(id).numLoads;
 }
 
 void DFnetlist_Impl::setNumStores(blockID id, std::string s)
 {
     assert(validPort(id));
-    blocks[id].numStores = s;
+    blockExtras[id].numStores = s;
 
 }
 
 const string& DFnetlist_Impl::getNumStores(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].numStores;
+    return getBlockExtra(id).numStores;
 }
 
 void DFnetlist_Impl::setLoadOffsets(blockID id, std::string s)
 {
     assert(validPort(id));
-    blocks[id].loadOffsets = s;
+    blockExtras[id].loadOffsets = s;
 
 }
 
 const string& DFnetlist_Impl::getLoadOffsets(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].loadOffsets;
+    return getBlockExtra(id).loadOffsets;
 }
 
 void DFnetlist_Impl::setStoreOffsets(blockID id, std::string s)
 {
     assert(validPort(id));
-    blocks[id].storeOffsets = s;
+    blockExtras[id].storeOffsets = s;
 
 }
 
 const string& DFnetlist_Impl::getStoreOffsets(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].storeOffsets;
+    return getBlockExtra(id).storeOffsets;
 }
 
 void DFnetlist_Impl::setLoadPorts(blockID id, std::string s)
 {
     assert(validPort(id));
-    blocks[id].loadPorts = s;
+    blockExtras[id].loadPorts = s;
 
 }
 
 const string& DFnetlist_Impl::getLoadPorts(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].loadPorts;
+    return getBlockExtra(id).loadPorts;
 }
 
 void DFnetlist_Impl::setStorePorts(blockID id, std::string s)
 {
     assert(validPort(id));
-    blocks[id].storePorts = s;
+    blockExtras[id].storePorts = s;
 
 }
 
 const string& DFnetlist_Impl::getStorePorts(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].storePorts;
+    return getBlockExtra(id).storePorts;
 }
 
 // Getelementptr array dimensions
 void DFnetlist_Impl::setGetPtrConst(blockID id, int c)
 {
     assert(validBlock(id));
-    blocks[id].getptrc = c;
+    blockExtras[id].getptrc = c;
 
 }
 
 void DFnetlist_Impl::setOrderings(blockID id, map<bbID, vector<int>> value){
     assert (validBlock(id));
-    blocks[id].orderings = value;
+    blockExtras[id].orderings = value;
 }
 
 //---------------------------
@@ -609,18 +677,18 @@ blockID DFnetlist_Impl::getBlockFromPort(portID p) const
 int DFnetlist_Impl::getGetPtrConst(blockID id) const
 {
     assert(validBlock(id));
-    return blocks[id].getptrc;
+    return getBlockExtra(id).getptrc;
 }
 
-// Generates a fresh port name for a given block name. isInput indicates whether the port
-// must be input or output (prefix "in" or "out"). name2port contains all full names
-// for the ports (to check that not an existing name is generated).
-static string genFreshPortName(const string& blockName, bool isInput, map<string, portID>& name2port)
+// Generates a fresh port name for a block. isInput indicates whether the port
+// must be input or output (prefix "in" or "out"). The name is not the name of
+// an existing port of the block.
+static string genFreshPortName(const DFnetlist_Impl& DF, blockID block, bool isInput)
 {
     string prefix = isInput ? "in" : "out";
     for (int suffix = 1; ; ++suffix) {
         string name = prefix + to_string(suffix);
-        if (name2port.count(blockName + ":" + name) == 0) return name;
+        if (DF.getPort(block, name) == invalidDataflowID) return name;
     }
 }
 
@@ -628,12 +696,12 @@ portID DFnetlist_Impl::createPort(blockID block, bool isInput, const string& nam
 {
     assert(validBlock(block));
 
-    string localname = name.empty() ? genFreshPortName(getBlockName(block), isInput, name2port) : name;
-    string fullname = getBlockName(block) + ":" + localname;
+    int sym = name.empty() ? symbols.intern(genFreshPortName(*this, block, isInput)) : symbols.intern(name);
+    uint64_t key = portKey(block, sym);
 
     // Check for duplication
-    if (name2port.count(fullname) > 0) {
-        setError("Duplicated port name (" + fullname + ").");
+    if (name2port.find(key) != invalidDataflowID) {
+        setError("Duplicated port name (" + getBlockName(block) + ":" + name + ").");
         return invalidDataflowID;
     }
 
@@ -648,7 +716,7 @@ portID DFnetlist_Impl::createPort(blockID block, bool isInput, const string& nam
     }
 
     nPorts++;
-    name2port.emplace(fullname, pid);
+    name2port.insert(key, pid);
 
     Block& B = blocks[block];
     B.allPorts.insert(pid);
@@ -662,19 +730,20 @@ portID DFnetlist_Impl::createPort(blockID block, bool isInput, const string& nam
     // The input ports are stored in listPorts. Afterwards, the output ports
     // are paired in order of declaration. The remaining input port is the
     // data port
-    if (B.type == DEMUX) {
-        if (isInput) B.listPorts.push_back(pid);
+    if (blockArrays.type[block] == DEMUX) {
+        BlockExtra& X = blockExtras[block];
+        if (isInput) X.listPorts.push_back(pid);
         else {
-            assert(not B.listPorts.empty());
-            portID inp = B.listPorts.front();
-            B.listPorts.pop_front();
-            B.demuxPairs.emplace(pid, inp);
-            B.demuxPairs.emplace(inp, pid);
+            assert(not X.listPorts.empty());
+            portID inp = X.listPorts.front();
+            X.listPorts.pop_front();
+            X.demuxPairs.emplace(pid, inp);
+            X.demuxPairs.emplace(inp, pid);
 
             // The last input port is data
-            if (B.listPorts.size() == 1) {
-                B.data = B.listPorts.front();
-                B.listPorts.pop_front();
+            if (X.listPorts.size() == 1) {
+                B.data = X.listPorts.front();
+                X.listPorts.pop_front();
             }
         }
     }
@@ -683,14 +752,14 @@ portID DFnetlist_Impl::createPort(blockID block, bool isInput, const string& nam
     Port& P = ports[pid];
     P.id = pid;
     P.block = block;
-    P.short_name = localname;
-    P.full_name = fullname;
+    P.name = sym;
     P.isInput = isInput;
     P.width = width;
     P.delay = 0;
     P.type = type;
     P.channel = invalidDataflowID;
     allPorts.insert(pid);
+    invalidateGraph();
 
     return pid;
 }
@@ -706,26 +775,28 @@ void DFnetlist_Impl::removePort(portID p)
     else B.outPorts.erase(p);
 
     if (validChannel(P.channel)) removeChannel(P.channel);
-    name2port.erase(getPortName(p));
+    name2port.erase(portKey(P.block, P.name));
     P = Port {};
     P.nextFree = freePort;
     freePort = p;
     allPorts.erase(p);
+    invalidateGraph();
 }
 
 portID DFnetlist_Impl::getPort(blockID block, const string& name) const
 {
     assert(validBlock(block));
-    string fullname = getBlockName(block) + ":" + name;
-    const auto& it = name2port.find(fullname);
-    if (it == name2port.end()) return invalidDataflowID;
-    return it->second;
+    int sym = symbols.find(name);
+    if (sym < 0) return invalidDataflowID;
+    return name2port.find(portKey(block, sym));
 }
 
-const string& DFnetlist_Impl::getPortName(portID port, bool full) const
+string DFnetlist_Impl::getPortName(portID port, bool full) const
 {
     assert(validPort(port));
-    return full ? ports[port].full_name : ports[port].short_name;
+    const Port& P = ports[port];
+    if (not full) return symbols.name(P.name);
+    return getBlockName(P.block) + ":" + symbols.name(P.name);
 }
 
 PortType DFnetlist_Impl::getPortType(portID port) const
@@ -793,7 +864,7 @@ double DFnetlist_Impl::getCombinationalDelay(portID inp, portID outp) const
     return getPortDelay(inp) + getPortDelay(outp) + getBlockDelay(b);
 }
 
-const setPorts& DFnetlist_Impl::getPorts(blockID id, PortDirection dir) const
+const blockPorts& DFnetlist_Impl::getPorts(blockID id, PortDirection dir) const
 {
     assert(validBlock(id));
     if (dir == INPUT_PORTS) return blocks[id].inPorts;
@@ -836,9 +907,9 @@ portID DFnetlist_Impl::getDataPort(blockID id) const
 portID DFnetlist_Impl::getDemuxComplementaryPort(portID port) const
 {
     assert(validPort(port));
-    const Block& B = blocks[ports[port].block];
-    const auto& it = B.demuxPairs.find(port);
-    if (it != B.demuxPairs.end()) return it->second;
+    const BlockExtra& X = getBlockExtra(ports[port].block);
+    const auto& it = X.demuxPairs.find(port);
+    if (it != X.demuxPairs.end()) return it->second;
     return invalidDataflowID;
 }
 
@@ -881,10 +952,12 @@ channelID DFnetlist_Impl::createChannel(portID src, portID dst, int slots, bool
     C.slots = slots;
     C.transparent = transparent;
     C.backEdge = false;
+    C.coverage = 0;
     C.nextFree = invalidDataflowID;
     allChannels.insert(id);
 
     ports[src].channel = ports[dst].channel = id;
+    invalidateGraph();
     return id;
 }
 
@@ -897,6 +970,7 @@ void DFnetlist_Impl::removeChannel(channelID id)
     freeChannel = id;
     ports[C.src].channel = ports[C.dst].channel = invalidDataflowID;
     allChannels.erase(id);
+    invalidateGraph();
 }
 
 portID DFnetlist_Impl::getSrcPort(channelID id) const
@@ -1029,56 +1103,112 @@ bool DFnetlist_Impl::validChannel(channelID id) const
 }
 
 
-bool DFnetlist_Impl::channelIsInMGs(channelID c) {
-    assert(validChannel(c));
-    return channels_in_MGs.count(c) > 0;
-}
-
-bool DFnetlist_Impl::blockIsInMGs(blockID b) {
-    assert(validBlock(b));
-    return blocks_in_MGs.count(b) > 0;
-}
+void DFnetlist_Impl::makeMGsfromCFDFCs() {
+    MG_disjoint.clear();
 
-bool DFnetlist_Impl::channelIsInBorders(channelID c) {
-    assert(validChannel(c));
-    return channels_in_borders.count(c) > 0;
+    cout << "Adding Marked Graphs from CFDFCs..." << endl;
+    for (int i = 0; i < CFDFC_disjoint.size(); i++) {
+        MG_disjoint.push_back(getMGfromCFDFC(CFDFC_disjoint[i]));
+    }
+    cout << endl;
+    computeMGCoverage();
 }
 
-bool DFnetlist_Impl::blockIsInBorders(blockID b) {
-    assert(validBlock(b));
-    return blocks_in_borders.count(b) > 0;
-}
+void DFnetlist_Impl::computeMGCoverage()
+{
+    MG_disjoint_cover = vector<MGCoverage>(MG_disjoint.size());
+    for (int mg = 0; mg < MG_disjoint.size(); ++mg) {
+        MGCoverage& cover = MG_disjoint_cover[mg];
+        const subNetlist& snl = MG_disjoint[mg];
+        cover.channels.assign(snl.getChannels().begin(), snl.getChannels().end());
+        cover.blocks.assign(snl.getBlocks().begin(), snl.getBlocks().end());
+        cover.hasChannel = BitSet(vecChannelsSize());
+        cover.hasBlock = BitSet(vecBlocksSize());
+        for (channelID c: cover.channels) cover.hasChannel.insert(c);
+        for (blockID b: cover.blocks) cover.hasBlock.insert(b);
+    }
 
-bool DFnetlist_Impl::channelIsInMCLSQ(channelID c) {
-    assert(validChannel(c));
-    return channels_in_MC_LSQ.count(c) > 0;
-}
+    // Border channels and blocks of each MG
+    const GraphCSR& G = getGraph();
+    for (channelID c: G.channelList) {
+        if (not channelIsInBorders(c)) continue;
+        blockID src = G.channelSrcBlock[c];
+        blockID dst = G.channelDstBlock[c];
+        for (MGCoverage& cover: MG_disjoint_cover) {
+            if (cover.hasBlock.contains(src) or cover.hasBlock.contains(dst)) cover.borderChannels.push_back(c);
+        }
+    }
 
-bool DFnetlist_Impl::blockIsInMCLSQ(blockID b) {
-    assert(validBlock(b));
-    return blocks_in_MC_LSQ.count(b) > 0;
+    for (blockID b: G.blockList) {
+        if (not blockIsInBorders(b)) continue;
+        for (MGCoverage& cover: MG_disjoint_cover) {
+            bool connected = false;
+            for (channelID c: G.predecessors(b)) connected = connected or cover.hasBlock.contains(G.channelSrcBlock[c]);
+            for (channelID c: G.successors(b)) connected = connected or cover.hasBlock.contains(G.channelDstBlock[c]);
+            if (connected) cover.borderBlocks.push_back(b);
+        }
+    }
 }
 
-bool DFnetlist_Impl::channelIsCovered(channelID c, bool MG, bool borders, bool MC_LSQ) {
-    bool state_MG = MG ? channelIsInMGs(c) : false;
-    bool state_borders = borders ? channelIsInBorders(c) : false;
-    bool state_MC_LSQ = MC_LSQ ? channelIsInMCLSQ(c) : false;
-    return state_MG || state_borders || state_MC_LSQ;
+// Bytes of a string outside the object (the short strings are stored inside)
+static size_t stringHeapBytes(const string& s)
+{
+    return s.capacity() >= sizeof(string) ? s.capacity() + 1 : 0;
 }
 
-bool DFnetlist_Impl::blockIsCovered(blockID b, bool MG, bool borders, bool MC_LSQ) {
-    bool state_MG = MG ? blockIsInMGs(b) : false;
-    bool state_borders = borders ? blockIsInBorders(b) : false;
-    bool state_MC_LSQ = MC_LSQ ? blockIsInMCLSQ(b) : false;
-    return state_MG || state_borders || state_MC_LSQ;
-}
+size_t DFnetlist_Impl::reportMemoryUsage(ostream& s) const
+{
+    // Estimated size of a node of std::set/std::map (three pointers and the color)
+    const size_t treeNode = 4 * sizeof(void*);
 
-void DFnetlist_Impl::makeMGsfromCFDFCs() {
-    MG_disjoint.clear();
+    size_t blockBytes = blocks.capacity() * sizeof(Block);
+    for (const Block& B: blocks) {
+        blockBytes += B.inPorts.heapBytes() + B.outPorts.heapBytes() + B.allPorts.heapBytes();
+    }
 
-    cout << "Adding Marked Graphs from CFDFCs..." << endl;
-    for (int i = 0; i < CFDFC_disjoint.size(); i++) {
-        MG_disjoint.push_back(getMGfromCFDFC(CFDFC_disjoint[i]));
+    size_t arrayBytes = blockArrays.type.capacity() * sizeof(BlockType) +
+                        blockArrays.basicBlock.capacity() * sizeof(bbID) +
+                        blockArrays.delay.capacity() * sizeof(double) +
+                        blockArrays.latency.capacity() * sizeof(int) +
+                        blockArrays.II.capacity() * sizeof(int) +
+                        blockArrays.freq.capacity() * sizeof(double);
+
+    size_t extraBytes = blockExtras.bucket_count() * sizeof(void*);
+    for (const auto& it: blockExtras) {
+        const BlockExtra& X = it.second;
+        extraBytes += sizeof(void*) + sizeof(it);
+        for (const string* str: {&X.memName, &X.funcName, &X.numLoads, &X.numStores,
+                                 &X.loadOffsets, &X.storeOffsets, &X.loadPorts, &X.storePorts}) {
+            extraBytes += stringHeapBytes(*str);
+        }
+        for (const auto& ordering: X.orderings) {
+            extraBytes += treeNode + sizeof(ordering) + ordering.second.capacity() * sizeof(int);
+        }
+        extraBytes += X.listPorts.size() * sizeof(portID) + X.demuxPairs.size() * (treeNode + 2 * sizeof(portID));
     }
-    cout << endl;
+
+    size_t portBytes = ports.capacity() * sizeof(Port);
+    for (const Port& P: ports) portBytes += P.defs.size() * (treeNode + sizeof(portID));
+
+    size_t channelBytes = channels.capacity() * sizeof(Channel);
+    size_t symbolBytes = symbols.memoryUsage();
+    size_t indexBytes = symbol2block.capacity() * sizeof(blockID) + name2port.memoryUsage();
+    size_t setBytes = (allBlocks.size() + allPorts.size() + allChannels.size()) * (treeNode + sizeof(int));
+
+    size_t total = blockBytes + arrayBytes + extraBytes + portBytes + channelBytes +
+                   symbolBytes + indexBytes + setBytes;
+
+    auto line = [&s](const string& what, size_t n, size_t bytes) {
+        s << left << setw(16) << what << right << setw(10) << n << setw(14) << bytes << " bytes" << endl;
+    };
+    line("Blocks:", numBlocks(), blockBytes);
+    line("Block arrays:", numBlocks(), arrayBytes);
+    line("Block extras:", blockExtras.size(), extraBytes);
+    line("Ports:", numPorts(), portBytes);
+    line("Channels:", numChannels(), channelBytes);
+    line("Names:", symbols.size(), symbolBytes);
+    line("Name indices:", name2port.size(), indexBytes);
+    line("Iteration sets:", allBlocks.size() + allPorts.size() + allChannels.size(), setBytes);
+    line("Total:", numBlocks(), total);
+    return total;
 }
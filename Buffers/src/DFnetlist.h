@@ -3,13 +3,17 @@
 
 #include <cassert>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include "BitSet.h"
 #include "Dataflow.h"
 #include "ErrorManager.h"
 #include "FileUtil.h"
 #include "MILP_Model.h"
+#include "SymbolTable.h"
 
 // Some useful macros
 #define ForAllBlocks(b)         for (blockID b: allBlocks)
@@ -19,6 +23,8 @@
 #define ForAllOutputPorts(b,p)  for (portID p: getPorts(b, OUTPUT_PORTS))
 #define ForAllBasicBlocks(bb)   for (bbID bb = 0; bb < numBasicBlocks(); ++bb)
 
+class DotAttrs; // Defined in DotParser.h
+
 namespace Dataflow
 {
 struct milpVarsEB; // Defined locally in DFnetlist_buffers.cpp
@@ -297,7 +303,8 @@ public:
     /**
      * @brief If the BB frequencies are already define, nothing is done.
      * Otherwise, the BB frequencies are calculated treating the graph
-     * as a Markov chain. It considers that the frequency of the
+     * as a Markov chain (sparse linear system solved by Gaussian
+     * elimination, no MILP solver is used). It considers that the frequency of the
      * entry point is 1. If the probabilities of the arcs are not defined,
      * some default values are set, considering that back arcs have a
      * higher probability.
@@ -332,6 +339,10 @@ public:
         Arcs[arc].MG_numbers.push_back(number);
     }
 
+    void clearMGnumbers() {
+        for (BB_Arc& arc: Arcs) arc.MG_numbers.clear();
+    }
+
     int getDSUnumberArc(bbArcID arc) {
         return Arcs[arc].DSU_number;
     }
@@ -445,6 +456,15 @@ public:
     */
     DFnetlist_Impl(const std::string& name, const std::string& name_bb);
 
+    /**
+     * @brief Selects the reader of the dot files for the netlists read
+     * afterwards (by all threads).
+     * @param reader "native" (default) or "cgraph" (graphviz, only available
+     * if compiled with USE_GRAPHVIZ).
+     * @return True if successful, and false if the reader is not available.
+     */
+    static bool setDotReader(const std::string& reader);
+
     /**
      * @brief Checks that the netlist is well-formed.
      * @return True if it is well-formed and false otherwise.
@@ -752,9 +772,9 @@ public:
      * @brief Returns the name of a port.
      * @param port Identifier of the port.
      * @param full If asserted, the full name (block:port) is returned.
-     * @return A string with the name of the port.
+     * @return A string with the name of the port (the full name is built on demand).
      */
-    const std::string& getPortName(portID port, bool full=true) const;
+    std::string getPortName(portID port, bool full=true) const;
 
     /**
      * @brief Returns the type of a port.
@@ -841,9 +861,9 @@ public:
      * @brief Returns a set of ports with a certain direction.
      * @param id Block id (the owner of the ports).
      * @param dir Direction of the ports (input/output/all).
-     * @return The set of ports.
+     * @return The set of ports (in increasing order).
      */
-    const setPorts& getPorts(blockID id, PortDirection dir) const;
+    const blockPorts& getPorts(blockID id, PortDirection dir) const;
 
     /**
      * @brief Returns the set of ports that define values for a port.
@@ -1086,7 +1106,8 @@ public:
     bool writeDot(const std::string& filename = "");
 
     /**
-     * @brief Writes the dataflow netlist in dot format.
+     * @brief Writes the dataflow netlist in dot format. The lines of large
+     * netlists are formatted concurrently into buffers written in order.
      * @param s The output stream.
      * @return True if successful, and false otherwise.
      */
@@ -1098,6 +1119,36 @@ public:
     bool writeDotBB(const std::string& filename = "");
     bool writeDotBB(std::ostream& of);
 
+    /**
+     * @brief Writes the netlist and its BB graph in binary format (see
+     * DFbinary.h). The netlist obtained when the file is read is the same
+     * as the one obtained by reading the dot export (the ports of the
+     * blocks are normalized as in writeDot), but without parsing.
+     * @param filename The name of the file.
+     * @return True if successful, and false otherwise.
+     */
+    bool writeBinary(const std::string& filename);
+
+    /**
+     * @brief Writes a report of the memory used by the netlist: blocks,
+     * ports, channels, names and indices. The sizes are estimated from the
+     * capacities of the containers (the overhead of the allocator is not
+     * included).
+     * @param s The output stream.
+     * @return The total memory (bytes).
+     */
+    size_t reportMemoryUsage(std::ostream& s) const;
+
+    /**
+     * @brief Reads the Basic Block graph of the netlist in dot format.
+     * @param f File descriptor. The graphs of several netlists can be read
+     * sequentially from the same file.
+     * @return True if no errors, and false otherwise (no graph or error).
+     */
+    bool readBasicBlockGraph(FILE* f) {
+        return readDataflowDotBB(f);
+    }
+
     /**
      * @brief Writes the basic blocks of a dataflow netlist in dot format.
      * @param filename The name of the file. In case the filename is empty,
@@ -1138,6 +1189,54 @@ public:
     bool addElasticBuffersBB(double Period = 0, double BufferDelay = 0, bool MaxThroughput = false, double coverage = 0, int timeout = -1, bool first_MG = false);
     bool addElasticBuffersBB_sc(double Period = 0, double BufferDelay = 0, bool MaxThroughput = false, double coverage = 0, int timeout = -1, bool first_MG = false);
 
+    /**
+     * @brief Explores several periods with the same model of addElasticBuffersBB
+     * (with throughput maximization). The MGs are extracted and the MILP is created
+     * once for the largest period. For every period, only the rhs of the path
+     * constraints that depend on the period are modified. The MILPs are solved
+     * concurrently (see setMilpJobs) and a table with the period, throughput and
+     * buffers of each solution is printed, marking the Pareto-optimal ones.
+     * The netlist is not modified.
+     * @param minPeriod Smallest period.
+     * @param maxPeriod Largest period.
+     * @param step Increment of the period.
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @param timeout Time limit of each MILP (no limit if <= 0).
+     * @param first_MG If asserted, only the throughput of the first MG is maximized.
+     * @param prefix If not empty, the buffered netlist of every Pareto-optimal
+     * period is written into prefix_p<period>_graph_buf.dot (and _bbgraph_buf.dot).
+     * @return True if no error, and false otherwise.
+     */
+    bool addElasticBuffersSweep(double minPeriod, double maxPeriod, double step, double BufferDelay = 0,
+                                int timeout = -1, bool first_MG = false, const std::string& prefix = "");
+
+    /**
+     * @brief Greedy buffer placement for netlists too large for the MILPs.
+     * Every cycle gets an opaque buffer, a static timing analysis inserts an
+     * opaque buffer before each violation of the period and the buffers on the
+     * critical cycles of the MGs are moved while the throughput improves
+     * (until the target throughput is reached). The buffers are annotated in
+     * the channels, or used as MIP start of the exact placement.
+     * @param Period Cycle period (ignored if Period <= 0).
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @param targetThroughput Throughput at which the MGs are not improved any more.
+     * @param bound If asserted, the MILP of addElasticBuffersBB is created and the
+     * gap between the greedy solution and its LP relaxation is reported.
+     * @param asMilpStart If asserted, the buffers are not annotated in the channels,
+     * they are used as MIP start of the next buffer placement (see setMilpStart).
+     * @return True if no error, and false otherwise.
+     */
+    bool addElasticBuffersGreedy(double Period = 0, double BufferDelay = 0, double targetThroughput = 1,
+                                 bool bound = true, bool asMilpStart = false);
+
+    /**
+     * @brief Calculates the longest combinational path with the buffers
+     * annotated in the channels (before instantiateElasticBuffers).
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @return The critical path (infinity if there is a combinational cycle).
+     */
+    double getCriticalPath(double BufferDelay = 0);
+
     void addBorderBuffers();
     void findMCLSQ_load_channels();
     /**
@@ -1162,6 +1261,73 @@ public:
      */
     void setMilpSolver(const std::string& solver="cbc");
 
+    /**
+     * @brief Sets the number of MILP models that can be solved concurrently.
+     * @param jobs Number of parallel jobs (sequential if jobs <= 1).
+     */
+    void setMilpJobs(int jobs = 1);
+
+    /**
+     * @brief Sets a global time budget for the MILPs of the buffer placement.
+     * The budget is distributed among the MILPs according to their weight.
+     * @param seconds Budget in seconds (the timeout of each MILP is used if seconds <= 0).
+     */
+    void setMilpBudget(int seconds = -1);
+
+    /**
+     * @brief Sets the use of the LP relaxation for the buffer placement.
+     * @param mode "off", "fallback" (only when the MILP finds no solution)
+     * or "always" (the MILP is not solved).
+     * @param polish Time limit in seconds of the local MILP that polishes
+     * the rounded solution (no polish if <= 0).
+     * @return True if successful, and false otherwise (unknown mode).
+     */
+    bool setMilpRelaxation(const std::string& mode = "off", int polish = 0);
+
+    /**
+     * @brief Sets the method to extract the CFDFCs of the BB graph.
+     * @param method "milp" (one MILP per CFDFC), "graph" (longest cycles
+     * of the BB graph) or "compare" (both, reporting the differences and
+     * using the MILP).
+     * @return True if successful, and false otherwise (unknown method).
+     */
+    bool setCFDFCExtraction(const std::string& method = "milp");
+
+    /**
+     * @brief Enables the static timing analysis that removes the time
+     * variables of the ports without critical paths from the buffer MILPs.
+     * @param enable True to remove them (default), false to keep all variables.
+     */
+    void setMilpPathPruning(bool enable = true);
+
+    /**
+     * @brief Reads the buffers of a previously buffered netlist to be used
+     * as MIP start of the buffer placement.
+     * @param filename The dot file of the buffered netlist.
+     * @return True if successful, and false otherwise.
+     */
+    bool setMilpStart(const std::string& filename);
+
+    /**
+     * @brief Reads a previous buffer placement for an incremental placement.
+     * The CFDFCs of the previous run are obtained from the MG numbers of the
+     * BB graph and the disjoint sets of CFDFCs that have not changed (same BB
+     * arcs, frequencies, blocks, delays and channels) keep their buffers
+     * instead of solving their MILP again.
+     * @param filename The dot file of the buffered netlist.
+     * @param filename_bb The dot file of the buffered BB graph.
+     * @return True if successful, and false otherwise.
+     */
+    bool setPreviousPlacement(const std::string& filename, const std::string& filename_bb);
+
+    /**
+     * @brief Measures the traversals of the netlist with the sets of the blocks
+     * and with the CSR snapshot (port sweep, forward/backward DFS and SCCs)
+     * and prints the times.
+     * @param iterations Number of repetitions of each traversal.
+     */
+    void benchmarkGraph(int iterations = 10);
+
     /**
      * @brief Removes all non-SCC blocks and channels.
      * @return The netlist with only the SCCs.
@@ -1209,6 +1375,15 @@ public:
      */
     double extractMarkedGraphsBB(double coverage);
 
+    /**
+     * @brief Computes the throughput of the extracted marked graphs with the
+     * current buffers (maximum cycle ratio of latency over tokens).
+     * @param result Throughput and critical cycle of each marked graph (output).
+     * @param disjoint If asserted, the disjoint marked graphs are analyzed.
+     * @return True if successful, and false otherwise (no marked graphs).
+     */
+    bool analyzeThroughput(std::vector<ThroughputInfo>& result, bool disjoint = false);
+
     void printBlockSCCs();
     void computeSCCpublic(bool onlyMarked) {
         computeSCC(onlyMarked);
@@ -1223,60 +1398,72 @@ public:
 
 private:
 
+    // The type, BB, delay, latency, II and frequency of the blocks are in
+    // BlockArrays, and the attributes of a few kinds of blocks in BlockExtra.
     struct Block {
         blockID id;                 // Id of the block (redundant, but useful)
-        std::string name;           // Name of the block
-        BlockType type;             // Type of block
+        int name;                   // Name of the block (symbol)
         longValueType value;        // Value (only used for constants)
         bool boolValue;             // Boolean value (only used for constants)
+        bool transparent;           // Is the buffer transparent? (only for EBs)
+        bool mark;                  // Flag used for traversals
+        unsigned char coverage;     // Coverage flags (MGs, borders, MC/LSQ) for the buffer MILPs
         blockID nextFree;           // Next free block in the vector of blocks
-        bbID basicBlock;            // Basic block to which the block belongs to
-        double delay;               // Delay of the block
-        int latency;                // Latency of the block (only for Operators)
-        int II;                     // Initiation interval of the block (only for Operators)
         int slots;                  // Number of slots (only for EBs)
-        bool transparent;           // Is the buffer transparent? (only for EBs)
-        setPorts inPorts;           // Set of input ports (id's)
-        setPorts outPorts;          // Set of output ports (id's)
-        setPorts allPorts;          // All ports of the block
+        blockPorts inPorts;         // Set of input ports (id's)
+        blockPorts outPorts;        // Set of output ports (id's)
+        blockPorts allPorts;        // All ports of the block
         portID portCond;            // Port for condition (for branch/select)
         portID portTrue, portFalse; // True and false ports (for branch/select)
         portID data;                // Port for data (input for branch/demux, output for select)
         portID srcCond;             // Port that generates the condition for the branch (beyond forks)
-        double freq;                // Execution frequency (obtained from profiling)
         double frac;                // True/false fraction of select inputs (obtained from profiling)
         double retimingDiff;        // Axel
-        bool mark;                  // Flag used for traversals
         int scc_number;             // SCC number
         int DFSorder;               // Post-visit number during DFS traversal
-        std::deque<portID> listPorts;       // Temporary list of input ports (for demux pairing)
-        std::map<portID,portID> demuxPairs; // Pairs of ports in a demux. The pairs are in both directions.
         blockID bbParent;           // Disjoint set parent for BB calculation
         int bbRank;                 // Disjoint set rank for BB calculation
-        std::string operation;      // Lana: arithmetic/memory operation (instruction)
-        int memPortID;              // Lana: used to connect load/store to MC/LSQ
-        int memOffset;              // Lana: used to connect load/store to MC/LSQ
-        int memBBCount;             // Lana: number of BBs connected to MC/LSQ
-        int memLdCount;             // Lana: number of loads connected to MC/LSQ
-        int memStCount;             // Lana: number of stores connected to MC/LSQ
+        int operation;              // Lana: arithmetic/memory operation (instruction, symbol)
+    };
+
+    // Attributes of the blocks read by the traversals, the timing analysis
+    // and the MILPs, in contiguous arrays indexed by the block id
+    struct BlockArrays {
+        std::vector<BlockType> type;        // Type of block
+        std::vector<bbID> basicBlock;       // Basic block to which the block belongs to
+        std::vector<double> delay;          // Delay of the block
+        std::vector<int> latency;           // Latency of the block (only for Operators)
+        std::vector<int> II;                // Initiation interval of the block (only for Operators)
+        std::vector<double> freq;           // Execution frequency (obtained from profiling)
+    };
+
+    // Attributes of memory operations, MC/LSQ, calls, selectors and demuxes.
+    // They are only stored for the blocks that define some of them (see blockExtras).
+    struct BlockExtra {
+        int memPortID = 0;          // Lana: used to connect load/store to MC/LSQ
+        int memOffset = 0;          // Lana: used to connect load/store to MC/LSQ
+        int memBBCount = 0;         // Lana: number of BBs connected to MC/LSQ
+        int memLdCount = 0;         // Lana: number of loads connected to MC/LSQ
+        int memStCount = 0;         // Lana: number of stores connected to MC/LSQ
         std::string memName;        // LSQ/MC name
         std::string funcName;       // Lana: name of called function (for call instruction)
-        int fifoDepth;              // Lana: LSQ depth
+        int fifoDepth = 0;          // Lana: LSQ depth
         // Lana: LSQ json configuration info
-        std::string numLoads;       
+        std::string numLoads;
         std::string numStores;
         std::string loadOffsets;
         std::string storeOffsets;
         std::string loadPorts;
         std::string storePorts;
-        int getptrc; // Lana: constant for getelementpointer dimensions
+        int getptrc = 0; // Lana: constant for getelementpointer dimensions
         map<bbID, vector<int>> orderings; //Axel : used by selector to know order of execution
+        std::deque<portID> listPorts;       // Temporary list of input ports (for demux pairing)
+        std::map<portID,portID> demuxPairs; // Pairs of ports in a demux. The pairs are in both directions.
     };
 
     struct Port {
         portID id;              // Identifier of the port
-        std::string short_name; // Name of the port
-        std::string full_name;  // Full name of the port (block:port)
+        int name;               // Name of the port (symbol, the full name block:port is not stored)
         blockID block;          // Owner of the port
         portID nextFree;        // Next free slot in the vector of ports
         bool isInput;           // Direction of the port
@@ -1285,7 +1472,7 @@ private:
         PortType type;          // Type: generic, selection, sel_true or sel_false
         channelID channel;      // Channel connected to the port
         setPorts defs;          // Set of definitions (ports) reaching this port
-        std::string memPortSuffix;  // Lana: MC/LSQ port suffix, to distinguish port types of MC/LSQ
+        int memPortSuffix;      // Lana: MC/LSQ port suffix, to distinguish port types of MC/LSQ (symbol)
     };
 
     struct Channel {
@@ -1298,6 +1485,82 @@ private:
         channelID nextFree;         // Next free slot in the vector of channels
         bool mark;                  // Flag used for traversals
         double freq;                // number of times this channels is executed
+        unsigned char coverage;     // Coverage flags (MGs, borders, MC/LSQ) for the buffer MILPs
+    };
+
+    // Flags of the coverage of blocks and channels (see channelIsCovered)
+    enum CoverageFlag {
+        COVER_MG = 1,       // In a marked graph
+        COVER_BORDER = 2,   // In the border of a marked graph
+        COVER_MC_LSQ = 4    // Between a load and an MC/LSQ
+    };
+
+    // Immutable compressed-sparse-row snapshot of the topology of the netlist.
+    // The ports of every block and the channels leaving/entering every block
+    // are stored in contiguous arrays, so that traversals do not chase the
+    // nodes of the sets. The membership to MGs, borders and MC/LSQ is stored
+    // as flags of the blocks and channels (see channelIsCovered).
+    // All vectors are indexed by id (the invalid ids have empty ranges).
+    // The ports of a block are in ascending order of id (first the inputs,
+    // then the outputs), as in the sets of the block.
+    struct GraphCSR {
+        // Contiguous range of ids (for range-based loops)
+        struct Range {
+            const int* first;
+            const int* last;
+            const int* begin() const { return first; }
+            const int* end() const { return last; }
+            int size() const { return last - first; }
+            bool empty() const { return first == last; }
+        };
+
+        vecBlocks blockList;            // Valid blocks in ascending order
+        vecChannels channelList;        // Valid channels in ascending order
+
+        std::vector<int> portBegin;     // First port of each block in blockPorts (size: #blocks + 1)
+        std::vector<int> inputEnd;      // End of the input ports of each block in blockPorts
+        vecPorts blockPorts;            // Ports of all blocks
+        vecBlocks portBlock;            // Owner of each port
+        vecChannels portChannel;        // Channel connected to each port (invalidDataflowID if none)
+
+        vecPorts channelSrc;            // Source port of each channel
+        vecPorts channelDst;            // Destination port of each channel
+        vecBlocks channelSrcBlock;      // Source block of each channel
+        vecBlocks channelDstBlock;      // Destination block of each channel
+
+        std::vector<int> succBegin;     // First output channel of each block in succChannel (size: #blocks + 1)
+        vecChannels succChannel;        // Output channels (in order of output ports)
+        std::vector<int> predBegin;     // First input channel of each block in predChannel (size: #blocks + 1)
+        vecChannels predChannel;        // Input channels (in order of input ports)
+
+        Range range(const std::vector<int>& v, int from, int to) const {
+            return Range {v.data() + from, v.data() + to};
+        }
+
+        // Input ports of a block
+        Range inputs(blockID b) const {
+            return range(blockPorts, portBegin[b], inputEnd[b]);
+        }
+
+        // Output ports of a block
+        Range outputs(blockID b) const {
+            return range(blockPorts, inputEnd[b], portBegin[b+1]);
+        }
+
+        // All ports of a block
+        Range ports(blockID b) const {
+            return range(blockPorts, portBegin[b], portBegin[b+1]);
+        }
+
+        // Channels leaving a block
+        Range successors(blockID b) const {
+            return range(succChannel, succBegin[b], succBegin[b+1]);
+        }
+
+        // Channels entering a block
+        Range predecessors(blockID b) const {
+            return range(predChannel, predBegin[b], predBegin[b+1]);
+        }
     };
 
     // Structure to represent a fragment of a netlist.
@@ -1543,9 +1806,41 @@ private:
     bbID entryBB;               // Entry basic block
 
     std::string milpSolver;     // Name of the MILP solver
+    int milpJobs;               // Number of MILP models solved concurrently
+    int milpBudget;             // Global time budget of the MILPs (seconds, <= 0 if none)
+    std::string milpRelaxation; // Use of the LP relaxation (off, fallback or always)
+    int milpPolish;             // Time limit of the polish of the rounded LP (seconds, <= 0 if none)
+    std::string cfdfcExtraction; // Method to extract the CFDFCs (milp, graph or compare)
+    bool milpPathPruning;       // Whether the non-critical ports are removed from the path constraints
+    // MIP start for the buffers: channel name -> (slots, transparent)
+    std::map<std::string, std::pair<int,bool>> milpStart;
+    bool hasMilpStart;          // Whether a MIP start has been defined
+    // Buffers of the previous placement for each disjoint set of CFDFCs:
+    // signature of the set -> (channel name -> (slots, transparent))
+    std::map<std::string, std::map<std::string, std::pair<int,bool>>> prevPlacement;
+    bool hasPrevPlacement;      // Whether a previous placement has been defined
+
+    BlockArrays blockArrays;            // Hot attributes of the blocks (indexed by block id)
+    std::unordered_map<blockID, BlockExtra> blockExtras; // Attributes of a few kinds of blocks
 
-    std::map<std::string,blockID> name2block; // Map to obtain blocks from names
-    std::map<std::string,portID> name2port;   // Map to obtain ports from names (string = "block:port")
+    /**
+     * @brief Returns the attributes of a block stored in blockExtras.
+     * @param id The block.
+     * @return The attributes (the default values if the block has none).
+     */
+    const BlockExtra& getBlockExtra(blockID id) const;
+
+    SymbolTable symbols;                // Names of the blocks and ports (and operations)
+    std::vector<blockID> symbol2block;  // Block of each symbol (invalidDataflowID if none)
+    IdMap name2port;                    // Map to obtain ports from (block, symbol of the name), see portKey
+
+    /**
+     * @brief Returns the key of a port in name2port.
+     * @param block The block of the port.
+     * @param name The symbol of the name of the port.
+     * @return The key.
+     */
+    static uint64_t portKey(blockID block, int name) { return (uint64_t(block) << 32) | uint32_t(name); }
 
     // Maps from/to blokcs/ports to strings
     static std::map<BlockType,std::string> BlockType2String;
@@ -1559,18 +1854,21 @@ private:
     std::vector<subNetlist> MG;     // Extracted marked graphs in order of importance
     std::vector<double> MGfreq;     // Execution frequency of Marked Graphs
 
-    setBlocks blocks_in_MGs;
-    setChannels channels_in_MGs;
-
-    setBlocks blocks_in_borders;
-    setChannels channels_in_borders;
-
-    setBlocks blocks_in_MC_LSQ;
-    setChannels channels_in_MC_LSQ;
-
     std::vector<subNetlist> MG_disjoint; // All marked graphs that make the disjoint sets
     std::vector<double> MG_disjoint_freq;
 
+    // Coverage of a disjoint set of MGs, precomputed for the constraint
+    // generators of the buffer MILPs (all lists in ascending order of id)
+    struct MGCoverage {
+        vecChannels channels;       // Channels of the MG
+        vecBlocks blocks;           // Blocks of the MG
+        vecChannels borderChannels; // Border channels with one end in the MG
+        vecBlocks borderBlocks;     // Border blocks connected to the MG
+        BitSet hasChannel;          // Channels of the MG (for membership queries)
+        BitSet hasBlock;            // Blocks of the MG (for membership queries)
+    };
+    std::vector<MGCoverage> MG_disjoint_cover;
+
     std::vector<subNetlistBB> CFDFC;
     std::vector<double> CFDFCfreq;
 
@@ -1580,6 +1878,9 @@ private:
 
     std::vector<vector<int> > components;  // each index corresponds to the CFDFCs the DSU_CFDFC is built of
 
+    GraphCSR graphCSR;      // CSR snapshot of the netlist (see getGraph)
+    bool graphValid;        // Whether the snapshot is up to date
+
     // Structure to store the MILP variables
     // Note: the out_retime variables are only used for pipelined units (latency > 0)
     struct milpVarsEB {
@@ -1587,6 +1888,7 @@ private:
         vector<int> buffer_slots;       // Number of slots of the elastic buffer
         vector<int> has_buffer;         // Boolean variable to indicate whether there is a buffer
         vector<int> time_path;          // Combinational arrival time for ports
+        vector<double> time_path_fixed; // Fixed time of the non-critical ports (-1 if the port has a time variable)
         vector<int> time_elastic;       // Arrival time for elasticity (longest rigid fragment)
         vector<vector<int>> in_retime_tokens;  // Input retiming variables for tokens (indices: [MarkedGraph,block])
         vector<vector<int>> out_retime_tokens; // Output retiming variables for tokens (indices: [MarkedGraph,block]).
@@ -1594,6 +1896,19 @@ private:
         vector<vector<int>> th_tokens;  // Throughput associated to every channel for tokens (indices: [MargedGraph, channel])
         vector<vector<int>> th_bubbles; // Throughput associated to every channel for bubbles (indices: [MargedGraph, channel])
         vector<int> th_MG;              // Throughput variables (one for each marked graph)
+
+        // Constraint whose rhs depends on the period: rhs + coef * (period - period of the model)
+        struct PeriodRow {
+            int row;        // Index of the row
+            double coef;    // Coefficient of the period
+            double rhs;     // Rhs for the period of the model
+        };
+        vector<PeriodRow> period_rows;  // Rows that depend on the period (for period sweeps)
+        double period_shift = 0;        // Smallest period minus the period of the model (<= 0, for period sweeps)
+
+        bool isPathFixed(portID p) const {
+            return p < time_path_fixed.size() and time_path_fixed[p] >= 0;
+        }
     };
 
     /**
@@ -1640,9 +1955,78 @@ private:
      */
     bool readDataflowDot(FILE* f);
 
+    /**
+     * @brief Reads a netlist (and its BB graph, if present) in binary format.
+     * The file is mapped in memory and the records are read in place.
+     * @param filename Name of the file.
+     * @return True if no errors, and false otherwise.
+     */
+    bool readBinary(const std::string& filename);
+
+    /**
+     * @brief Reads a netlist in dot or binary format (detected by the
+     * magic number of the binary files).
+     * @param filename Name of the file.
+     * @return True if no errors, and false otherwise.
+     */
+    bool readNetlist(const std::string& filename);
+
     bool readDataflowDotBB(FILE *f);
     bool readDataflowDotBB(const std::string& filename);
 
+    /**
+     * @brief Reads the name and the attributes of the graph of a netlist. The
+     * functions readDot* are shared by the native reader and graphviz.
+     * @param name Name of the graph.
+     * @param attrs Attributes of the graph.
+     * @return True if no errors, and false otherwise.
+     */
+    bool readDotGraph(const std::string& name, const DotAttrs& attrs);
+
+    /**
+     * @brief Creates a block from a node of the dot file.
+     * @param name Name of the node.
+     * @param attrs Attributes of the node.
+     * @return True if no errors, and false otherwise.
+     */
+    bool readDotBlock(const std::string& name, const DotAttrs& attrs);
+
+    /**
+     * @brief Creates a channel from an edge of the dot file.
+     * @param src_name Name of the tail node.
+     * @param dst_name Name of the head node.
+     * @param attrs Attributes of the edge.
+     * @param src_attrs Attributes of the tail node (slots and transparency of the channel).
+     * @return True if no errors, and false otherwise.
+     */
+    bool readDotChannel(const std::string& src_name, const std::string& dst_name,
+                        const DotAttrs& attrs, const DotAttrs& src_attrs);
+
+    /**
+     * @brief Creates a basic block from a node of the dot file of the BB graph.
+     * @param name Name of the node.
+     * @param name2bbID Map from names to basic blocks (updated).
+     * @return True if no errors, and false otherwise.
+     */
+    bool readDotBasicBlock(const std::string& name, std::map<std::string, bbID>& name2bbID);
+
+    /**
+     * @brief Creates an arc of the BB graph from an edge of the dot file.
+     * @param src_name Name of the tail node.
+     * @param dst_name Name of the head node.
+     * @param attrs Attributes of the edge (freq and MG).
+     * @param name2bbID Map from names to basic blocks.
+     * @return True if no errors, and false otherwise.
+     */
+    bool readDotBasicBlockArc(const std::string& src_name, const std::string& dst_name,
+                              const DotAttrs& attrs, const std::map<std::string, bbID>& name2bbID);
+
+    /**
+     * @brief Sets the entry and exit basic blocks and the frequencies of the
+     * basic blocks after the BB graph has been read.
+     */
+    void finishBasicBlockGraph();
+
     /**
      * @brief Generates a fresh name for a block.
      * @param type Type of the block.
@@ -1794,7 +2178,7 @@ private:
      * @return True if they have the same width, and false otherwise.
      * @note An error is generated in case they have different width.
      */
-    bool checkSamePortWidth(const setPorts& P);
+    bool checkSamePortWidth(const blockPorts& P);
 
     /**
      * @brief Check that a block has a certain number of input/output ports.
@@ -1815,15 +2199,17 @@ private:
     * @brief Writes the information of a block in dot format.
     * @param s The output stream.
     * @param id The block id.
+    * @note Only reads the netlist, so that several blocks can be written concurrently.
     */
-    void writeBlockDot(std::ostream& s, blockID id);
+    void writeBlockDot(std::ostream& s, blockID id) const;
 
     /**
     * @brief Writes the information of a channel in dot format.
     * @param s The output stream.
     * @param id The channel id.
+    * @note Can be called concurrently, as writeBlockDot.
     */
-    void writeChannelDot(std::ostream& s, channelID id);
+    void writeChannelDot(std::ostream& s, channelID id) const;
 
     //SHAB_note: implement these
     void writeBasicBlockDot(std::ostream& s, bbID id);
@@ -1957,6 +2343,72 @@ private:
         return milpSolver;
     }
 
+    /**
+     * @return The number of MILP models that can be solved concurrently.
+     */
+    int getMilpJobs() const {
+        return milpJobs;
+    }
+
+    /**
+     * @return The global time budget of the MILPs in seconds (<= 0 if none).
+     */
+    int getMilpBudget() const {
+        return milpBudget;
+    }
+
+    /**
+     * @return The use of the LP relaxation (off, fallback or always).
+     */
+    const std::string& getMilpRelaxation() const {
+        return milpRelaxation;
+    }
+
+    /**
+     * @return The time limit of the polish of the rounded LP in seconds (<= 0 if none).
+     */
+    int getMilpPolish() const {
+        return milpPolish;
+    }
+
+    /**
+     * @return The method to extract the CFDFCs (milp, graph or compare).
+     */
+    const std::string& getCFDFCExtraction() const {
+        return cfdfcExtraction;
+    }
+
+    /**
+     * @return Whether the non-critical ports are removed from the path constraints.
+     */
+    bool getMilpPathPruning() const {
+        return milpPathPruning;
+    }
+
+    /**
+     * @brief Returns the CSR snapshot of the netlist. The snapshot is built
+     * the first time it is requested after a change of the blocks, ports or
+     * channels.
+     * @return The snapshot (valid until the next change of the netlist).
+     */
+    const GraphCSR& getGraph() {
+        if (not graphValid) buildGraph();
+        return graphCSR;
+    }
+
+    /**
+     * @brief Invalidates the CSR snapshot (called by the methods that
+     * create or remove blocks, ports and channels).
+     */
+    void invalidateGraph() {
+        graphValid = false;
+    }
+
+    /**
+     * @brief Builds the CSR snapshot.
+     */
+    void buildGraph();
+
     /**
      * @brief Creates the variables of an MILP model for the insertion of buffers.
      * @param milp MILP model.
@@ -1967,6 +2419,18 @@ private:
     void createMilpVarsEB_sc(Milp_Model& milp, milpVarsEB& vars, bool max_throughput, int mg, bool first_MG= false);
     void createMilpVars_remaining(Milp_Model& milp, milpVarsEB& vars);
 
+    /**
+     * @brief Sets the names of the variables of an MILP model for the insertion
+     * of buffers. The variables are created without name and the names are only
+     * built from the netlist when the model is written with names (writeLP).
+     * @param milp MILP model.
+     * @param vars Structure storing the MILP variables (must outlive the model).
+     * @param suffix Suffix of the names of the channel and port variables.
+     * @param mgSuffix Suffix of the names of the variables of each marked graph.
+     */
+    void setMilpVarNamesEB(Milp_Model& milp, const milpVarsEB& vars, const std::string& suffix,
+                           std::function<std::string(int)> mgSuffix);
+
     /**
      * @brief Creates the path constraints for the MILP model.b The constraints
      * ensure that no combinational path will be longer than the period.
@@ -1980,6 +2444,60 @@ private:
     bool createPathConstraints_sc(Milp_Model& milp, milpVarsEB& Vars, double Period, double BufferDelay, int mg);
     bool createPathConstraints_remaining(Milp_Model& milp, milpVarsEB& Vars, double Period, double BufferDelay);
 
+    /**
+     * @brief Static timing analysis of the netlist for the path constraints.
+     * A port is not critical if the longest combinational path through it
+     * (without new buffers) is not longer than the period.
+     * @param Period Cycle period (ignored if Period <= 0).
+     * @param BufferDelay Clk-Q delay of the elastic buffer.
+     * @param MG Indicates whether the opaque buffers of the channels in the
+     * MGs cut paths (as in the MILP of the remaining channels).
+     * @return The arrival time of each non-critical port (-1 for the critical
+     * ports). Empty if the pruning of path constraints is disabled.
+     */
+    std::vector<double> computeNonCriticalPorts(double Period, double BufferDelay, bool MG = false);
+
+    /**
+     * @brief Adds a path constraint to the MILP. The time of the non-critical
+     * ports is substituted by their arrival time and the constraint is
+     * dropped if it is always satisfied.
+     * @param milp MILP model.
+     * @param Vars Structure that contains the MILP variables.
+     * @param ports Terms of the constraint with the time of ports (coefficient, port).
+     * @param type Type of constraint ('<', '>' or '=').
+     * @param rhs Right-hand side of the constraint.
+     * @param flops Terms of the constraint with boolean variables (coefficient, variable).
+     * @param periodCoef Coefficient of the period in the rhs. The rows with a
+     * non-zero coefficient are recorded in Vars.period_rows.
+     */
+    void newPathRow(Milp_Model& milp, milpVarsEB& Vars, const Milp_Model::vecTerms& ports,
+                    char type, double rhs, const Milp_Model::vecTerms& flops = {}, double periodCoef = 0);
+
+    /**
+     * @brief Calculates the smallest period that satisfies the delays of the
+     * blocks and ports checked by the path constraints.
+     * @param BufferDelay Clk-Q delay of the elastic buffer.
+     * @return The smallest period.
+     */
+    double getMinimumPeriod(double BufferDelay);
+
+    /**
+     * @brief Static timing analysis of the greedy buffer placement. The ports
+     * are visited in topological order and an opaque buffer is inserted in a
+     * channel when the delay of its destination block would exceed the period
+     * (i.e., as late as possible on each path).
+     * @param Period Cycle period.
+     * @param BufferDelay Clk-Q delay of the elastic buffer.
+     * @param flop Channels with an opaque buffer (input and output). They must cut all the cycles.
+     * @param eligible Channels in which a buffer can be inserted.
+     * @param arrival Arrival time of each port (output).
+     * @param step Delay from each input port to the next sequential element or output port (output).
+     * @return The largest violation of the period (not positive if the period is met).
+     */
+    double greedyTiming(double Period, double BufferDelay, std::vector<bool>& flop,
+                        const std::vector<bool>& eligible, std::vector<double>& arrival,
+                        std::vector<double>& step);
+
     /**
      * @brief Creates the elasticity constraints for the MILP model. The constraints
      * ensure that every cycle will have one elastic buffer at least (maybe transparent).
@@ -2003,17 +2521,59 @@ private:
     bool createThroughputConstraints(Milp_Model& milp, milpVarsEB& Vars, bool first_MG= false);
     bool createThroughputConstraints_sc(Milp_Model& milp, milpVarsEB& Vars, int mg, bool first_MG= false);
 
-    bool channelIsInMGs(channelID c);
-    bool blockIsInMGs(blockID b);
+    /**
+     * @brief Adds a channel to the MGs, the borders or the MC/LSQ channels.
+     * @param c Id of the channel.
+     * @param flag Coverage to be added.
+     */
+    void coverChannel(channelID c, CoverageFlag flag) {
+        assert(validChannel(c));
+        channels[c].coverage |= flag;
+    }
+
+    /**
+     * @brief Adds a block to the MGs, the borders or the MC/LSQ blocks.
+     * @param b Id of the block.
+     * @param flag Coverage to be added.
+     */
+    void coverBlock(blockID b, CoverageFlag flag) {
+        assert(validBlock(b));
+        blocks[b].coverage |= flag;
+    }
+
+    bool channelIsInMGs(channelID c) const { return channelIsCovered(c, true, false, false); }
+    bool blockIsInMGs(blockID b) const { return blockIsCovered(b, true, false, false); }
+
+    bool channelIsInBorders(channelID c) const { return channelIsCovered(c, false, true, false); }
+    bool blockIsInBorders(blockID b) const { return blockIsCovered(b, false, true, false); }
+
+    bool channelIsInMCLSQ(channelID c) const { return channelIsCovered(c, false, false, true); }
+    bool blockIsInMCLSQ(blockID b) const { return blockIsCovered(b, false, false, true); }
 
-    bool channelIsInBorders(channelID c);
-    bool blockIsInBorders(blockID b);
+    /**
+     * @brief Checks whether a channel is covered by the MGs, the borders or
+     * the MC/LSQ channels (only those selected by the parameters).
+     */
+    bool channelIsCovered(channelID c, bool MG, bool borders, bool MC_LSQ) const {
+        assert(validChannel(c));
+        return channels[c].coverage & (MG * COVER_MG | borders * COVER_BORDER | MC_LSQ * COVER_MC_LSQ);
+    }
 
-    bool channelIsInMCLSQ(channelID c);
-    bool blockIsInMCLSQ(blockID b);
+    /**
+     * @brief Checks whether a block is covered by the MGs, the borders or
+     * the MC/LSQ blocks (only those selected by the parameters).
+     */
+    bool blockIsCovered(blockID b, bool MG, bool borders, bool MC_LSQ) const {
+        assert(validBlock(b));
+        return blocks[b].coverage & (MG * COVER_MG | borders * COVER_BORDER | MC_LSQ * COVER_MC_LSQ);
+    }
 
-    bool channelIsCovered(channelID c, bool MG, bool borders, bool MC_LSQ);
-    bool blockIsCovered(blockID b, bool MG, bool borders, bool MC_LSQ);
+    /**
+     * @brief Computes the coverage of the disjoint sets of MGs (MG_disjoint_cover)
+     * from MG_disjoint and the borders. It must be called again if the borders
+     * or the disjoint MGs change.
+     */
+    void computeMGCoverage();
     /**
      * @brief Writes details of the MILP solution into cout (for debugging purposes).
      * @param milp The MILP model.
@@ -2023,6 +2583,67 @@ private:
 
     void writeRetimingDiffs(const Milp_Model& milp, const milpVarsEB& vars);
 
+    /**
+     * @brief Creates the MILP model for the buffers of a disjoint MG.
+     * @param milp The MILP model (already initialized).
+     * @param vars The MILP variables.
+     * @param mg The index of the disjoint MG.
+     * @return True if successful, and false otherwise.
+     * @note The netlist is not modified, except for the error message.
+     */
+    bool createMilpModelEB_sc(Milp_Model& milp, milpVarsEB& vars, int mg, double Period,
+                              double BufferDelay, bool MaxThroughput, bool first_MG);
+
+    /**
+     * @brief Defines the MIP start of the buffer variables from the buffers
+     * read by setMilpStart (no buffer for the channels not found).
+     * @param milp The MILP model.
+     * @param vars The MILP variables.
+     */
+    void setMilpStartEB(Milp_Model& milp, const milpVarsEB& vars);
+
+    /**
+     * @brief Calculates a signature of a disjoint set of CFDFCs with everything
+     * that determines its MILP: BB arcs and frequencies of the CFDFCs, blocks,
+     * delays and channels of the marked graph and the blocks at its borders.
+     * @param mg The index of the disjoint set.
+     * @return The signature (equal for two identical sets of different netlists).
+     */
+    std::string disjointSetSignature(int mg);
+
+    /**
+     * @brief Annotates the buffers of the previous placement in the channels
+     * of a disjoint set if the set has not changed.
+     * @param mg The index of the disjoint set.
+     * @return True if the set has been found in the previous placement.
+     */
+    bool carryOverBuffers(int mg);
+
+    /**
+     * @brief Annotates the buffers of the solution of a disjoint MG in the channels.
+     * @param milp The solved MILP model.
+     * @param vars The MILP variables.
+     * @param mg The index of the disjoint MG.
+     * @return True if successful, and false otherwise (no solution found).
+     */
+    bool applyMilpSolutionEB_sc(const Milp_Model& milp, const milpVarsEB& vars, int mg,
+                                bool MaxThroughput, bool first_MG);
+
+    /**
+     * @brief Solves a MILP model of the buffer placement. Depending on
+     * getMilpRelaxation(), the LP relaxation is solved when the MILP finds
+     * no solution (or instead of the MILP). The buffer variables are then
+     * rounded, the rounding is repaired until the continuous variables are
+     * feasible and, optionally, polished with a MILP on the fractional
+     * channels. The model keeps the final solution.
+     * @param milp The MILP model.
+     * @param vars The MILP variables.
+     * @param timeout Time limit in seconds of each solve (no limit if <= 0).
+     * @param report Summary of the relaxation (output, empty if not used).
+     * @return The elapsed time in ms.
+     */
+    uint32_t solveMilpEB(Milp_Model& milp, const milpVarsEB& vars, int timeout, std::string& report);
+
     /**
      * @brief Makes some buffers non-transparent to cut combinational cycles.
      * @note This function should be rarely invoked. It is only necessary when
@@ -2113,6 +2734,17 @@ private:
      */
     subNetlistBB extractMarkedGraphBB(const map<bbID, double>& freq);
 
+    /**
+     * @brief Extracts the same kind of CFDFC as extractMarkedGraphBB without
+     * solving a MILP: a cycle of the BB graph with exactly one back arc that
+     * maximizes its minimum frequency times its number of arcs. Since the
+     * forward arcs are acyclic, for every frequency threshold the cycles are
+     * found as longest paths of forward arcs closed by a back arc.
+     * @param freq A map indicating the execution frequency of the arcs.
+     * @return The selected BBs and arcs (empty if there is no cycle).
+     */
+    subNetlistBB extractMarkedGraphBBcycles(const map<bbArcID, double>& freq);
+
     /**
      * @brief Calculates the blocks and channels corresponding to a graph of Basic Blocks and Arcs.
      * @param BB_CFDFC A subNetlistBB of BBs and Arcs.
@@ -2126,6 +2758,13 @@ private:
 
     void makeMGsfromCFDFCs();
 
+    /**
+     * @brief Computes the throughput of a marked graph with the current buffers.
+     * @param mg The marked graph.
+     * @return The throughput and the critical cycle.
+     */
+    ThroughputInfo analyzeThroughput(const subNetlist& mg) const;
+
 
     /**
      * @brief Sets a unit delay for each block.
@@ -2187,6 +2826,43 @@ public:
      */
     bool writeDot(std::ostream& s);
 
+    /**
+     * @brief Reads the Basic Block graphs of the functions of the library.
+     * The file must contain one graph for each function, in the same order
+     * as the functions.
+     * @param filename Name of the file (dot format).
+     * @return True if successful, and false if an error is produced.
+     */
+    bool addBB(const string& filename);
+
+    /**
+     * @brief Writes the Basic Block graphs of the functions in dot format.
+     * @param filename The name of the file. In case the filename is empty,
+     * it is written into cout.
+     * @return true if successful, and false otherwise.
+     */
+    bool writeDotBB(const std::string& filename = "");
+
+    /**
+     * @brief Adds elastic buffers to all the functions of the library. The
+     * functions are buffered concurrently by a pool of workers with one
+     * queue each (largest functions first). A worker with an empty queue
+     * steals functions from the other queues. Each function is buffered with
+     * its own settings (solver, jobs, etc.) and its own MILP models. The
+     * buffers are instantiated and a report with the buffers, critical path
+     * and throughput of each function is printed.
+     * @param Period Cycle period.
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @param set If asserted, set optimization is used (see addElasticBuffersBB_sc).
+     * @param timeout Time limit of each MILP in seconds (no limit if <= 0).
+     * @param first_MG If asserted, only the throughput of the first MG is maximized.
+     * @param jobs Number of functions buffered concurrently (number of cores if <= 0).
+     * @param report Name of the file of the report (not written if empty).
+     * @return True if all functions were buffered without errors, and false otherwise.
+     */
+    bool addElasticBuffers(double Period, double BufferDelay, bool set = true, int timeout = -1,
+                           bool first_MG = false, int jobs = 0, const std::string& report = "");
+
     /**
      * @brief Sets an error message for the library
      * @param err The error message
@@ -8,19 +8,21 @@ using namespace std;
 
 void DFnetlist_Impl::DFS(bool forward, bool onlyMarked)
 {
+    const GraphCSR& G = getGraph();
+
     // Vector to detect the blocks that have been visited
     // or have been processed.
     vector<bool> visited(blocks.size());
 
     // All the blocks are not visited, except those that are marked
-    ForAllBlocks(b) visited[b] = onlyMarked and not isBlockMarked(b);
+    for (blockID b: G.blockList) visited[b] = onlyMarked and not isBlockMarked(b);
 
     // Visiting order of blocks (first: entry nodes). This is necessary
     // to properly identify the back edges. DFS must start from the
     // entry nodes (see theory in Compilers book)
     listBlocks lBlocks;
     int clock = 0;
-    ForAllBlocks(b) {
+    for (blockID b: G.blockList) {
         setDFSorder(b, -1);
         if (visited[b]) continue;
         if (getBlockType(b) == FUNC_ENTRY) lBlocks.push_front(b);
@@ -32,21 +34,22 @@ void DFnetlist_Impl::DFS(bool forward, bool onlyMarked)
     DFSorder = vector<blockID>(clock);
     stack<blockID> S, listChildren;
 
-    for (blockID b: lBlocks) {
-        if (visited[b]) continue;
-        S.push(b);
-        visited[b] = true;
-
-        // Put the children to the pending list. The lists of children
-        // from different blocks are separated by an invalidDataflowID
+    // Puts the children to the pending list. The lists of children
+    // from different blocks are separated by an invalidDataflowID
+    auto pushChildren = [&](blockID b) {
         listChildren.push(invalidDataflowID);
-        const setPorts& ports = getPorts(b, (forward ? OUTPUT_PORTS : INPUT_PORTS));
-        for (portID p: ports) {
-            channelID c = getConnectedChannel(p);
+        for (channelID c: (forward ? G.successors(b) : G.predecessors(b))) {
             if (onlyMarked and not isChannelMarked(c)) continue; // Skip if the channel is not marked
-            blockID other_b = getBlockFromPort(getConnectedPort(p));
+            blockID other_b = forward ? G.channelDstBlock[c] : G.channelSrcBlock[c];
             if (not visited[other_b]) listChildren.push(other_b);
         }
+    };
+
+    for (blockID b: lBlocks) {
+        if (visited[b]) continue;
+        S.push(b);
+        visited[b] = true;
+        pushChildren(b);
 
         while (not S.empty()) {
             blockID kid = listChildren.top();
@@ -59,21 +62,14 @@ void DFnetlist_Impl::DFS(bool forward, bool onlyMarked)
                 if (visited[kid]) continue;
                 S.push(kid);
                 visited[kid] = true;
-                listChildren.push(invalidDataflowID);
-                const setPorts& ports = getPorts(kid, (forward ? OUTPUT_PORTS : INPUT_PORTS));
-                for (portID p: ports) {
-                    channelID c = getConnectedChannel(p);
-                    if (onlyMarked and not isChannelMarked(c)) continue; // Skip if the channel is not marked
-                    blockID other_b = getBlockFromPort(getConnectedPort(p));
-                    if (not visited[other_b]) listChildren.push(other_b);
-                }
+                pushChildren(kid);
             }
         }
     }
 
     assert(clock == 0);
 
-    ForAllBlocks(b) {
+    for (blockID b: G.blockList) {
         int i = getDFSorder(b);
         assert((onlyMarked and not isBlockMarked(b)) or (i < DFSorder.size()));
         if (i >= 0) DFSorder[i] = b;
@@ -85,10 +81,11 @@ void DFnetlist_Impl::computeSCC(bool onlyMarked)
 {
     DFS(false, onlyMarked); // DFS with the reverse graph
 
+    const GraphCSR& G = getGraph();
     SCC.clear();
 
     vector<bool> visited(blocks.size());
-    ForAllBlocks(b) {
+    for (blockID b: G.blockList) {
         visited[b] = onlyMarked and not isBlockMarked(b);
         setDFSorder(b, -1);
     }
@@ -110,10 +107,9 @@ void DFnetlist_Impl::computeSCC(bool onlyMarked)
         while (not s.empty()) {
             blockID v = s.top();
             s.pop();
-            ForAllOutputPorts(v, p) {
-                channelID c = getConnectedChannel(p);
+            for (channelID c: G.successors(v)) {
                 if (onlyMarked and not isChannelMarked(c)) continue; // Skip if the channel is not marked
-                blockID other_b = getBlockFromPort(getConnectedPort(p));
+                blockID other_b = G.channelDstBlock[c];
                 if (not visited[other_b]) {
                     visited[other_b] = true;
                     s.push(other_b);
@@ -133,19 +129,17 @@ void DFnetlist_Impl::computeSCC(bool onlyMarked)
     });
 
     // Assign SCC numbers to all blocks
-    ForAllBlocks(b) blocks[b].scc_number = -1;
+    for (blockID b: G.blockList) blocks[b].scc_number = -1;
     for (int n = 0; n < SCC.size(); ++n) {
         for (blockID b: SCC[n].getBlocks()) blocks[b].scc_number = n;
     }
 
     // Revisit all channels and add all those that may also be inside the SCCs and have not been visited
-    ForAllChannels(c) {
+    for (channelID c: G.channelList) {
         if (onlyMarked and not isChannelMarked(c)) continue; // Skip if the channel is not marked
-        blockID src = getSrcBlock(c);
-        int scc = blocks[src].scc_number;
+        int scc = blocks[G.channelSrcBlock[c]].scc_number;
         if (scc < 0) continue; // Not in an SCC
-        blockID dst = getDstBlock(c);
-        if (scc == blocks[dst].scc_number) SCC[scc].insertChannel(*this, c);
+        if (scc == blocks[G.channelDstBlock[c]].scc_number) SCC[scc].insertChannel(*this, c);
     }
 }
 
@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <functional>
 #include "DFnetlist.h"
 
 using namespace Dataflow;
@@ -30,16 +33,37 @@ double DFnetlist_Impl::extractMarkedGraphsBB(double coverage) {
     CFDFCfreq.clear();
     MG.clear();
     MGfreq.clear();
+    BBG.clearMGnumbers();
 
     BBG.calculateBackArcs();
 
+    // Value of a CFDFC in the objective of the extraction
+    auto cfdfcValue = [&freq](subNetlistBB& cfdfc) {
+        if (cfdfc.empty()) return 0.0;
+        double min_freq = numeric_limits<double>::infinity();
+        for (auto arc: cfdfc.getBasicBlockArcs()) min_freq = min(min_freq, freq[arc]);
+        return min_freq * cfdfc.numBasicBlockArcs();
+    };
+
+    const string& method = getCFDFCExtraction();
     int iter = 1;
     double covered_freq = 0;
     while (covered_freq < coverage * total_freq) {
         cout << "--------------------------" << endl;
         cout << "Iteration " << iter << endl;
 
-        subNetlistBB extracted_CFDFC = extractMarkedGraphBB(freq);
+        subNetlistBB extracted_CFDFC;
+        if (method == "graph") extracted_CFDFC = extractMarkedGraphBBcycles(freq);
+        else extracted_CFDFC = extractMarkedGraphBB(freq);
+
+        if (method == "compare") {
+            subNetlistBB graph_CFDFC = extractMarkedGraphBBcycles(freq);
+            double milp_value = cfdfcValue(extracted_CFDFC);
+            double graph_value = cfdfcValue(graph_CFDFC);
+            if (abs(milp_value - graph_value) > 1e-6 * max(1.0, milp_value)) {
+                cout << "CFDFC extraction mismatch: MILP " << milp_value << ", graph " << graph_value << endl;
+            } else cout << "CFDFC extraction match: " << milp_value << endl;
+        }
 
         if (extracted_CFDFC.empty()){
             cout << "No new MG can be extracted to increase coverage." << endl;
@@ -235,11 +259,12 @@ DFnetlist_Impl::subNetlistBB DFnetlist_Impl::extractMarkedGraphBB(const map<bbID
 
     start_time = get_timestamp1();
 
+    milp.setLabel("CFDFC extraction");
     milp.solve();
 
     end_time = get_timestamp1();
     elapsed_time = ( uint32_t ) ( end_time - start_time ) ;
-    printf ("ILP time: [ms] %d \n\r", elapsed_time);
+    cout << "ILP time: [ms] " << elapsed_time << " \n\r";
 
     // add the selected blocks and arcs to the cfdfc.
     subNetlistBB selected;
@@ -261,6 +286,93 @@ DFnetlist_Impl::subNetlistBB DFnetlist_Impl::extractMarkedGraphBB(const map<bbID
     return selected;
 }
 
+DFnetlist_Impl::subNetlistBB DFnetlist_Impl::extractMarkedGraphBBcycles(const map<bbArcID, double> &freq) {
+    long long start_time = get_timestamp1();
+
+    // Arcs that can be selected (the same as in the MILP)
+    vector<double> N_e(BBG.numArcs(), 0);
+    vector<double> thresholds;
+    for (bbArcID i = 0; i < BBG.numArcs(); i++){
+        auto it = freq.find(i);
+        if (it == freq.end() or it->second <= 0) continue;
+        if (BBG.getSrcBB(i) == 0 || BBG.getDstBB(i) == 0) continue;
+        N_e[i] = it->second;
+        thresholds.push_back(N_e[i]);
+    }
+    sort(thresholds.begin(), thresholds.end(), greater<double>());
+    thresholds.erase(unique(thresholds.begin(), thresholds.end()), thresholds.end());
+
+    // Forward arcs of each BB and back arcs sorted by source. The forward
+    // arcs of the BBs reachable from the entry are acyclic.
+    int nBBs = BBG.numBasicBlocks();
+    vector<vector<bbArcID>> forward(nBBs + 1);
+    vector<bbArcID> back;
+    for (bbArcID i = 0; i < BBG.numArcs(); i++){
+        if (N_e[i] <= 0) continue;
+        if (BBG.isBackArc(i)) back.push_back(i);
+        else forward[BBG.getSrcBB(i)].push_back(i);
+    }
+    sort(back.begin(), back.end(), [this](bbArcID a, bbArcID b) {
+        return BBG.getSrcBB(a) < BBG.getSrcBB(b);
+    });
+
+    // For every threshold, the cycles with arcs of larger or equal frequency
+    // are a back arc src->dst and the longest forward path dst->src.
+    const int unknown = -2;
+    vector<int> length(nBBs + 1);       // Longest forward path to the source (-1 if none)
+    vector<bbArcID> next(nBBs + 1);     // Next arc of the longest path
+    double best_value = 0;
+    vector<bbArcID> best_cycle;
+    for (double theta: thresholds) {
+        bbID target = invalidDataflowID;
+        function<int(bbID)> longest = [&](bbID bb) {
+            if (length[bb] != unknown) return length[bb];
+            length[bb] = -1;
+            if (bb == target) return length[bb] = 0;
+            for (bbArcID arc: forward[bb]) {
+                if (N_e[arc] < theta) continue;
+                int l = longest(BBG.getDstBB(arc));
+                if (l >= 0 and l + 1 > length[bb]) {
+                    length[bb] = l + 1;
+                    next[bb] = arc;
+                }
+            }
+            return length[bb];
+        };
+
+        for (bbArcID arc: back) {
+            if (N_e[arc] < theta) continue;
+            if (BBG.getSrcBB(arc) != target) {
+                target = BBG.getSrcBB(arc);
+                fill(length.begin(), length.end(), unknown);
+            }
+            int l = longest(BBG.getDstBB(arc));
+            if (l < 0 or theta * (l + 1) <= best_value) continue;
+
+            best_value = theta * (l + 1);
+            best_cycle.clear();
+            for (bbID bb = BBG.getDstBB(arc); bb != target; bb = BBG.getDstBB(next[bb])) {
+                best_cycle.push_back(next[bb]);
+            }
+            best_cycle.push_back(arc);
+        }
+    }
+
+    cout << "CFDFC time: [ms] " << ( uint32_t ) ( get_timestamp1() - start_time ) << " \n\r";
+
+    // add the selected blocks and arcs to the cfdfc.
+    subNetlistBB selected;
+    cout << "Arcs in the CFDFC:" << endl;
+    for (bbArcID i: best_cycle) {
+        selected.insertBasicBlock(BBG.getSrcBB(i));
+        selected.insertBasicBlockArc(i);
+
+        cout << "\t" << BBG.getSrcBB(i) << "->" << BBG.getDstBB(i) << ":" << N_e[i] << endl;
+    }
+
+    return selected;
+}
+
 DFnetlist_Impl::subNetlist DFnetlist_Impl::extractMarkedGraph(const map<blockID, double>& freq)
 {
 
@@ -547,11 +659,12 @@ DFnetlist_Impl::subNetlist DFnetlist_Impl::extractMarkedGraph(const map<blockID,
 
     start_time = get_timestamp1();
 
+    milp.setLabel("CFDFC extraction");
     milp.solve();
 
     end_time = get_timestamp1();
     elapsed_time = ( uint32_t ) ( end_time - start_time ) ;
-    printf ("ILP time: [ms] %d \n\r", elapsed_time);
+    cout << "ILP time: [ms] " << elapsed_time << " \n\r";
 
     // cout << "MILP: " << milp.getStatus() << endl;
     // cout << "obj = " << milp.getObj() << endl;
@@ -617,15 +730,15 @@ DFnetlist_Impl::subNetlist DFnetlist_Impl::getMGfromCFDFC(Dataflow::DFnetlist_Im
             assert(connection != invalidDataflowID);
             if (BB_CFDFC.hasBasicBlockArc(connection)) {
                 snl.insertChannel(*this, i);
-                channels_in_MGs.insert(i);
-                blocks_in_MGs.insert(getSrcBlock(i));
-                blocks_in_MGs.insert(getDstBlock(i));
+                coverChannel(i, COVER_MG);
+                coverBlock(getSrcBlock(i), COVER_MG);
+                coverBlock(getDstBlock(i), COVER_MG);
             }
         } else if (src == dst) {
             snl.insertChannel(*this, i);
-            channels_in_MGs.insert(i);
-            blocks_in_MGs.insert(getSrcBlock(i));
-            blocks_in_MGs.insert(getDstBlock(i));
+            coverChannel(i, COVER_MG);
+            coverBlock(getSrcBlock(i), COVER_MG);
+            coverBlock(getDstBlock(i), COVER_MG);
         }
     }
 
@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+#include "DFnetlist.h"
+#include "DFbinary.h"
+
+using namespace Dataflow;
+using namespace std;
+
+// Sections of a binary netlist under construction
+struct BinaryNetlist {
+    vector<DFbinary::Block> blocks;
+    vector<DFbinary::Extra> extras;
+    vector<DFbinary::Port> ports;
+    vector<DFbinary::Channel> channels;
+    vector<DFbinary::BasicBlock> basicBlocks;
+    vector<DFbinary::Arc> arcs;
+    vector<int32_t> ints;
+    vector<uint32_t> stringOffsets;
+    string stringData;
+    unordered_map<string, uint32_t> stringIds;
+
+    BinaryNetlist() {
+        addString("");
+    }
+
+    // Returns the index of a string in the table (each string is stored once)
+    uint32_t addString(const string& s) {
+        auto it = stringIds.find(s);
+        if (it != stringIds.end()) return it->second;
+        uint32_t id = stringOffsets.size();
+        stringOffsets.push_back(stringData.size());
+        stringData.append(s);
+        stringData.push_back('\0');
+        stringIds.emplace(s, id);
+        return id;
+    }
+
+    // Appends a section aligned to 8 bytes and returns its offset
+    template<typename T>
+    static uint64_t append(string& file, const T* data, size_t n) {
+        file.resize((file.size() + 7) & ~(size_t) 7, '\0');
+        uint64_t offset = file.size();
+        file.append((const char*) data, n * sizeof(T));
+        return offset;
+    }
+
+    // Returns the contents of the file
+    string serialize(DFbinary::Header& H) {
+        H.numBlocks = blocks.size();
+        H.numExtras = extras.size();
+        H.numPorts = ports.size();
+        H.numChannels = channels.size();
+        H.numBasicBlocks = basicBlocks.size();
+        H.numArcs = arcs.size();
+        H.numInts = ints.size();
+        H.numStrings = stringOffsets.size();
+
+        string file(sizeof(H), '\0');
+        H.blocks = append(file, blocks.data(), blocks.size());
+        H.extras = append(file, extras.data(), extras.size());
+        H.ports = append(file, ports.data(), ports.size());
+        H.channels = append(file, channels.data(), channels.size());
+        H.basicBlocks = append(file, basicBlocks.data(), basicBlocks.size());
+        H.arcs = append(file, arcs.data(), arcs.size());
+        H.ints = append(file, ints.data(), ints.size());
+        H.strings = append(file, stringOffsets.data(), stringOffsets.size());
+        H.stringData = append(file, stringData.data(), stringData.size());
+        H.fileSize = file.size();
+        memcpy(&file[0], &H, sizeof(H));
+        return file;
+    }
+};
+
+/**
+ * @brief Returns the key used to sort the ports of a block in the dot
+ * export (the index of the port with at least two digits).
+ * @param name Name of the port (e.g. in3).
+ * @return The key (e.g. in03).
+ */
+static string dotPortKey(const string& name)
+{
+    size_t index = name.find_last_not_of("0123456789");
+    if (index == string::npos or index + 1 == name.size()) return name;
+    string digits = name.substr(index + 1);
+    return name.substr(0, index + 1) + (digits.size() < 2 ? "0" : "") + digits;
+}
+
+bool DFnetlist_Impl::writeBinary(const string& filename)
+{
+    BinaryNetlist N;
+    DFbinary::Header H;
+    memset(&H, 0, sizeof(H));
+    memcpy(H.magic, DFbinary::MAGIC, sizeof(H.magic));
+    H.version = DFbinary::VERSION;
+    H.byteOrder = DFbinary::BYTE_ORDER_MARK;
+    H.name = N.addString(getName());
+
+    // The blocks in the order of writeDot: by BB, and the blocks without BB
+    // at the end (followed by the blocks of unknown BBs, not exported in dot)
+    int nBBs = BBG.numBasicBlocks();
+    auto rank = [nBBs](bbID bb) {
+        if (bb >= 1 and bb <= nBBs) return bb;
+        return bb == 0 ? nBBs + 1 : nBBs + 2;
+    };
+    vecBlocks order(allBlocks.begin(), allBlocks.end());
+    stable_sort(order.begin(), order.end(), [&](blockID a, blockID b) {
+        return rank(blockArrays.basicBlock[a]) < rank(blockArrays.basicBlock[b]);
+    });
+
+    vector<uint32_t> portIndex(ports.size(), DFbinary::NONE);
+    for (blockID b: order) {
+        const Block& B = blocks[b];
+        const BlockExtra& X = getBlockExtra(b);
+        BlockType btype = blockArrays.type[b];
+        DFbinary::Block R;
+        memset(&R, 0, sizeof(R));
+        R.name = N.addString(symbols.name(B.name));
+        R.type = N.addString(BlockType2String[btype]);
+        R.operation = N.addString(symbols.name(B.operation));
+        R.basicBlock = blockArrays.basicBlock[b];
+        R.latency = blockArrays.latency[b];
+        R.II = blockArrays.II[b];
+        R.slots = B.slots;
+        R.transparent = B.transparent;
+        R.value = B.value;
+        R.delay = blockArrays.delay[b];
+        R.freq = blockArrays.freq[b];
+
+        // The attributes of a few types of blocks are stored apart
+        R.extra = DFbinary::NONE;
+        if (not X.funcName.empty() or not X.memName.empty() or not X.numLoads.empty() or
+            not X.numStores.empty() or not X.loadOffsets.empty() or not X.storeOffsets.empty() or
+            not X.loadPorts.empty() or not X.storePorts.empty() or X.memPortID != 0 or X.memOffset != 0 or
+            X.memBBCount != 0 or X.memLdCount != 0 or X.memStCount != 0 or X.fifoDepth != 0 or
+            X.getptrc != 0 or not X.orderings.empty() or B.frac != 0 or B.retimingDiff != 0) {
+            DFbinary::Extra E;
+            memset(&E, 0, sizeof(E));
+            E.funcName = N.addString(X.funcName);
+            E.memName = N.addString(X.memName);
+            E.numLoads = N.addString(X.numLoads);
+            E.numStores = N.addString(X.numStores);
+            E.loadOffsets = N.addString(X.loadOffsets);
+            E.storeOffsets = N.addString(X.storeOffsets);
+            E.loadPorts = N.addString(X.loadPorts);
+            E.storePorts = N.addString(X.storePorts);
+            E.memPortID = X.memPortID;
+            E.memOffset = X.memOffset;
+            E.memBBCount = X.memBBCount;
+            E.memLdCount = X.memLdCount;
+            E.memStCount = X.memStCount;
+            E.fifoDepth = X.fifoDepth;
+            E.getPtrConst = X.getptrc;
+            E.trueFrac = B.frac;
+            E.retimingDiff = B.retimingDiff;
+            E.firstOrdering = N.ints.size();
+            for (const auto& ordering: X.orderings) {
+                N.ints.push_back(ordering.first);
+                N.ints.push_back(ordering.second.size());
+                N.ints.insert(N.ints.end(), ordering.second.begin(), ordering.second.end());
+            }
+            E.numOrderingInts = N.ints.size() - E.firstOrdering;
+            R.extra = N.extras.size();
+            N.extras.push_back(E);
+        }
+
+        // Ports, normalized as in writeBlockDot. The demux keeps the order of
+        // creation, in which its inputs and outputs are paired.
+        vecPorts sorted;
+        if (btype == DEMUX) sorted.assign(B.allPorts.begin(), B.allPorts.end());
+        else {
+            map<string, portID> by_key;
+            for (portID p: B.allPorts) by_key.emplace(dotPortKey(getPortName(p, false)), p);
+            for (const auto& it: by_key) sorted.push_back(it.second);
+        }
+        int last_width = sorted.empty() ? 0 : getPortWidth(sorted.back());
+
+        R.firstPort = N.ports.size();
+        auto addPort = [&](const string& name, bool input, int width, PortType type,
+                           const string& suffix, bool export_only) {
+            DFbinary::Port P;
+            memset(&P, 0, sizeof(P));
+            P.name = N.addString(name);
+            P.block = N.blocks.size();
+            P.memSuffix = N.addString(suffix);
+            P.width = width;
+            P.flags = (input ? DFbinary::PORT_INPUT : 0) | (export_only ? DFbinary::PORT_EXPORT_ONLY : 0);
+            P.type = type;
+            N.ports.push_back(P);
+        };
+
+        // Constants and the entry have one input with the width of the last port,
+        // and the exit one output (only in the export)
+        bool fixed_input = btype == CONSTANT or btype == FUNC_ENTRY;
+        if (fixed_input) addPort("in1", true, last_width, GENERIC_PORT, "", false);
+        for (portID p: sorted) {
+            bool input = isInputPort(p);
+            if (input and fixed_input) continue;
+            if (not input and btype == FUNC_EXIT) continue;
+            addPort(getPortName(p, false), input, getPortWidth(p), getPortType(p), getMemPortSuffix(p), false);
+        }
+        if (btype == FUNC_EXIT) addPort("out1", false, last_width, GENERIC_PORT, "", true);
+        R.numPorts = N.ports.size() - R.firstPort;
+
+        // Netlist ports -> records (by name, as the channels and delays of the dot export)
+        for (portID p: B.allPorts) {
+            const string& name = getPortName(p, false);
+            for (uint32_t i = R.firstPort; i < N.ports.size(); ++i) {
+                DFbinary::Port& P = N.ports[i];
+                if (name != N.stringData.c_str() + N.stringOffsets[P.name]) continue;
+                if (bool(P.flags & DFbinary::PORT_INPUT) != isInputPort(p)) continue;
+                portIndex[p] = i;
+                if (getPortDelay(p) > 0) P.delay = getPortDelay(p);
+                break;
+            }
+        }
+
+        N.blocks.push_back(R);
+    }
+
+    ForAllChannels(c) {
+        const Channel& C = channels[c];
+        if (portIndex[C.src] == DFbinary::NONE or portIndex[C.dst] == DFbinary::NONE or
+            (N.ports[portIndex[C.src]].flags & DFbinary::PORT_EXPORT_ONLY)) {
+            setError("Channel " + getChannelName(c, true) + " cannot be exported.");
+            return false;
+        }
+        DFbinary::Channel R;
+        memset(&R, 0, sizeof(R));
+        R.src = portIndex[C.src];
+        R.dst = portIndex[C.dst];
+        R.slots = C.slots;
+        R.transparent = C.transparent;
+        R.backEdge = C.backEdge;
+        R.freq = C.freq;
+        N.channels.push_back(R);
+    }
+
+    // BB graph
+    H.entryBasicBlock = BBG.empty() ? invalidDataflowID : BBG.getEntryBasicBlock();
+    for (bbID bb = 1; bb <= nBBs; ++bb) {
+        DFbinary::BasicBlock R;
+        memset(&R, 0, sizeof(R));
+        R.freq = BBG.getFrequency(bb);
+        R.exec = BBG.getExecTime(bb);
+        R.exit = BBG.isExitBasicBlock(bb);
+        N.basicBlocks.push_back(R);
+    }
+
+    for (bbArcID arc = 0; arc < BBG.numArcs(); ++arc) {
+        DFbinary::Arc R;
+        memset(&R, 0, sizeof(R));
+        R.src = BBG.getSrcBB(arc);
+        R.dst = BBG.getDstBB(arc);
+        R.DSU = BBG.getDSUnumberArc(arc);
+        R.back = BBG.isBackArc(arc);
+        R.prob = BBG.getProbability(arc);
+        R.freq = BBG.getFrequencyArc(arc);
+        const vector<int>& mgs = BBG.getMGnumbers(arc);
+        R.firstMG = N.ints.size();
+        R.numMGs = mgs.size();
+        N.ints.insert(N.ints.end(), mgs.begin(), mgs.end());
+        N.arcs.push_back(R);
+    }
+
+    return FileUtil::write(N.serialize(H), filename, getError());
+}
+
+bool DFnetlist_Impl::readBinary(const string& filename)
+{
+    DFbinary::File F;
+    if (not F.open(filename)) {
+        setError(F.getError());
+        return false;
+    }
+
+    const DFbinary::Header& H = F.header();
+    net_name = F.getString(H.name);
+    if (net_name.empty()) {
+        setError("Invalid identifier: the graph has no name.");
+        return false;
+    }
+
+    // The types are looked up once for each string
+    unordered_map<uint32_t, BlockType> types;
+    vector<portID> portIDs(H.numPorts, invalidDataflowID);
+    for (uint32_t b = 0; b < H.numBlocks; ++b) {
+        const DFbinary::Block& R = F.block(b);
+        auto it_type = types.find(R.type);
+        if (it_type == types.end()) {
+            auto it = String2BlockType.find(F.getString(R.type));
+            if (it == String2BlockType.end()) {
+                setError("Block " + string(F.getString(R.name)) + ": unknown type " + F.getString(R.type));
+                return false;
+            }
+            it_type = types.emplace(R.type, it->second).first;
+        }
+
+        blockID id = createBlock(it_type->second, F.getString(R.name));
+        if (not validBlock(id)) return false;
+
+        for (uint32_t p = R.firstPort; p < R.firstPort + R.numPorts; ++p) {
+            const DFbinary::Port& P = F.port(p);
+            if (P.flags & DFbinary::PORT_EXPORT_ONLY) continue;
+            portID port = createPort(id, P.flags & DFbinary::PORT_INPUT, F.getString(P.name),
+                                     P.width, (PortType) P.type);
+            if (port == invalidDataflowID) return false;
+            portIDs[p] = port;
+            ports[port].delay = P.delay;
+            if (P.memSuffix != 0) ports[port].memPortSuffix = symbols.intern(F.getString(P.memSuffix));
+        }
+
+        Block& B = blocks[id];
+        B.operation = symbols.intern(F.getString(R.operation));
+        blockArrays.basicBlock[id] = R.basicBlock;
+        blockArrays.latency[id] = R.latency;
+        blockArrays.II[id] = R.II;
+        B.slots = R.slots;
+        B.transparent = R.transparent;
+        setValue(id, R.value);
+        blockArrays.delay[id] = R.delay;
+        blockArrays.freq[id] = R.freq;
+        if (R.extra == DFbinary::NONE) continue;
+
+        const DFbinary::Extra& E = F.extra(R.extra);
+        BlockExtra& X = blockExtras[id];
+        X.funcName = F.getString(E.funcName);
+        X.memName = F.getString(E.memName);
+        X.numLoads = F.getString(E.numLoads);
+        X.numStores = F.getString(E.numStores);
+        X.loadOffsets = F.getString(E.loadOffsets);
+        X.storeOffsets = F.getString(E.storeOffsets);
+        X.loadPorts = F.getString(E.loadPorts);
+        X.storePorts = F.getString(E.storePorts);
+        X.memPortID = E.memPortID;
+        X.memOffset = E.memOffset;
+        X.memBBCount = E.memBBCount;
+        X.memLdCount = E.memLdCount;
+        X.memStCount = E.memStCount;
+        X.fifoDepth = E.fifoDepth;
+        X.getptrc = E.getPtrConst;
+        B.frac = E.trueFrac;
+        B.retimingDiff = E.retimingDiff;
+
+        uint32_t i = E.firstOrdering, end = E.firstOrdering + E.numOrderingInts;
+        while (i + 1 < end) {
+            bbID bb = F.getInt(i);
+            int n = F.getInt(i + 1);
+            if (n < 0 or n > end - i - 2) break;
+            vector<int>& ordering = X.orderings[bb];
+            for (int k = 0; k < n; ++k) ordering.push_back(F.getInt(i + 2 + k));
+            i += n + 2;
+        }
+        if (i != end) {
+            setError("Block " + symbols.name(B.name) + ": wrong orderings.");
+            return false;
+        }
+    }
+
+    // The channels are created in the order of the dot reader: by source
+    // block (in the order of the records) and then in the order of the file
+    vector<uint32_t> channelOrder(H.numChannels);
+    for (uint32_t c = 0; c < H.numChannels; ++c) channelOrder[c] = c;
+    stable_sort(channelOrder.begin(), channelOrder.end(), [&F](uint32_t a, uint32_t b) {
+        return F.port(F.channel(a).src).block < F.port(F.channel(b).src).block;
+    });
+
+    for (uint32_t c: channelOrder) {
+        const DFbinary::Channel& R = F.channel(c);
+        if (portIDs[R.src] == invalidDataflowID or portIDs[R.dst] == invalidDataflowID) {
+            setError("Channel " + to_string(c) + ": unknown port.");
+            return false;
+        }
+        if (validChannel(getConnectedChannel(portIDs[R.src])) or validChannel(getConnectedChannel(portIDs[R.dst]))) {
+            setError("Channel " + to_string(c) + ": port already connected.");
+            return false;
+        }
+        // The slots and the transparency are taken from the source block, as in
+        // the dot reader (only elastic buffers define them)
+        blockID src = getBlockFromPort(portIDs[R.src]);
+        bool buffer = getBlockType(src) == ELASTIC_BUFFER;
+        channelID id = createChannel(portIDs[R.src], portIDs[R.dst],
+                                     buffer ? getBufferSize(src) : 0,
+                                     buffer ? isBufferTransparent(src) : true);
+        setBackEdge(id, R.backEdge);
+        setChannelFrequency(id, R.freq);
+    }
+
+    // BB graph
+    if (H.numBasicBlocks == 0) return true;
+    BBG.clear();
+    for (bbID bb = 1; bb <= (bbID) H.numBasicBlocks; ++bb) {
+        BBG.createBasicBlock();
+        BBG.setFrequency(bb, F.basicBlock(bb).freq);
+        BBG.setExecTime(bb, F.basicBlock(bb).exec);
+        if (F.basicBlock(bb).exit) BBG.addExitBasicBlock(bb);
+    }
+    if (H.entryBasicBlock > 0) BBG.setEntryBasicBlock(H.entryBasicBlock);
+
+    for (uint32_t a = 0; a < H.numArcs; ++a) {
+        const DFbinary::Arc& R = F.arc(a);
+        if (BBG.findArc(R.src, R.dst) != invalidDataflowID) {
+            setError("BB" + to_string(R.src) + "->BB" + to_string(R.dst) + " arc: already defined");
+            return false;
+        }
+        bbArcID arc = BBG.findOrAddArc(R.src, R.dst, R.freq);
+        BBG.setProbability(arc, R.prob);
+        BBG.setBackArc(arc, R.back);
+        BBG.setDSUnumberArc(arc, R.DSU);
+        for (uint32_t i = R.firstMG; i < R.firstMG + R.numMGs; ++i) BBG.addMGnumber(arc, F.getInt(i));
+    }
+    return true;
+}
+
+bool DFnetlist_Impl::readNetlist(const string& filename)
+{
+    if (DFbinary::isBinaryFile(filename)) return readBinary(filename);
+    return readDataflowDot(filename);
+}
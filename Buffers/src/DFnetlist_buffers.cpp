@@ -1,8 +1,13 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include "DFnetlist.h"
+#include "ThreadLog.h"
 
 using namespace Dataflow;
 using namespace std;
@@ -57,26 +62,19 @@ void DFnetlist_Impl::createMilpVarsEB(Milp_Model& milp, milpVarsEB& vars, bool m
     vars.has_buffer = vector<int>(vecChannelsSize(), -1);
     vars.time_path = vector<int>(vecPortsSize(), -1);
     vars.time_elastic = vector<int>(vecPortsSize(), -1);
+    setMilpVarNamesEB(milp, vars, "", [](int mg) { return "_mg" + to_string(mg); });
 
     ForAllChannels(c) {
         if (channelIsCovered(c, false, true, false)) continue;
-
-        const string& src = getBlockName(getSrcBlock(c));
-        const string& dst = getBlockName(getDstBlock(c));
-        // Lana 05/07/19 Adding port index to name
-        // Otherwise, if two channels between same two nodes, milp crashes
-        const string cname = src + "_" + dst + to_string(getDstPort(c));
-        vars.buffer_flop[c] = milp.newBooleanVar(cname + "_flop");
-        vars.buffer_slots[c] = milp.newIntegerVar(cname + "_slots");
-        vars.has_buffer[c] = milp.newBooleanVar(cname + "_hasBuffer");
+        vars.buffer_flop[c] = milp.newBooleanVar();
+        vars.buffer_slots[c] = milp.newIntegerVar();
+        vars.has_buffer[c] = milp.newBooleanVar();
     }
 
     ForAllBlocks(b) {
-        const string& bname = getBlockName(b);
         ForAllPorts(b,p) {
-            const string& pname = getPortName(p, false);
-            vars.time_path[p] = milp.newRealVar("timePath_" + bname + "_" + pname);
-            vars.time_elastic[p] = milp.newRealVar("timeElastic_" + bname + "_" + pname);
+            if (not vars.isPathFixed(p)) vars.time_path[p] = milp.newRealVar();
+            vars.time_elastic[p] = milp.newRealVar();
         }
     }
 
@@ -91,25 +89,18 @@ void DFnetlist_Impl::createMilpVarsEB(Milp_Model& milp, milpVarsEB& vars, bool m
     vars.th_MG = vector<int>(MG.size(), -1);
     for (int mg = 0; mg < MG.size(); ++mg) {
 
-        const string& mg_name = "_mg" + to_string(mg);
         vars.th_MG[mg] = milp.newRealVar();
 
         for (blockID b: MG[mg].getBlocks()) {
-            const string bname = getBlockName(b) + mg_name;
-            vars.in_retime_tokens[mg][b] = milp.newRealVar("inRetimeTok_" + bname);
-            vars.retime_bubbles[mg][b] = milp.newRealVar("retimeBub_" + bname);
+            vars.in_retime_tokens[mg][b] = milp.newRealVar();
+            vars.retime_bubbles[mg][b] = milp.newRealVar();
             // If the block is combinational, the in/out retiming variables are the same
-            vars.out_retime_tokens[mg][b] = getLatency(b) > 0 ? milp.newRealVar("outRetimeTok_" + bname) : vars.in_retime_tokens[mg][b];
+            vars.out_retime_tokens[mg][b] = getLatency(b) > 0 ? milp.newRealVar() : vars.in_retime_tokens[mg][b];
         }
 
         for (channelID c: MG[mg].getChannels()) {
-            const string& src = getBlockName(getSrcBlock(c));
-            const string& dst = getBlockName(getDstBlock(c));
-            // Lana 05/07/19 Adding port index to name
-            // Otherwise, if two channels between same two nodes, milp crashes
-            const string cname = src + "_" + dst + to_string(getDstPort(c)) + mg_name;
-            vars.th_tokens[mg][c] = milp.newRealVar("thTok_" + cname);
-            vars.th_bubbles[mg][c] = milp.newRealVar("thBub_" + cname);
+            vars.th_tokens[mg][c] = milp.newRealVar();
+            vars.th_bubbles[mg][c] = milp.newRealVar();
         }
         if (first_MG) break;
     }
@@ -122,66 +113,55 @@ void DFnetlist_Impl::createMilpVarsEB_sc(Milp_Model &milp, milpVarsEB &vars, boo
     vars.time_path = vector<int>(vecPortsSize(), -1);
     vars.time_elastic = vector<int>(vecPortsSize(), -1);
 
-    const string& mg_name = "_mg" + to_string(mg);
+    const string mg_name = "_mg" + to_string(mg);
+    setMilpVarNamesEB(milp, vars, mg_name, [mg_name](int sub_mg) { return mg_name + "_submg" + to_string(sub_mg); });
 
     ///////////////////////
     /// CHANNELS IN MG  ///
     ///////////////////////
-    for (channelID c: MG_disjoint[mg].getChannels()) {
+    for (channelID c: MG_disjoint_cover[mg].channels) {
         if (channelIsCovered(c, false, true, false)) continue;
-
-        const string& src = getBlockName(getSrcBlock(c));
-        const string& dst = getBlockName(getDstBlock(c));
-
-        // Lana 05/07/19 Adding port index to name
-        // Otherwise, if two channels between same two nodes, milp crashes
-        const string cname = src + "_" + dst + to_string(getDstPort(c)) + mg_name;
-        vars.buffer_flop[c] = milp.newBooleanVar(cname + "_flop");
-        vars.buffer_slots[c] = milp.newIntegerVar(cname + "_slots");
-        vars.has_buffer[c] = milp.newBooleanVar(cname + "_hasBuffer");
+        vars.buffer_flop[c] = milp.newBooleanVar();
+        vars.buffer_slots[c] = milp.newIntegerVar();
+        vars.has_buffer[c] = milp.newBooleanVar();
     }
 
     ////////////////////
     /// BLOCKS IN MG ///
     ////////////////////
-    for (blockID b: MG_disjoint[mg].getBlocks()) {
-        const string& bname = getBlockName(b);
+    for (blockID b: MG_disjoint_cover[mg].blocks) {
         ForAllPorts(b,p) {
-            if (!MG_disjoint[mg].hasChannel(getConnectedChannel(p)))
+            if (!MG_disjoint_cover[mg].hasChannel.contains(getConnectedChannel(p)))
                 continue;
-            const string& pname = getPortName(p, false);
-            vars.time_path[p] = milp.newRealVar("timePath_" + bname + "_" + pname + mg_name);
-            vars.time_elastic[p] = milp.newRealVar("timeElastic_" + bname + "_" + pname + mg_name);
+            if (not vars.isPathFixed(p)) vars.time_path[p] = milp.newRealVar();
+            vars.time_elastic[p] = milp.newRealVar();
         }
     }
 
     ///////////////////////////
     /// BLOCKS IN MG BORDER ///
     ///////////////////////////
-    for (blockID b: blocks_in_borders) {
-        const string& bname = getBlockName(b);
+    for (blockID b: MG_disjoint_cover[mg].borderBlocks) {
         ForAllPorts(b,p) {
             portID other_p;
             if (isInputPort(p)) {
-                if (!MG_disjoint[mg].hasBlock(getSrcBlock(getConnectedChannel(p)))) {
+                if (!MG_disjoint_cover[mg].hasBlock.contains(getSrcBlock(getConnectedChannel(p)))) {
                     continue;
                 }
                 other_p = getSrcPort(getConnectedChannel(p));
             }
             if (isOutputPort(p)) {
-                if (!MG_disjoint[mg].hasBlock(getDstBlock(getConnectedChannel(p)))) {
+                if (!MG_disjoint_cover[mg].hasBlock.contains(getDstBlock(getConnectedChannel(p)))) {
                     continue;
                 }
                 other_p = getDstPort(getConnectedChannel(p));
             }
 
-            const string& pname = getPortName(p, false);
-            vars.time_path[p] = milp.newRealVar("timePath_" + bname + "_" + pname + mg_name);
-            vars.time_elastic[p] = milp.newRealVar("timeElastic_" + bname + "_" + pname + mg_name);
+            if (not vars.isPathFixed(p)) vars.time_path[p] = milp.newRealVar();
+            vars.time_elastic[p] = milp.newRealVar();
 
-            const string& pname_other = getPortName(other_p, false);
-            vars.time_path[other_p] = milp.newRealVar("timePath_" + bname + "_" + pname_other + mg_name);
-            vars.time_elastic[other_p] = milp.newRealVar("timeElastic_" + bname + "_" + pname_other + mg_name);
+            if (not vars.isPathFixed(other_p)) vars.time_path[other_p] = milp.newRealVar();
+            vars.time_elastic[other_p] = milp.newRealVar();
         }
     }
 
@@ -199,27 +179,19 @@ void DFnetlist_Impl::createMilpVarsEB_sc(Milp_Model &milp, milpVarsEB &vars, boo
 
         cout << " creating throughput vars for sub_mg" << sub_mg << endl;
         //cout << "\tadding throughput variables for sub_mg " << sub_mg << endl;
-        const string& sub_mg_name = mg_name + "_submg" + to_string(sub_mg);
         vars.th_MG[sub_mg] = milp.newRealVar();
 
         for (blockID b: MG[sub_mg].getBlocks()) {
-            const string bname = getBlockName(b) + sub_mg_name;
-            vars.in_retime_tokens[sub_mg][b] = milp.newRealVar("inRetimeTok_" + bname);
-            vars.retime_bubbles[sub_mg][b] = milp.newRealVar("retimeBub_" + bname);
+            vars.in_retime_tokens[sub_mg][b] = milp.newRealVar();
+            vars.retime_bubbles[sub_mg][b] = milp.newRealVar();
 
             // If the block is combinational, the in/out retiming variables are the same
-            vars.out_retime_tokens[sub_mg][b] = getLatency(b) > 0 ? milp.newRealVar("outRetimeTok_" + bname) : vars.in_retime_tokens[sub_mg][b];
+            vars.out_retime_tokens[sub_mg][b] = getLatency(b) > 0 ? milp.newRealVar() : vars.in_retime_tokens[sub_mg][b];
         }
 
         for (channelID c: MG[sub_mg].getChannels()) {
-            const string& src = getBlockName(getSrcBlock(c));
-            const string& dst = getBlockName(getDstBlock(c));
-
-            // Lana 05/07/19 Adding port index to name
-            // Otherwise, if two channels between same two nodes, milp crashes
-            const string cname = src + "_" + dst + to_string(getDstPort(c)) + sub_mg_name;
-            vars.th_tokens[sub_mg][c] = milp.newRealVar("thTok_" + cname);
-            vars.th_bubbles[sub_mg][c] = milp.newRealVar("thBub_" + cname);
+            vars.th_tokens[sub_mg][c] = milp.newRealVar();
+            vars.th_bubbles[sub_mg][c] = milp.newRealVar();
         }
 
         if (first_MG) break;
@@ -230,29 +202,75 @@ void DFnetlist_Impl::createMilpVars_remaining(Milp_Model &milp, milpVarsEB &vars
     vars.buffer_flop = vector<int>(vecChannelsSize(), -1);
     vars.time_path = vector<int>(vecPortsSize(), -1);
     vars.time_elastic = vector<int>(vecPortsSize(), -1);
+    setMilpVarNamesEB(milp, vars, "", [](int mg) { return "_mg" + to_string(mg); });
 
     ForAllChannels(c) {
         if (channelIsCovered(c, true, true, false))
             continue;
-
-        const string& src = getBlockName(getSrcBlock(c));
-        const string& dst = getBlockName(getDstBlock(c));
-        // Lana 05/07/19 Adding port index to name
-        // Otherwise, if two channels between same two nodes, milp crashes
-        const string cname = src + "_" + dst + to_string(getDstPort(c));
-        vars.buffer_flop[c] = milp.newBooleanVar(cname + "_flop");
+        vars.buffer_flop[c] = milp.newBooleanVar();
     }
 
     ForAllBlocks(b) {
-        const string& bname = getBlockName(b);
         ForAllPorts(b,p) {
-            const string& pname = getPortName(p, false);
-            vars.time_path[p] = milp.newRealVar("timePath_" + bname + "_" + pname);
-            vars.time_elastic[p] = milp.newRealVar("timeElastic_" + bname + "_" + pname);
+            if (not vars.isPathFixed(p)) vars.time_path[p] = milp.newRealVar();
+            vars.time_elastic[p] = milp.newRealVar();
         }
     }
 }
 
+void DFnetlist_Impl::setMilpVarNamesEB(Milp_Model& milp, const milpVarsEB& vars, const string& suffix,
+                                       function<string(int)> mgSuffix)
+{
+    milp.setVarNamer([this, &vars, suffix, mgSuffix](vector<string>& names) {
+        // Index of a variable (-1 if it does not exist) and name of a variable
+        auto var = [](const vector<int>& v, int i) {
+            return i >= 0 and i < v.size() ? v[i] : -1;
+        };
+        auto name = [&names](int v, const string& n) {
+            if (v >= 0 and v < names.size() and names[v].empty()) names[v] = n;
+        };
+
+        // Lana 05/07/19 Adding port index to name
+        // Otherwise, if two channels between same two nodes, milp crashes
+        auto channelName = [this](channelID c) {
+            return getBlockName(getSrcBlock(c)) + "_" + getBlockName(getDstBlock(c)) + to_string(getDstPort(c));
+        };
+
+        ForAllChannels(c) {
+            if (var(vars.buffer_flop, c) < 0 and var(vars.buffer_slots, c) < 0 and var(vars.has_buffer, c) < 0) continue;
+            const string cname = channelName(c) + suffix;
+            name(var(vars.buffer_flop, c), cname + "_flop");
+            name(var(vars.buffer_slots, c), cname + "_slots");
+            name(var(vars.has_buffer, c), cname + "_hasBuffer");
+        }
+
+        ForAllBlocks(b) {
+            const string& bname = getBlockName(b);
+            ForAllPorts(b,p) {
+                const string pname = bname + "_" + getPortName(p, false) + suffix;
+                name(var(vars.time_path, p), "timePath_" + pname);
+                name(var(vars.time_elastic, p), "timeElastic_" + pname);
+            }
+        }
+
+        for (int mg = 0; mg < vars.in_retime_tokens.size() and mg < MG.size(); ++mg) {
+            const string mg_name = mgSuffix(mg);
+            for (blockID b: MG[mg].getBlocks()) {
+                const string bname = getBlockName(b) + mg_name;
+                name(var(vars.in_retime_tokens[mg], b), "inRetimeTok_" + bname);
+                name(var(vars.retime_bubbles[mg], b), "retimeBub_" + bname);
+                name(var(vars.out_retime_tokens[mg], b), "outRetimeTok_" + bname);
+            }
+            for (channelID c: MG[mg].getChannels()) {
+                if (var(vars.th_tokens[mg], c) < 0) continue;
+                const string cname = channelName(c) + mg_name;
+                name(var(vars.th_tokens[mg], c), "thTok_" + cname);
+                name(var(vars.th_bubbles[mg], c), "thBub_" + cname);
+            }
+        }
+    });
+}
+
 
 #include <sys/time.h>
 long long get_timestamp( void )
@@ -264,6 +282,152 @@ long long get_timestamp( void )
     return milliseconds;
 }
 
+uint32_t DFnetlist_Impl::solveMilpEB(Milp_Model& milp, const milpVarsEB& vars, int timeout, string& report)
+{
+    report = "";
+    const string& mode = getMilpRelaxation();
+    long long start_time = get_timestamp();
+    auto solved = [&](int limit) {
+        bool ok = limit > 0 ? milp.solve(limit) : milp.solve();
+        Milp_Model::Status stat = milp.getStatus();
+        return ok and (stat == Milp_Model::OPTIMAL or stat == Milp_Model::NONOPTIMAL);
+    };
+    auto elapsed = [&]() {
+        return ( uint32_t ) ( get_timestamp() - start_time );
+    };
+
+    if (mode != "always") {
+        if (solved(timeout) or mode == "off") return elapsed();
+    }
+
+    // The whole fallback (relaxation, roundings and polish) gets the time
+    // limit of the MILP: each solve only receives the time left before the
+    // deadline, and the fallback stops when it is used up.
+    long long deadline = get_timestamp() + 1000LL * timeout;
+    bool outOfTime = false;
+    auto solvedBeforeDeadline = [&](int limit) {
+        if (timeout <= 0) return solved(limit);
+        int left = (deadline - get_timestamp()) / 1000;
+        if (left < 1) {
+            outOfTime = true;
+            return false;
+        }
+        return solved(limit > 0 ? min(limit, left) : left);
+    };
+
+    // Values of the buffer variables in the LP relaxation
+    bool hasSlots = not vars.buffer_slots.empty();
+    vector<channelID> channels;
+    ForAllChannels(c) {
+        if (vars.buffer_flop[c] >= 0) channels.push_back(c);
+    }
+
+    ostringstream rep;
+    rep << "LP relaxation: ";
+    milp.setRelaxation(true);
+    if (not solvedBeforeDeadline(-1)) {
+        milp.setRelaxation(false);
+        rep << (outOfTime ? "time limit reached" : "no solution");
+        report = rep.str();
+        return elapsed();
+    }
+
+    double bound = milp.getObj();
+    rep << "bound " << bound;
+    vector<double> lpFlop(vecChannelsSize(), 0);
+    vector<double> lpSlots(vecChannelsSize(), 0);
+    for (channelID c: channels) {
+        lpFlop[c] = milp[vars.buffer_flop[c]];
+        if (hasSlots) lpSlots[c] = milp[vars.buffer_slots[c]];
+    }
+
+    // Rounding: a flop is inserted if its relaxed value reaches the
+    // threshold (all channels if negative) and the slots are rounded up.
+    // The integer variables are fixed and the LP of the continuous
+    // variables (timing, retiming and throughput) checks the feasibility.
+    // Adding buffers never cuts a path, thus lower thresholds repair the
+    // path and elasticity constraints violated by the rounding.
+    const double eps = 1e-6;
+    vector<int> flop(vecChannelsSize(), 0);
+    vector<int> slots(vecChannelsSize(), 0);
+    auto fixBuffers = [&](double threshold) {
+        for (channelID c: channels) {
+            flop[c] = threshold < 0 or lpFlop[c] >= threshold;
+            milp.fixVar(vars.buffer_flop[c], flop[c]);
+            if (not hasSlots) continue;
+            slots[c] = max((int) ceil(lpSlots[c] - eps), flop[c]);
+            milp.fixVar(vars.buffer_slots[c], slots[c]);
+            milp.fixVar(vars.has_buffer[c], slots[c] > 0);
+        }
+    };
+
+    double threshold = 0;
+    bool feasible = false;
+    for (double t: {0.5, 0.25, 0.1, eps, -1.0}) {
+        threshold = t;
+        fixBuffers(threshold);
+        if ((feasible = solvedBeforeDeadline(-1)) or outOfTime) break;
+    }
+
+    if (not feasible) {
+        milp.setRelaxation(false);
+        rep << (outOfTime ? ", time limit reached before a feasible rounding" : ", no feasible rounding");
+        report = rep.str();
+        return elapsed();
+    }
+
+    double obj = milp.getObj();
+    int nbuffers = 0;
+    for (channelID c: channels) nbuffers += hasSlots ? slots[c] > 0 : flop[c];
+    rep << ", rounded " << obj << " (";
+    if (threshold < 0) rep << "all channels";
+    else rep << "threshold " << threshold;
+    rep << ", " << nbuffers << " buffers)";
+
+    // Polish: the channels with fractional values in the relaxation are
+    // released and solved as a MILP, starting from the rounded solution.
+    // The result is kept if it is closer to the LP bound.
+    int polish = getMilpPolish();
+    milp.setRelaxation(false);
+    Milp_Model::Solution rounded = milp.getSolution();
+    if (polish > 0) {
+        int fractional = 0;
+        for (channelID c: channels) {
+            milp.setStartValue(vars.buffer_flop[c], flop[c]);
+            if (hasSlots) {
+                milp.setStartValue(vars.buffer_slots[c], slots[c]);
+                milp.setStartValue(vars.has_buffer[c], slots[c] > 0);
+            }
+            bool frac = lpFlop[c] > eps and lpFlop[c] < 1 - eps;
+            if (hasSlots) frac = frac or abs(lpSlots[c] - round(lpSlots[c])) > eps;
+            if (not frac) continue;
+            fractional++;
+            milp.unfixVar(vars.buffer_flop[c]);
+            if (hasSlots) {
+                milp.unfixVar(vars.buffer_slots[c]);
+                milp.unfixVar(vars.has_buffer[c]);
+            }
+        }
+
+        if (fractional > 0) {
+            if (solvedBeforeDeadline(polish) and abs(milp.getObj() - bound) < abs(obj - bound)) {
+                obj = milp.getObj();
+                rep << ", polished " << obj << " (" << fractional << " channels)";
+            } else {
+                // Restore the rounded solution (no solve needed)
+                fixBuffers(threshold);
+                milp.setSolution(rounded);
+                rep << (outOfTime ? ", not polished (time limit reached)" : ", not polished");
+            }
+        }
+    }
+
+    double gap = abs(obj - bound) / max(abs(obj), 1e-10);
+    rep << ", gap " << fixed << setprecision(2) << 100 * gap << "%";
+    report = rep.str();
+    return elapsed();
+}
+
 bool DFnetlist_Impl::addElasticBuffers(double Period, double BufferDelay, bool MaxThroughput, double coverage)
 {
     Milp_Model milp;
@@ -291,7 +455,9 @@ bool DFnetlist_Impl::addElasticBuffers(double Period, double BufferDelay, bool M
 //    addBorderBuffers();
     // Create the variables
     milpVarsEB milpVars;
+    milpVars.time_path_fixed = computeNonCriticalPorts(Period, BufferDelay);
     createMilpVarsEB(milp, milpVars, MaxThroughput);
+    if (hasMilpStart) setMilpStartEB(milp, milpVars);
 
     if (not createPathConstraints(milp, milpVars, Period, BufferDelay)) return false;
     if (not createElasticityConstraints(milp, milpVars)) return false;
@@ -326,7 +492,7 @@ bool DFnetlist_Impl::addElasticBuffers(double Period, double BufferDelay, bool M
     end_time = get_timestamp();
 
     elapsed_time = ( uint32_t ) ( end_time - start_time ) ;
-    printf ("Milp time: [ms] %d \n\r", elapsed_time);
+    cout << "Milp time: [ms] " << elapsed_time << " \n\r";
 
     Milp_Model::Status stat = milp.getStatus();
 
@@ -402,7 +568,9 @@ bool DFnetlist_Impl::addElasticBuffersBB(double Period, double BufferDelay, bool
     cout << "===========================" << endl;
 
     milpVarsEB milpVars;
+    milpVars.time_path_fixed = computeNonCriticalPorts(Period, BufferDelay);
     createMilpVarsEB(milp, milpVars, MaxThroughput, first_MG);
+    if (hasMilpStart) setMilpStartEB(milp, milpVars);
     if (not createPathConstraints(milp, milpVars, Period, BufferDelay)) return false;
     if (not createElasticityConstraints(milp, milpVars)) return false;
 
@@ -439,7 +607,7 @@ bool DFnetlist_Impl::addElasticBuffersBB(double Period, double BufferDelay, bool
     else milp.solve();
     end_time = get_timestamp();
     elapsed_time = ( uint32_t ) ( end_time - start_time ) ;
-    printf ("Milp time: [ms] %d \n\r", elapsed_time);
+    cout << "Milp time: [ms] " << elapsed_time << " \n\r";
 
     Milp_Model::Status stat = milp.getStatus();
     if (stat != Milp_Model::OPTIMAL and stat != Milp_Model::NONOPTIMAL) {
@@ -479,6 +647,608 @@ bool DFnetlist_Impl::addElasticBuffersBB(double Period, double BufferDelay, bool
     return true;
 }
 
+bool DFnetlist_Impl::addElasticBuffersSweep(double minPeriod, double maxPeriod, double step, double BufferDelay,
+                                            int timeout, bool first_MG, const string& prefix)
+{
+    if (minPeriod <= 0 or maxPeriod < minPeriod or step <= 0) {
+        setError("Invalid period sweep (the periods must be positive and the step larger than zero).");
+        return false;
+    }
+
+    vector<double> periods;
+    for (int k = 0; minPeriod + k * step <= maxPeriod + 1e-9; ++k) periods.push_back(minPeriod + k * step);
+    maxPeriod = periods.back();
+
+    cleanElasticBuffers();
+
+    cout << "==========================" << endl;
+    cout << "PERIOD SWEEP WITH BUFFERS" << endl;
+    cout << "==========================" << endl;
+
+    Milp_Model milp;
+    if (not milp.init(getMilpSolver())) {
+        setError(milp.getError());
+        return false;
+    }
+
+    cout << "Extracting marked graphs" << endl;
+    if (extractMarkedGraphsBB(1) == 0) {
+        setError("No marked graphs to optimize.");
+        return false;
+    }
+
+    findMCLSQ_load_channels();
+
+    // The model is created once for the largest period. The big-M coefficients
+    // of the flops (2 * period) are also valid for the smaller periods. The
+    // ports without critical paths are calculated for the smallest period, so
+    // that they are non-critical for all the periods of the sweep.
+    milpVarsEB milpVars;
+    milpVars.time_path_fixed = computeNonCriticalPorts(minPeriod, BufferDelay);
+    milpVars.period_shift = minPeriod - maxPeriod;
+    createMilpVarsEB(milp, milpVars, true, first_MG);
+    if (not createPathConstraints(milp, milpVars, maxPeriod, BufferDelay)) return false;
+    if (not createElasticityConstraints(milp, milpVars)) return false;
+    createThroughputConstraints(milp, milpVars, first_MG);
+
+    // Same cost function as in addElasticBuffersBB
+    computeChannelFrequencies();
+    double total_freq = 0;
+    ForAllChannels(c) total_freq += getChannelFrequency(c);
+
+    int optimize_num = first_MG ? 1 : MG.size();
+    vector<double> th_coef(optimize_num);
+    double highest_coef = 0.0, order_buf = 0.0001, order_slot = 0.00001;
+    for (int i = 0; i < optimize_num; i++) {
+        th_coef[i] = MG[i].numChannels() * MGfreq[i] / total_freq;
+        milp.newCostTerm(th_coef[i], milpVars.th_MG[i]);
+        highest_coef = max(highest_coef, th_coef[i]);
+    }
+
+    ForAllChannels(c) {
+        milp.newCostTerm(-1 * order_buf * highest_coef, milpVars.has_buffer[c]);
+        milp.newCostTerm(-1 * order_slot * highest_coef, milpVars.buffer_slots[c]);
+    }
+
+    milp.setMaximize();
+
+    // Periods that cannot satisfy the delays of the blocks are not solved
+    double minimum = getMinimumPeriod(BufferDelay);
+    int n = periods.size();
+    int jobs = max(1, min(getMilpJobs(), n));
+    cout << "Solving " << n << " MILPs for periods " << minPeriod << " to " << maxPeriod
+         << " with " << jobs << " jobs (" << milpVars.period_rows.size() << " rows depend on the period)" << endl;
+
+    vector<Milp_Model> milps(n);
+    vector<bool> solved(n, false);
+    vector<uint32_t> elapsed_time(n, 0);
+    vector<string> relax_report(n);
+    atomic<int> next(0);
+    string* log = ThreadLog::current();
+    vector<thread> workers;
+    for (int j = 0; j < jobs; j++) {
+        workers.emplace_back([&]() {
+            ThreadLog::Nested nested(log);
+            for (int k = next++; k < n; k = next++) {
+                if (periods[k] < minimum - 1e-9) continue;
+                milps[k] = milp;
+                for (const auto& r: milpVars.period_rows) {
+                    milps[k].setRHS(r.row, r.rhs + r.coef * (periods[k] - maxPeriod));
+                }
+                elapsed_time[k] = solveMilpEB(milps[k], milpVars, timeout, relax_report[k]);
+                Milp_Model::Status stat = milps[k].getStatus();
+                solved[k] = stat == Milp_Model::OPTIMAL or stat == Milp_Model::NONOPTIMAL;
+                nested.flush();
+            }
+        });
+    }
+    for (thread& t: workers) t.join();
+
+    // Throughput (weighted as in the cost function) and buffers of every period
+    double total_coef = 0;
+    for (double coef: th_coef) total_coef += coef;
+    vector<double> throughput(n, 0);
+    vector<int> buffers(n, 0), slots(n, 0);
+    for (int k = 0; k < n; k++) {
+        if (not solved[k]) continue;
+        for (int i = 0; i < optimize_num; i++) throughput[k] += th_coef[i] * milps[k][milpVars.th_MG[i]];
+        if (total_coef > 0) throughput[k] /= total_coef;
+        ForAllChannels(c) {
+            if (channelIsCovered(c, false, false, true) or milpVars.has_buffer[c] < 0) continue;
+            if (milps[k][milpVars.has_buffer[c]] < 0.5) continue;
+            buffers[k]++;
+            slots[k] += milps[k][milpVars.buffer_slots[c]] + 0.5;
+        }
+    }
+
+    // Pareto-optimal points: no other period is shorter (or equal) with
+    // a higher (or equal) throughput and less (or equal) buffers
+    const double eps = 1e-6;
+    vector<bool> pareto(n, false);
+    for (int k = 0; k < n; k++) {
+        if (not solved[k]) continue;
+        pareto[k] = true;
+        for (int j = 0; j < n and pareto[k]; j++) {
+            if (j == k or not solved[j]) continue;
+            bool dominates = periods[j] <= periods[k] + eps and throughput[j] >= throughput[k] - eps
+                             and buffers[j] <= buffers[k];
+            bool better = periods[j] < periods[k] - eps or throughput[j] > throughput[k] + eps
+                          or buffers[j] < buffers[k];
+            if (dominates and better) pareto[k] = false;
+        }
+    }
+
+    // The table is formatted apart, so that the format of cout is not changed
+    ostringstream table;
+    table << endl << "Period sweep (time per token = period / throughput):" << endl;
+    table << setw(10) << "period" << setw(12) << "throughput" << setw(16) << "time per token"
+          << setw(9) << "buffers" << setw(7) << "slots" << setw(11) << "milp [ms]" << "  pareto" << endl;
+    table << fixed << setprecision(3);
+    for (int k = 0; k < n; k++) {
+        table << setw(10) << periods[k];
+        if (solved[k]) {
+            table << setw(12) << throughput[k]
+                  << setw(16) << (throughput[k] > eps ? periods[k] / throughput[k] : INFINITY)
+                  << setw(9) << buffers[k] << setw(7) << slots[k] << setw(11) << elapsed_time[k]
+                  << (pareto[k] ? "  *" : "");
+        } else if (periods[k] < minimum - 1e-9) {
+            table << "  infeasible (the delays of the blocks need " << minimum << ")";
+        } else table << "  no solution";
+        table << endl;
+        if (not relax_report[k].empty()) table << "  " << relax_report[k] << endl;
+    }
+    cout << table.str();
+
+    if (prefix.empty()) return true;
+
+    // Buffered netlists of the Pareto-optimal periods (the netlist is not modified)
+    for (int k = 0; k < n; k++) {
+        if (not pareto[k]) continue;
+        DFnetlist_Impl buffered(*this);
+        ForAllChannels(c) {
+            if (channelIsCovered(c, false, false, true) or milpVars.has_buffer[c] < 0) continue;
+            if (milps[k][milpVars.has_buffer[c]] < 0.5) continue;
+            buffered.setChannelTransparency(c, milps[k].isFalse(milpVars.buffer_flop[c]));
+            buffered.setChannelBufferSize(c, milps[k][milpVars.buffer_slots[c]] + 0.5);
+        }
+        buffered.instantiateElasticBuffers();
+
+        ostringstream name;
+        name << prefix << "_p" << periods[k];
+        if (not buffered.writeDot(name.str() + "_graph_buf.dot") or
+            not buffered.writeDotBB(name.str() + "_bbgraph_buf.dot")) {
+            setError(buffered.getError());
+            return false;
+        }
+        cout << "Pareto-optimal period " << periods[k] << " written to " << name.str() << "_graph_buf.dot" << endl;
+    }
+
+    return true;
+}
+
+/*
+ * Greedy buffer placement. The netlist is too large for the MILP, thus the
+ * buffers are placed in three steps with linear-time traversals:
+ *  1. Elasticity: a DFS from the entry finds the back channels of the netlist
+ *     and each one gets an opaque buffer, so that every cycle has one.
+ *  2. Timing: the ports are visited in topological order and an opaque buffer
+ *     is inserted in a channel when the delay of the next block would exceed
+ *     the period (the latest cut of each critical path).
+ *  3. Throughput: the critical cycle of each MG is found by the throughput
+ *     analysis. The timing buffers of the cycle are moved to the channels that
+ *     enter the source block or leave the destination block (outside the cycle)
+ *     if the period is still met and the throughput improves.
+ */
+double DFnetlist_Impl::greedyTiming(double Period, double BufferDelay, vector<bool>& flop,
+                                    const vector<bool>& eligible, vector<double>& arrival, vector<double>& step)
+{
+    const double eps = 1e-9;
+    const GraphCSR& G = getGraph();
+    int n = vecPortsSize();
+    arrival.assign(n, 0);
+    step.assign(n, 0);
+    vector<int> indegree(n, 0);
+
+    // Same channels as in the path constraints
+    auto isPathChannel = [&](channelID c) {
+        return getBlockType(G.channelDstBlock[c]) != LSQ and getBlockType(G.channelSrcBlock[c]) != LSQ
+           and getBlockType(G.channelDstBlock[c]) != MC and getBlockType(G.channelSrcBlock[c]) != MC;
+    };
+
+    for (channelID c: G.channelList) {
+        if (not isPathChannel(c)) continue;
+        portID dst = G.channelDst[c];
+        arrival[dst] = max(arrival[dst], BufferDelay);
+        if (not flop[c]) indegree[dst]++;
+    }
+
+    for (blockID b: G.blockList) {
+        if (getLatency(b) == 0) {
+            for (portID in_p: G.inputs(b)) {
+                for (portID out_p: G.outputs(b)) {
+                    step[in_p] = max(step[in_p], getCombinationalDelay(in_p, out_p));
+                    indegree[out_p]++;
+                }
+            }
+        } else {
+            for (portID in_p: G.inputs(b)) step[in_p] = getPortDelay(in_p);
+            for (portID out_p: G.outputs(b)) arrival[out_p] = getPortDelay(out_p);
+        }
+    }
+
+    vector<portID> order;
+    for (blockID b: G.blockList) {
+        for (portID p: G.ports(b)) {
+            if (indegree[p] == 0) order.push_back(p);
+        }
+    }
+
+    double worst = -INFINITY;
+    for (int i = 0; i < order.size(); ++i) {
+        portID p = order[i];
+        worst = max(worst, arrival[p] + step[p] - Period);
+
+        if (isInputPort(p)) {
+            blockID b = G.portBlock[p];
+            if (getLatency(b) > 0) continue;
+            for (portID out_p: G.outputs(b)) {
+                arrival[out_p] = max(arrival[out_p], arrival[p] + getCombinationalDelay(p, out_p));
+                if (--indegree[out_p] == 0) order.push_back(out_p);
+            }
+            continue;
+        }
+
+        channelID c = G.portChannel[p];
+        if (c == invalidDataflowID or not isPathChannel(c) or flop[c]) continue;
+        portID dst = G.channelDst[c];
+        if (eligible[c] and arrival[p] + step[dst] > Period + eps) flop[c] = true;
+        else arrival[dst] = max(arrival[dst], arrival[p]);
+        if (--indegree[dst] == 0) order.push_back(dst);
+    }
+
+    // Some port in a combinational cycle
+    if (order.size() < G.portBegin.back()) return INFINITY;
+    return worst;
+}
+
+double DFnetlist_Impl::getCriticalPath(double BufferDelay)
+{
+    vector<bool> flop(vecChannelsSize(), false);
+    vector<bool> eligible(vecChannelsSize(), false);
+    ForAllChannels(c) {
+        flop[c] = getChannelBufferSize(c) > 0 and not isChannelTransparent(c);
+    }
+
+    vector<double> arrival, step;
+    return max(0.0, greedyTiming(0, BufferDelay, flop, eligible, arrival, step));
+}
+
+bool DFnetlist_Impl::addElasticBuffersGreedy(double Period, double BufferDelay, double targetThroughput,
+                                             bool bound, bool asMilpStart)
+{
+    cleanElasticBuffers();
+
+    cout << "===========================" << endl;
+    cout << "GREEDY PLACEMENT OF BUFFERS" << endl;
+    cout << "===========================" << endl;
+
+    if (Period <= 0) Period = INFINITY;
+    double minimum = getMinimumPeriod(BufferDelay);
+    if (Period < minimum) {
+        ostringstream err;
+        err << "Period " << Period << " cannot be satisfied (the delays of the blocks need " << minimum << ").";
+        setError(err.str());
+        return false;
+    }
+
+    if (BBG.empty()) cout << "No Basic Blocks: the marked graphs are not extracted" << endl;
+    else {
+        cout << "Extracting marked graphs" << endl;
+        extractMarkedGraphsBB(1);
+    }
+    findMCLSQ_load_channels();
+
+    // The MILP of addElasticBuffersBB is created before any buffer is
+    // annotated (the static timing analysis of the model uses them)
+    Milp_Model milp;
+    milpVarsEB milpVars;
+    if (bound and not milp.init(getMilpSolver())) {
+        cout << "Warning: no LP bound (" << milp.getError() << ")" << endl;
+        bound = false;
+    }
+    if (bound) {
+        milpVars.time_path_fixed = computeNonCriticalPorts(Period, BufferDelay);
+        createMilpVarsEB(milp, milpVars, true, false);
+        if (not createPathConstraints(milp, milpVars, isinf(Period) ? 0 : Period, BufferDelay)) return false;
+        if (not createElasticityConstraints(milp, milpVars)) return false;
+        createThroughputConstraints(milp, milpVars, false);
+    }
+
+    long long start_time = get_timestamp();
+    const GraphCSR& G = getGraph();
+    int nc = vecChannelsSize();
+
+    // Channels of the path and elasticity constraints, and channels
+    // in which a buffer can be inserted (same as in the MILP)
+    vector<bool> pathChannel(nc, false), eligible(nc, false);
+    for (channelID c: G.channelList) {
+        if (getBlockType(G.channelDstBlock[c]) == LSQ || getBlockType(G.channelSrcBlock[c]) == LSQ
+         || getBlockType(G.channelDstBlock[c]) == MC || getBlockType(G.channelSrcBlock[c]) == MC )
+            continue;
+        pathChannel[c] = true;
+        eligible[c] = not channelIsCovered(c, false, true, true);
+    }
+
+    // 1. Elasticity: opaque buffers in the back channels of a DFS
+    vector<bool> flop(nc, false);
+    vector<char> state(vecBlocksSize(), 0);     // 0: not visited, 1: in the stack, 2: done
+    vector<blockID> roots;
+    for (blockID b: G.blockList) {
+        if (getBlockType(b) == FUNC_ENTRY) roots.insert(roots.begin(), b);
+        else roots.push_back(b);
+    }
+    vector<pair<blockID,int>> S;                // Block and next successor
+    for (blockID root: roots) {
+        if (state[root]) continue;
+        S.push_back({root, 0});
+        state[root] = 1;
+        while (not S.empty()) {
+            blockID b = S.back().first;
+            auto succ = G.successors(b);
+            int& next = S.back().second;
+            if (next == succ.size()) {
+                state[b] = 2;
+                S.pop_back();
+                continue;
+            }
+            channelID c = succ.begin()[next++];
+            if (not pathChannel[c]) continue;
+            blockID kid = G.channelDstBlock[c];
+            if (state[kid] == 1) flop[c] = eligible[c];
+            else if (state[kid] == 0) {
+                state[kid] = 1;
+                S.push_back({kid, 0});
+            }
+        }
+    }
+    vector<bool> elastic(flop);
+    int numElastic = count(flop.begin(), flop.end(), true);
+
+    // 2. Timing: latest cut of every path longer than the period
+    vector<double> arrival, step;
+    double violation = greedyTiming(Period, BufferDelay, flop, eligible, arrival, step);
+    int numTiming = count(flop.begin(), flop.end(), true) - numElastic;
+    if (violation > 1e-9) {
+        setError("Greedy placement of buffers: the period cannot be satisfied (combinational cycle or fixed channels).");
+        return false;
+    }
+
+    auto annotate = [&](channelID c) {
+        setChannelTransparency(c, not flop[c]);
+        setChannelBufferSize(c, flop[c] ? 1 : 0);
+    };
+    for (channelID c: G.channelList) annotate(c);
+
+    // 3. Throughput: move the timing buffers out of the critical cycles
+    int numMG = MG.size();
+    double total_freq = 0;
+    if (numMG > 0 and not BBG.empty()) {
+        computeChannelFrequencies();
+        ForAllChannels(c) total_freq += getChannelFrequency(c);
+    }
+    vector<double> coef(numMG);
+    vector<ThroughputInfo> info(numMG);
+    for (int i = 0; i < numMG; i++) {
+        coef[i] = total_freq > 0 ? MG[i].numChannels() * MGfreq[i] / total_freq : 1;
+        info[i] = analyzeThroughput(MG[i]);
+    }
+
+    // Arrival time of a port from its predecessors (as in greedyTiming)
+    auto portArrival = [&](portID p) {
+        if (isInputPort(p)) {
+            channelID c = G.portChannel[p];
+            if (c == invalidDataflowID or not pathChannel[c]) return 0.0;
+            return flop[c] ? BufferDelay : max(BufferDelay, arrival[G.channelSrc[c]]);
+        }
+        blockID b = G.portBlock[p];
+        if (getLatency(b) > 0) return getPortDelay(p);
+        double a = 0;
+        for (portID in_p: G.inputs(b)) a = max(a, arrival[in_p] + getCombinationalDelay(in_p, p));
+        return a;
+    };
+
+    // Moves a buffer to other channels if the period is still met. Only the
+    // arrival times of the ports after the modified channels are updated.
+    // The previous arrival times are stored in log to undo the move.
+    typedef pair<channelID, vecChannels> Move;
+    vector<pair<portID,double>> log;
+    auto undoMove = [&](const Move& move, int mark) {
+        flop[move.first] = true;
+        for (channelID other: move.second) flop[other] = false;
+        while (log.size() > mark) {
+            arrival[log.back().first] = log.back().second;
+            log.pop_back();
+        }
+    };
+    auto tryMove = [&](const Move& move) {
+        int mark = log.size();
+        flop[move.first] = false;
+        for (channelID other: move.second) flop[other] = true;
+
+        vector<portID> pending {G.channelDst[move.first]};
+        for (channelID other: move.second) pending.push_back(G.channelDst[other]);
+        while (not pending.empty()) {
+            portID p = pending.back();
+            pending.pop_back();
+            double a = portArrival(p);
+            if (abs(a - arrival[p]) < 1e-12) continue;
+            log.push_back({p, arrival[p]});
+            arrival[p] = a;
+            if (a + step[p] > Period + 1e-9) {
+                undoMove(move, mark);
+                return false;
+            }
+            if (isInputPort(p)) {
+                if (getLatency(G.portBlock[p]) > 0) continue;
+                for (portID out_p: G.outputs(G.portBlock[p])) pending.push_back(out_p);
+            } else {
+                channelID c = G.portChannel[p];
+                if (c != invalidDataflowID and pathChannel[c] and not flop[c]) pending.push_back(G.channelDst[c]);
+            }
+        }
+        return true;
+    };
+
+    // The timing buffers of the critical cycle of an MG are moved to the
+    // channels entering the source block or leaving the destination block
+    // (not in the cycle). The moves are kept if the weighted throughput of
+    // the MGs improves and no MG gets worse.
+    int moves = 0;
+    vector<bool> done(numMG, false);
+    for (int round = 0; round < 100 * numMG; ++round) {
+        // The MG with the largest weight below the target
+        int mg = -1;
+        for (int i = 0; i < numMG; i++) {
+            if (done[i] or info[i].throughput >= targetThroughput - 1e-9) continue;
+            if (mg < 0 or coef[i] > coef[mg]) mg = i;
+        }
+        if (mg < 0) break;
+
+        setChannels cycle(info[mg].criticalCycle.begin(), info[mg].criticalCycle.end());
+        vector<Move> applied;
+        int mark = log.size();
+        for (channelID c: info[mg].criticalCycle) {
+            if (not flop[c] or elastic[c] or not eligible[c]) continue;
+            for (bool up: {true, false}) {
+                blockID b = up ? G.channelSrcBlock[c] : G.channelDstBlock[c];
+                if (getLatency(b) > 0) continue;
+                Move move {c, {}};
+                bool valid = true;
+                for (channelID other: up ? G.predecessors(b) : G.successors(b)) {
+                    if (flop[other]) continue;
+                    if (not eligible[other] or cycle.count(other)) valid = false;
+                    else move.second.push_back(other);
+                }
+                if (valid and tryMove(move)) {
+                    applied.push_back(move);
+                    break;
+                }
+            }
+        }
+
+        if (applied.empty()) {
+            done[mg] = true;
+            continue;
+        }
+
+        // Throughput of the MGs affected by the moves
+        for (const Move& move: applied) {
+            annotate(move.first);
+            for (channelID other: move.second) annotate(other);
+        }
+        vector<ThroughputInfo> new_info(info);
+        double gain = 0;
+        bool worse = false;
+        for (int i = 0; i < numMG and not worse; i++) {
+            bool affected = false;
+            for (const Move& move: applied) {
+                affected = affected or MG[i].hasChannel(move.first);
+                for (channelID other: move.second) affected = affected or MG[i].hasChannel(other);
+            }
+            if (not affected) continue;
+            new_info[i] = analyzeThroughput(MG[i]);
+            worse = new_info[i].throughput < info[i].throughput - 1e-9;
+            gain += coef[i] * (new_info[i].throughput - info[i].throughput);
+        }
+
+        if (worse or gain <= 1e-9) {
+            for (int k = applied.size() - 1; k >= 0; --k) undoMove(applied[k], mark);
+            for (const Move& move: applied) {
+                annotate(move.first);
+                for (channelID other: move.second) annotate(other);
+            }
+            done[mg] = true;
+            continue;
+        }
+
+        info = new_info;
+        log.clear();
+        moves += applied.size();
+    }
+
+    uint32_t elapsed_time = ( uint32_t ) ( get_timestamp() - start_time );
+
+    // The report is formatted apart, so that the format of cout is not changed
+    ostringstream rep;
+    rep << fixed << setprecision(3);
+    int numBuffers = count(flop.begin(), flop.end(), true);
+    double weighted = 0, total_coef = 0;
+    for (int i = 0; i < numMG; i++) {
+        weighted += coef[i] * info[i].throughput;
+        total_coef += coef[i];
+        rep << "Throughput of MG " << i << ": " << info[i].throughput << endl;
+    }
+    if (total_coef > 0) weighted /= total_coef;
+    rep << "Greedy placement: " << numBuffers << " buffers (" << numElastic << " for cycles, "
+        << numTiming << " for the period, " << moves << " moves for throughput), weighted throughput "
+        << weighted << ", time [ms] " << elapsed_time << endl;
+    cout << rep.str();
+    rep.str("");
+
+    // Gap to the LP relaxation of the MILP. The objective of the greedy
+    // solution is obtained with the buffers fixed (one slot per buffer)
+    if (bound) {
+        double highest_coef = 0;
+        for (int i = 0; i < numMG; i++) {
+            milp.newCostTerm(coef[i], milpVars.th_MG[i]);
+            highest_coef = max(highest_coef, coef[i]);
+        }
+        if (numMG == 0) highest_coef = 1;
+        ForAllChannels(c) {
+            milp.newCostTerm(-0.0001 * highest_coef, milpVars.has_buffer[c]);
+            milp.newCostTerm(-0.00001 * highest_coef, milpVars.buffer_slots[c]);
+        }
+        milp.setMaximize();
+        milp.setRelaxation(true);
+
+        auto solved = [&]() {
+            Milp_Model::Status stat = milp.solve() ? milp.getStatus() : Milp_Model::UNKNOWN;
+            return stat == Milp_Model::OPTIMAL or stat == Milp_Model::NONOPTIMAL;
+        };
+
+        if (not solved()) rep << "LP relaxation: no solution" << endl;
+        else {
+            double lp_bound = milp.getObj();
+            for (channelID c: G.channelList) {
+                if (milpVars.buffer_flop[c] < 0) continue;
+                milp.fixVar(milpVars.buffer_flop[c], flop[c]);
+                milp.fixVar(milpVars.buffer_slots[c], flop[c]);
+                milp.fixVar(milpVars.has_buffer[c], flop[c]);
+            }
+            rep << "LP relaxation: bound " << lp_bound;
+            if (solved()) {
+                double obj = milp.getObj();
+                double gap = abs(lp_bound - obj) / max(abs(obj), 1e-10);
+                rep << ", greedy " << obj << ", gap " << setprecision(2) << 100 * gap << "%" << endl;
+            } else rep << ", greedy solution not feasible in the MILP (slots)" << endl;
+        }
+        cout << rep.str();
+        milp.setRelaxation(false);
+    }
+
+    if (not asMilpStart) return true;
+
+    // The buffers are the MIP start of the exact placement
+    milpStart.clear();
+    for (channelID c: G.channelList) {
+        if (flop[c]) milpStart[getChannelName(c)] = {1, false};
+    }
+    hasMilpStart = true;
+    cleanElasticBuffers();
+    cout << "MIP start: " << milpStart.size() << " buffers from the greedy placement" << endl;
+    return true;
+}
+
 bool DFnetlist_Impl::addElasticBuffersBB_sc(double Period, double BufferDelay, bool MaxThroughput, double coverage, int timeout, bool first_MG) {
 
     cleanElasticBuffers();
@@ -487,6 +1257,9 @@ bool DFnetlist_Impl::addElasticBuffersBB_sc(double Period, double BufferDelay, b
     cout << "ADDING ELASTIC BUFFERS" << endl;
     cout << "======================" << endl;
 
+    // The clock of the global budget includes the extraction of the MGs
+    Milp_Budget budget(getMilpBudget(), getMilpJobs());
+
     Milp_Model milp;
 
     if (not milp.init(getMilpSolver())) {
@@ -536,113 +1309,139 @@ bool DFnetlist_Impl::addElasticBuffersBB_sc(double Period, double BufferDelay, b
     calculateDisjointCFDFCs();
     makeMGsfromCFDFCs();
 
-    auto milpVars_sc = vector<milpVarsEB>(MG_disjoint.size(), milpVarsEB());
+    int numMGs = MG_disjoint.size();
+    auto milpVars_sc = vector<milpVarsEB>(numMGs, milpVarsEB());
+    vector<double> fixed_ports = computeNonCriticalPorts(Period, BufferDelay);
+    for (milpVarsEB& vars: milpVars_sc) vars.time_path_fixed = fixed_ports;
     long long total_time = 0;
-    double order_buf = 0.0001, order_slot = 0.00001;
 
     if (MaxThroughput) computeChannelFrequencies();
 
-    for (int i = 0; i < MG_disjoint.size(); i++) {
-        cout << "-------------------------------" << endl;
-        cout << "Initiating MILP for MG number " << i << endl;
-        cout << "-------------------------------" << endl;
-
-        createMilpVarsEB_sc(milp, milpVars_sc[i], MaxThroughput, i, first_MG);
-        if (not createPathConstraints_sc(milp, milpVars_sc[i], Period, BufferDelay, i)) return false;
-        if (not createElasticityConstraints_sc(milp, milpVars_sc[i], i)) return false;
-
-
-        double highest_coef = 1.0;
-        if (MaxThroughput) {
-            createThroughputConstraints_sc(milp, milpVars_sc[i], i, first_MG);
-
-            double total_freq = 0;
-            for (channelID c: MG_disjoint[i].getChannels()) {
-                total_freq += getChannelFrequency(c);
-            }
-
-            double mg_highest_coef = 0.0;
-            for (auto sub_mg: components[i]) {
-                double coef = MG[sub_mg].numChannels() * MGfreq[sub_mg] / total_freq;
-                milp.newCostTerm(coef, milpVars_sc[i].th_MG[sub_mg]);
-                mg_highest_coef = mg_highest_coef > coef ? mg_highest_coef : coef;
-                if (first_MG) break;
-            }
-            highest_coef = mg_highest_coef;
+    // Incremental placement: the disjoint sets that have not changed
+    // keep the buffers of the previous placement
+    vector<bool> carried(numMGs, false);
+    if (hasPrevPlacement) {
+        for (int i = 0; i < numMGs; i++) carried[i] = carryOverBuffers(i);
+    }
+
+    // Register the MILPs in the global budget. The weight of each MG is the
+    // same as in the objective (size times frequency). The MILP of the
+    // remaining channels is weighted as if they had the average frequency.
+    vector<int> budget_mg(numMGs);
+    vector<double> mg_weight(numMGs, 0);
+    int budget_remaining = -1;
+    if (budget.enabled()) {
+        double total_weight = 0;
+        int total_channels = 0;
+        for (int i = 0; i < numMGs; i++) {
+            if (carried[i]) continue;
+            double weight = 0;
+            if (MaxThroughput) {
+                for (auto sub_mg: components[i]) {
+                    weight += MG[sub_mg].numChannels() * MGfreq[sub_mg];
+                    if (first_MG) break;
+                }
+            } else weight = MG_disjoint[i].numChannels();
+            budget_mg[i] = budget.add(weight);
+            mg_weight[i] = weight;
+            total_weight += weight;
+            total_channels += MG_disjoint[i].numChannels();
         }
-
-        for (channelID c: MG_disjoint[i].getChannels()) {
-            if (channelIsCovered(c, false, true, false)) continue;
-
-            milp.newCostTerm(-1 * order_buf * highest_coef, milpVars_sc[i].has_buffer[c]);
-            milp.newCostTerm(-1 * order_slot * highest_coef, milpVars_sc[i].buffer_slots[c]);
+        int uncovered = 0;
+        ForAllChannels(c) {
+            if (not channelIsCovered(c, true, true, false)) uncovered++;
         }
-
-        milp.setMaximize();
-
-        cout << "Solving MILP for elastic buffers: MG " << i << endl;
-
-        long long start_time, end_time;
-        uint32_t elapsed_time;
-        start_time = get_timestamp();
-        if (timeout > 0) milp.solve(timeout);
-        else milp.solve();
-        end_time = get_timestamp();
-        elapsed_time = ( uint32_t ) ( end_time - start_time ) ;
-        printf ("Milp time for MG %d: [ms] %d \n\n\r", i, elapsed_time);
-        total_time += elapsed_time;
-
-        Milp_Model::Status stat = milp.getStatus();
-        if (stat != Milp_Model::OPTIMAL and stat != Milp_Model::NONOPTIMAL) {
-            setError("No solution found to add elastic buffers.");
-            return false;
-        }
-
-        if (MaxThroughput) {
-            for (auto sub_mg: components[i]) {
-                cout << "************************" << endl;
-                cout << "*** Throughput for MG " << sub_mg << " in disjoint MG " << i << ": ";
-                cout << fixed << setprecision(2) << milp[milpVars_sc[i].th_MG[sub_mg]] << " ***" << endl;
-                cout << "************************" << endl;
-                if (first_MG) break;
+        double channel_weight = total_channels > 0 ? total_weight / total_channels : 1;
+        budget_remaining = budget.add(uncovered * channel_weight);
+        cout << "MILP time budget: [s] " << getMilpBudget() << " (" << (int) budget.remainingTime() << " left)" << endl;
+    }
+
+    int jobs = min(getMilpJobs(), numMGs);
+    if (jobs <= 1) {
+        for (int i = 0; i < numMGs; i++) {
+            if (carried[i]) continue;
+            if (not createMilpModelEB_sc(milp, milpVars_sc[i], i, Period, BufferDelay, MaxThroughput, first_MG)) return false;
+
+            cout << "Solving MILP for elastic buffers: MG " << i << endl;
+            int mg_timeout = budget.enabled() ? budget.claim(budget_mg[i]) : timeout;
+            if (budget.enabled()) cout << "Time limit for MG " << i << ": [s] " << mg_timeout << endl;
+            string relax_report;
+            uint32_t elapsed_time = solveMilpEB(milp, milpVars_sc[i], mg_timeout, relax_report);
+            if (budget.enabled()) budget.release(budget_mg[i]);
+            cout << "Milp time for MG " << i << ": [ms] " << elapsed_time << " \n\n\r";
+            if (getMilpSolver() == "portfolio") cout << "Solver for MG " << i << ": " << milp.getSolverUsed() << endl;
+            if (not milp.getPresolveReport().empty()) cout << milp.getPresolveReport() << endl;
+            if (not relax_report.empty()) cout << relax_report << endl;
+            total_time += elapsed_time;
+
+            if (not applyMilpSolutionEB_sc(milp, milpVars_sc[i], i, MaxThroughput, first_MG)) return false;
+
+            if (not milp.init(getMilpSolver())) {
+                setError(milp.getError());
+                return false;
             }
         }
-
-         //dumpMilpSolution(milp, milpVars_sc[i]);
-
-        // Add channels
-        vector<channelID> buffers;
-        for (channelID c: MG_disjoint[i].getChannels()) {
-            if (channelIsCovered(c, false, true, true)) continue;
-            if (milp[milpVars_sc[i].buffer_slots[c]] > 0.5) {
-                buffers.push_back(c);
+    } else {
+        // The models of the disjoint MGs cover disjoint sets of channels and
+        // do not depend on each other. They are all created first and solved
+        // concurrently. The solutions are annotated in the order of the MGs,
+        // so that the result is the same as in the sequential execution.
+        vector<Milp_Model> milps(numMGs);
+        for (int i = 0; i < numMGs; i++) {
+            if (carried[i]) continue;
+            if (not milps[i].init(getMilpSolver())) {
+                setError(milps[i].getError());
+                return false;
             }
+            if (not createMilpModelEB_sc(milps[i], milpVars_sc[i], i, Period, BufferDelay, MaxThroughput, first_MG)) return false;
         }
 
-        for (channelID c: buffers) {
-            int slots = milp[milpVars_sc[i].buffer_slots[c]] + 0.5; // Automatically truncated
-            bool transparent = milp.isFalse(milpVars_sc[i].buffer_flop[c]);
-            setChannelTransparency(c, transparent);
-            setChannelBufferSize(c, slots);
-
-            printChannelInfo(c, slots, transparent);
+        vector<int> order;
+        for (int i = 0; i < numMGs; i++) {
+            if (not carried[i]) order.push_back(i);
         }
+        cout << "Solving " << order.size() << " MILPs for elastic buffers with " << jobs << " jobs" << endl;
 
-        //write retiming diffs
-        writeRetimingDiffs(milp, milpVars_sc[i]);
-
+        // With a budget, the heaviest MGs are started first
+        if (budget.enabled()) {
+            stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return mg_weight[a] > mg_weight[b];
+            });
+        }
 
-        if (MaxThroughput) {
-            for (auto sub_mg: components[i]) {
-                cout << "\n*** Throughput achieved in sub MG " << sub_mg << ": " <<
-                     fixed << setprecision(2) << milp[milpVars_sc[i].th_MG[sub_mg]] << " ***\n" << endl;
-                if (first_MG) break;
-            }
+        vector<uint32_t> elapsed_time(numMGs, 0);
+        vector<int> mg_timeout(numMGs, timeout);
+        vector<string> relax_report(numMGs);
+        atomic<int> next_mg(0);
+        long long start_time = get_timestamp();
+        string* log = ThreadLog::current();
+        vector<thread> workers;
+        for (int j = 0; j < jobs; j++) {
+            workers.emplace_back([&]() {
+                ThreadLog::Nested nested(log);
+                for (int k = next_mg++; k < order.size(); k = next_mg++) {
+                    int i = order[k];
+                    if (budget.enabled()) mg_timeout[i] = budget.claim(budget_mg[i]);
+                    elapsed_time[i] = solveMilpEB(milps[i], milpVars_sc[i], mg_timeout[i], relax_report[i]);
+                    if (budget.enabled()) budget.release(budget_mg[i]);
+                    nested.flush();
+                }
+            });
         }
-        if (not milp.init(getMilpSolver())) {
-            setError(milp.getError());
-            return false;
+        for (thread& t: workers) t.join();
+        uint32_t wall_time = ( uint32_t ) ( get_timestamp() - start_time );
+
+        for (int i = 0; i < numMGs; i++) {
+            if (carried[i]) continue;
+            if (budget.enabled()) cout << "Time limit for MG " << i << ": [s] " << mg_timeout[i] << endl;
+            cout << "Milp time for MG " << i << ": [ms] " << elapsed_time[i] << " \n\n\r";
+            if (getMilpSolver() == "portfolio") cout << "Solver for MG " << i << ": " << milps[i].getSolverUsed() << endl;
+            if (not milps[i].getPresolveReport().empty()) cout << milps[i].getPresolveReport() << endl;
+            if (not relax_report[i].empty()) cout << relax_report[i] << endl;
+            total_time += elapsed_time[i];
+            if (not applyMilpSolutionEB_sc(milps[i], milpVars_sc[i], i, MaxThroughput, first_MG)) return false;
         }
+        cout << "Milp wall time for " << order.size() << " MGs (" << jobs << " jobs): [ms] " << wall_time << " \n\n\r";
     }
 
 
@@ -659,7 +1458,10 @@ bool DFnetlist_Impl::addElasticBuffersBB_sc(double Period, double BufferDelay, b
 
     milpVarsEB remaining;
 
+    milp.setLabel("remaining channels");
+    remaining.time_path_fixed = computeNonCriticalPorts(Period, BufferDelay, true);
     createMilpVars_remaining(milp, remaining);
+    if (hasMilpStart) setMilpStartEB(milp, remaining);
     createPathConstraints_remaining(milp, remaining, Period, BufferDelay);
     createElasticityConstraints_remaining(milp, remaining);
 
@@ -672,14 +1474,16 @@ bool DFnetlist_Impl::addElasticBuffersBB_sc(double Period, double BufferDelay, b
 
     cout << "Solving MILP for channels not covered by MGs" << endl;
 
-    long long start_time, end_time;
-    uint32_t elapsed_time;
-    start_time = get_timestamp();
-    if (timeout > 0) milp.solve(timeout);
-    else milp.solve();
-    end_time = get_timestamp();
-    elapsed_time = ( uint32_t ) ( end_time - start_time ) ;
-    printf ("Milp time for remaining channels: [ms] %d \n\n\r", elapsed_time);
+    if (budget.enabled()) {
+        timeout = budget.claim(budget_remaining);
+        cout << "Time limit for remaining channels: [s] " << timeout << endl;
+    }
+
+    string relax_report;
+    uint32_t elapsed_time = solveMilpEB(milp, remaining, timeout, relax_report);
+    cout << "Milp time for remaining channels: [ms] " << elapsed_time << " \n\n\r";
+    if (not milp.getPresolveReport().empty()) cout << milp.getPresolveReport() << endl;
+    if (not relax_report.empty()) cout << relax_report << endl;
     total_time += elapsed_time;
 
     Milp_Model::Status stat = milp.getStatus();
@@ -705,64 +1509,298 @@ bool DFnetlist_Impl::addElasticBuffersBB_sc(double Period, double BufferDelay, b
     }
 
     cout << "***************************" << endl;
-    printf ("Total MILP time: [ms] %d\n\r", total_time);
+    cout << "Total MILP time: [ms] " << total_time << "\n\r";
     cout << "***************************" << endl;
     return true;
 }
 
 
 
+bool DFnetlist_Impl::createMilpModelEB_sc(Milp_Model& milp, milpVarsEB& vars, int mg, double Period,
+                                          double BufferDelay, bool MaxThroughput, bool first_MG)
+{
+    double order_buf = 0.0001, order_slot = 0.00001;
+
+    cout << "-------------------------------" << endl;
+    cout << "Initiating MILP for MG number " << mg << endl;
+    cout << "-------------------------------" << endl;
+
+    milp.setLabel("MG " + to_string(mg));
+    createMilpVarsEB_sc(milp, vars, MaxThroughput, mg, first_MG);
+    if (hasMilpStart) setMilpStartEB(milp, vars);
+    if (not createPathConstraints_sc(milp, vars, Period, BufferDelay, mg)) return false;
+    if (not createElasticityConstraints_sc(milp, vars, mg)) return false;
+
+
+    double highest_coef = 1.0;
+    if (MaxThroughput) {
+        createThroughputConstraints_sc(milp, vars, mg, first_MG);
+
+        double total_freq = 0;
+        for (channelID c: MG_disjoint_cover[mg].channels) {
+            total_freq += getChannelFrequency(c);
+        }
+
+        double mg_highest_coef = 0.0;
+        for (auto sub_mg: components[mg]) {
+            double coef = MG[sub_mg].numChannels() * MGfreq[sub_mg] / total_freq;
+            milp.newCostTerm(coef, vars.th_MG[sub_mg]);
+            mg_highest_coef = mg_highest_coef > coef ? mg_highest_coef : coef;
+            if (first_MG) break;
+        }
+        highest_coef = mg_highest_coef;
+    }
+
+    for (channelID c: MG_disjoint_cover[mg].channels) {
+        if (channelIsCovered(c, false, true, false)) continue;
+
+        milp.newCostTerm(-1 * order_buf * highest_coef, vars.has_buffer[c]);
+        milp.newCostTerm(-1 * order_slot * highest_coef, vars.buffer_slots[c]);
+    }
+
+    milp.setMaximize();
+    return true;
+}
+
+bool DFnetlist_Impl::applyMilpSolutionEB_sc(const Milp_Model& milp, const milpVarsEB& vars, int mg,
+                                            bool MaxThroughput, bool first_MG)
+{
+    Milp_Model::Status stat = milp.getStatus();
+    if (stat != Milp_Model::OPTIMAL and stat != Milp_Model::NONOPTIMAL) {
+        setError("No solution found to add elastic buffers.");
+        return false;
+    }
+
+    if (MaxThroughput) {
+        for (auto sub_mg: components[mg]) {
+            cout << "************************" << endl;
+            cout << "*** Throughput for MG " << sub_mg << " in disjoint MG " << mg << ": ";
+            cout << fixed << setprecision(2) << milp[vars.th_MG[sub_mg]] << " ***" << endl;
+            cout << "************************" << endl;
+            if (first_MG) break;
+        }
+    }
+
+     //dumpMilpSolution(milp, vars);
+
+    // Add channels
+    vector<channelID> buffers;
+    for (channelID c: MG_disjoint_cover[mg].channels) {
+        if (channelIsCovered(c, false, true, true)) continue;
+        if (milp[vars.buffer_slots[c]] > 0.5) {
+            buffers.push_back(c);
+        }
+    }
+
+    for (channelID c: buffers) {
+        int slots = milp[vars.buffer_slots[c]] + 0.5; // Automatically truncated
+        bool transparent = milp.isFalse(vars.buffer_flop[c]);
+        setChannelTransparency(c, transparent);
+        setChannelBufferSize(c, slots);
+
+        printChannelInfo(c, slots, transparent);
+    }
+
+    //write retiming diffs
+    writeRetimingDiffs(milp, vars);
+
+
+    if (MaxThroughput) {
+        for (auto sub_mg: components[mg]) {
+            cout << "\n*** Throughput achieved in sub MG " << sub_mg << ": " <<
+                 fixed << setprecision(2) << milp[vars.th_MG[sub_mg]] << " ***\n" << endl;
+            if (first_MG) break;
+        }
+    }
+    return true;
+}
+
+double DFnetlist_Impl::getMinimumPeriod(double BufferDelay)
+{
+    const GraphCSR& G = getGraph();
+    double minimum = 0;
+    for (blockID b: G.blockList) {
+        if (getLatency(b) == 0) {
+            for (portID out_p: G.outputs(b)) {
+                for (portID in_p: G.inputs(b)) minimum = max(minimum, getCombinationalDelay(in_p, out_p) + BufferDelay);
+            }
+        } else {
+            minimum = max(minimum, getBlockDelay(b));
+            for (portID out_p: G.outputs(b)) minimum = max(minimum, getPortDelay(out_p));
+            for (portID in_p: G.inputs(b)) minimum = max(minimum, getPortDelay(in_p) + BufferDelay);
+        }
+    }
+    return minimum;
+}
+
+/*
+ * Static timing analysis for the path constraints. The arrival time of a port
+ * is the longest combinational delay from a sequential element (output of a
+ * pipelined unit, buffer delay at the input of a channel) and the required time
+ * is the longest delay to a sequential element (input of a pipelined unit or
+ * end of a channel). The channels with an opaque buffer already annotated are
+ * cut and the rest are considered without buffer. If the sum of both times is
+ * not larger than the period, no path through the port needs a buffer and its
+ * time can be fixed to the arrival time: for any placement of buffers, the
+ * earliest times of the ports still satisfy the path constraints when the
+ * non-critical ports take their arrival time. The model is thus not changed
+ * (same feasible buffers), but it is smaller.
+ */
+vector<double> DFnetlist_Impl::computeNonCriticalPorts(double Period, double BufferDelay, bool MG)
+{
+    vector<double> fixed;
+    if (not getMilpPathPruning()) return fixed;
+
+    if (Period <= 0) Period = INFINITY;
+    const GraphCSR& G = getGraph();
+    int n = vecPortsSize();
+    vector<vector<pair<portID,double>>> succ(n);   // Combinational arcs (port, delay)
+    vector<double> arrival(n, 0);
+    vector<double> required(n, 0);
+
+    for (channelID c: G.channelList) {
+        // Same channels as in the path constraints
+        if (getBlockType(G.channelDstBlock[c]) == LSQ || getBlockType(G.channelSrcBlock[c]) == LSQ
+         || getBlockType(G.channelDstBlock[c]) == MC || getBlockType(G.channelSrcBlock[c]) == MC )
+            continue;
+
+        portID dst = G.channelDst[c];
+        if (BufferDelay > 0) arrival[dst] = max(arrival[dst], BufferDelay);
+        if (channelIsCovered(c, MG, true, false) and not isChannelTransparent(c)) continue;
+        succ[G.channelSrc[c]].push_back({dst, 0});
+    }
+
+    for (blockID b: G.blockList) {
+        if (getLatency(b) == 0) {
+            for (portID out_p: G.outputs(b)) {
+                for (portID in_p: G.inputs(b)) succ[in_p].push_back({out_p, getCombinationalDelay(in_p, out_p)});
+            }
+        } else {
+            for (portID out_p: G.outputs(b)) arrival[out_p] = max(arrival[out_p], getPortDelay(out_p));
+            for (portID in_p: G.inputs(b)) required[in_p] = max(required[in_p], getPortDelay(in_p));
+        }
+    }
+
+    // Topological order of the ports. The ports in combinational cycles
+    // (or after them) are not visited and remain critical.
+    vector<int> indegree(n, 0);
+    for (const auto& arcs: succ) {
+        for (const auto& arc: arcs) indegree[arc.first]++;
+    }
+    vector<portID> order;
+    for (portID p = 0; p < n; ++p) {
+        if (indegree[p] == 0) order.push_back(p);
+    }
+    for (int i = 0; i < order.size(); ++i) {
+        portID p = order[i];
+        for (const auto& arc: succ[p]) {
+            arrival[arc.first] = max(arrival[arc.first], arrival[p] + arc.second);
+            if (--indegree[arc.first] == 0) order.push_back(arc.first);
+        }
+    }
+
+    vector<bool> visited(n, false);
+    for (portID p: order) visited[p] = true;
+    for (int i = order.size() - 1; i >= 0; --i) {
+        portID p = order[i];
+        for (const auto& arc: succ[p]) {
+            double r = visited[arc.first] ? arc.second + required[arc.first] : INFINITY;
+            required[p] = max(required[p], r);
+        }
+    }
+
+    fixed = vector<double>(n, -1);
+    int numPorts = 0, numFixed = 0;
+    for (blockID b: G.blockList) {
+        for (portID p: G.ports(b)) {
+            numPorts++;
+            if (not visited[p] or isinf(required[p]) or arrival[p] + required[p] > Period) continue;
+            fixed[p] = arrival[p];
+            numFixed++;
+        }
+    }
+    cout << "Static timing analysis: " << numFixed << " of " << numPorts
+         << " ports without critical paths" << endl;
+    return fixed;
+}
+
+void DFnetlist_Impl::newPathRow(Milp_Model& milp, milpVarsEB& Vars, const Milp_Model::vecTerms& ports,
+                                char type, double rhs, const Milp_Model::vecTerms& flops, double periodCoef)
+{
+    Milp_Model::vecTerms terms;
+    for (const auto& t: ports) {
+        if (Vars.isPathFixed(t.second)) rhs -= t.first * Vars.time_path_fixed[t.second];
+        else terms.push_back({t.first, Vars.time_path[t.second]});
+    }
+
+    // Without time variables, the row is dropped if it holds for
+    // any value of the (boolean) flop variables and any period
+    if (terms.empty()) {
+        const double eps = 1e-9;
+        double lo = 0, hi = 0;
+        double rhs_lo = rhs + min(0.0, periodCoef * Vars.period_shift);
+        double rhs_hi = rhs + max(0.0, periodCoef * Vars.period_shift);
+        for (const auto& t: flops) (t.first > 0 ? hi : lo) += t.first;
+        if (type == '>' and lo >= rhs_hi - eps) return;
+        if (type == '<' and hi <= rhs_lo + eps) return;
+        if (type == '=' and flops.empty() and periodCoef == 0 and abs(rhs) <= eps) return;
+    }
+
+    terms.insert(terms.end(), flops.begin(), flops.end());
+    int row = milp.newRow(terms, type, rhs);
+    if (periodCoef != 0) Vars.period_rows.push_back({row, periodCoef, rhs});
+}
+
 bool DFnetlist_Impl::createPathConstraints(Milp_Model& milp, milpVarsEB& Vars, double Period, double BufferDelay)
 {
 
     // Create the variables and constraints for all channels
     bool hasPeriod = Period > 0;
     if (not hasPeriod) Period = INFINITY;
+    const GraphCSR& G = getGraph();
 
 
-    ForAllChannels(c) {
+    for (channelID c: G.channelList) {
         // Lana 02.05.20. paths from/to memory do not need buffers
-        if (getBlockType(getDstBlock(c)) == LSQ || getBlockType(getSrcBlock(c)) == LSQ
-         || getBlockType(getDstBlock(c)) == MC || getBlockType(getSrcBlock(c)) == MC )
+        if (getBlockType(G.channelDstBlock[c]) == LSQ || getBlockType(G.channelSrcBlock[c]) == LSQ
+         || getBlockType(G.channelDstBlock[c]) == MC || getBlockType(G.channelSrcBlock[c]) == MC )
             continue;
 
-        int v1 =  Vars.time_path[getSrcPort(c)];
-        int v2 =  Vars.time_path[getDstPort(c)];
+        portID p1 = G.channelSrc[c];
+        portID p2 = G.channelDst[c];
         int R = Vars.buffer_flop[c];
 
         if (hasPeriod) {
             // v1, v2 <= Period
-            milp.newRow( {{1,v1}}, '<', Period);
-            milp.newRow( {{1,v2}}, '<', Period);
+            newPathRow(milp, Vars, {{1, p1}}, '<', Period, {}, 1);
+            newPathRow(milp, Vars, {{1, p2}}, '<', Period, {}, 1);
 
             // v2 >= v1 - 2*period*R
             if (channelIsCovered(c, false, true, false))
-                milp.newRow({{-1, v1}, {1, v2}}, '>', -2 * Period * !isChannelTransparent(c));
+                newPathRow(milp, Vars, {{-1, p1}, {1, p2}}, '>', -2 * Period * !isChannelTransparent(c));
             else
-                milp.newRow ({{-1,v1}, {1,v2}, {2 * Period, R}}, '>', 0);
+                newPathRow(milp, Vars, {{-1, p1}, {1, p2}}, '>', 0, {{2 * Period, R}});
         }
 
         // v2 >= Buffer Delay
-        if (BufferDelay > 0) milp.newRow( {{1,v2}}, '>', BufferDelay);
+        if (BufferDelay > 0) newPathRow(milp, Vars, {{1, p2}}, '>', BufferDelay);
     }
 
     // Create the constraints to propagate the delays of the blocks
-    ForAllBlocks(b) {
+    for (blockID b: G.blockList) {
         double d = getBlockDelay(b);
 
         // First: combinational blocks
         if (getLatency(b) == 0) {
-            ForAllOutputPorts(b, out_p) {
-                int v_out = Vars.time_path[out_p];
-                ForAllInputPorts(b, in_p) {
-                    int v_in = Vars.time_path[in_p];
+            for (portID out_p: G.outputs(b)) {
+                for (portID in_p: G.inputs(b)) {
                     // Add constraint v_out >= d_in + d + d_out + v_in;
                     double D = getCombinationalDelay(in_p, out_p);
                     if (D + BufferDelay > Period) {
                         setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                         return false;
                     }
-                    milp.newRow( {{1, v_out}, {-1,v_in}}, '>', D);
+                    newPathRow(milp, Vars, {{1, out_p}, {-1, in_p}}, '>', D);
                 }
             }
         } else {
@@ -772,28 +1810,25 @@ bool DFnetlist_Impl::createPathConstraints(Milp_Model& milp, milpVarsEB& Vars, d
                 return false;
             }
 
-            ForAllOutputPorts(b, out_p) {
+            for (portID out_p: G.outputs(b)) {
                 double d_out = getPortDelay(out_p);
-                int v_out = Vars.time_path[out_p];
-
                 if (d_out > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_out = d_out;
-                milp.newRow( {{1, v_out}}, '=', d_out);
+                newPathRow(milp, Vars, {{1, out_p}}, '=', d_out);
             }
 
-            ForAllInputPorts(b, in_p) {
+            for (portID in_p: G.inputs(b)) {
 
                 double d_in = getPortDelay(in_p);
-                int v_in = Vars.time_path[in_p];
                 if (d_in + BufferDelay > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_in + d_in <= Period
-                if (hasPeriod) milp.newRow( {{1, v_in}}, '<', Period - d_in);
+                if (hasPeriod) newPathRow(milp, Vars, {{1, in_p}}, '<', Period - d_in, {}, 1);
             }
         }
     }
@@ -807,32 +1842,33 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
     // Create the variables and constraints for all channels
     bool hasPeriod = Period > 0;
     if (not hasPeriod) Period = INFINITY;
+    const GraphCSR& G = getGraph();
 
     //////////////////////
     /** CHANNELS IN MG **/
     //////////////////////
 
     //cout << "   path constraints for channels in MG" << endl;
-    for (channelID c: MG_disjoint[mg].getChannels()) {
+    for (channelID c: MG_disjoint_cover[mg].channels) {
         // Lana 02.05.20. paths from/to memory do not need buffers
         if (getBlockType(getDstBlock(c)) == LSQ || getBlockType(getSrcBlock(c)) == LSQ
          || getBlockType(getDstBlock(c)) == MC || getBlockType(getSrcBlock(c)) == MC )
             continue;
-        int v1 =  Vars.time_path[getSrcPort(c)];
-        int v2 =  Vars.time_path[getDstPort(c)];
+        portID p1 = getSrcPort(c);
+        portID p2 = getDstPort(c);
         int R = Vars.buffer_flop[c];
 
         if (hasPeriod) {
             // v1, v2 <= Period
-            milp.newRow( {{1,v1}}, '<', Period);
-            milp.newRow( {{1,v2}}, '<', Period);
+            newPathRow(milp, Vars, {{1, p1}}, '<', Period, {}, 1);
+            newPathRow(milp, Vars, {{1, p2}}, '<', Period, {}, 1);
 
             // v2 >= v1 - 2*period*R
-            milp.newRow ( {{-1,v1}, {1,v2}, {2*Period, R}}, '>', 0);
+            newPathRow(milp, Vars, {{-1, p1}, {1, p2}}, '>', 0, {{2 * Period, R}});
         }
 
         // v2 >= Buffer Delay
-        if (BufferDelay > 0) milp.newRow( {{1,v2}}, '>', BufferDelay);
+        if (BufferDelay > 0) newPathRow(milp, Vars, {{1, p2}}, '>', BufferDelay);
     }
 
     //////////////////////////////
@@ -840,26 +1876,25 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
     //////////////////////////////
 
     //cout << "   path constraints for channels in MG borders" << endl;
-    for (channelID c: channels_in_borders) {
-        if (!MG_disjoint[mg].hasBlock(getSrcBlock(c)) && !MG_disjoint[mg].hasBlock(getDstBlock(c))) continue;
+    for (channelID c: MG_disjoint_cover[mg].borderChannels) {
 
-        int v1 = Vars.time_path[getSrcPort(c)];
-        int v2 = Vars.time_path[getDstPort(c)];
+        portID p1 = getSrcPort(c);
+        portID p2 = getDstPort(c);
         int R = !isChannelTransparent(c);
 
         assert(R == 1);
 
         if (hasPeriod) {
             // v1, v2 <= Period
-            milp.newRow( {{1,v1}}, '<', Period);
-            milp.newRow( {{1,v2}}, '<', Period);
+            newPathRow(milp, Vars, {{1, p1}}, '<', Period, {}, 1);
+            newPathRow(milp, Vars, {{1, p2}}, '<', Period, {}, 1);
 
             // v2 >= v1 - 2*period*R
-            milp.newRow ( {{-1,v1}, {1,v2}}, '>', -2 * Period * R);
+            newPathRow(milp, Vars, {{-1, p1}, {1, p2}}, '>', -2 * Period * R);
         }
 
         // v2 >= Buffer Delay
-        if (BufferDelay > 0) milp.newRow( {{1,v2}}, '>', BufferDelay);
+        if (BufferDelay > 0) newPathRow(milp, Vars, {{1, p2}}, '>', BufferDelay);
     }
 
     ////////////////////
@@ -868,23 +1903,19 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
 
     //cout << "   path constraints for blocks in MG" << endl;
     // Create the constraints to propagate the delays of the blocks
-    for (blockID b: MG_disjoint[mg].getBlocks()) {
+    for (blockID b: MG_disjoint_cover[mg].blocks) {
         double d = getBlockDelay(b);
 
         // First: combinational blocks
         if (getLatency(b) == 0) {
-            ForAllOutputPorts(b, out_p) {
-                if (!MG_disjoint[mg].hasChannel(getConnectedChannel(out_p)))
+            for (portID out_p: G.outputs(b)) {
+                if (!MG_disjoint_cover[mg].hasChannel.contains(G.portChannel[out_p]))
                     continue;
 
-                int v_out = Vars.time_path[out_p];
-
-                ForAllInputPorts(b, in_p) {
-                    if (!MG_disjoint[mg].hasChannel(getConnectedChannel(in_p)))
+                for (portID in_p: G.inputs(b)) {
+                    if (!MG_disjoint_cover[mg].hasChannel.contains(G.portChannel[in_p]))
                         continue;
 
-                    int v_in = Vars.time_path[in_p];
-
                     // Add constraint v_out >= d_in + d + d_out + v_in;
                     double D = getCombinationalDelay(in_p, out_p);
                     if (D + BufferDelay > Period) {
@@ -892,7 +1923,7 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
                         return false;
                     }
 
-                    milp.newRow( {{1, v_out}, {-1,v_in}}, '>', D);
+                    newPathRow(milp, Vars, {{1, out_p}, {-1, in_p}}, '>', D);
                 }
             }
         } else {
@@ -902,32 +1933,30 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
                 return false;
             }
 
-            ForAllOutputPorts(b, out_p) {
-                if (!MG_disjoint[mg].hasChannel(getConnectedChannel(out_p)))
+            for (portID out_p: G.outputs(b)) {
+                if (!MG_disjoint_cover[mg].hasChannel.contains(G.portChannel[out_p]))
                     continue;
 
                 double d_out = getPortDelay(out_p);
-                int v_out = Vars.time_path[out_p];
                 if (d_out > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_out = d_out;
-                milp.newRow( {{1, v_out}}, '=', d_out);
+                newPathRow(milp, Vars, {{1, out_p}}, '=', d_out);
             }
 
-            ForAllInputPorts(b, in_p) {
-                if (!MG_disjoint[mg].hasChannel(getConnectedChannel(in_p)))
+            for (portID in_p: G.inputs(b)) {
+                if (!MG_disjoint_cover[mg].hasChannel.contains(G.portChannel[in_p]))
                     continue;
 
                 double d_in = getPortDelay(in_p);
-                int v_in = Vars.time_path[in_p];
                 if (d_in + BufferDelay > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_in + d_in <= Period
-                if (hasPeriod) milp.newRow( {{1, v_in}}, '<', Period - d_in);
+                if (hasPeriod) newPathRow(milp, Vars, {{1, in_p}}, '<', Period - d_in, {}, 1);
             }
         }
     }
@@ -936,27 +1965,23 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
     /// BLOCKS IN MG BORDERS ///
     ////////////////////////////
     //cout << "   path constraints for blocks in MG border" << endl;
-    for (blockID b: blocks_in_borders) {
+    for (blockID b: MG_disjoint_cover[mg].borderBlocks) {
         double d = getBlockDelay(b);
 
         // First: combinational blocks
         if (getLatency(b) == 0) {
-            ForAllOutputPorts(b, out_p) {
-                if (!MG_disjoint[mg].hasBlock(getDstBlock(getConnectedChannel(out_p)))) continue;
-
-                int v_out = Vars.time_path[out_p];
-
-                ForAllInputPorts(b, in_p) {
-                    if (!MG_disjoint[mg].hasBlock(getSrcBlock(getConnectedChannel(in_p)))) continue;
+            for (portID out_p: G.outputs(b)) {
+                if (!MG_disjoint_cover[mg].hasBlock.contains(G.channelDstBlock[G.portChannel[out_p]])) continue;
 
-                    int v_in = Vars.time_path[in_p];
+                for (portID in_p: G.inputs(b)) {
+                    if (!MG_disjoint_cover[mg].hasBlock.contains(G.channelSrcBlock[G.portChannel[in_p]])) continue;
 
                     double D = getCombinationalDelay(in_p, out_p);
                     if (D + BufferDelay > Period) {
                         setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                         return false;
                     }
-                    milp.newRow( {{1, v_out}, {-1,v_in}}, '>', D);
+                    newPathRow(milp, Vars, {{1, out_p}, {-1, in_p}}, '>', D);
                 }
             }
         } else {
@@ -966,29 +1991,27 @@ bool DFnetlist_Impl::createPathConstraints_sc(Milp_Model &milp, milpVarsEB &Vars
                 return false;
             }
 
-            ForAllOutputPorts(b, out_p) {
-                if (!MG_disjoint[mg].hasBlock(getDstBlock(getConnectedChannel(out_p)))) continue;
+            for (portID out_p: G.outputs(b)) {
+                if (!MG_disjoint_cover[mg].hasBlock.contains(G.channelDstBlock[G.portChannel[out_p]])) continue;
 
                 double d_out = getPortDelay(out_p);
-                int v_out = Vars.time_path[out_p];
                 if (d_out > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_out = d_out;
-                milp.newRow( {{1, v_out}}, '=', d_out);
+                newPathRow(milp, Vars, {{1, out_p}}, '=', d_out);
             }
 
-            ForAllInputPorts(b, in_p) {
-                if (!MG_disjoint[mg].hasBlock(getSrcBlock(getConnectedChannel(in_p)))) continue;
+            for (portID in_p: G.inputs(b)) {
+                if (!MG_disjoint_cover[mg].hasBlock.contains(G.channelSrcBlock[G.portChannel[in_p]])) continue;
 
                 double d_in = getPortDelay(in_p);
-                int v_in = Vars.time_path[in_p];
                 if (d_in + BufferDelay > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
-                if (hasPeriod) milp.newRow( {{1, v_in}}, '<', Period - d_in);
+                if (hasPeriod) newPathRow(milp, Vars, {{1, in_p}}, '<', Period - d_in, {}, 1);
             }
         }
     }
@@ -1000,50 +2023,49 @@ bool DFnetlist_Impl::createPathConstraints_remaining(Milp_Model &milp, milpVarsE
 
     bool hasPeriod = Period > 0;
     if (not hasPeriod) Period = INFINITY;
+    const GraphCSR& G = getGraph();
 
-    ForAllChannels(c) {
+    for (channelID c: G.channelList) {
         // Lana 02.05.20. paths from/to memory do not need buffers
-        if (getBlockType(getDstBlock(c)) == LSQ || getBlockType(getSrcBlock(c)) == LSQ
-         || getBlockType(getDstBlock(c)) == MC || getBlockType(getSrcBlock(c)) == MC )
+        if (getBlockType(G.channelDstBlock[c]) == LSQ || getBlockType(G.channelSrcBlock[c]) == LSQ
+         || getBlockType(G.channelDstBlock[c]) == MC || getBlockType(G.channelSrcBlock[c]) == MC )
             continue;
 
-        int v1 =  Vars.time_path[getSrcPort(c)];
-        int v2 =  Vars.time_path[getDstPort(c)];
+        portID p1 = G.channelSrc[c];
+        portID p2 = G.channelDst[c];
         int R = Vars.buffer_flop[c];
 
         if (hasPeriod) {
             // v1, v2 <= Period
-            milp.newRow( {{1,v1}}, '<', Period);
-            milp.newRow( {{1,v2}}, '<', Period);
+            newPathRow(milp, Vars, {{1, p1}}, '<', Period, {}, 1);
+            newPathRow(milp, Vars, {{1, p2}}, '<', Period, {}, 1);
 
             // v2 >= v1 - 2*period*R
             if (channelIsCovered(c, true, true, false))
-                milp.newRow({{-1, v1}, {1, v2}}, '>', -2 * Period * !isChannelTransparent(c));
+                newPathRow(milp, Vars, {{-1, p1}, {1, p2}}, '>', -2 * Period * !isChannelTransparent(c));
             else
-                milp.newRow ( {{-1,v1}, {1,v2}, {2*Period, R}}, '>', 0);
+                newPathRow(milp, Vars, {{-1, p1}, {1, p2}}, '>', 0, {{2 * Period, R}});
         }
 
         // v2 >= Buffer Delay
-        if (BufferDelay > 0) milp.newRow( {{1,v2}}, '>', BufferDelay);
+        if (BufferDelay > 0) newPathRow(milp, Vars, {{1, p2}}, '>', BufferDelay);
     }
 
     // Create the constraints to propagate the delays of the blocks
-    ForAllBlocks(b) {
+    for (blockID b: G.blockList) {
         double d = getBlockDelay(b);
 
         // First: combinational blocks
         if (getLatency(b) == 0) {
-            ForAllOutputPorts(b, out_p) {
-                int v_out = Vars.time_path[out_p];
-                ForAllInputPorts(b, in_p) {
-                    int v_in = Vars.time_path[in_p];
+            for (portID out_p: G.outputs(b)) {
+                for (portID in_p: G.inputs(b)) {
                     // Add constraint v_out >= d_in + d + d_out + v_in;
                     double D = getCombinationalDelay(in_p, out_p);
                     if (D + BufferDelay > Period) {
                         setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                         return false;
                     }
-                    milp.newRow( {{1, v_out}, {-1,v_in}}, '>', D);
+                    newPathRow(milp, Vars, {{1, out_p}, {-1, in_p}}, '>', D);
                 }
             }
         } else {
@@ -1053,26 +2075,24 @@ bool DFnetlist_Impl::createPathConstraints_remaining(Milp_Model &milp, milpVarsE
                 return false;
             }
 
-            ForAllOutputPorts(b, out_p) {
+            for (portID out_p: G.outputs(b)) {
                 double d_out = getPortDelay(out_p);
-                int v_out = Vars.time_path[out_p];
                 if (d_out > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_out = d_out;
-                milp.newRow( {{1, v_out}}, '=', d_out);
+                newPathRow(milp, Vars, {{1, out_p}}, '=', d_out);
             }
 
-            ForAllInputPorts(b, in_p) {
+            for (portID in_p: G.inputs(b)) {
                 double d_in = getPortDelay(in_p);
-                int v_in = Vars.time_path[in_p];
                 if (d_in + BufferDelay > Period) {
                     setError("Block " + getBlockName(b) + ": path constraints cannot be satisfied.");
                     return false;
                 }
                 // Add constraint: v_in + d_in <= Period
-                if (hasPeriod) milp.newRow( {{1, v_in}}, '<', Period - d_in);
+                if (hasPeriod) newPathRow(milp, Vars, {{1, in_p}}, '<', Period - d_in, {}, 1);
             }
         }
     }
@@ -1140,7 +2160,7 @@ bool DFnetlist_Impl::createElasticityConstraints_sc(Milp_Model &milp, milpVarsEB
     //////////////////////
     // Create the variables and constraints for all channels
     //cout << "   elasticity constraints for channels in MG" << endl;
-    for (channelID c: MG_disjoint[mg].getChannels()) {
+    for (channelID c: MG_disjoint_cover[mg].channels) {
         // Lana 02.05.20. paths from/to memory do not need buffers
         if (getBlockType(getDstBlock(c)) == LSQ || getBlockType(getSrcBlock(c)) == LSQ
          || getBlockType(getDstBlock(c)) == MC || getBlockType(getSrcBlock(c)) == MC )
@@ -1192,8 +2212,7 @@ bool DFnetlist_Impl::createElasticityConstraints_sc(Milp_Model &milp, milpVarsEB
     /// CHANNELS IN MG BORDER ///
     /////////////////////////////
     //cout << "   elasticity constraints for channels in MG border" << endl;
-    for (channelID c: channels_in_borders) {
-        if (!MG_disjoint[mg].hasBlock(getSrcBlock(c)) && !MG_disjoint[mg].hasBlock(getDstBlock(c))) continue;
+    for (channelID c: MG_disjoint_cover[mg].borderChannels) {
 
         int v1 = Vars.time_elastic[getSrcPort(c)];
         int v2 = Vars.time_elastic[getDstPort(c)];
@@ -1206,14 +2225,14 @@ bool DFnetlist_Impl::createElasticityConstraints_sc(Milp_Model &milp, milpVarsEB
     ////////////////////
     // Create the constraints to propagate the delays of the blocks
     //cout << "   elasticity constraints for blocks in MG" << endl;
-    for (blockID b: MG_disjoint[mg].getBlocks()) {
+    for (blockID b: MG_disjoint_cover[mg].blocks) {
         ForAllOutputPorts(b, out_p) {
-            if (!MG_disjoint[mg].hasChannel(getConnectedChannel(out_p)))
+            if (!MG_disjoint_cover[mg].hasChannel.contains(getConnectedChannel(out_p)))
                 continue;
 
             int v_out = Vars.time_elastic[out_p];
             ForAllInputPorts(b, in_p) {
-                if (!MG_disjoint[mg].hasChannel(getConnectedChannel(in_p)))
+                if (!MG_disjoint_cover[mg].hasChannel.contains(getConnectedChannel(in_p)))
                     continue;
 
                 int v_in = Vars.time_elastic[in_p];
@@ -1227,14 +2246,14 @@ bool DFnetlist_Impl::createElasticityConstraints_sc(Milp_Model &milp, milpVarsEB
     /// BLOCKS IN MG BORDER ///
     ///////////////////////////
     //cout << "   elasticity constraints for blocks in MG border" << endl;
-    for (blockID b: blocks_in_borders) {
+    for (blockID b: MG_disjoint_cover[mg].borderBlocks) {
         ForAllOutputPorts(b, out_p) {
-            if (!MG_disjoint[mg].hasBlock(getDstBlock(getConnectedChannel(out_p)))) continue;
+            if (!MG_disjoint_cover[mg].hasBlock.contains(getDstBlock(getConnectedChannel(out_p)))) continue;
 
             int v_out = Vars.time_elastic[out_p];
 
             ForAllInputPorts(b, in_p) {
-                if (!MG_disjoint[mg].hasBlock(getSrcBlock(getConnectedChannel(in_p)))) continue;
+                if (!MG_disjoint_cover[mg].hasBlock.contains(getSrcBlock(getConnectedChannel(in_p)))) continue;
 
                 int v_in = Vars.time_elastic[in_p];
 
@@ -1431,6 +2450,7 @@ blockID DFnetlist_Impl::insertBuffer(channelID c, int slots, bool transparent)
     bool back = isBackEdge(c);
     blockID b_src = getSrcBlock(c);
     bbID bb_src = getBasicBlock(b_src);
+    unsigned char coverage = channels[c].coverage;
 
     removeChannel(c);
 
@@ -1447,9 +2467,12 @@ blockID DFnetlist_Impl::insertBuffer(channelID c, int slots, bool transparent)
     portID out_buf = createPort(eb, false, "out1", width);
     //cout << "> Buffer created with ports "
     //     << getPortName(in_buf) << " and " << getPortName(out_buf) << endl;
-    createChannel(src, in_buf);
+    channelID in_c = createChannel(src, in_buf);
     channelID new_c = createChannel(out_buf, dst);
     setBackEdge(new_c, back);
+
+    // The buffer and both channels inherit the coverage of the channel
+    blocks[eb].coverage = channels[in_c].coverage = channels[new_c].coverage = coverage;
     return eb;
 }
 
@@ -1459,14 +2482,19 @@ channelID DFnetlist_Impl::removeBuffer(blockID buf)
 
     cout << "SHAB: removing buffer " << getBlockName(buf) << endl;
     // Get the ports at the other side of the channels
-    portID in_port = getSrcPort(getConnectedChannel(getInPort(buf)));
-    portID out_port = getDstPort(getConnectedChannel(getOutPort(buf)));
+    channelID in_c = getConnectedChannel(getInPort(buf));
+    channelID out_c = getConnectedChannel(getOutPort(buf));
+    portID in_port = getSrcPort(in_c);
+    portID out_port = getDstPort(out_c);
+    unsigned char coverage = channels[in_c].coverage | channels[out_c].coverage;
 
     // remove the buffer
     removeBlock(buf);
 
-    // reconnect the ports
-    return createChannel(in_port, out_port);
+    // reconnect the ports (the channel keeps the coverage of both channels)
+    channelID c = createChannel(in_port, out_port);
+    channels[c].coverage = coverage;
+    return c;
 }
 
 void DFnetlist_Impl::makeNonTransparentBuffers()
@@ -1564,9 +2592,9 @@ void DFnetlist_Impl::addBorderBuffers(){
             setChannelBufferSize(c, 1);
 
             // so we won't consider it for the next milp
-            channels_in_borders.insert(c);
-            if (blockIsInMGs(src)) blocks_in_borders.insert(dst);
-            else if (blockIsInMGs(dst)) blocks_in_borders.insert(src);
+            coverChannel(c, COVER_BORDER);
+            if (blockIsInMGs(src)) coverBlock(dst, COVER_BORDER);
+            else if (blockIsInMGs(dst)) coverBlock(src, COVER_BORDER);
 
             printChannelInfo(c, 1, 0);
         }
@@ -1599,7 +2627,7 @@ void DFnetlist_Impl::findMCLSQ_load_channels() {
         assert(!(src_lsq && src_load) && !(dst_lsq && dst_load));
         if ((src_lsq && dst_load) || (src_load && dst_lsq)) {
            // cout << "\tis from/to load to/from MC LSQ" << endl;
-            channels_in_MC_LSQ.insert(c);
+            coverChannel(c, COVER_MC_LSQ);
         }
     }
 }
@@ -1725,3 +2753,169 @@ void DFnetlist_Impl::writeRetimingDiffs(const Milp_Model& milp, const milpVarsEB
         //cout << ", Retiming bub = " << milp[ret_bub] << endl;
     }
 }
+
+bool DFnetlist_Impl::setMilpStart(const string& filename)
+{
+    DFnetlist_Impl prev(filename);
+    if (prev.hasError()) {
+        setError(prev.getError());
+        return false;
+    }
+
+    // The buffers of the netlist are annotated in the channels
+    prev.hideElasticBuffers();
+
+    milpStart.clear();
+    for (channelID c: prev.allChannels) {
+        int slots = prev.getChannelBufferSize(c);
+        if (slots > 0) milpStart[prev.getChannelName(c)] = {slots, prev.isChannelTransparent(c)};
+    }
+    hasMilpStart = true;
+    cout << "MIP start: " << milpStart.size() << " buffers read from " << filename << endl;
+    return true;
+}
+
+void DFnetlist_Impl::setMilpStartEB(Milp_Model& milp, const milpVarsEB& vars)
+{
+    ForAllChannels(c) {
+        if (c >= vars.buffer_flop.size() or vars.buffer_flop[c] < 0) continue;
+
+        auto it = milpStart.find(getChannelName(c));
+        int slots = it == milpStart.end() ? 0 : it->second.first;
+        bool flop = slots > 0 and not it->second.second;
+
+        milp.setStartValue(vars.buffer_flop[c], flop);
+        if (c < vars.buffer_slots.size() and vars.buffer_slots[c] >= 0) {
+            milp.setStartValue(vars.buffer_slots[c], slots);
+        }
+        if (c < vars.has_buffer.size() and vars.has_buffer[c] >= 0) {
+            milp.setStartValue(vars.has_buffer[c], slots > 0);
+        }
+    }
+}
+
+bool DFnetlist_Impl::setPreviousPlacement(const string& filename, const string& filename_bb)
+{
+    DFnetlist_Impl prev(filename, filename_bb);
+    if (prev.hasError()) {
+        setError(prev.getError());
+        return false;
+    }
+
+    // The buffers of the netlist are annotated in the channels
+    prev.hideElasticBuffers();
+    prev.computeChannelFrequencies();
+
+    // CFDFCs of the previous run (in the order of extraction)
+    map<int, subNetlistBB> cfdfcs;
+    double total_freq = 0;
+    for (bbArcID arc = 0; arc < prev.BBG.numArcs(); arc++) {
+        total_freq += prev.BBG.getFrequencyArc(arc);
+        for (int number: prev.BBG.getMGnumbers(arc)) {
+            cfdfcs[number].insertBasicBlockArc(arc);
+            cfdfcs[number].insertBasicBlock(prev.BBG.getSrcBB(arc));
+            cfdfcs[number].insertBasicBlock(prev.BBG.getDstBB(arc));
+        }
+    }
+
+    // The frequency of each CFDFC is the minimum residual frequency of
+    // its arcs, as in the extraction
+    map<bbArcID, double> freq;
+    for (bbArcID arc = 0; arc < prev.BBG.numArcs(); arc++) {
+        freq[arc] = total_freq > 0 ? prev.BBG.getFrequencyArc(arc) : 1.0;
+    }
+    for (auto& it: cfdfcs) {
+        double min_freq = numeric_limits<double>::infinity();
+        for (bbArcID arc: it.second.getBasicBlockArcs()) min_freq = min(min_freq, freq[arc]);
+        for (bbArcID arc: it.second.getBasicBlockArcs()) freq[arc] -= min_freq;
+        prev.CFDFC.push_back(it.second);
+        prev.CFDFCfreq.push_back(min_freq);
+        prev.MG.push_back(prev.getMGfromCFDFC(it.second));
+        prev.MGfreq.push_back(min_freq);
+    }
+    prev.calculateDisjointCFDFCs();
+    prev.makeMGsfromCFDFCs();
+
+    prevPlacement.clear();
+    for (int mg = 0; mg < prev.MG_disjoint.size(); mg++) {
+        auto& buffers = prevPlacement[prev.disjointSetSignature(mg)];
+        for (channelID c: prev.MG_disjoint[mg].getChannels()) {
+            int slots = prev.getChannelBufferSize(c);
+            if (slots > 0) buffers[prev.getChannelName(c)] = {slots, prev.isChannelTransparent(c)};
+        }
+    }
+    hasPrevPlacement = true;
+    cout << "Previous placement: " << prevPlacement.size() << " disjoint sets of CFDFCs read from "
+         << filename << endl;
+    return true;
+}
+
+string DFnetlist_Impl::disjointSetSignature(int mg)
+{
+    vector<string> lines;
+
+    for (int sub_mg: components[mg]) {
+        vector<pair<bbID,bbID>> arcs;
+        for (bbArcID arc: CFDFC[sub_mg].getBasicBlockArcs()) {
+            arcs.push_back({BBG.getSrcBB(arc), BBG.getDstBB(arc)});
+        }
+        sort(arcs.begin(), arcs.end());
+        ostringstream s;
+        s << "cfdfc " << CFDFCfreq[sub_mg];
+        for (const auto& arc: arcs) s << " " << arc.first << "->" << arc.second;
+        lines.push_back(s.str());
+    }
+
+    auto blockSignature = [&](blockID b) {
+        ostringstream s;
+        s << getBlockName(b) << " " << getBlockType(b) << " " << getOperation(b) << " "
+          << getBasicBlock(b) << " " << getLatency(b) << " " << getInitiationInterval(b) << " "
+          << getBlockDelay(b);
+        ForAllPorts(b, p) s << " " << getPortName(p, false) << ":" << getPortWidth(p) << ":" << getPortDelay(p);
+        return s.str();
+    };
+
+    const subNetlist& snl = MG_disjoint[mg];
+    for (blockID b: snl.getBlocks()) {
+        lines.push_back("block " + blockSignature(b));
+
+        // Blocks at the borders of the set
+        ForAllPorts(b, p) {
+            channelID c = getConnectedChannel(p);
+            if (c < 0 or snl.hasChannel(c)) continue;
+            blockID other = isInputPort(p) ? getSrcBlock(c) : getDstBlock(c);
+            if (snl.hasBlock(other)) continue;
+            lines.push_back("border " + getChannelName(c) + " " + blockSignature(other));
+        }
+    }
+
+    for (channelID c: snl.getChannels()) {
+        ostringstream s;
+        s << "channel " << getChannelName(c) << " " << getChannelFrequency(c);
+        lines.push_back(s.str());
+    }
+
+    sort(lines.begin(), lines.end());
+    string signature;
+    for (const string& line: lines) signature += line + "\n";
+    return signature;
+}
+
+bool DFnetlist_Impl::carryOverBuffers(int mg)
+{
+    auto it = prevPlacement.find(disjointSetSignature(mg));
+    if (it == prevPlacement.end()) return false;
+
+    int num_buffers = 0;
+    for (channelID c: MG_disjoint[mg].getChannels()) {
+        if (channelIsCovered(c, false, true, true)) continue;
+        auto buf = it->second.find(getChannelName(c));
+        if (buf == it->second.end()) continue;
+        setChannelTransparency(c, buf->second.second);
+        setChannelBufferSize(c, buf->second.first);
+        printChannelInfo(c, buf->second.first, buf->second.second);
+        num_buffers++;
+    }
+    cout << "MG " << mg << " unchanged: " << num_buffers << " buffers carried over from the previous placement" << endl;
+    return true;
+}
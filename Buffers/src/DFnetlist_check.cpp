@@ -4,7 +4,7 @@
 using namespace Dataflow;
 using namespace std;
 
-bool DFnetlist_Impl::checkSamePortWidth(const setPorts& ports)
+bool DFnetlist_Impl::checkSamePortWidth(const blockPorts& ports)
 {
     if (ports.size() <= 1) return true;
     int width = getPortWidth(*(ports.begin()));
@@ -141,7 +141,9 @@ bool DFnetlist_Impl::check()
 bool DFnetlist_Impl::checkPortsConnected(blockID b)
 {
     assert (b == invalidDataflowID or validBlock(b));
-    const setPorts& P = (b == invalidDataflowID) ? allPorts : getPorts(b, ALL_PORTS);
+    vecPorts P;
+    if (b == invalidDataflowID) P.assign(allPorts.begin(), allPorts.end());
+    else P.assign(getPorts(b, ALL_PORTS).begin(), getPorts(b, ALL_PORTS).end());
     vecPorts removed;
 
     for (auto p: P) {
@@ -247,12 +249,15 @@ bool DFnetlist_Impl::checkConstant(blockID b)
     //    return false;
     //}
 
-    // Normalize the value with sign extension
+    // Normalize the value with sign extension. The value is first truncated
+    // to the width, so that normalizing it again (e.g., after reading a
+    // netlist in binary format) does not change it.
     int width = getPortWidth(getOutPort(b));
-    int sign_location = 1 << (width - 1);
-    longValueType v = getValue(b);
-    if ((v & sign_location) != 0) v += ((longValueType) -1) << width;
-    setValue(b, v);
+    if (width <= 0 or width >= 64) return true;
+    unsigned long long mask = (1ULL << width) - 1;
+    unsigned long long v = (unsigned long long) getValue(b) & mask;
+    if ((v >> (width - 1)) != 0) v |= ~mask;
+    setValue(b, (longValueType) v);
     return true;
 }
 
@@ -402,7 +407,7 @@ bool DFnetlist_Impl::checkDemux(blockID b)
         }
     }
 
-    for (auto& pair: blocks[b].demuxPairs) {
+    for (auto& pair: getBlockExtra(b).demuxPairs) {
         portID p1 = pair.first;
         portID p2 = pair.second;
         if (not isControlPort(p1)) swap(p1, p2);
@@ -0,0 +1,206 @@
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stack>
+#include "DFnetlist.h"
+
+using namespace Dataflow;
+using namespace std;
+
+/*
+ * This file contains the construction of the CSR snapshot of the netlist
+ * (GraphCSR). The blocks, ports and channels are stored in vectors with
+ * free lists, but the ports of the blocks are std::sets, which are slow to
+ * traverse. The snapshot stores the same
+ * information in contiguous arrays. It is rebuilt lazily after every
+ * change of the topology, so it can be used by any traversal that does
+ * not modify the netlist.
+ */
+
+void DFnetlist_Impl::buildGraph()
+{
+    GraphCSR& G = graphCSR;
+    int nb = blocks.size();
+    int np = ports.size();
+    int nc = channels.size();
+
+    G.blockList.assign(allBlocks.begin(), allBlocks.end());
+    G.channelList.assign(allChannels.begin(), allChannels.end());
+
+    G.portBegin.assign(nb + 1, 0);
+    G.inputEnd.assign(nb, 0);
+    G.succBegin.assign(nb + 1, 0);
+    G.predBegin.assign(nb + 1, 0);
+    G.blockPorts.clear();
+    G.blockPorts.reserve(nPorts);
+    G.succChannel.clear();
+    G.succChannel.reserve(nChannels);
+    G.predChannel.clear();
+    G.predChannel.reserve(nChannels);
+
+    for (blockID b = 0; b < nb; ++b) {
+        G.portBegin[b] = G.blockPorts.size();
+        G.succBegin[b] = G.succChannel.size();
+        G.predBegin[b] = G.predChannel.size();
+        if (validBlock(b)) {
+            for (portID p: blocks[b].inPorts) {
+                G.blockPorts.push_back(p);
+                if (validChannel(ports[p].channel)) G.predChannel.push_back(ports[p].channel);
+            }
+            G.inputEnd[b] = G.blockPorts.size();
+            for (portID p: blocks[b].outPorts) {
+                G.blockPorts.push_back(p);
+                if (validChannel(ports[p].channel)) G.succChannel.push_back(ports[p].channel);
+            }
+        } else G.inputEnd[b] = G.blockPorts.size();
+    }
+    G.portBegin[nb] = G.blockPorts.size();
+    G.succBegin[nb] = G.succChannel.size();
+    G.predBegin[nb] = G.predChannel.size();
+
+    G.portBlock.assign(np, invalidDataflowID);
+    G.portChannel.assign(np, invalidDataflowID);
+    for (portID p: allPorts) {
+        G.portBlock[p] = ports[p].block;
+        G.portChannel[p] = ports[p].channel;
+    }
+
+    G.channelSrc.assign(nc, invalidDataflowID);
+    G.channelDst.assign(nc, invalidDataflowID);
+    G.channelSrcBlock.assign(nc, invalidDataflowID);
+    G.channelDstBlock.assign(nc, invalidDataflowID);
+    for (channelID c: allChannels) {
+        G.channelSrc[c] = channels[c].src;
+        G.channelDst[c] = channels[c].dst;
+        G.channelSrcBlock[c] = ports[channels[c].src].block;
+        G.channelDstBlock[c] = ports[channels[c].dst].block;
+    }
+
+    graphValid = true;
+}
+
+void DFnetlist_Impl::benchmarkGraph(int iterations)
+{
+    if (iterations < 1) iterations = 1;
+
+    // Average time (in ms) of a traversal
+    auto measure = [iterations](const function<void()>& f) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) f();
+        chrono::duration<double, milli> t = chrono::steady_clock::now() - start;
+        return t.count() / iterations;
+    };
+
+    auto report = [](const string& name, double t_sets, double t_csr) {
+        cout << "  " << left << setw(20) << name << right << fixed << setprecision(3)
+             << setw(12) << t_sets << setw(12) << t_csr
+             << setw(9) << setprecision(1) << (t_csr > 0 ? t_sets / t_csr : 0) << "x" << endl;
+    };
+
+    ios::fmtflags flags = cout.flags();
+    streamsize precision = cout.precision();
+
+    cout << "Netlist " << getName() << ": " << numBlocks() << " blocks, "
+         << numPorts() << " ports, " << numChannels() << " channels" << endl;
+
+    double t_build = measure([this]() { buildGraph(); });
+    const GraphCSR& G = getGraph();
+    cout << "  Snapshot built in " << fixed << setprecision(3) << t_build << " ms" << endl;
+    cout << "  " << left << setw(20) << "Traversal" << right << setw(12) << "sets (ms)"
+         << setw(12) << "CSR (ms)" << setw(10) << "speedup" << endl;
+
+    volatile long checksum = 0;
+
+    // Ports of all blocks and their channels
+    double t_sets = measure([this, &checksum]() {
+        long sum = 0;
+        ForAllBlocks(b) {
+            ForAllPorts(b, p) sum += ports[p].channel;
+        }
+        checksum += sum;
+    });
+    double t_csr = measure([&G, &checksum]() {
+        long sum = 0;
+        for (blockID b: G.blockList) {
+            for (portID p: G.ports(b)) sum += G.portChannel[p];
+        }
+        checksum += sum;
+    });
+    report("port sweep", t_sets, t_csr);
+
+    // Successors of all blocks (block -> port -> channel -> port -> block)
+    t_sets = measure([this, &checksum]() {
+        long sum = 0;
+        ForAllBlocks(b) {
+            ForAllOutputPorts(b, p) {
+                channelID c = ports[p].channel;
+                if (validChannel(c)) sum += ports[channels[c].dst].block;
+            }
+        }
+        checksum += sum;
+    });
+    t_csr = measure([&G, &checksum]() {
+        long sum = 0;
+        for (blockID b: G.blockList) {
+            for (channelID c: G.successors(b)) sum += G.channelDstBlock[c];
+        }
+        checksum += sum;
+    });
+    report("successor sweep", t_sets, t_csr);
+
+    // DFS traversals with the sets (as they were implemented before the
+    // snapshot) and with the snapshot. The post-visit orders must be equal.
+    vecBlocks order_sets;
+    auto dfsSets = [this, &order_sets](bool forward) {
+        vector<bool> visited(blocks.size(), false);
+        listBlocks lBlocks;
+        ForAllBlocks(b) {
+            if (getBlockType(b) == FUNC_ENTRY) lBlocks.push_front(b);
+            else lBlocks.push_back(b);
+        }
+        int clock = lBlocks.size();
+        order_sets = vecBlocks(clock);
+        stack<blockID> S, listChildren;
+        auto pushChildren = [&](blockID b) {
+            listChildren.push(invalidDataflowID);
+            for (portID p: getPorts(b, forward ? OUTPUT_PORTS : INPUT_PORTS)) {
+                blockID other_b = getBlockFromPort(getConnectedPort(p));
+                if (not visited[other_b]) listChildren.push(other_b);
+            }
+        };
+        for (blockID b: lBlocks) {
+            if (visited[b]) continue;
+            S.push(b);
+            visited[b] = true;
+            pushChildren(b);
+            while (not S.empty()) {
+                blockID kid = listChildren.top();
+                listChildren.pop();
+                if (kid == invalidDataflowID) {
+                    order_sets[--clock] = S.top();
+                    S.pop();
+                } else if (not visited[kid]) {
+                    S.push(kid);
+                    visited[kid] = true;
+                    pushChildren(kid);
+                }
+            }
+        }
+    };
+
+    for (bool forward: {true, false}) {
+        t_sets = measure([&dfsSets, forward]() { dfsSets(forward); });
+        t_csr = measure([this, forward]() { DFS(forward); });
+        report(forward ? "DFS (forward)" : "DFS (backward)", t_sets, t_csr);
+        if (order_sets != DFSorder) cout << "  Warning: different DFS orders." << endl;
+    }
+
+    t_csr = measure([this]() { computeSCC(); });
+    cout << "  " << left << setw(20) << "SCC" << right << setw(12) << "-"
+         << setw(12) << setprecision(3) << t_csr << endl;
+
+    cout.flags(flags);
+    cout.precision(precision);
+}
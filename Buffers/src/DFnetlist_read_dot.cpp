@@ -1,8 +1,12 @@
+#include <atomic>
 #include <cassert>
 #include <iterator>
 #include <sstream>
+#ifdef USE_GRAPHVIZ
 #include <graphviz/cgraph.h>
+#endif
 #include "DFnetlist.h"
+#include "DotParser.h"
 
 using namespace Dataflow;
 using namespace std;
@@ -168,15 +172,14 @@ string extractMemorySuffix(string& port)
 }
 
 // Reads the ports of a block
-static bool readPorts(DFnetlist_Impl& DF, blockID id, Agnode_t* v, bool input)
+static bool readPorts(DFnetlist_Impl& DF, blockID id, const DotAttrs& v, bool input)
 {
-    char* in_out = (char *) string(input ? "in" : "out").c_str();
-    const char* attr = agget(v, in_out);
+    const char* attr = v.get(input ? "in" : "out");
 
     if (DF.getBlockType(id) == FUNC_EXIT & input == false)
         return true;
 
-    if ((attr = agget(v, in_out)) != nullptr) {
+    if (attr != nullptr) {
         istringstream iss(attr);
         vector<string> tokens {istream_iterator<string>{iss},
                                istream_iterator<string>{}
@@ -202,9 +205,9 @@ static bool readPorts(DFnetlist_Impl& DF, blockID id, Agnode_t* v, bool input)
 }
 
 // Reads the delays of a block
-static bool readDelays(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readDelays(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
-    const char* attr = agget(v, (char *) "delay");
+    const char* attr = v.get("delay");
     if (attr == nullptr) return true;
 
     string block_name = DF.getBlockName(id);
@@ -243,10 +246,10 @@ static bool readDelays(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Reads the latency and initiation interval of a block
-static bool readLatencyII(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readLatencyII(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "latency");
+    const char* attr = v.get("latency");
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != OPERATOR) {
             DF.setError("Block " + block_name + ": latency can only be defined for operators.");
@@ -260,7 +263,7 @@ static bool readLatencyII(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
         DF.setLatency(id, lat);
     }
 
-    attr = agget(v, (char *) "II");
+    attr = v.get("II");
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != OPERATOR) {
             DF.setError("Block " + block_name + ": II can only be defined for operators.");
@@ -278,10 +281,10 @@ static bool readLatencyII(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Reads the execution frequency of a block
-static bool readExecFrequency(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readExecFrequency(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "freq");
+    const char* attr = v.get("freq");
     if (attr != nullptr and strlen(attr) > 0) {
         double freq = getPositiveDouble(attr);
         if (freq < 0) {
@@ -295,8 +298,8 @@ static bool readExecFrequency(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 
-static bool readTrueFrac(DFnetlist_Impl& DF, blockID id, Agnode_t* v) {
-    const char* attr = agget(v, (char *) "trueFrac");
+static bool readTrueFrac(DFnetlist_Impl& DF, blockID id, const DotAttrs& v) {
+    const char* attr = v.get("trueFrac");
     if (attr != nullptr and strlen(attr) > 0) {
         //if (DF.getOperation(id) != "select_op")
             //DF.setError("True/false execution fraction can be specified only for select op.");
@@ -310,10 +313,10 @@ static bool readTrueFrac(DFnetlist_Impl& DF, blockID id, Agnode_t* v) {
 }
 
 // Lana: reads ops of operators
-static bool readOperation(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readOperation(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "op");
+    const char* attr = v.get("op");
 
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != OPERATOR) {
@@ -328,10 +331,10 @@ static bool readOperation(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana: reads function name of function call
-static bool readFuncName(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readFuncName(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "function");
+    const char* attr = v.get("function");
 
     if (DF.getBlockType(id) == OPERATOR && DF.getOperation(id) == "call_op")
         if (attr != nullptr and strlen(attr) > 0) {
@@ -347,10 +350,10 @@ static bool readFuncName(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 
 // Lana: reads basic block id
 // SHAB_note: changed this so all blocks can have bbID tag.
-static bool readBasicBlock(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readBasicBlock(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "bbID");
+    const char* attr = v.get("bbID");
 
 //    if (DF.getBlockType(id) == BRANCH
 //        || (DF.getBlockType(id) == OPERATOR && DF.getOperation(id) == "lsq_load_op")
@@ -374,10 +377,10 @@ static bool readBasicBlock(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 03/07/19 read memory port parameters to connect to MC/LSQ
-static bool readMemPortID(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readMemPortID(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "portId");
+    const char* attr = v.get("portId");
     if (attr != nullptr and strlen(attr) > 0) {
         int t = getPositiveInteger(attr);
         if (t < 0) {
@@ -391,10 +394,10 @@ static bool readMemPortID(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 03/07/19 read memory port parameters to connect to MC/LSQ
-static bool readMemOffset(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readMemOffset(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "offset");
+    const char* attr = v.get("offset");
     if (attr != nullptr and strlen(attr) > 0) {
         int t = getPositiveInteger(attr);
         if (t < 0) {
@@ -408,10 +411,10 @@ static bool readMemOffset(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 03/07/19 read memory port parameters to connect to MC/LSQ
-static bool readMemBBCount(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readMemBBCount(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "bbcount");
+    const char* attr = v.get("bbcount");
     if (attr != nullptr and strlen(attr) > 0) {
         int t = getPositiveInteger(attr);
         if (t < 0) {
@@ -425,10 +428,10 @@ static bool readMemBBCount(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 03/07/19 read memory port parameters to connect to MC/LSQ
-static bool readMemLdCount(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readMemLdCount(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "ldcount");
+    const char* attr = v.get("ldcount");
     if (attr != nullptr and strlen(attr) > 0) {
         int t = getPositiveInteger(attr);
         if (t < 0) {
@@ -442,10 +445,10 @@ static bool readMemLdCount(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 03/07/19 read memory port parameters to connect to MC/LSQ
-static bool readMemStCount(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readMemStCount(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "stcount");
+    const char* attr = v.get("stcount");
     if (attr != nullptr and strlen(attr) > 0) {
         int t = getPositiveInteger(attr);
         if (t < 0) {
@@ -459,10 +462,10 @@ static bool readMemStCount(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 03/07/19 read memory port parameters to connect to MC/LSQ
-static bool readMemName(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readMemName(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "memory");
+    const char* attr = v.get("memory");
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != MC && DF.getBlockType(id) != LSQ) {
             DF.setError("Block " + block_name + ": memory name can only be defined for MC/LSQ.");
@@ -476,13 +479,13 @@ static bool readMemName(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 04/10/19 read LSQ params for json
-static bool readLSQParams(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readLSQParams(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
 
     if (DF.getBlockType(id) == LSQ) {
 
-        const char* attr = agget(v, (char *) "fifoDepth");
+        const char* attr = v.get("fifoDepth");
         if (attr != nullptr and strlen(attr) > 0) {
             int t = getPositiveInteger(attr);
             if (t < 0) {
@@ -493,32 +496,32 @@ static bool readLSQParams(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
              DF.setLSQDepth(id, t);
         }
 
-        attr = agget(v, (char *) "numLoads");
+        attr = v.get("numLoads");
 
         if (attr != nullptr and strlen(attr) > 0) 
             DF.setNumLoads(id, std::string(attr));
 
-        attr = agget(v, (char *) "numStores");
+        attr = v.get("numStores");
 
         if (attr != nullptr and strlen(attr) > 0) 
             DF.setNumStores(id, std::string(attr));
 
-        attr = agget(v, (char *) "loadOffsets");
+        attr = v.get("loadOffsets");
 
         if (attr != nullptr and strlen(attr) > 0) 
             DF.setLoadOffsets(id, std::string(attr));
 
-        attr = agget(v, (char *) "storeOffsets");
+        attr = v.get("storeOffsets");
 
         if (attr != nullptr and strlen(attr) > 0) 
             DF.setStoreOffsets(id, std::string(attr));
 
-        attr = agget(v, (char *) "loadPorts");
+        attr = v.get("loadPorts");
 
         if (attr != nullptr and strlen(attr) > 0) 
             DF.setLoadPorts(id, std::string(attr));
 
-        attr = agget(v, (char *) "storePorts");
+        attr = v.get("storePorts");
 
         if (attr != nullptr and strlen(attr) > 0) 
             DF.setStorePorts(id, std::string(attr));
@@ -528,13 +531,13 @@ static bool readLSQParams(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Lana 04/10/19 read LSQ params for json
-static bool readGetPtrConst(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readGetPtrConst(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
 
     if (DF.getBlockType(id) == OPERATOR) {
 
-        const char* attr = agget(v, (char *) "constants");
+        const char* attr = v.get("constants");
         if (attr != nullptr and strlen(attr) > 0) {
             int t = getPositiveInteger(attr);
             if (t < 0) {
@@ -550,10 +553,10 @@ static bool readGetPtrConst(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
     return true;
 }
 
-static bool readValue(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readValue(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     string block_name = DF.getBlockName(id);
-    const char* attr = agget(v, (char *) "value");
+    const char* attr = v.get("value");
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != CONSTANT) {
             DF.setError("Block " + block_name + ": value can only be defined for constants.");
@@ -581,7 +584,7 @@ static bool readValue(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Reads the attributes of elastic buffers (slots and transparency)
-static bool readBufferAttributes(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
+static bool readBufferAttributes(DFnetlist_Impl& DF, blockID id, const DotAttrs& v)
 {
     if (DF.getBlockType(id) != ELASTIC_BUFFER) return true;
 
@@ -589,7 +592,7 @@ static bool readBufferAttributes(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
     string block_name = DF.getBlockName(id);
     //cout << "setting buffer attributes for " << block_name << endl;
 
-    const char* attr = agget(v, (char *) "slots");
+    const char* attr = v.get("slots");
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != ELASTIC_BUFFER) {
             DF.setError("Block " + block_name + ": slots can only be defined for elastic buffers.");
@@ -605,7 +608,7 @@ static bool readBufferAttributes(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
         DF.setBufferSize(id, slots);
     }
 
-    attr = agget(v, (char *) "transparent");
+    attr = v.get("transparent");
     if (attr != nullptr and strlen(attr) > 0) {
         if (DF.getBlockType(id) != ELASTIC_BUFFER) {
             DF.setError("Block " + block_name + ": transparency can only be defined for elastic buffers.");
@@ -624,10 +627,10 @@ static bool readBufferAttributes(DFnetlist_Impl& DF, blockID id, Agnode_t* v)
 }
 
 // Reads the attributes of elastic buffers (slots and transparency)
-static bool readChannelBufferAttributes(DFnetlist_Impl& DF, channelID c, Agnode_t* v)
+static bool readChannelBufferAttributes(DFnetlist_Impl& DF, channelID c, const DotAttrs& v)
 {
     //cout << "setting channel buffer attributes for " << DF.getChannelName(c) << endl;
-    const char* attr = agget(v, (char *) "slots");
+    const char* attr = v.get("slots");
     int slots = 0;
     if (attr != nullptr and strlen(attr) > 0) {
         slots = getPositiveInteger(attr);
@@ -639,7 +642,7 @@ static bool readChannelBufferAttributes(DFnetlist_Impl& DF, channelID c, Agnode_
     }
     DF.setChannelBufferSize(c, slots);
 
-    attr = agget(v, (char *) "transparent");
+    attr = v.get("transparent");
     bool transparent = slots <= 1;
     if (attr != nullptr and strlen(attr) > 0) {
         string str_attr(attr);
@@ -655,7 +658,33 @@ static bool readChannelBufferAttributes(DFnetlist_Impl& DF, channelID c, Agnode_
     return true;
 }
 
-bool DFnetlist_Impl::readDataflowDot(FILE *f)
+// Reader of the dot files (native or graphviz)
+static atomic<bool> cgraphReader(false);
+
+bool DFnetlist_Impl::setDotReader(const string& reader)
+{
+    if (reader == "native") cgraphReader = false;
+#ifdef USE_GRAPHVIZ
+    else if (reader == "cgraph") cgraphReader = true;
+#endif
+    else return false;
+    return true;
+}
+
+#ifdef USE_GRAPHVIZ
+// Lookup of attributes for DotAttrs
+static const char* cgraphAttr(void* obj, const char* attr)
+{
+    return agget(obj, (char *) attr);
+}
+
+/**
+ * @brief Reads a graph with graphviz.
+ * @param DF The netlist (to report errors).
+ * @param f File descriptor.
+ * @return The graph (nullptr if there is no graph or an error occurs).
+ */
+static Agraph_t* readCgraph(DFnetlist_Impl& DF, FILE* f)
 {
     agseterr(AGMAX);
 
@@ -663,24 +692,55 @@ bool DFnetlist_Impl::readDataflowDot(FILE *f)
 
     if (agerrors() > 0) {
         string errmsg(aglasterr());
-        setError("Read netlist: " + errmsg);
-        return false;
+        DF.setError("Read netlist: " + errmsg);
+        return nullptr;
     }
 
-    if (g == nullptr) return false; // No graph has been read.
+    if (g == nullptr) return nullptr; // No graph has been read.
 
     if (not agisdirected(g)) {
-        setError("It is not a directed graph.");
+        DF.setError("It is not a directed graph.");
+        agclose(g);
+        return nullptr;
+    }
+    return g;
+}
+#endif
+
+/**
+ * @brief Reads a graph with the native parser.
+ * @param DF The netlist (to report errors).
+ * @param G The graph.
+ * @param f File descriptor.
+ * @return True if successful, and false otherwise (no graph or error).
+ */
+static bool readNative(DFnetlist_Impl& DF, DotGraph& G, FILE* f)
+{
+    if (not G.read(f)) {
+        if (G.hasError()) DF.setError("Read netlist: " + G.getError());
         return false;
     }
 
+    if (not G.isDirected()) {
+        DF.setError("It is not a directed graph.");
+        return false;
+    }
+    return true;
+}
+
+bool DFnetlist_Impl::readDotGraph(const string& name, const DotAttrs& attrs)
+{
     // Name of the graph
-    net_name = string(agnameof(g));
+    net_name = name;
+    if (net_name.empty()) {
+        setError("Invalid identifier: the graph has no name.");
+        return false;
+    }
     if (not goodIdentifier(*this, net_name)) return false;
 
     // Get the default width of the ports (originally defined as 32 bits)
     default_width = -1;
-    const char* attr = agget(g, (char *) "channel_width");
+    const char* attr = attrs.get("channel_width");
     if (attr != nullptr) {
         // Default channel width defined
         int v = getPositiveInteger(attr);
@@ -690,147 +750,183 @@ bool DFnetlist_Impl::readDataflowDot(FILE *f)
         }
         default_width = v;
     }
+    return true;
+}
 
-    // Traverse the set of nodes
-    for (Agnode_t* v = agfstnode(g); v; v = agnxtnode(g,v)) {
-        string node_name = string(agnameof(v));
-//        cout << "currently traversing node " << node_name << endl;
+bool DFnetlist_Impl::readDotBlock(const string& node_name, const DotAttrs& v)
+{
+    if (not goodIdentifier(*this, node_name)) {
+        setError("Block " + node_name + ": invalid identifier.");
+        return false;
+    }
 
-        if (not goodIdentifier(*this, node_name)) {
-            setError("Block " + node_name + ": invalid identifier.");
-            return false;
-        }
+    const char* attr = v.get("type");
+    if (attr == nullptr) {
+        setError("Block " + node_name + ": type not defined.");
+        return false;
+    }
 
-        const char* attr = agget(v, (char *) "type");
-  //      cout << "\ttype is " << attr << endl;
-        if (attr == nullptr) {
-            setError("Block " + node_name + ": type not defined.");
-            return false;
-        }
+    string type_str = string(attr);
+    auto it = String2BlockType.find(type_str);
+    if (it == String2BlockType.end()) {
+        setError("Block " + node_name + ": unknown type " + type_str);
+        return false;
+    }
 
-        string type_str = string(attr);
-        auto it = String2BlockType.find(type_str);
-        if (it == String2BlockType.end()) {
-            setError("Block " + node_name + ": unknown type " + type_str);
-            return false;
-        }
+    BlockType type = it->second;
+    blockID id = createBlock(type, node_name);
+    if (not validBlock(id)) return false;
 
-        BlockType type = String2BlockType[type_str];
-        blockID id = createBlock(type, node_name);
-        if (not validBlock(id)) return false;
+    // Reading input and output ports
+    if (not readPorts(*this, id, v, true)) return false;
+    if (not readPorts(*this, id, v, false)) return false;
 
-        // Reading input and output ports
-        if (not readPorts(*this, id, v, true)) return false;
-        if (not readPorts(*this, id, v, false)) return false;
+    // Reading delays
+    if (not readDelays(*this, id, v)) return false;
 
-        // Reading delays
-        if (not readDelays(*this, id, v)) return false;
+    // Reading latency and initiation interval
+    if (not readLatencyII(*this, id, v)) return false;
 
-        // Reading latency and initiation interval
-        if (not readLatencyII(*this, id, v)) return false;
+    // Reading execution frequency
+    if (not readExecFrequency(*this, id, v)) return false;
 
-        // Reading execution frequency
-        if (not readExecFrequency(*this, id, v)) return false;
+    // Reading select input fraction
+    if (not readTrueFrac(*this, id, v)) return false;
 
-        // Reading select input fraction
-        if (not readTrueFrac(*this, id, v)) return false;
+    // Reading the value for constants
+    if (not readValue(*this, id, v)) return false;
 
-        // Reading the value for constants
-        if (not readValue(*this, id, v)) return false;
+    // Reading the operation for operators
+    if (not readOperation(*this, id, v)) return false;
 
-        // Reading the operation for operators
-        if (not readOperation(*this, id, v)) return false;
+    // Reading the BB id
+    if (not readBasicBlock(*this, id, v)) return false;
 
-        // Reading the BB id
-        if (not readBasicBlock(*this, id, v)) return false;
+    // Reading mem port param
+    if (not readMemPortID(*this, id, v)) return false;
 
-        // Reading mem port param
-        if (not readMemPortID(*this, id, v)) return false;
+    // Reading mem port param
+    if (not readMemOffset(*this, id, v)) return false;
 
-        // Reading mem port param
-        if (not readMemOffset(*this, id, v)) return false;
+    // Reading mem port param
+    if (not readMemBBCount(*this, id, v)) return false;
 
-        // Reading mem port param
-        if (not readMemBBCount(*this, id, v)) return false;
+    // Reading mem port param
+    if (not readMemLdCount(*this, id, v)) return false;
 
-        // Reading mem port param
-        if (not readMemLdCount(*this, id, v)) return false;
+    // Reading mem port param
+    if (not readMemStCount(*this, id, v)) return false;
 
-        // Reading mem port param
-        if (not readMemStCount(*this, id, v)) return false;
+    if (not readMemName(*this, id, v)) return false;
 
-        if (not readMemName(*this, id, v)) return false;
+    if (not readFuncName(*this, id, v)) return false;
 
-        if (not readFuncName(*this, id, v)) return false;
+    if (not readLSQParams(*this, id, v)) return false;
 
-        if (not readLSQParams(*this, id, v)) return false;
+    // Reading getelementptr array dimensions
+    if (not readGetPtrConst(*this, id, v)) return false;
 
-        // Reading getelementptr array dimensions
-        if (not readGetPtrConst(*this, id, v)) return false;
+    // SHAB: to support naive buffer placement
+    if (not readBufferAttributes(*this, id, v)) return false;
 
-        // SHAB: to support naive buffer placement
-        if (not readBufferAttributes(*this, id, v)) return false;
+    return true;
+}
+
+bool DFnetlist_Impl::readDotChannel(const string& src_name, const string& dst_name,
+                                    const DotAttrs& e, const DotAttrs& v)
+{
+    blockID src = getBlock(src_name);
+
+    if (not validBlock(src)) {
+        setError ("Unknown block " + src_name + ".");
+        return false;
     }
 
-    // Traverse the set of edges
-    for (Agnode_t* v = agfstnode(g); v; v = agnxtnode(g,v)) {
-        for (Agedge_t* e = agfstout(g,v); e; e = agnxtout(g,e)) {
-            string src_name = agnameof(agtail(e));
-            string dst_name = agnameof(aghead(e));
-            blockID src = getBlock(src_name);
-
-            if (not validBlock(src)) {
-                setError ("Unknown block " + src_name + ".");
-                return false;
-            }
+    blockID dst = getBlock(dst_name);
+    if (not validBlock(dst)) {
+        setError ("Unknown block " + dst_name + ".");
+        return false;
+    }
 
-            blockID dst = getBlock(dst_name);
-            if (not validBlock(dst)) {
-                setError ("Unknown block " + dst_name + ".");
-                return false;
-            }
+    const char* attr = e.get("from");
+    if (attr == nullptr) {
+        setError("Missing port for channel " + src_name + " -> " + dst_name + ".");
+        return false;
+    }
 
-            const char* attr = agget(e, (char *) "from");
-            if (attr == nullptr) {
-                setError("Missing port for channel " + src_name + " -> " + dst_name + ".");
-                return false;
-            }
+    portID psrc = getPort(src, string(attr));
+    if (not validPort(psrc)) {
+        setError ("Block " + getBlockName(src) + ": unknown port " + string(attr) + ".");
+        return false;
+    }
 
-            portID psrc = getPort(src, string(attr));
-            if (not validPort(psrc)) {
-                setError ("Block " + getBlockName(src) + ": unknown port " + string(attr) + ".");
-                return false;
-            }
 
+    attr = e.get("to");
+    if (attr == nullptr) {
+        setError("Missing port for channel " + src_name + " -> " + dst_name + ".");
+        return false;
+    }
 
-            attr = agget(e, (char *) "to");
-            if (attr == nullptr) {
-                setError("Missing port for channel " + src_name + " -> " + dst_name + ".");
-                return false;
-            }
+    portID pdst = getPort(dst, string(attr));
+    if (not validPort(pdst)) {
+        setError ("Block " + getBlockName(dst) + ": unknown port " + string(attr) + ".");
+        return false;
+    }
 
-            portID pdst = getPort(dst, string(attr));
-            if (not validPort(pdst)) {
-                setError ("Block " + getBlockName(dst) + ": unknown port " + string(attr) + ".");
-                return false;
-            }
+    channelID c = createChannel(psrc, pdst);
+    if (not validChannel(c)) {
+        setError("Error when creating channel " + src_name + " -> " + dst_name + ".");
+        return false;
+    }
 
-            channelID c = createChannel(psrc, pdst);
-            if (not validChannel(c)) {
-                setError("Error when creating channel " + src_name + " -> " + dst_name + ".");
-                return false;
-            }
+    // Checking attributes for elastic buffers (slots and transparency).
+    // They are read from the tail node, as in the original reader.
+    return readChannelBufferAttributes(*this, c, v);
+}
+
+bool DFnetlist_Impl::readDataflowDot(FILE *f)
+{
+#ifdef USE_GRAPHVIZ
+    if (cgraphReader) {
+        Agraph_t* g = readCgraph(*this, f);
+        if (g == nullptr) return false;
+
+        bool status = readDotGraph(agnameof(g), DotAttrs(cgraphAttr, g));
 
-            // Checking attributes for elastic buffers (slots and transparency)
-            if (not readChannelBufferAttributes(*this, c, v)) return false;
+        // Traverse the set of nodes
+        for (Agnode_t* v = agfstnode(g); status and v; v = agnxtnode(g,v)) {
+            status = readDotBlock(agnameof(v), DotAttrs(cgraphAttr, v));
+        }
+
+        // Traverse the set of edges
+        for (Agnode_t* v = agfstnode(g); status and v; v = agnxtnode(g,v)) {
+            for (Agedge_t* e = agfstout(g,v); status and e; e = agnxtout(g,e)) {
+                status = readDotChannel(agnameof(agtail(e)), agnameof(aghead(e)),
+                                        DotAttrs(cgraphAttr, e), DotAttrs(cgraphAttr, v));
+            }
         }
+
+        agclose(g);
+        return status;
     }
+#endif
 
-    //bbCount = 0;
+    DotGraph G;
+    if (not readNative(*this, G, f)) return false;
 
-    ///for(Agraph_t* h = agfstsubg(g); h; h = agnxtsubg(h)) {
-    //    bbCount++;
-    //}
+    if (not readDotGraph(G.getName(), DotAttrs::graph(G))) return false;
+
+    // Traverse the set of nodes
+    for (int v = 0; v < G.numNodes(); ++v) {
+        if (not readDotBlock(G.getNodeName(v), DotAttrs::node(G, v))) return false;
+    }
+
+    // Traverse the set of edges
+    for (int e = 0; e < G.numEdges(); ++e) {
+        int v = G.getTail(e);
+        if (not readDotChannel(G.getNodeName(v), G.getNodeName(G.getHead(e)),
+                               DotAttrs::edge(G, e), DotAttrs::node(G, v))) return false;
+    }
 
     return true;
 }
@@ -934,97 +1030,78 @@ void DFnetlist_Impl::computeChannelFrequencies() {
     }
 }
 
-//SHAB_note: add error checking.
-bool DFnetlist_Impl::readDataflowDotBB(FILE *f) {
-
-    cout << "===================" << endl;
-    cout << "READING BB DOT FILE" << endl;
-    cout << "===================" << endl;
-
-    agseterr(AGMAX);
-
-    Agraph_t *g = agread(f, nullptr);
+bool DFnetlist_Impl::readDotBasicBlock(const string& node_name, map<string, bbID>& name2bbID)
+{
+    if (not goodIdentifier(*this, node_name)) {
+        setError("Block " + node_name + ": invalid identifier.");
+        return false;
+    }
 
-    cout << "Reading graph name..." << endl;
-    if (agerrors() > 0) {
-        string errmsg(aglasterr());
-        setError("Read netlist: " + errmsg);
+    if (name2bbID.find(node_name) != name2bbID.end()) {
+        setError("Block " + node_name + ": already defined.");
         return false;
     }
 
-    if (g == nullptr) return false; // No graph has been read.
+    bbID node_bbID = BBG.createBasicBlock();
+    name2bbID[node_name] = node_bbID;
+    return true;
+}
 
-    if (not agisdirected(g)) {
-        setError("It is not a directed graph.");
+bool DFnetlist_Impl::readDotBasicBlockArc(const string& src_name, const string& dst_name,
+                                          const DotAttrs& e, const map<string, bbID>& name2bbID)
+{
+    auto it_src = name2bbID.find(src_name);
+    if (it_src == name2bbID.end()) {
+        setError("Invalid source Basic Block: " + src_name + " to " + dst_name);
         return false;
     }
 
-    // Name of the graph
-    if (not goodIdentifier(*this, string(agnameof(g)))) return false;
+    auto it_dst = name2bbID.find(dst_name);
+    if (it_dst == name2bbID.end()) {
+        setError("Invalid destination Basic Block: " + src_name + " to " + dst_name);
+        return false;
+    }
 
-    BBG.clear();
-    map<string, bbID> name2bbID;
+    bbID src = it_src->second;
+    bbID dst = it_dst->second;
 
-    cout << "Reading set of nodes..." << endl;
-    // Traverse the set of nodes
-    for (Agnode_t* v = agfstnode(g); v; v = agnxtnode(g,v)) {
-        string node_name = string(agnameof(v));
-
-        if (not goodIdentifier(*this, node_name)) {
-            setError("Block " + node_name + ": invalid identifier.");
-            return false;
-        }
+    if (BBG.findArc(src, dst) != -1) {
+        setError(src_name + "->" + dst_name + " arc: already defined");
+        return false;
+    }
 
-        if (name2bbID.find(node_name) != name2bbID.end()) {
-            setError("Block " + node_name + ": already defined.");
+    const char* attr = e.get("freq");
+    double freq = 0;
+    if (attr != nullptr and strlen(attr) > 0) {
+        freq = getPositiveDouble(attr);
+        if (freq < 0) {
+            setError(src_name + "->" + dst_name + " arc: negative execution frequency.");
             return false;
         }
-
-        bbID node_bbID = BBG.createBasicBlock();
-        name2bbID[node_name] = node_bbID;
     }
 
-    cout << "Reading set of edges between nodes..." << endl;
-    // Traverse the set of edges
-    for (Agnode_t* v = agfstnode(g); v; v = agnxtnode(g,v)) {
-        for (Agedge_t* e = agfstout(g,v); e; e = agnxtout(g,e)) {
-            string src_name = agnameof(agtail(e));
-            string dst_name = agnameof(aghead(e));
-
-            auto it_src = name2bbID.find(src_name);
-            if (it_src == name2bbID.end()) {
-                setError("Invalid source Basic Block: " + src_name + " to " + dst_name);
-                return false;
-            }
-
-            auto it_dst = name2bbID.find(dst_name);
-            if (it_dst == name2bbID.end()) {
-                setError("Invalid destination Basic Block: " + src_name + " to " + dst_name);
-                return false;
-            }
-
-            bbID src = it_src->second;
-            bbID dst = it_dst->second;
+    bbArcID arc = BBG.findOrAddArc(src, dst, freq);
 
-            if (BBG.findArc(src, dst) != -1) {
-                setError(src_name + "->" + dst_name + " arc: already defined");
+    // MGs of the arc (written with the buffered BB graph)
+    attr = e.get("MG");
+    if (attr != nullptr and strlen(attr) > 0) {
+        istringstream mgs(attr);
+        string mg;
+        while (getline(mgs, mg, ',')) {
+            size_t first = mg.find_first_not_of(' ');
+            double number = first == string::npos ? -1 : getPositiveDouble(mg.substr(first));
+            if (number < 1) {
+                setError(src_name + "->" + dst_name + " arc: wrong MG number.");
                 return false;
             }
-
-            const char* attr = agget(e, (char *) "freq");
-            double freq = 0;
-            if (attr != nullptr and strlen(attr) > 0) {
-                freq = getPositiveDouble(attr);
-                if (freq < 0) {
-                    setError(src_name + "->" + dst_name + " arc: negative execution frequency.");
-                    return false;
-                }
-            }
-
-            bbArcID arc = BBG.findOrAddArc(src, dst, freq);
+            BBG.addMGnumber(arc, (int) number);
         }
     }
+    return true;
+}
 
+void DFnetlist_Impl::finishBasicBlockGraph()
+{
     // set the entryBB. it is assumed that the entry/exit BB has no input/output edges.
     cout << "Setting entry and exit BB..." << endl;
     determineEntryExitBlock();
@@ -1040,7 +1117,74 @@ bool DFnetlist_Impl::readDataflowDotBB(FILE *f) {
         cout << "BB" << i << " : " << BBG.getFrequency(i) << endl;
     }
     cout << endl;
+}
+
+//SHAB_note: add error checking.
+bool DFnetlist_Impl::readDataflowDotBB(FILE *f) {
+
+    cout << "===================" << endl;
+    cout << "READING BB DOT FILE" << endl;
+    cout << "===================" << endl;
+
+    map<string, bbID> name2bbID;
+
+#ifdef USE_GRAPHVIZ
+    if (cgraphReader) {
+        cout << "Reading graph name..." << endl;
+        Agraph_t* g = readCgraph(*this, f);
+        if (g == nullptr) return false;
+
+        // Name of the graph
+        bool status = goodIdentifier(*this, string(agnameof(g)));
+        BBG.clear();
+
+        cout << "Reading set of nodes..." << endl;
+        for (Agnode_t* v = agfstnode(g); status and v; v = agnxtnode(g,v)) {
+            status = readDotBasicBlock(agnameof(v), name2bbID);
+        }
+
+        cout << "Reading set of edges between nodes..." << endl;
+        for (Agnode_t* v = agfstnode(g); status and v; v = agnxtnode(g,v)) {
+            for (Agedge_t* e = agfstout(g,v); status and e; e = agnxtout(g,e)) {
+                status = readDotBasicBlockArc(agnameof(agtail(e)), agnameof(aghead(e)),
+                                              DotAttrs(cgraphAttr, e), name2bbID);
+            }
+        }
+
+        agclose(g);
+        if (not status) return false;
+        finishBasicBlockGraph();
+        return true;
+    }
+#endif
+
+    cout << "Reading graph name..." << endl;
+    DotGraph G;
+    if (not readNative(*this, G, f)) return false;
+
+    // Name of the graph
+    if (*G.getName() == '\0') {
+        setError("Invalid identifier: the graph has no name.");
+        return false;
+    }
+    if (not goodIdentifier(*this, G.getName())) return false;
+
+    BBG.clear();
+
+    cout << "Reading set of nodes..." << endl;
+    // Traverse the set of nodes
+    for (int v = 0; v < G.numNodes(); ++v) {
+        if (not readDotBasicBlock(G.getNodeName(v), name2bbID)) return false;
+    }
+
+    cout << "Reading set of edges between nodes..." << endl;
+    // Traverse the set of edges
+    for (int e = 0; e < G.numEdges(); ++e) {
+        if (not readDotBasicBlockArc(G.getNodeName(G.getTail(e)), G.getNodeName(G.getHead(e)),
+                                     DotAttrs::edge(G, e), name2bbID)) return false;
+    }
 
+    finishBasicBlockGraph();
     return true;
 }
 
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include "DFnetlist.h"
+
+using namespace Dataflow;
+using namespace std;
+
+/*
+ * Throughput analysis of marked graphs.
+ *
+ * The throughput of a marked graph is determined by its critical cycle:
+ * the cycle with the maximum ratio latency/tokens. The throughput is the
+ * inverse of this ratio (at most one token per cycle). The graph has one
+ * node per block and one arc per channel. The latency of an arc is the
+ * latency of its source block plus one cycle if the channel has a
+ * non-transparent buffer. The tokens of an arc are the initial tokens of
+ * the back edges. This is the same model as the throughput constraints of
+ * the MILP for buffer placement, thus the channels ignored by the MILP are
+ * also ignored here.
+ *
+ * The maximum cycle ratio is calculated with Howard's policy iteration,
+ * which converges in a few iterations on the graphs of marked graphs.
+ */
+
+// Graph for the cycle ratio analysis
+struct RatioGraph {
+    int numNodes = 0;
+    vector<int> src;            // Source node of each arc
+    vector<int> dst;            // Destination node of each arc
+    vector<int> latency;        // Latency of each arc
+    vector<int> tokens;         // Initial tokens of each arc
+    vector<channelID> channel;  // Channel of each arc
+    vector<vector<int>> out;    // Output arcs of each node
+
+    int numArcs() const {
+        return src.size();
+    }
+
+    void addArc(int s, int d, int lat, int tok, channelID c) {
+        out[s].push_back(src.size());
+        src.push_back(s);
+        dst.push_back(d);
+        latency.push_back(lat);
+        tokens.push_back(tok);
+        channel.push_back(c);
+    }
+};
+
+// Strongly connected components of the graph restricted to the arcs
+// for which useArc holds (iterative version of Tarjan's algorithm).
+// Returns the component of each node.
+static vector<int> ratioGraphSCCs(const RatioGraph& g, const vector<bool>& useArc)
+{
+    int n = g.numNodes;
+    vector<int> comp(n, -1);
+    vector<int> index(n, -1);
+    vector<int> low(n, 0);
+    vector<int> next(n, 0);     // Next arc to explore of each node
+    vector<bool> onStack(n, false);
+    vector<int> stack;
+    vector<int> call;
+    int counter = 0;
+    int ncomp = 0;
+
+    for (int s = 0; s < n; ++s) {
+        if (index[s] >= 0) continue;
+        index[s] = low[s] = counter++;
+        stack.push_back(s);
+        onStack[s] = true;
+        call.push_back(s);
+        while (not call.empty()) {
+            int u = call.back();
+            if (next[u] < g.out[u].size()) {
+                int a = g.out[u][next[u]++];
+                if (not useArc[a]) continue;
+                int v = g.dst[a];
+                if (index[v] < 0) {
+                    index[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    onStack[v] = true;
+                    call.push_back(v);
+                } else if (onStack[v]) low[u] = min(low[u], index[v]);
+                continue;
+            }
+
+            call.pop_back();
+            if (not call.empty()) low[call.back()] = min(low[call.back()], low[u]);
+            if (low[u] != index[u]) continue;
+            int v;
+            do {
+                v = stack.back();
+                stack.pop_back();
+                onStack[v] = false;
+                comp[v] = ncomp;
+            } while (v != u);
+            ncomp++;
+        }
+    }
+    return comp;
+}
+
+// Maximum ratio latency/tokens of the cycles of the graph restricted to the
+// arcs for which useArc holds (Howard's policy iteration). Every node with
+// some of these arcs must be in a cycle, and the cycles without tokens must
+// have no latency. Returns -1 if there is no cycle. The arcs of the critical
+// cycle are returned in cycle.
+static double maxCycleRatio(const RatioGraph& g, const vector<bool>& useArc, vector<int>& cycle)
+{
+    const double eps = 1e-9;
+    const int MaxIterations = 1000;
+    int n = g.numNodes;
+
+    // Initial policy: the output arc with the largest latency
+    vector<int> policy(n, -1);
+    for (int a = 0; a < g.numArcs(); ++a) {
+        if (not useArc[a]) continue;
+        int u = g.src[a];
+        if (policy[u] < 0 or g.latency[a] > g.latency[policy[u]]) policy[u] = a;
+    }
+
+    vector<double> eta(n, 0);   // Ratio of the cycle reached by each node
+    vector<double> x(n, 0);     // Potential of each node
+    vector<int> visit(n);
+    vector<bool> known(n);
+    vector<int> path;
+    double best = -1;
+
+    for (int iter = 0; iter < MaxIterations; ++iter) {
+        // Find the cycles of the policy graph. A node of each cycle
+        // is taken as a reference with potential 0.
+        fill(visit.begin(), visit.end(), -1);
+        fill(known.begin(), known.end(), false);
+        best = -1;
+        cycle.clear();
+        for (int s = 0; s < n; ++s) {
+            if (policy[s] < 0 or visit[s] >= 0) continue;
+            int u = s;
+            while (visit[u] < 0) {
+                visit[u] = s;
+                u = g.dst[policy[u]];
+            }
+            if (visit[u] != s) continue;    // Already known cycle
+
+            long long lat = 0, tok = 0;
+            int v = u;
+            do {
+                lat += g.latency[policy[v]];
+                tok += g.tokens[policy[v]];
+                v = g.dst[policy[v]];
+            } while (v != u);
+            assert (tok > 0 or lat == 0);
+            eta[u] = tok > 0 ? double(lat) / tok : 0;
+            x[u] = 0;
+            known[u] = true;
+            if (eta[u] > best) {
+                best = eta[u];
+                cycle.clear();
+                v = u;
+                do {
+                    cycle.push_back(policy[v]);
+                    v = g.dst[policy[v]];
+                } while (v != u);
+            }
+        }
+
+        // Potentials of the rest of nodes
+        for (int s = 0; s < n; ++s) {
+            if (policy[s] < 0 or known[s]) continue;
+            for (int u = s; not known[u]; u = g.dst[policy[u]]) path.push_back(u);
+            while (not path.empty()) {
+                int u = path.back();
+                path.pop_back();
+                int a = policy[u];
+                int v = g.dst[a];
+                eta[u] = eta[v];
+                x[u] = g.latency[a] - eta[v] * g.tokens[a] + x[v];
+                known[u] = true;
+            }
+        }
+
+        // Policy improvement. First, move to cycles with larger ratio.
+        bool changed = false;
+        vector<double> bestEta(eta);
+        for (int a = 0; a < g.numArcs(); ++a) {
+            if (not useArc[a]) continue;
+            int u = g.src[a];
+            if (eta[g.dst[a]] > bestEta[u] + eps) {
+                bestEta[u] = eta[g.dst[a]];
+                policy[u] = a;
+                changed = true;
+            }
+        }
+        if (changed) continue;
+
+        // Next, increase the potentials within the same ratio
+        vector<double> bestX(x);
+        for (int a = 0; a < g.numArcs(); ++a) {
+            if (not useArc[a]) continue;
+            int u = g.src[a];
+            int v = g.dst[a];
+            if (abs(eta[v] - eta[u]) > eps) continue;
+            double val = g.latency[a] - eta[u] * g.tokens[a] + x[v];
+            if (val > bestX[u] + eps) {
+                bestX[u] = val;
+                policy[u] = a;
+                changed = true;
+            }
+        }
+        if (not changed) break;
+    }
+
+    return best;
+}
+
+ThroughputInfo DFnetlist_Impl::analyzeThroughput(const subNetlist& mg) const
+{
+    const double frac = 0.5;
+
+    RatioGraph g;
+    vector<int> node(vecBlocksSize(), -1);
+    for (blockID b: mg.getBlocks()) node[b] = g.numNodes++;
+    g.out.resize(g.numNodes);
+
+    for (channelID c: mg.getChannels()) {
+        blockID src = getSrcBlock(c);
+        blockID dst = getDstBlock(c);
+        if (node[src] < 0 or node[dst] < 0) continue;
+
+        // Same channels as in the throughput constraints of the MILP
+        if (getBlockType(dst) == OPERATOR and getOperation(dst) == "select_op") {
+            if (getPortType(getDstPort(c)) == TRUE_PORT and getTrueFrac(dst) < frac) continue;
+            if (getPortType(getDstPort(c)) == FALSE_PORT and getTrueFrac(dst) > frac) continue;
+        }
+        if (getBlockType(dst) == OPERATOR and getOperation(dst) == "lsq_store_op") continue;
+
+        int lat = getLatency(src);
+        if (getBlockType(src) == ELASTIC_BUFFER and not isBufferTransparent(src)) lat++;
+        if (getChannelBufferSize(c) > 0 and not isChannelTransparent(c)) lat++;
+        g.addArc(node[src], node[dst], lat, isBackEdge(c) ? 1 : 0, c);
+    }
+
+    ThroughputInfo info {1.0, 0, 0, vecChannels()};
+    auto setCycle = [&](const vector<int>& arcs) {
+        for (int a: arcs) {
+            info.latency += g.latency[a];
+            info.tokens += g.tokens[a];
+            info.criticalCycle.push_back(g.channel[a]);
+        }
+    };
+
+    // A cycle without tokens and with some latency is a deadlock. It is
+    // found in the components of the arcs without tokens.
+    int m = g.numArcs();
+    vector<bool> useArc(m);
+    for (int a = 0; a < m; ++a) useArc[a] = g.tokens[a] == 0;
+    vector<int> comp = ratioGraphSCCs(g, useArc);
+    for (int a = 0; a < m; ++a) {
+        if (not useArc[a] or g.latency[a] == 0 or comp[g.src[a]] != comp[g.dst[a]]) continue;
+
+        // Path from the destination to the source of the arc (BFS)
+        vector<int> pred(g.numNodes, -1);
+        deque<int> queue {g.dst[a]};
+        while (pred[g.src[a]] < 0 and not queue.empty()) {
+            int u = queue.front();
+            queue.pop_front();
+            for (int b: g.out[u]) {
+                int v = g.dst[b];
+                if (not useArc[b] or comp[v] != comp[u] or pred[v] >= 0 or v == g.dst[a]) continue;
+                pred[v] = b;
+                queue.push_back(v);
+            }
+        }
+
+        vector<int> arcs;
+        for (int u = g.src[a]; u != g.dst[a]; u = g.src[pred[u]]) arcs.push_back(pred[u]);
+        reverse(arcs.begin(), arcs.end());
+        arcs.push_back(a);
+        setCycle(arcs);
+        info.throughput = 0;
+        return info;
+    }
+
+    // Cycle ratio of the arcs inside the strongly connected components
+    fill(useArc.begin(), useArc.end(), true);
+    comp = ratioGraphSCCs(g, useArc);
+    for (int a = 0; a < m; ++a) useArc[a] = comp[g.src[a]] == comp[g.dst[a]];
+
+    vector<int> arcs;
+    double ratio = maxCycleRatio(g, useArc, arcs);
+    if (ratio < 0) return info;     // No cycles
+    setCycle(arcs);
+    if (ratio > 1) info.throughput = 1 / ratio;
+    return info;
+}
+
+bool DFnetlist_Impl::analyzeThroughput(vector<ThroughputInfo>& result, bool disjoint)
+{
+    const vector<subNetlist>& mgs = disjoint ? MG_disjoint : MG;
+    if (mgs.empty()) {
+        setError("No marked graphs to analyze the throughput.");
+        return false;
+    }
+
+    result.clear();
+    for (const subNetlist& mg: mgs) result.push_back(analyzeThroughput(mg));
+    return true;
+}
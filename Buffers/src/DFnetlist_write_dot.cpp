@@ -2,6 +2,7 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include "DFnetlist.h"
 
 using namespace Dataflow;
@@ -38,6 +39,45 @@ static map<PortType,string> channelSrcAttr = {
     {FALSE_PORT, ", dir=both, arrowtail=odot"}
 };
 
+// Minimum number of lines formatted by each thread of writeDot
+static const int dotLinesPerJob = 4096;
+
+// Returns the value of a key in a table (empty string if the key is not in the
+// table). The tables are not modified, so that the lines can be formatted
+// concurrently.
+template<typename Key>
+static const string& lookup(const map<Key,string>& table, Key key)
+{
+    static const string none;
+    auto it = table.find(key);
+    return it == table.end() ? none : it->second;
+}
+
+// Formats n lines into a stream with format(s, i), for i = 0..n-1. The lines
+// are split into consecutive ranges formatted concurrently into separate
+// buffers, which are written in order. Small outputs are formatted directly.
+template<typename Format>
+static void formatLines(ostream& of, int n, const Format& format)
+{
+    int jobs = min<int>(thread::hardware_concurrency(), n / dotLinesPerJob);
+    if (jobs <= 1) {
+        for (int i = 0; i < n; ++i) format(of, i);
+        return;
+    }
+
+    vector<ostringstream> buffers(jobs);
+    vector<thread> workers;
+    for (int w = 0; w < jobs; ++w) {
+        workers.emplace_back([&, w]() {
+            int last = (long long) n * (w + 1) / jobs;
+            for (int i = (long long) n * w / jobs; i < last; ++i) format(buffers[w], i);
+        });
+    }
+
+    for (thread& t: workers) t.join();
+    for (ostringstream& buf: buffers) of << buf.str();
+}
+
 bool DFnetlist_Impl::writeBasicBlockDot(const string& filename)
 {
     ostringstream of;
@@ -52,23 +92,23 @@ bool DFnetlist_Impl::writeBasicBlockDot(std::ostream& of)
     const string& name = getName();
     if (name.empty()) of << "BasicBlocks";
     else of << name << "_BasicBlocks";
-    of << " {" << endl;
+    of << " {" << '\n';
 
     for (bbID bb = 0; bb < BBG.numBasicBlocks(); ++bb) {
-        of << "  BB" << bb << " [label=\"BB #" << bb << "\";];" << endl;
+        of << "  BB" << bb << " [label=\"BB #" << bb << "\";];" << '\n';
     }
 
-    of << endl;
+    of << '\n';
     for (bbID bb_src = 0; bb_src < BBG.numBasicBlocks(); ++bb_src) {
         for (bbArcID arc: BBG.successors(bb_src)) {
             bbID bb_dst = BBG.getDstBB(arc);
             of << "  BB" << bb_src << " -> BB" << bb_dst;
             if (BBG.isBackArc(arc)) of << " [color=red;]";
-            of << ';' << endl;
+            of << ';' << '\n';
         }
     }
 
-    of << "}" << endl;
+    of << "}" << '\n';
     return true;
 }
 
@@ -81,15 +121,15 @@ bool DFnetlist_Impl::writeDot(const string& filename)
 
 bool DFnetlist_Impl::writeDot(std::ostream& of)
 {
-    of << "// Number of blocks: " << numBlocks() << endl;
-    of << "// Number of channels: " << numChannels() << endl;
+    of << "// Number of blocks: " << numBlocks() << '\n';
+    of << "// Number of channels: " << numChannels() << '\n';
     of << "Digraph ";
     const string& name = getName();
     if (name.empty()) of << "DataflowNetlist";
     else of << name;
-    of << " {" << endl;
+    of << " {" << '\n';
 
-    of << endl << "  // Blocks" << endl;
+    of << '\n' << "  // Blocks" << '\n';
     
     // Lana 03/07/19
     /*
@@ -130,34 +170,54 @@ bool DFnetlist_Impl::writeDot(std::ostream& of)
         of << "  }" << endl;
     }*/
 
-// Print nodes in BB clusters
-for (bbID i = 1; i <= BBG.numBasicBlocks(); i++) {
-    of <<  "subgraph cluster_" + to_string(i) + " {\n";
-    of << "color = \"darkgreen\"\n";
-	of << "label = \"block"+ to_string(i) +"\"\n";
-    	
-    ForAllBlocks(b) {
-    	bbID bb_src = getBasicBlock(b);
-  
-        if (bb_src == i) 
-            writeBlockDot(of, b);  
-    }
+    // Lines of the body: the nodes in BB clusters (BB 1..n), the remaining
+    // nodes (bbID = 0) and the channels. The blocks of other BBs are not written.
+    enum LineType {CLUSTER_BEGIN, CLUSTER_END, BLOCK_LINE, CHANNELS_BEGIN, CHANNEL_LINE};
+    struct Line {
+        LineType type;
+        int id;                 // BB, block or channel
+    };
 
-    of << "}\n";
-}
-// Print remaining nodes (bbID = 0)
+    int nBB = BBG.numBasicBlocks();
+    vector<vecBlocks> bbBlocks(nBB + 1);
     ForAllBlocks(b) {
-        bbID bb_src = getBasicBlock(b);
-        
-        if (bb_src == 0) 
-            writeBlockDot(of, b);
-    }
-
-
-    of << endl << "  // Channels" << endl;
-
-
-    ForAllChannels(c) writeChannelDot(of, c);
+        bbID bb = getBasicBlock(b);
+        if (bb >= 0 and bb <= nBB) bbBlocks[bb].push_back(b);
+    }
+
+    vector<Line> lines;
+    lines.reserve(numBlocks() + numChannels() + 2 * nBB + 1);
+    for (bbID i = 1; i <= nBB; i++) {
+        lines.push_back({CLUSTER_BEGIN, i});
+        for (blockID b: bbBlocks[i]) lines.push_back({BLOCK_LINE, b});
+        lines.push_back({CLUSTER_END, i});
+    }
+    for (blockID b: bbBlocks[0]) lines.push_back({BLOCK_LINE, b});
+    lines.push_back({CHANNELS_BEGIN, 0});
+    ForAllChannels(c) lines.push_back({CHANNEL_LINE, c});
+
+    formatLines(of, lines.size(), [&](ostream& s, int i) {
+        const Line& L = lines[i];
+        switch (L.type) {
+        case CLUSTER_BEGIN:
+            s << "subgraph cluster_" << L.id << " {\n";
+            s << "color = \"darkgreen\"\n";
+            s << "label = \"block" << L.id << "\"\n";
+            break;
+        case CLUSTER_END:
+            s << "}\n";
+            break;
+        case BLOCK_LINE:
+            writeBlockDot(s, L.id);
+            break;
+        case CHANNELS_BEGIN:
+            s << '\n' << "  // Channels" << '\n';
+            break;
+        case CHANNEL_LINE:
+            writeChannelDot(s, L.id);
+            break;
+        }
+    });
 
     of << "}" << endl;
     return true;
@@ -174,11 +234,11 @@ bool DFnetlist_Impl::writeDotBB(std::ostream& of) {
     const string& name = getName();
     if (name.empty()) of << "DataflowNetlist";
     else of << name;
-    of << " {" << endl;
+    of << " {" << '\n';
 
-    of << "\tsplines=spline;" << endl;
+    of << "\tsplines=spline;" << '\n';
     for (bbID i = 1; i < BBG.numBasicBlocks(); i++) {
-        of << "\t\t\"block" << to_string(i) << "\";" << endl;
+        of << "\t\t\"block" << to_string(i) << "\";" << '\n';
     }
 
     for (bbArcID i = 0; i < BBG.numArcs(); i++) {
@@ -204,7 +264,7 @@ bool DFnetlist_Impl::writeDotBB(std::ostream& of) {
         of << ", freq = " << freq;
         of << ", DSU = " << DSU;
         of << ", MG = " << MG_numbers;
-        of << "];" << endl;
+        of << "];" << '\n';
     }
 
     of << "}";
@@ -219,22 +279,23 @@ bool DFnetlist_Impl::writeDotMG(const std::string &filename) {
 
 bool DFnetlist_Impl::writeDotMG(std::ostream &s) {
 
-    for (auto curr: MG) {
+    for (const auto& curr: MG) {
         for (auto b: curr.getBlocks()) {
-            s << "block " << getBlockName(b) << endl;
+            s << "block " << getBlockName(b) << '\n';
         }
 
         for (auto c: curr.getChannels()) {
-            s << "channel " << getBlockName(getSrcBlock(c)) << " -> " << getBlockName(getDstBlock(c)) << endl;
+            s << "channel " << getBlockName(getSrcBlock(c)) << " -> " << getBlockName(getDstBlock(c)) << '\n';
         }
-        s << "minimum frequency is " << MGfreq[0] << endl;
+        s << "minimum frequency is " << MGfreq[0] << '\n';
         cout << "writing shit" << endl;
     }
+    return true;
 }
 
-void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
+void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b) const
 {
-    s << "  " << getBlockName(b) << " [type=" << BlockType2String[getBlockType(b)];
+    s << "  " << getBlockName(b) << " [type=" << lookup(BlockType2String, getBlockType(b));
 
     // Delays
     ostringstream delay;
@@ -248,7 +309,10 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
 
     int num_control = 0, num_noncontrol = 0;
 
-    Block& B = blocks[b];
+    const Block& B = blocks[b];
+    const BlockExtra& X = getBlockExtra(b);
+    BlockType type = blockArrays.type[b];
+    const string& operation = getOperation(b);
     // Ports
     string inp, outp;
 
@@ -314,7 +378,7 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
     // The list of input and output ports are listed in order, with the
     // data port at the end of the input ports.
     if (getBlockType(b) == DEMUX) {
-        for(auto& pair: B.demuxPairs) {
+        for(auto& pair: X.demuxPairs) {
             if (not isControlPort(pair.first)) continue;
             inp += getPortName(pair.first, false) + ":0 ";
             outp += getPortName(pair.first, false) + ":0 ";
@@ -323,7 +387,7 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
     }
 
     // Lana 25.03.19 Ignore constant here (input size is incorrect)
-    if (not inp.empty() && B.type != CONSTANT) {
+    if (not inp.empty() && type != CONSTANT) {
         inp.pop_back();
         s << ", in=\"" << inp << "\"";
     }
@@ -344,8 +408,8 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
     }
 
     // Lana 07.03.19. Printing out operation type of operators
-    if (B.type == OPERATOR and not B.operation.empty()) {
-        s << ", op = \"" << B.operation << "\"";
+    if (type == OPERATOR and not operation.empty()) {
+        s << ", op = \"" << operation << "\"";
     }
 
     if (not delay.str().empty()) {
@@ -355,22 +419,22 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
         if (not only_block_delay) s << "\"";
     }
 
-    if (B.type == OPERATOR and B.latency > 0) {
-        s << ", latency=" << B.latency;
-        if (B.II > 1) s << ", II=" << B.II;
+    if (type == OPERATOR and blockArrays.latency[b] > 0) {
+        s << ", latency=" << blockArrays.latency[b];
+        if (blockArrays.II[b] > 1) s << ", II=" << blockArrays.II[b];
     }
 
 
-    if (B.type == OPERATOR and (B.operation == "getelementptr_op")) {
+    if (type == OPERATOR and (operation == "getelementptr_op")) {
         s << ", constants=" << getGetPtrConst(b);
     }
 
     s << ", bbID = " << getBasicBlock(b);
     // Lana 02/07/19
-    if (B.type == OPERATOR and (B.operation == "mc_load_op" 
-        || B.operation == "mc_store_op" 
-        || B.operation == "lsq_load_op"
-        || B.operation == "lsq_store_op")) {
+    if (type == OPERATOR and (operation == "mc_load_op" 
+        || operation == "mc_store_op" 
+        || operation == "lsq_load_op"
+        || operation == "lsq_store_op")) {
         
         //s << ", bbID = " << getBasicBlock(b);
         s << ", portID = " << getMemPortID(b);
@@ -378,19 +442,19 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
 
     }
 
-    if (B.type == OPERATOR and (B.operation == "call_op")) {
+    if (type == OPERATOR and (operation == "call_op")) {
         
         s << ", function = \"" << getFuncName(b) << "\"";
 
     }
 
-    if (B.type == BRANCH) {
+    if (type == BRANCH) {
         
         //s << ", bbID = " << getBasicBlock(b);
 
     }
 
-    if (B.type == MC || B.type == LSQ) {
+    if (type == MC || type == LSQ) {
 
         s << ", memory = \"" << getMemName(b)<< "\"";
         s << ", bbcount = " << getMemBBCount(b);
@@ -399,7 +463,7 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
      
     }
 
-    if (B.type == LSQ) {
+    if (type == LSQ) {
 
         s << ", fifoDepth = " << getLSQDepth(b);
         s << ", numLoads = \"" << getNumLoads(b) << "\"";
@@ -411,7 +475,7 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
      
     }
 
-    if (B.type == ELASTIC_BUFFER) {
+    if (type == ELASTIC_BUFFER) {
         s << ", slots=" << B.slots << ", transparent=" << (B.transparent ? "true" : "false");
         //s << ", fillcolor=" << (B.transparent ? "gray" : "black, fontcolor=white");
         s << ", label=\"" << getBlockName(b) << " [" << B.slots;
@@ -420,7 +484,7 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
     }
 
     // Lana 25.03.19 Printing out constants in hex always
-    if (B.type == CONSTANT) {
+    if (type == CONSTANT) {
         string k;
         int width = getPortWidth(getOutPort(b));
         if (width == 1) k = (B.value == 0) ? "\"0x0\"" : "\"0x1\"";
@@ -446,14 +510,14 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
         s << ", retimingDiff=" << B.retimingDiff;
     }
 
-    s << ", " << blockShapes[getBlockType(b)];
+    s << ", " << lookup(blockShapes, getBlockType(b));
 
     // Special color for control blocks
-   // if (B.type != ELASTIC_BUFFER and num_control > num_noncontrol) s << ", color=green, fillcolor=greenyellow";
+   // if (type != ELASTIC_BUFFER and num_control > num_noncontrol) s << ", color=green, fillcolor=greenyellow";
 
-    if (B.type == SELECTOR) {
+    if (type == SELECTOR) {
         s << ", orderings=\"";
-        for (auto mappings : B.orderings) {
+        for (auto mappings : X.orderings) {
             for (auto index_it = mappings.second.begin();
                     index_it != mappings.second.end(); ++index_it) {
                 if (index_it != (mappings.second.end() - 1)) {
@@ -467,10 +531,10 @@ void DFnetlist_Impl::writeBlockDot(ostream& s, blockID b)
         s << ", color=pink, fillcolor=pink";
     }
     
-    s << "];" << endl;
+    s << "];" << '\n';
 }
 
-void DFnetlist_Impl::writeChannelDot(ostream& s, channelID id)
+void DFnetlist_Impl::writeChannelDot(ostream& s, channelID id) const
 {
     portID src = getSrcPort(id);
     portID dst = getDstPort(id);
@@ -478,7 +542,7 @@ void DFnetlist_Impl::writeChannelDot(ostream& s, channelID id)
     s << "  " << getChannelName(id, false);
 
     s << " [from=" << getPortName(src, false) << ", to=" << getPortName(dst, false);
-    s << channelSrcAttr[getPortType(src)] << channelDstAttr[getPortType(dst)];
+    s << lookup(channelSrcAttr, getPortType(src)) << lookup(channelDstAttr, getPortType(dst));
 
     // Data, boolean, control
 
@@ -519,7 +583,7 @@ void DFnetlist_Impl::writeChannelDot(ostream& s, channelID id)
 
     if (isBackEdge(id)) s << ", style=dashed, minlen = 3";
 
-    s << "];" << endl;
+    s << "];" << '\n';
 }
 
 bool DFlib_Impl::writeDot(const string& filename)
@@ -540,3 +604,21 @@ bool DFlib_Impl::writeDot(const string& filename)
     return FileUtil::write(of.str(), filename, getError());
 }
 
+
+bool DFlib_Impl::writeDotBB(const string& filename)
+{
+    ostringstream of;
+
+    bool first = true;
+    for (funcID id: allFuncs) {
+        if (not first) of << endl;
+        else first = false;
+        DFnetlist_Impl& DF = *funcs[id].DFI;
+        if (not DF.writeDotBB(of)) {
+            setError("Error in function " + DF.getName() + ": " + DF.getError());
+            return false;
+        }
+    }
+
+    return FileUtil::write(of.str(), filename, getError());
+}
@@ -14,6 +14,11 @@ DFnetlist::DFnetlist(const string &name, const string &name_bb) : DFI(new DFnetl
 
 DFnetlist::DFnetlist(const DFnetlist& other) : DFI(new DFnetlist_Impl(*(other.DFI))) {}
 
+bool DFnetlist::setDotReader(const string& reader)
+{
+    return DFnetlist_Impl::setDotReader(reader);
+}
+
 DFnetlist::~DFnetlist()
 {
     delete DFI;
@@ -149,7 +154,7 @@ portID DFnetlist::getPort(blockID block, const string& name) const
     return DFI->getPort(block, name);
 }
 
-const string& DFnetlist::getPortName(portID port, bool full) const
+string DFnetlist::getPortName(portID port, bool full) const
 {
     return DFI->getPortName(port, full);
 }
@@ -194,7 +199,7 @@ void DFnetlist::setPortDelay(portID port, double d)
     DFI->setPortDelay(port, d);
 }
 
-const setPorts& DFnetlist::getPorts(blockID id, PortDirection dir) const
+const blockPorts& DFnetlist::getPorts(blockID id, PortDirection dir) const
 {
     return DFI->getPorts(id, dir);
 }
@@ -389,6 +394,16 @@ bool DFnetlist::writeDotBB(std::ostream &s) {
     return DFI->writeDotBB(s);
 }
 
+bool DFnetlist::writeBinary(const string& filename)
+{
+    return DFI->writeBinary(filename);
+}
+
+size_t DFnetlist::reportMemoryUsage(ostream& s) const
+{
+    return DFI->reportMemoryUsage(s);
+}
+
 bool DFnetlist::writeBasicBlockDot(const string& filename)
 {
     return DFI->writeBasicBlockDot(filename);
@@ -404,6 +419,51 @@ void DFnetlist::setMilpSolver(const string& solver)
     return DFI->setMilpSolver(solver);
 }
 
+void DFnetlist::setMilpJobs(int jobs)
+{
+    return DFI->setMilpJobs(jobs);
+}
+
+void DFnetlist::setMilpBudget(int seconds)
+{
+    return DFI->setMilpBudget(seconds);
+}
+
+bool DFnetlist::analyzeThroughput(vector<ThroughputInfo>& result, bool disjoint)
+{
+    return DFI->analyzeThroughput(result, disjoint);
+}
+
+bool DFnetlist::setCFDFCExtraction(const string& method)
+{
+    return DFI->setCFDFCExtraction(method);
+}
+
+void DFnetlist::setMilpPathPruning(bool enable)
+{
+    return DFI->setMilpPathPruning(enable);
+}
+
+bool DFnetlist::setMilpRelaxation(const string& mode, int polish)
+{
+    return DFI->setMilpRelaxation(mode, polish);
+}
+
+bool DFnetlist::setMilpStart(const string& filename)
+{
+    return DFI->setMilpStart(filename);
+}
+
+bool DFnetlist::setPreviousPlacement(const string& filename, const string& filename_bb)
+{
+    return DFI->setPreviousPlacement(filename, filename_bb);
+}
+
+void DFnetlist::benchmarkGraph(int iterations)
+{
+    DFI->benchmarkGraph(iterations);
+}
+
 bool DFnetlist::addElasticBuffers(double Period, double BufferDelay, bool maxThroughput, double coverage)
 {
     return DFI->addElasticBuffers(Period, BufferDelay, maxThroughput, coverage);
@@ -414,6 +474,18 @@ bool DFnetlist::addElasticBuffersBB_sc(double Period, double BufferDelay, bool m
     return DFI->addElasticBuffersBB_sc(Period, BufferDelay, maxThroughput, coverage, timeout, first_MG);
 }
 
+bool DFnetlist::addElasticBuffersSweep(double minPeriod, double maxPeriod, double step, double BufferDelay,
+                                       int timeout, bool first_MG, const string& prefix)
+{
+    return DFI->addElasticBuffersSweep(minPeriod, maxPeriod, step, BufferDelay, timeout, first_MG, prefix);
+}
+
+bool DFnetlist::addElasticBuffersGreedy(double Period, double BufferDelay, double targetThroughput,
+                                        bool bound, bool asMilpStart)
+{
+    return DFI->addElasticBuffersGreedy(Period, BufferDelay, targetThroughput, bound, asMilpStart);
+}
+
 bool DFnetlist::addElasticBuffersBB(double Period, double BufferDelay, bool maxThroughput, double coverage, int timeout, bool first_MG)
 {
     return DFI->addElasticBuffersBB(Period, BufferDelay, maxThroughput, coverage, timeout, first_MG);
@@ -490,6 +562,22 @@ bool DFlib::writeDot(const std::string& filename)
     return DFLI->writeDot(filename);
 }
 
+bool DFlib::addBB(const std::string& filename)
+{
+    return DFLI->addBB(filename);
+}
+
+bool DFlib::writeDotBB(const std::string& filename)
+{
+    return DFLI->writeDotBB(filename);
+}
+
+bool DFlib::addElasticBuffers(double Period, double BufferDelay, bool set, int timeout,
+                              bool first_MG, int jobs, const std::string& report)
+{
+    return DFLI->addElasticBuffers(Period, BufferDelay, set, timeout, first_MG, jobs, report);
+}
+
 void DFlib::setError(const string& err)
 {
     DFLI->setError(err);
@@ -5,6 +5,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include "IdList.h"
 
 namespace Dataflow
 {
@@ -33,6 +34,7 @@ using listBlocks = std::list<blockID>;
 using vecPorts = std::vector<portID>;
 using setPorts = std::set<portID>;
 using listPorts = std::list<portID>;
+using blockPorts = IdList;      // Ports of a block (sorted, inline storage for a few ports)
 using vecChannels = std::vector<channelID>;
 using setChannels = std::set<channelID>;
 using listChannels = std::list<channelID>;
@@ -77,6 +79,14 @@ enum PortDirection {INPUT_PORTS,
                     ALL_PORTS
                    };
 
+/// Throughput of a marked graph (see DFnetlist::analyzeThroughput).
+struct ThroughputInfo {
+    double throughput;          // Tokens per cycle (between 0 and 1)
+    int tokens;                 // Tokens in the critical cycle
+    int latency;                // Latency in cycles of the critical cycle
+    vecChannels criticalCycle;  // Channels of the critical cycle (empty if no cycle)
+};
+
 class DFnetlist_Impl;
 class DFlib_Impl;
 
@@ -98,7 +108,7 @@ public:
 
     /**
     * @brief Constructor. It reads a netlist from a file.
-    * @param name Filename of the input description.
+    * @param name Filename of the input description (dot or binary).
     */
     DFnetlist(const std::string& name);
 
@@ -115,6 +125,8 @@ public:
    * first file consists of blocks.
    * second file consists of basic blocks.
   * @param file File name of the input descriptions.
+  * @note If the first file is a binary netlist with a BB graph, the
+  * second file is not read.
   */
     DFnetlist(const std::string& name, const std::string& name_bb);
 
@@ -123,12 +135,98 @@ public:
      */
     DFnetlist(const DFnetlist& other);
 
+    /**
+     * @brief Selects the reader of the dot files of the netlists created
+     * afterwards. The native reader does not need graphviz.
+     * @param reader "native" (default) or "cgraph" (only available if
+     * compiled with USE_GRAPHVIZ).
+     * @return True if successful, and false if the reader is not available.
+     */
+    static bool setDotReader(const std::string& reader = "native");
+
     /**
      * @brief Sets the solver for MILP optimization problems.
      * @param solver Name of the solver (usually cbc or glpsol).
      */
     void setMilpSolver(const std::string& solver = "cbc");
 
+    /**
+     * @brief Sets the number of MILP models that can be solved concurrently.
+     * @param jobs Number of parallel jobs (sequential if jobs <= 1).
+     */
+    void setMilpJobs(int jobs = 1);
+
+    /**
+     * @brief Sets a global time budget for all the MILPs of the buffer
+     * placement. Each MILP receives a time limit proportional to its weight
+     * in the objective and the time not used by a MILP is returned to the
+     * pool. The timeout of the buffer placement methods is then ignored.
+     * @param seconds Budget in seconds (no budget if seconds <= 0).
+     */
+    void setMilpBudget(int seconds = -1);
+
+    /**
+     * @brief Sets the use of the LP relaxation for the buffer placement of
+     * very large netlists. The LP relaxation is solved, the buffers are
+     * rounded and repaired until the timing and elasticity constraints hold,
+     * and the result can be polished with a MILP on the fractional channels.
+     * The gap to the LP bound is reported.
+     * @param mode "off", "fallback" (only when the MILP finds no solution)
+     * or "always" (the MILP is not solved).
+     * @param polish Time limit in seconds of the polish (none if <= 0).
+     * @return True if successful, and false otherwise (unknown mode).
+     */
+    bool setMilpRelaxation(const std::string& mode = "off", int polish = 0);
+
+    /**
+     * @brief Sets the method to extract the CFDFCs for the buffer placement.
+     * @param method "milp" (one MILP per CFDFC), "graph" (longest cycles of
+     * the BB graph, without MILPs) or "compare" (both methods, reporting
+     * the CFDFCs with different value and using the MILP).
+     * @return True if successful, and false otherwise (unknown method).
+     */
+    bool setCFDFCExtraction(const std::string& method = "milp");
+
+    /**
+     * @brief Enables the static timing analysis of the path constraints of
+     * the buffer placement. The ports whose longest combinational path fits
+     * in the period have their time fixed and their constraints are removed
+     * from the MILPs. The buffers found are the same.
+     * @param enable True to prune the path constraints (default), false to
+     * keep all of them.
+     */
+    void setMilpPathPruning(bool enable = true);
+
+    /**
+     * @brief Reads the buffers of a previously buffered netlist (e.g. the
+     * _graph_buf.dot file of a previous run) to be used as MIP start of the
+     * buffer placement. Channels are matched by the names of their ports.
+     * @param filename The dot file of the buffered netlist.
+     * @return True if successful, and false otherwise.
+     */
+    bool setMilpStart(const std::string& filename);
+
+    /**
+     * @brief Reads the buffer placement of a previous run (the _graph_buf.dot
+     * and _bbgraph_buf.dot files) for an incremental placement with set
+     * optimization. The disjoint sets of CFDFCs are matched by their BB arcs
+     * and the sets whose blocks, channels, delays and frequencies have not
+     * changed keep their buffers. Only the MILPs of the other sets are solved.
+     * @param filename The dot file of the buffered netlist.
+     * @param filename_bb The dot file of the buffered BB graph.
+     * @return True if successful, and false otherwise.
+     */
+    bool setPreviousPlacement(const std::string& filename, const std::string& filename_bb);
+
+    /**
+     * @brief Measures the time of the most common traversals of the netlist
+     * (ports of the blocks, successors, DFS and SCCs) with the sets of the
+     * blocks and with the CSR snapshot used by the algorithms, and prints
+     * the times and the speedups.
+     * @param iterations Number of repetitions of each traversal.
+     */
+    void benchmarkGraph(int iterations = 10);
+
     /**
      * @brief Checks that the netlist is well-formed.
      * @return True if it is well-formed and false otherwise.
@@ -303,9 +401,9 @@ public:
      * @brief Returns the name of a port.
      * @param port Identifier of the port.
      * @param full If asserted, the full name (block:port) is returned.
-     * @return A string with the name of the port.
+     * @return A string with the name of the port (the full name is built on demand).
      */
-    const std::string& getPortName(portID port, bool full=true) const;
+    std::string getPortName(portID port, bool full=true) const;
 
     /**
      * @brief Returns the type of a port.
@@ -367,9 +465,9 @@ public:
      * @brief Returns the set of ports with a certain direction.
      * @param id Block id (the owner of the ports).
      * @param dir Direction of the ports (input/output/all).
-     * @return The set of ports.
+     * @return The set of ports (in increasing order).
      */
-    const setPorts& getPorts(blockID id, PortDirection dir) const;
+    const blockPorts& getPorts(blockID id, PortDirection dir) const;
 
     /**
      * @param id Block id.
@@ -602,6 +700,21 @@ public:
     bool writeDotBB(std::ostream& s);
     bool writeDotBB(const std::string& filename = "");
 
+    /**
+     * @brief Writes the netlist and its BB graph in binary format. The file
+     * can be given to the constructors instead of the dot files.
+     * @param filename The name of the file.
+     * @return true if successful, and false otherwise.
+     */
+    bool writeBinary(const std::string& filename);
+
+    /**
+     * @brief Writes a report of the memory used by the netlist.
+     * @param s The output stream.
+     * @return The total memory (bytes).
+     */
+    size_t reportMemoryUsage(std::ostream& s) const;
+
     /**
      * @brief Writes the Basic Blocks of the dataflow netlist in dot format.
      * @param filename The name of the file. In case the filename is empty,
@@ -631,6 +744,47 @@ public:
 
     bool addElasticBuffersBB_sc(double Period = 0, double BufferDelay = 0, bool maxThroughput = false, double coverage = 0, int timeout = -1, bool first_MG = false);
 
+    /**
+     * @brief Explores the periods minPeriod, minPeriod + step, ..., maxPeriod
+     * with the model of addElasticBuffersBB (throughput maximization). The MGs
+     * are extracted and the MILP is created only once. For each period, the rhs
+     * of the path constraints are updated and the MILPs are solved concurrently
+     * (see setMilpJobs). A table with the throughput and the buffers of every
+     * period is printed, marking the Pareto-optimal periods. The netlist is not
+     * modified.
+     * @param minPeriod Smallest period.
+     * @param maxPeriod Largest period.
+     * @param step Increment of the period.
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @param timeout Time limit of each MILP in seconds (no limit if <= 0).
+     * @param first_MG If asserted, only the throughput of the first MG is maximized.
+     * @param prefix If not empty, the buffered netlist of each Pareto-optimal period
+     * is written into prefix_p<period>_graph_buf.dot and prefix_p<period>_bbgraph_buf.dot.
+     * @return True if successful, and false otherwise.
+     */
+    bool addElasticBuffersSweep(double minPeriod, double maxPeriod, double step, double BufferDelay = 0,
+                                int timeout = -1, bool first_MG = false, const std::string& prefix = "");
+
+    /**
+     * @brief Greedy buffer placement without MILPs, for netlists too large for
+     * the exact placement. An opaque buffer is inserted in a back channel of
+     * every cycle and, with a static timing analysis, before every violation
+     * of the period. Then, the buffers on the critical cycles of the MGs are
+     * moved to neighbouring channels while the throughput improves. The time
+     * is linear in the size of the netlist for the first two steps.
+     * @param Period Cycle period (ignored if Period <= 0).
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @param targetThroughput The buffers of an MG are not moved once its
+     * throughput reaches this value.
+     * @param bound If asserted, the LP relaxation of the MILP of addElasticBuffersBB
+     * is solved and the gap of the greedy solution is reported.
+     * @param asMilpStart If asserted, the buffers are not annotated in the channels
+     * and become the MIP start of the next buffer placement (see setMilpStart).
+     * @return True if successful, and false otherwise.
+     */
+    bool addElasticBuffersGreedy(double Period = 0, double BufferDelay = 0, double targetThroughput = 1,
+                                 bool bound = true, bool asMilpStart = false);
+
     /**
      * @brief Creates buffers for all those channels annotated with buffers.
      * The information in the channels is deleted.
@@ -683,6 +837,21 @@ public:
      * @return The achieved coverage.
      */
     double extractMarkedGraphs(double coverage);
+
+    /**
+     * @brief Computes the throughput of the extracted marked graphs with
+     * the current buffers, without solving any MILP. The throughput of a
+     * marked graph is the minimum ratio tokens/latency of its cycles
+     * (maximum cycle ratio, Howard's policy iteration). The latency of a
+     * cycle is the latency of its blocks plus its non-transparent buffers
+     * and the tokens are given by the back edges.
+     * @param result Throughput and critical cycle of each marked graph (output).
+     * @param disjoint If asserted, the disjoint marked graphs of the buffer
+     * placement with set optimization (unions of marked graphs) are analyzed.
+     * @return True if successful, and false otherwise (no marked graphs).
+     * @note The marked graphs must be extracted before the buffers are instantiated.
+     */
+    bool analyzeThroughput(std::vector<ThroughputInfo>& result, bool disjoint = false);
 };
 
 class DFlib
@@ -723,6 +892,45 @@ public:
      */
     bool writeDot(const std::string& filename = "");
 
+    /**
+     * @brief Reads the Basic Block graphs of the functions of the library.
+     * The file must contain one graph for each function, in the same order
+     * as the functions of the library.
+     * @param filename Name of the file (dot format).
+     * @return True if successful, and false if an error is produced.
+     */
+    bool addBB(const std::string& filename);
+
+    /**
+     * @brief Writes the Basic Block graphs of the functions in dot format.
+     * @param filename The name of the file. In case the filename is empty,
+     * it is written into cout.
+     * @return true if successful, and false otherwise.
+     */
+    bool writeDotBB(const std::string& filename = "");
+
+    /**
+     * @brief Adds elastic buffers to all the functions of the library and
+     * instantiates them. The functions are independent, so they are buffered
+     * concurrently: each worker has a queue of functions (the largest ones
+     * first) and steals functions from the other queues when its own queue
+     * is empty. Each function uses its own settings (solver, jobs, budget,
+     * etc., see the setters of DFnetlist) and its own MILP models, so the
+     * result of each function is the same as in a sequential execution.
+     * A report with the blocks, channels, buffers, slots, critical path,
+     * throughput of the MGs and time of each function is printed.
+     * @param Period Cycle period.
+     * @param BufferDelay CLK-to-Q delay of the Elastic Buffer.
+     * @param set If asserted, set optimization is used (see addElasticBuffersBB_sc).
+     * @param timeout Time limit of each MILP in seconds (no limit if <= 0).
+     * @param first_MG If asserted, only the throughput of the first MG is maximized.
+     * @param jobs Number of functions buffered concurrently (number of cores if <= 0).
+     * @param report Name of the file where the report is also written (none if empty).
+     * @return True if all the functions were buffered, and false otherwise.
+     */
+    bool addElasticBuffers(double Period, double BufferDelay = 0, bool set = true, int timeout = -1,
+                           bool first_MG = false, int jobs = 0, const std::string& report = "");
+
     /**
      * @brief Sets an error message for the library
      * @param err The error message
@@ -0,0 +1,704 @@
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DotParser.h"
+
+using namespace std;
+
+/*
+ * This file contains a parser of dot files that does not depend on graphviz.
+ * The lexer works on the text mapped in memory: the IDs are pieces of the
+ * text (Key) and only the names and values stored in the graph are copied
+ * (into chunks that are never reallocated). The quoted strings with escapes
+ * or concatenations are built in a buffer.
+ *
+ * The grammar is the one of graphviz, except for the edges with subgraphs
+ * as endpoints, which are not supported.
+ */
+
+static const size_t chunkSize = 1 << 16;
+static const char* emptyString = "";
+
+bool DotGraph::Key::operator==(const Key& k) const
+{
+    return n == k.n and memcmp(s, k.s, n) == 0;
+}
+
+uint64_t DotGraph::hash(const Key& k)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < k.n; ++i) {
+        h ^= (unsigned char) k.s[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void DotGraph::KeyTable::clear()
+{
+    table.assign(16, Entry{0, {nullptr, 0}, -1});
+    count = 0;
+}
+
+int DotGraph::KeyTable::find(const Key& k, uint64_t h) const
+{
+    size_t mask = table.size() - 1;
+    for (size_t i = h & mask; table[i].value >= 0; i = (i + 1) & mask) {
+        if (table[i].hash == h and table[i].key == k) return table[i].value;
+    }
+    return -1;
+}
+
+void DotGraph::KeyTable::insert(const Key& k, uint64_t h, int value)
+{
+    // Load factor below 1/2
+    if (2 * (count + 1) > table.size()) {
+        vector<Entry> old(2 * table.size(), Entry{0, {nullptr, 0}, -1});
+        old.swap(table);
+        size_t mask = table.size() - 1;
+        for (const Entry& e: old) {
+            if (e.value < 0) continue;
+            size_t i = e.hash & mask;
+            while (table[i].value >= 0) i = (i + 1) & mask;
+            table[i] = e;
+        }
+    }
+
+    size_t mask = table.size() - 1;
+    size_t i = h & mask;
+    while (table[i].value >= 0) i = (i + 1) & mask;
+    table[i] = {h, k, value};
+    count++;
+}
+
+DotGraph::DotGraph()
+{
+    clear();
+}
+
+void DotGraph::clear()
+{
+    error.clear();
+    name = emptyString;
+    directed = false;
+    strict = false;
+    nodes.clear();
+    edges.clear();
+    attrPool.clear();
+    graphAttrs = -1;
+    scopes.clear();
+    nodeIds.clear();
+    for (int kind = GRAPH; kind <= EDGE; ++kind) {
+        attrIds[kind].clear();
+        numAttrs[kind] = 0;
+    }
+    strictEdges.clear();
+    chunks.clear();
+    chunkFree = 0;
+    chunkPtr = nullptr;
+}
+
+const char* DotGraph::store(const Key& k)
+{
+    if (k.n + 1 > chunkFree) {
+        size_t size = max(chunkSize, k.n + 1);
+        chunks.emplace_back(new char[size]);
+        chunkPtr = chunks.back().get();
+        chunkFree = size;
+    }
+    char* s = chunkPtr;
+    memcpy(s, k.s, k.n);
+    s[k.n] = '\0';
+    chunkPtr += k.n + 1;
+    chunkFree -= k.n + 1;
+    return s;
+}
+
+bool DotGraph::read(FILE* f)
+{
+    clear();
+    long start = ftell(f);
+    struct stat st;
+    int fd = fileno(f);
+
+    if (start >= 0 and fstat(fd, &st) == 0 and S_ISREG(st.st_mode)) {
+        size_t size = st.st_size;
+        if (start >= size) return false;
+        void* text = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED) {
+            error = "the file could not be mapped in memory.";
+            return false;
+        }
+        madvise(text, size, MADV_SEQUENTIAL);
+        size_t pos = start;
+        bool status = parse((const char*) text, size, pos);
+        munmap(text, size);
+        fseek(f, pos, SEEK_SET);
+        return status;
+    }
+
+    // Streams that cannot be mapped (e.g., pipes): only the text of the
+    // graph is read, so that the next graphs can be read afterwards
+    string text;
+    readGraphText(f, text);
+    size_t pos = 0;
+    return parse(text.data(), text.size(), pos);
+}
+
+void DotGraph::readGraphText(FILE* f, string& text)
+{
+    // The strings and comments are skipped as in the lexer, so that their
+    // braces are not counted. The stream is read up to the brace that
+    // closes the graph (or to the end if the graph is incomplete).
+    enum {NORMAL, QUOTED, HTML, LINE_COMMENT, BLOCK_COMMENT} state = NORMAL;
+    int depth = 0;              // Depth of the braces
+    int html = 0;               // Depth of the <> of an HTML string
+    int prev = '\n';            // Previous character (0 after a string or comment)
+    int c;
+
+    flockfile(f);
+    while ((c = getc_unlocked(f)) != EOF) {
+        text += (char) c;
+        int last = c;
+        switch (state) {
+        case NORMAL:
+            if (c == '"') state = QUOTED;
+            else if (c == '<') {
+                state = HTML;
+                html = 1;
+            } else if (c == '/' and prev == '/') state = LINE_COMMENT;
+            else if (c == '*' and prev == '/') {
+                state = BLOCK_COMMENT;
+                last = 0;
+            } else if (c == '#' and prev == '\n') state = LINE_COMMENT;
+            else if (c == '{') ++depth;
+            else if (c == '}' and --depth == 0) {
+                funlockfile(f);
+                return;
+            }
+            break;
+        case QUOTED:
+            if (c == '\\') {
+                c = getc_unlocked(f);
+                if (c == EOF) break;
+                text += (char) c;
+                last = 0;
+            } else if (c == '"') {
+                state = NORMAL;
+                last = 0;
+            }
+            break;
+        case HTML:
+            if (c == '<') ++html;
+            else if (c == '>' and --html == 0) {
+                state = NORMAL;
+                last = 0;
+            }
+            break;
+        case LINE_COMMENT:
+            if (c == '\n') state = NORMAL;
+            break;
+        case BLOCK_COMMENT:
+            if (c == '/' and prev == '*') {
+                state = NORMAL;
+                last = 0;
+            }
+            break;
+        }
+        prev = last;
+    }
+    funlockfile(f);
+}
+
+bool DotGraph::parse(const char* text, size_t size, size_t& pos)
+{
+    clear();
+    begin = text;
+    end = text + size;
+    cur = text + pos;
+
+    next();
+    if (tok.type == T_END) {
+        pos = size;
+        return false;
+    }
+
+    bool status = parseGraph();
+    pos = status ? cur - begin : size;
+    return status;
+}
+
+/////////////
+//  Lexer  //
+/////////////
+
+static inline bool isIdChar(char c)
+{
+    return isalnum((unsigned char) c) or c == '_' or (unsigned char) c >= 128;
+}
+
+void DotGraph::skipSpaces()
+{
+    while (cur < end) {
+        char c = *cur;
+        if (c == ' ' or c == '\n' or c == '\t' or c == '\r' or c == '\f' or c == '\v') {
+            ++cur;
+        } else if (c == '/' and cur + 1 < end and cur[1] == '/') {
+            while (cur < end and *cur != '\n') ++cur;
+        } else if (c == '/' and cur + 1 < end and cur[1] == '*') {
+            cur += 2;
+            while (cur + 1 < end and not (cur[0] == '*' and cur[1] == '/')) ++cur;
+            cur = min(cur + 2, end);
+        } else if (c == '#' and (cur == begin or cur[-1] == '\n')) {
+            // Preprocessor output
+            while (cur < end and *cur != '\n') ++cur;
+        } else break;
+    }
+}
+
+void DotGraph::next()
+{
+    skipSpaces();
+    tok.pos = cur;
+    tok.quoted = false;
+    if (cur == end) {
+        tok.type = T_END;
+        tok.text = {cur, 0};
+        return;
+    }
+
+    char c = *cur;
+    tok.text = {cur, 1};
+    switch (c) {
+    case '{': tok.type = T_LBRACE; ++cur; return;
+    case '}': tok.type = T_RBRACE; ++cur; return;
+    case '[': tok.type = T_LBRACKET; ++cur; return;
+    case ']': tok.type = T_RBRACKET; ++cur; return;
+    case '=': tok.type = T_EQUAL; ++cur; return;
+    case ';': tok.type = T_SEMICOLON; ++cur; return;
+    case ',': tok.type = T_COMMA; ++cur; return;
+    case ':': tok.type = T_COLON; ++cur; return;
+    case '"': tok.type = lexQuoted() ? T_ID : T_ERROR; return;
+    case '<': tok.type = lexHTML() ? T_ID : T_ERROR; return;
+    case '-':
+        if (cur + 1 < end and (cur[1] == '>' or cur[1] == '-')) {
+            tok.type = T_EDGEOP;
+            tok.text = {cur, 2};
+            cur += 2;
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (c == '-' or c == '.' or isdigit((unsigned char) c)) {
+        tok.type = lexNumeral() ? T_ID : T_ERROR;
+        return;
+    }
+
+    if (isIdChar(c)) {
+        const char* p = cur + 1;
+        while (p < end and isIdChar(*p)) ++p;
+        tok.type = T_ID;
+        tok.text = {cur, size_t(p - cur)};
+        cur = p;
+        return;
+    }
+
+    tok.type = T_ERROR;
+}
+
+bool DotGraph::lexQuoted()
+{
+    // Fast path: no escapes and no concatenation (the text is the ID)
+    bool buffered = false;
+    tok.quoted = true;
+    while (true) {
+        const char* p = cur + 1;
+        const char* s = p;
+        while (p < end and *p != '"') {
+            if (*p == '\\' and p + 1 < end) {
+                if (p[1] == '"' or p[1] == '\n') {
+                    // \" is a quote and \ + newline is a line continuation
+                    if (not buffered) {
+                        escaped.clear();
+                        buffered = true;
+                    }
+                    escaped.append(s, p);
+                    if (p[1] == '"') escaped += '"';
+                    p += 2;
+                    s = p;
+                    continue;
+                }
+                p += 2;
+                continue;
+            }
+            ++p;
+        }
+        if (p >= end) return false;     // Unterminated string
+
+        Key segment = {s, size_t(p - s)};
+        if (buffered) escaped.append(segment.s, segment.n);
+        cur = p + 1;
+
+        // Concatenation of strings ("a" + "b")
+        const char* save = cur;
+        skipSpaces();
+        if (cur < end and *cur == '+') {
+            ++cur;
+            skipSpaces();
+            if (cur < end and *cur == '"') {
+                if (not buffered) {
+                    escaped.assign(tok.pos + 1, segment.s + segment.n);
+                    buffered = true;
+                }
+                continue;
+            }
+            return false;
+        }
+        cur = save;
+
+        if (buffered) tok.text = {escaped.data(), escaped.size()};
+        else tok.text = segment;
+        return true;
+    }
+}
+
+bool DotGraph::lexHTML()
+{
+    int depth = 1;
+    const char* p = cur + 1;
+    while (p < end) {
+        if (*p == '<') ++depth;
+        else if (*p == '>' and --depth == 0) break;
+        ++p;
+    }
+    if (p >= end) return false;
+    tok.quoted = true;
+    tok.text = {cur + 1, size_t(p - cur - 1)};
+    cur = p + 1;
+    return true;
+}
+
+bool DotGraph::lexNumeral()
+{
+    // -?(.[0-9]+ | [0-9]+(.[0-9]*)?)
+    const char* p = cur;
+    if (*p == '-') ++p;
+    const char* digits = p;
+    while (p < end and isdigit((unsigned char) *p)) ++p;
+    bool integer = p > digits;
+    if (p < end and *p == '.') {
+        ++p;
+        const char* frac = p;
+        while (p < end and isdigit((unsigned char) *p)) ++p;
+        if (not integer and p == frac) return false;
+    } else if (not integer) return false;
+
+    // Badly delimited number (e.g., 1e-3 or 2x)
+    if (p < end and (isIdChar(*p) or *p == '.')) return false;
+
+    tok.text = {cur, size_t(p - cur)};
+    cur = p;
+    return true;
+}
+
+bool DotGraph::isKeyword(const char* kw) const
+{
+    if (tok.type != T_ID or tok.quoted) return false;
+    size_t n = strlen(kw);
+    if (tok.text.n != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (tolower((unsigned char) tok.text.s[i]) != kw[i]) return false;
+    }
+    return true;
+}
+
+bool DotGraph::syntaxError()
+{
+    int line = 1;
+    for (const char* p = begin; p < tok.pos; ++p) line += *p == '\n';
+    string near = tok.type == T_END ? "" : string(tok.text.s, tok.text.n);
+    if (tok.type == T_ERROR) near = string(tok.pos, min<size_t>(end - tok.pos, 10));
+    error = "syntax error in line " + to_string(line) + " near '" + near + "'";
+    return false;
+}
+
+//////////////
+//  Parser  //
+//////////////
+
+bool DotGraph::parseGraph()
+{
+    if (isKeyword("strict")) {
+        strict = true;
+        next();
+    }
+
+    if (isKeyword("digraph")) directed = true;
+    else if (not isKeyword("graph")) return syntaxError();
+    next();
+
+    if (tok.type == T_ID) {
+        name = store(tok.text);
+        next();
+    }
+
+    if (tok.type != T_LBRACE) return syntaxError();
+    next();
+
+    scopes.emplace_back();
+    if (not parseStatements()) return false;
+
+    // The edges in the order of cgraph (by tail node)
+    vector<int> first(nodes.size() + 1, 0);
+    for (const Edge& e: edges) first[e.tail + 1]++;
+    for (int v = 0; v < nodes.size(); ++v) first[v + 1] += first[v];
+    vector<Edge> sorted(edges.size());
+    for (const Edge& e: edges) sorted[first[e.tail]++] = e;
+    edges.swap(sorted);
+
+    // The current token is the closing brace (the position is after it)
+    return true;
+}
+
+bool DotGraph::parseStatements()
+{
+    while (tok.type != T_RBRACE) {
+        if (tok.type == T_END) return syntaxError();
+        if (not parseStatement()) return false;
+        if (tok.type == T_SEMICOLON) next();
+    }
+    return true;
+}
+
+bool DotGraph::parseStatement()
+{
+    // Defaults (graph/node/edge [attrs])
+    Kind kind = GRAPH;
+    bool defaults = true;
+    if (isKeyword("graph")) kind = GRAPH;
+    else if (isKeyword("node")) kind = NODE;
+    else if (isKeyword("edge")) kind = EDGE;
+    else defaults = false;
+
+    if (defaults) {
+        next();
+        if (tok.type != T_LBRACKET) return syntaxError();
+        vector<pair<int, const char*>>& attrs = stmtAttrs;
+        attrs.clear();
+        while (tok.type == T_LBRACKET) {
+            if (not parseAttrList(kind, attrs)) return false;
+        }
+        for (auto& a: attrs) {
+            if (kind == GRAPH) {
+                if (scopes.size() == 1) setAttr(graphAttrs, a.first, a.second);
+                continue;
+            }
+            auto& scope = kind == NODE ? scopes.back().node : scopes.back().edge;
+            bool found = false;
+            for (auto& d: scope) {
+                if (d.first == a.first) {
+                    d.second = a.second;
+                    found = true;
+                }
+            }
+            if (not found) scope.push_back(a);
+        }
+        return true;
+    }
+
+    if (isKeyword("subgraph") or tok.type == T_LBRACE) {
+        if (not parseSubgraph()) return false;
+        if (tok.type == T_EDGEOP) {
+            error = "edges with subgraphs are not supported.";
+            return false;
+        }
+        return true;
+    }
+
+    if (tok.type != T_ID) return syntaxError();
+
+    // Graph attribute (ID = ID)
+    const char* save = cur;
+    Token id = tok;
+    next();
+    if (tok.type == T_EQUAL) {
+        int attr = attrId(GRAPH, id.text);
+        next();
+        if (tok.type != T_ID) return syntaxError();
+        const char* value = store(tok.text);
+        if (scopes.size() == 1) setAttr(graphAttrs, attr, value);
+        next();
+        return true;
+    }
+
+    // Node or edge statement (the ID is lexed again, it might be in the buffer)
+    cur = save;
+    tok = id;
+    if (id.text.s == escaped.data()) {
+        cur = id.pos;
+        next();
+    }
+
+    int v;
+    if (not parseNodeId(v)) return false;
+
+    vector<pair<int, const char*>>& attrs = stmtAttrs;
+    attrs.clear();
+    if (tok.type != T_EDGEOP) {
+        while (tok.type == T_LBRACKET) {
+            if (not parseAttrList(NODE, attrs)) return false;
+        }
+        for (auto& a: attrs) setAttr(nodes[v].attrs, a.first, a.second);
+        return true;
+    }
+
+    vector<int> chain(1, v);
+    while (tok.type == T_EDGEOP) {
+        bool arrow = tok.text.s[1] == '>';
+        if (arrow != directed) return syntaxError();
+        next();
+        if (isKeyword("subgraph") or tok.type == T_LBRACE) {
+            error = "edges with subgraphs are not supported.";
+            return false;
+        }
+        if (not parseNodeId(v)) return false;
+        chain.push_back(v);
+    }
+
+    while (tok.type == T_LBRACKET) {
+        if (not parseAttrList(EDGE, attrs)) return false;
+    }
+
+    for (int i = 0; i + 1 < chain.size(); ++i) {
+        int tail = chain[i];
+        int head = chain[i + 1];
+        int e = -1;
+        if (strict) {
+            uint64_t key = directed ? (uint64_t(tail) << 32 | head)
+                                    : (uint64_t(min(tail, head)) << 32 | max(tail, head));
+            auto it = strictEdges.find(key);
+            if (it != strictEdges.end()) e = it->second;
+            else strictEdges[key] = edges.size();
+        }
+        if (e < 0) {
+            e = edges.size();
+            edges.push_back({tail, head, -1});
+            for (auto& d: scopes.back().edge) setAttr(edges[e].attrs, d.first, d.second);
+        }
+        for (auto& a: attrs) setAttr(edges[e].attrs, a.first, a.second);
+    }
+    return true;
+}
+
+bool DotGraph::parseNodeId(int& v)
+{
+    if (tok.type != T_ID) return syntaxError();
+    v = findOrCreateNode(tok.text);
+    next();
+
+    // Ports (node:port:compass) are ignored
+    for (int i = 0; i < 2 and tok.type == T_COLON; ++i) {
+        next();
+        if (tok.type != T_ID) return syntaxError();
+        next();
+    }
+    return true;
+}
+
+bool DotGraph::parseSubgraph()
+{
+    if (isKeyword("subgraph")) {
+        next();
+        if (tok.type == T_ID) next();
+    }
+    if (tok.type != T_LBRACE) return syntaxError();
+    next();
+
+    // The defaults are inherited from the enclosing scope
+    Scope scope = scopes.back();
+    scopes.push_back(scope);
+    if (not parseStatements()) return false;
+    scopes.pop_back();
+    next();
+    return true;
+}
+
+bool DotGraph::parseAttrList(Kind kind, vector<pair<int, const char*>>& attrs)
+{
+    // The current token is '['
+    next();
+    while (tok.type != T_RBRACKET) {
+        if (tok.type != T_ID) return syntaxError();
+        int attr = attrId(kind, tok.text);
+        next();
+        if (tok.type != T_EQUAL) return syntaxError();
+        next();
+        if (tok.type != T_ID) return syntaxError();
+        attrs.emplace_back(attr, store(tok.text));
+        next();
+        if (tok.type == T_SEMICOLON or tok.type == T_COMMA) next();
+    }
+    next();
+    return true;
+}
+
+//////////////////////////////
+//  Nodes and attributes    //
+//////////////////////////////
+
+int DotGraph::findOrCreateNode(const Key& k)
+{
+    uint64_t h = hash(k);
+    int v = nodeIds.find(k, h);
+    if (v >= 0) return v;
+
+    const char* s = store(k);
+    v = nodes.size();
+    nodes.push_back({s, -1});
+    nodeIds.insert(Key{s, k.n}, h, v);
+
+    // Default values of the scope where the node is created
+    for (auto& d: scopes.back().node) setAttr(nodes[v].attrs, d.first, d.second);
+    return v;
+}
+
+int DotGraph::attrId(Kind kind, const Key& k)
+{
+    uint64_t h = hash(k);
+    int id = attrIds[kind].find(k, h);
+    if (id >= 0) return id;
+    id = numAttrs[kind]++;
+    attrIds[kind].insert(Key{store(k), k.n}, h, id);
+    return id;
+}
+
+void DotGraph::setAttr(int& list, int name, const char* value)
+{
+    for (int a = list; a != -1; a = attrPool[a].next) {
+        if (attrPool[a].name == name) {
+            attrPool[a].value = value;
+            return;
+        }
+    }
+    attrPool.push_back({name, value, list});
+    list = attrPool.size() - 1;
+}
+
+const char* DotGraph::getAttr(Kind kind, int list, const char* attr) const
+{
+    Key k = {attr, strlen(attr)};
+    int id = attrIds[kind].find(k, hash(k));
+    if (id < 0) return nullptr;
+
+    for (int a = list; a != -1; a = attrPool[a].next) {
+        if (attrPool[a].name == id) return attrPool[a].value;
+    }
+    return emptyString;
+}
@@ -0,0 +1,329 @@
+#ifndef DOTPARSER_H
+#define DOTPARSER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class DotGraph
+ * @file DotParser.h
+ * @brief Parser of graphs in dot format. It reads the subset of the language
+ * used by the dataflow netlists (nodes, edges, attribute lists, defaults,
+ * subgraphs and graph attributes) without graphviz. The file is mapped in
+ * memory and the tokens are not copied unless they are stored in the graph.
+ * The nodes and the attributes follow the semantics of cgraph:
+ * - The nodes are numbered in order of creation (first appearance).
+ * - The edges are ordered by tail node and then by order of creation
+ *   (the order of agfstout/agnxtout).
+ * - An attribute that has been used by some node (edge) is defined for all
+ *   nodes (edges), with the default value of the scope where the node (edge)
+ *   was created or the empty string. An attribute never used is undefined
+ *   (nullptr).
+ */
+class DotGraph
+{
+public:
+
+    /**
+     * @brief Constructor of an empty graph.
+     */
+    DotGraph();
+
+    /**
+     * @brief Reads the next graph of a file, starting at the current position.
+     * After the call, the file is positioned after the graph, so that several
+     * graphs can be read sequentially. Regular files are mapped in memory, and
+     * the other streams (e.g., pipes) are read up to the end of the graph.
+     * @param f File descriptor.
+     * @return True if successful, and false otherwise. In case there is no
+     * graph in the file, false is returned without an error.
+     */
+    bool read(FILE* f);
+
+    /**
+     * @brief Parses the first graph of a text.
+     * @param text The text.
+     * @param size Size of the text.
+     * @param pos Position where the parsing starts. After the call, it has the
+     * position after the graph.
+     * @return True if successful, and false otherwise (see read).
+     */
+    bool parse(const char* text, size_t size, size_t& pos);
+
+    /**
+     * @return The error message of the last read/parse (empty if no error).
+     */
+    const std::string& getError() const {
+        return error;
+    }
+
+    /**
+     * @return True if the last read/parse had an error.
+     */
+    bool hasError() const {
+        return not error.empty();
+    }
+
+    /**
+     * @return The name of the graph (empty if anonymous).
+     */
+    const char* getName() const {
+        return name;
+    }
+
+    /**
+     * @return True if the graph is directed (digraph).
+     */
+    bool isDirected() const {
+        return directed;
+    }
+
+    /**
+     * @return The number of nodes.
+     */
+    int numNodes() const {
+        return nodes.size();
+    }
+
+    /**
+     * @return The number of edges.
+     */
+    int numEdges() const {
+        return edges.size();
+    }
+
+    /**
+     * @param v The node.
+     * @return The name of the node.
+     */
+    const char* getNodeName(int v) const {
+        return nodes[v].name;
+    }
+
+    /**
+     * @param e The edge.
+     * @return The tail node of the edge.
+     */
+    int getTail(int e) const {
+        return edges[e].tail;
+    }
+
+    /**
+     * @param e The edge.
+     * @return The head node of the edge.
+     */
+    int getHead(int e) const {
+        return edges[e].head;
+    }
+
+    /**
+     * @brief Returns the value of an attribute of a node (as agget).
+     * @param v The node.
+     * @param attr The name of the attribute.
+     * @return The value (nullptr if the attribute is not defined for nodes).
+     */
+    const char* getNodeAttr(int v, const char* attr) const {
+        return getAttr(NODE, nodes[v].attrs, attr);
+    }
+
+    /**
+     * @brief Returns the value of an attribute of an edge (as agget).
+     * @param e The edge.
+     * @param attr The name of the attribute.
+     * @return The value (nullptr if the attribute is not defined for edges).
+     */
+    const char* getEdgeAttr(int e, const char* attr) const {
+        return getAttr(EDGE, edges[e].attrs, attr);
+    }
+
+    /**
+     * @brief Returns the value of an attribute of the graph (as agget).
+     * @param attr The name of the attribute.
+     * @return The value (nullptr if the attribute is not defined for graphs).
+     */
+    const char* getGraphAttr(const char* attr) const {
+        return getAttr(GRAPH, graphAttrs, attr);
+    }
+
+private:
+    enum Kind {GRAPH, NODE, EDGE};
+
+    // String that is not necessarily null-terminated (a piece of the text)
+    struct Key {
+        const char* s;
+        size_t n;
+        bool operator==(const Key& k) const;
+    };
+
+    static uint64_t hash(const Key& k);
+
+    // Map from strings to integers (open addressing, the keys are not copied)
+    class KeyTable {
+    public:
+        void clear();
+        int find(const Key& k, uint64_t h) const;
+        void insert(const Key& k, uint64_t h, int value);
+    private:
+        struct Entry {
+            uint64_t hash;
+            Key key;
+            int value;          // -1 if the entry is empty
+        };
+        std::vector<Entry> table;
+        size_t count = 0;
+    };
+
+    // Value of an attribute of an object (linked list)
+    struct Attr {
+        int name;               // Id of the name of the attribute
+        const char* value;      // Value
+        int next;               // Next attribute of the object (-1 if last)
+    };
+
+    struct Node {
+        const char* name;       // Name of the node
+        int attrs;              // First attribute (-1 if none)
+    };
+
+    struct Edge {
+        int tail;               // Tail node
+        int head;               // Head node
+        int attrs;              // First attribute (-1 if none)
+    };
+
+    // Default values of the attributes in a scope (graph or subgraph)
+    struct Scope {
+        std::vector<std::pair<int, const char*>> node;
+        std::vector<std::pair<int, const char*>> edge;
+    };
+
+    // Tokens of the lexer
+    enum TokenType {T_ID, T_LBRACE, T_RBRACE, T_LBRACKET, T_RBRACKET, T_EQUAL,
+                    T_SEMICOLON, T_COMMA, T_COLON, T_EDGEOP, T_END, T_ERROR};
+
+    struct Token {
+        TokenType type;
+        Key text;               // Text of an ID (without quotes and escapes)
+        bool quoted;            // The ID was a quoted string (not a keyword)
+        const char* pos;        // Position in the text (for errors)
+    };
+
+    const char* begin;          // Text being parsed
+    const char* end;            // End of the text
+    const char* cur;            // Current position of the lexer
+    Token tok;                  // Current token
+    std::string escaped;        // Buffer for IDs with escapes or concatenations
+
+    std::string error;          // Error message
+    const char* name;           // Name of the graph
+    bool directed;              // Is it a digraph?
+    bool strict;                // Is it a strict graph?
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::vector<Attr> attrPool;
+    int graphAttrs;             // First attribute of the graph (-1 if none)
+    std::vector<Scope> scopes;  // Scopes of the defaults (root graph first)
+
+    KeyTable nodeIds;           // Node name -> node
+    KeyTable attrIds[3];        // Attribute name -> id (per kind)
+    int numAttrs[3];            // Number of attributes (per kind)
+    std::unordered_map<uint64_t, int> strictEdges;          // (tail, head) -> edge (strict graphs)
+    std::vector<std::pair<int, const char*>> stmtAttrs;     // Attributes of the current statement
+
+    // Storage of the strings (chunks are never reallocated)
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunkFree;
+    char* chunkPtr;
+
+    void clear();
+    const char* store(const Key& k);
+    static void readGraphText(FILE* f, std::string& text);
+
+    void next();
+    void skipSpaces();
+    bool lexQuoted();
+    bool lexHTML();
+    bool lexNumeral();
+    bool isKeyword(const char* kw) const;
+    bool syntaxError();
+
+    bool parseGraph();
+    bool parseStatements();
+    bool parseStatement();
+    bool parseAttrList(Kind kind, std::vector<std::pair<int, const char*>>& attrs);
+    bool parseSubgraph();
+    bool parseNodeId(int& v);
+
+    int findOrCreateNode(const Key& k);
+    int attrId(Kind kind, const Key& k);
+    void setAttr(int& list, int name, const char* value);
+    const char* getAttr(Kind kind, int list, const char* attr) const;
+};
+
+/**
+ * @class DotAttrs
+ * @file DotParser.h
+ * @brief Attributes of a node, an edge or a graph of a dot file. They can be
+ * obtained from a DotGraph or from an external reader (e.g., graphviz) with
+ * a lookup function with the semantics of agget.
+ */
+class DotAttrs
+{
+public:
+    using Lookup = const char* (*)(void* obj, const char* attr);
+
+    /**
+     * @brief Attributes of a node of a DotGraph.
+     */
+    static DotAttrs node(const DotGraph& G, int v) {
+        return DotAttrs(&G, v, 1);
+    }
+
+    /**
+     * @brief Attributes of an edge of a DotGraph.
+     */
+    static DotAttrs edge(const DotGraph& G, int e) {
+        return DotAttrs(&G, e, 2);
+    }
+
+    /**
+     * @brief Attributes of a DotGraph.
+     */
+    static DotAttrs graph(const DotGraph& G) {
+        return DotAttrs(&G, 0, 0);
+    }
+
+    /**
+     * @brief Attributes of an object of an external reader.
+     * @param lookup Function that returns the value of an attribute of the object.
+     * @param obj The object.
+     */
+    DotAttrs(Lookup lookup, void* obj) : G(nullptr), id(0), kind(0), lookup(lookup), obj(obj) {}
+
+    /**
+     * @param attr Name of the attribute.
+     * @return The value of the attribute (nullptr if undefined).
+     */
+    const char* get(const char* attr) const {
+        if (G == nullptr) return lookup(obj, attr);
+        if (kind == 1) return G->getNodeAttr(id, attr);
+        if (kind == 2) return G->getEdgeAttr(id, attr);
+        return G->getGraphAttr(attr);
+    }
+
+private:
+    DotAttrs(const DotGraph* G, int id, int kind) : G(G), id(id), kind(kind), lookup(nullptr), obj(nullptr) {}
+
+    const DotGraph* G;          // Graph (nullptr for external readers)
+    int id;                     // Node or edge
+    int kind;                   // 0: graph, 1: node, 2: edge
+    Lookup lookup;              // Lookup function of the external reader
+    void* obj;                  // Object of the external reader
+};
+
+#endif // DOTPARSER_H
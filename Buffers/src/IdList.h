@@ -0,0 +1,173 @@
+#ifndef _IDLIST_H__
+#define _IDLIST_H__
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @class IdList
+ * @file IdList.h
+ * @brief Sorted list of distinct identifiers (e.g., the ports of a block).
+ * The first identifiers are stored inside the object and the heap is only
+ * used for longer lists, so that the lists of most blocks do not allocate
+ * memory. The elements are iterated in increasing order, as in std::set.
+ * Insertions and removals take linear time: the lists are meant to be short.
+ */
+class IdList
+{
+public:
+    using const_iterator = const int*;
+
+    /// Number of elements stored inside the object
+    static const int inlineCapacity = 4;
+
+    IdList() {}
+
+    IdList(const IdList& L) {
+        reserve(L.n);
+        std::copy(L.begin(), L.end(), data());
+        n = L.n;
+    }
+
+    IdList(IdList&& L) noexcept {
+        steal(L);
+    }
+
+    ~IdList() {
+        if (onHeap()) delete[] heap;
+    }
+
+    IdList& operator=(const IdList& L) {
+        if (this == &L) return *this;
+        n = 0;
+        reserve(L.n);
+        std::copy(L.begin(), L.end(), data());
+        n = L.n;
+        return *this;
+    }
+
+    IdList& operator=(IdList&& L) noexcept {
+        if (this == &L) return *this;
+        if (onHeap()) delete[] heap;
+        steal(L);
+        return *this;
+    }
+
+    const_iterator begin() const {
+        return data();
+    }
+
+    const_iterator end() const {
+        return data() + n;
+    }
+
+    /**
+     * @return The number of elements.
+     */
+    size_t size() const {
+        return n;
+    }
+
+    /**
+     * @return True if the list is empty, and false otherwise.
+     */
+    bool empty() const {
+        return n == 0;
+    }
+
+    /**
+     * @brief Checks whether an element is in the list.
+     * @param id The element.
+     * @return 1 if the element is in the list, and 0 otherwise.
+     */
+    size_t count(int id) const {
+        return std::binary_search(begin(), end(), id) ? 1 : 0;
+    }
+
+    /**
+     * @brief Inserts an element (nothing is done if it is already in the list).
+     * @param id The element.
+     * @return True if the element has been inserted, and false otherwise.
+     */
+    bool insert(int id) {
+        int* pos = std::lower_bound(data(), data() + n, id);
+        if (pos != data() + n and *pos == id) return false;
+        int i = pos - data();
+        if (n == cap) reserve(2 * cap);
+        int* d = data();
+        std::copy_backward(d + i, d + n, d + n + 1);
+        d[i] = id;
+        n++;
+        return true;
+    }
+
+    /**
+     * @brief Removes an element (nothing is done if it is not in the list).
+     * @param id The element.
+     * @return True if the element has been removed, and false otherwise.
+     */
+    bool erase(int id) {
+        int* d = data();
+        int* pos = std::lower_bound(d, d + n, id);
+        if (pos == d + n or *pos != id) return false;
+        std::copy(pos + 1, d + n, pos);
+        n--;
+        return true;
+    }
+
+    /**
+     * @brief Removes all the elements (the memory in the heap is kept).
+     */
+    void clear() {
+        n = 0;
+    }
+
+    /**
+     * @return The memory used in the heap (bytes).
+     */
+    size_t heapBytes() const {
+        return onHeap() ? cap * sizeof(int) : 0;
+    }
+
+private:
+    int n = 0;                      // Number of elements
+    int cap = inlineCapacity;       // Capacity (in the heap if larger than inlineCapacity)
+    union {
+        int local[inlineCapacity];  // Elements stored inside the object
+        int* heap;                  // Elements stored in the heap
+    };
+
+    bool onHeap() const {
+        return cap > inlineCapacity;
+    }
+
+    int* data() {
+        return onHeap() ? heap : local;
+    }
+
+    const int* data() const {
+        return onHeap() ? heap : local;
+    }
+
+    // Ensures a capacity of at least c elements (keeps the elements)
+    void reserve(int c) {
+        if (c <= cap) return;
+        int* h = new int[c];
+        std::copy(data(), data() + n, h);
+        if (onHeap()) delete[] heap;
+        heap = h;
+        cap = c;
+    }
+
+    // Takes the elements of L, which becomes empty
+    void steal(IdList& L) {
+        n = L.n;
+        cap = L.cap;
+        if (L.onHeap()) heap = L.heap;
+        else std::copy(L.local, L.local + L.n, local);
+        L.n = 0;
+        L.cap = inlineCapacity;
+    }
+};
+
+#endif // _IDLIST_H__
@@ -2,15 +2,45 @@
 #define MILP_MODEL_H
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <utime.h>
+
+#ifdef USE_CBC_LIB
+#include <coin/Cbc_C_Interface.h>
+#endif
+
+#ifdef USE_GLPK_LIB
+#include <glpk.h>
+#endif
 
 using namespace std;
 
@@ -36,6 +66,208 @@ public:
     using vecTerms = vector<Term>;          /// Vector of terms
     using vecVars = vector<int>;            /// Vector of variables
 
+    /**
+     * @brief Sparse snapshot of a normalized model. This is the
+     * representation handed over to the solver backends. Empty rows
+     * are not included. The constraint matrix is stored in compressed
+     * row format: the terms of row r are in [rowStart[r], rowStart[r+1]).
+     */
+    struct SparseModel {
+        bool minimize;              /// Minimization (true) or maximization (false)
+        vector<string> colName;     /// Names of the variables
+        vector<VarType> colType;    /// Types of the variables
+        vector<double> colLower;    /// Lower bounds
+        vector<double> colUpper;    /// Upper bounds (infinity if unbounded)
+        vector<double> objective;   /// Cost coefficient of each variable
+        vector<double> start;       /// MIP start (empty if none, NaN for unspecified variables)
+        vector<string> rowName;     /// Names of the constraints
+        vector<RowType> rowType;    /// Types of the constraints
+        vector<double> rhs;         /// RHS of the constraints
+        vector<int> rowStart;       /// Start of each row (numRows()+1 entries)
+        vector<int> colIndex;       /// Variable of each term
+        vector<double> value;       /// Coefficient of each term
+
+        int numCols() const {
+            return colName.size();
+        }
+
+        int numRows() const {
+            return rowType.size();
+        }
+
+        /**
+         * @brief Converts the matrix into compressed column format.
+         * @param start Start of each column (numCols()+1 entries).
+         * @param index Row of each term.
+         * @param val Coefficient of each term.
+         */
+        template<typename IndexType>
+        void byColumns(vector<IndexType>& start, vector<int>& index, vector<double>& val) const {
+            int nc = numCols();
+            start.assign(nc + 1, 0);
+            for (int k: colIndex) start[k+1]++;
+            for (int j = 0; j < nc; ++j) start[j+1] += start[j];
+            index.resize(colIndex.size());
+            val.resize(colIndex.size());
+            vector<IndexType> next(start.begin(), start.end() - 1);
+            for (int r = 0; r < numRows(); ++r) {
+                for (int k = rowStart[r]; k < rowStart[r+1]; ++k) {
+                    IndexType pos = next[colIndex[k]]++;
+                    index[pos] = r;
+                    val[pos] = value[k];
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Solution returned by a solver backend.
+     */
+    struct Solution {
+        Status status = UNKNOWN;    /// Status of the solution
+        double obj = 0;             /// Value of the cost function
+        vector<double> values;      /// Value of each variable
+        string solver;              /// Backend that found the solution
+        double bound = numeric_limits<double>::quiet_NaN();  /// Best bound of the cost function (NaN if unknown)
+        long nodes = -1;            /// Number of explored nodes (-1 if unknown)
+    };
+
+    /**
+     * @brief Progress of the search of a solver.
+     */
+    struct Progress {
+        double time = 0;            /// Seconds since the beginning of the solve
+        double incumbent = numeric_limits<double>::quiet_NaN();  /// Best solution found (NaN if none)
+        double bound = numeric_limits<double>::quiet_NaN();      /// Best bound (NaN if unknown)
+        long nodes = -1;            /// Number of explored nodes (-1 if unknown)
+    };
+
+    /**
+     * @brief Metrics of a solve.
+     */
+    struct Telemetry {
+        string label;               /// Label of the model (defined by the user)
+        string solver;              /// Backend that solved the model
+        int rawRows = 0;            /// Rows before normalization
+        int rawCols = 0;            /// Columns before normalization
+        int rawTerms = 0;           /// Terms (including the cost function) before normalization
+        int rows = 0;               /// Rows after normalization
+        int cols = 0;               /// Columns after normalization
+        int nnz = 0;                /// Non-zero coefficients after normalization
+        int presolvedRows = -1;     /// Rows after the presolve (-1 if no presolve)
+        int presolvedCols = -1;     /// Columns after the presolve (-1 if no presolve)
+        Status status = UNKNOWN;    /// Status of the solution
+        double obj = numeric_limits<double>::quiet_NaN();    /// Value of the cost function
+        double bound = numeric_limits<double>::quiet_NaN();  /// Best bound
+        double gap = numeric_limits<double>::quiet_NaN();    /// Relative gap between obj and bound
+        long nodes = -1;            /// Number of explored nodes (-1 if unknown)
+        double time = 0;            /// Time of the solve (seconds)
+        double timeFirstFeasible = numeric_limits<double>::quiet_NaN();  /// Time to the first solution
+        bool cached = false;        /// The solution was obtained from the cache
+        vector<Progress> trajectory;    /// Incumbent and bound over time
+    };
+
+    /**
+     * @brief Observer of the solves. The methods can be called concurrently
+     * from different threads when several models are solved in parallel.
+     */
+    class Observer {
+    public:
+        virtual ~Observer() {}
+
+        /**
+         * @brief Called when the solver reports progress (new incumbent or bound).
+         * @param t Metrics of the solve collected so far.
+         * @param p The progress.
+         */
+        virtual void progress(const Telemetry& t, const Progress& p) {}
+
+        /**
+         * @brief Called at the end of each solve.
+         * @param t Metrics of the solve.
+         */
+        virtual void finished(const Telemetry& t) {}
+    };
+
+    /**
+     * @brief Interface of the MILP solvers. A backend receives a sparse
+     * snapshot of the model and returns the solution. New solvers can be
+     * plugged by deriving from this class and calling solve(Backend&).
+     */
+    class Backend {
+    public:
+        virtual ~Backend() {}
+
+        /**
+         * @return The name of the backend.
+         */
+        virtual string name() const = 0;
+
+        /**
+         * @brief Solves a model.
+         * @param model The sparse model.
+         * @param timelimit Time limit in seconds. No limit if <= 0.
+         * @param sol The solution (values has one entry per column).
+         * @param error Error message in case of failure.
+         * @return True if the solver has been executed successfully, and false otherwise.
+         */
+        virtual bool solve(const SparseModel& model, int timelimit, Solution& sol, string& error) = 0;
+
+        /**
+         * @brief Interrupts the execution of solve (called from another thread).
+         * Solve must return as soon as possible, without a valid solution.
+         */
+        virtual void cancel() {}
+
+        /**
+         * @return True if the execution of solve can be interrupted.
+         */
+        virtual bool cancellable() const {
+            return false;
+        }
+
+        /**
+         * @brief Defines the function to be called by the backend when the
+         * search progresses (the time is defined by the caller).
+         * @param callback The function (none if empty).
+         */
+        void setProgressCallback(const function<void(const Progress&)>& callback) {
+            progressCallback = callback;
+        }
+
+    protected:
+
+        /**
+         * @brief Reports the progress of the search (if a callback has been defined).
+         * @param p The progress.
+         */
+        void reportProgress(const Progress& p) const {
+            if (progressCallback) progressCallback(p);
+        }
+
+    private:
+        function<void(const Progress&)> progressCallback;   /// Function to report progress
+    };
+
+    /**
+     * @brief Creates the backend for a solver. The solvers "cbc" and "glpsol"
+     * are executed in-process when the library support has been compiled
+     * (USE_CBC_LIB, USE_GLPK_LIB) and as external processes otherwise.
+     * The solvers "cbc-file" and "glpsol-file" always use the external
+     * executables, exchanging the model through LP files. The solver
+     * "portfolio" runs several backends concurrently (see Milp_PortfolioBackend).
+     * @param solver Name of the solver.
+     * @return The backend (nullptr if the solver is unknown).
+     */
+    static unique_ptr<Backend> createBackend(const string& solver);
+
+    /**
+     * @brief Checks whether a solver can be used.
+     * @param solver Name of the solver.
+     * @return True if available, and false otherwise.
+     */
+    static bool solverAvailable(const string& solver);
+
     /**
      * @brief Default constructor.
      */
@@ -91,6 +323,24 @@ public:
         return Matrix.size();
     }
 
+    /**
+     * @brief Function that names the variables created without name. It
+     * receives the names of the variables (empty for the unnamed ones) and
+     * fills the names it knows.
+     */
+    using VarNamer = function<void(vector<string>& names)>;
+
+    /**
+     * @brief Sets the function that names the unnamed variables. It is only
+     * called when the model is written with names (writeLP), so that the
+     * names are not built for the solvers, which receive compact names.
+     * The variables that remain unnamed are written as x<index>.
+     * @param namer The function (nullptr to remove it).
+     */
+    void setVarNamer(VarNamer namer) {
+        varNamer = namer;
+    }
+
     /**
      * @brief Creates a new real variable.
      * @param name Name of the variable.
@@ -152,7 +402,7 @@ public:
 
     /**
      * @brief Returns the value of a variable.
-     * @param name Name of the variable.
+     * @param name Name of the variable (only for the variables created with a name).
      * @return The value of variable.
      */
     double operator[](const string& name) const {
@@ -179,6 +429,30 @@ public:
         return not isTrue(i);
     }
 
+    /**
+     * @return The current solution (status, cost and values of the variables).
+     */
+    Solution getSolution() const {
+        Solution sol;
+        sol.status = stat;
+        sol.obj = obj;
+        sol.solver = solverUsed;
+        for (const Var& v: Vars) sol.values.push_back(v.value);
+        return sol;
+    }
+
+    /**
+     * @brief Restores a solution obtained with getSolution.
+     * @param sol The solution.
+     */
+    void setSolution(const Solution& sol) {
+        assert (sol.values.size() == Vars.size());
+        stat = sol.status;
+        obj = sol.obj;
+        solverUsed = sol.solver;
+        for (unsigned int i = 0; i < Vars.size(); ++i) Vars[i].value = sol.values[i];
+    }
+
     /**
      * @brief Creates a new row in the constraint matrix.
      * @param type Type of row ('<', '>', '=').
@@ -335,6 +609,49 @@ public:
     }
 
 
+    /**
+     * @brief Defines the initial value of a variable for the MIP start.
+     * The solver uses the values as a first incumbent (only supported
+     * by cbc). Variables without initial value are completed by the solver.
+     * @param varIndex Index of the variable.
+     * @param value Initial value.
+     */
+    void setStartValue(int varIndex, double value) {
+        assert (varIndex >= 0 and varIndex < Vars.size());
+        Vars[varIndex].start = value;
+        hasStart = true;
+    }
+
+    /**
+     * @brief Fixes the value of a variable (lower and upper bounds are
+     * set to the value when the model is handed over to the solver).
+     * @param varIndex Index of the variable.
+     * @param value Value of the variable.
+     */
+    void fixVar(int varIndex, double value) {
+        assert (varIndex >= 0 and varIndex < Vars.size());
+        Vars[varIndex].fixed = value;
+    }
+
+    /**
+     * @brief Releases a variable fixed by fixVar.
+     * @param varIndex Index of the variable.
+     */
+    void unfixVar(int varIndex) {
+        assert (varIndex >= 0 and varIndex < Vars.size());
+        Vars[varIndex].fixed = numeric_limits<double>::quiet_NaN();
+    }
+
+    /**
+     * @brief Solves the LP relaxation of the model in the following calls
+     * to solve: all variables are real (Boolean variables in [0,1]) and the
+     * MIP start is ignored.
+     * @param relax True if the integrality constraints must be relaxed.
+     */
+    void setRelaxation(bool relax = true) {
+        relaxed = relax;
+    }
+
     /**
      * @brief Adds a new term to the cost function.
      * @param coeff Coefficient of the term.
@@ -346,21 +663,13 @@ public:
     }
 
     /**
-     * @brief Write the LP model into a file in CPLEX LP format.
+     * @brief Write the LP model into a file in CPLEX LP format, with the names
+     * of the variables and constraints (the solvers receive compact names).
+     * The unnamed variables are named by the function of setVarNamer.
      * @param filename Name of the file.
      * @return True if successful, and false otherwise.
      */
-    bool writeLP(const string& filename) {
-        ofstream f;
-        f.open(filename);
-        if (not f.is_open()) {
-            setError("Could not open file " + filename + ".");
-            return false;
-        }
-        writeLP(f);
-        f.close();
-        return true;
-    }
+    bool writeLP(const string& filename);
 
     /**
      * @brief Calls the MILP solver.
@@ -368,39 +677,155 @@ public:
      * @return True if successful, and false otherwise.
      */
     bool solve(int timelimit = -1) {
-
-        if (solver != "cbc" and solver != "glpsol") {
+        unique_ptr<Backend> backend = createBackend(solver);
+        if (backend == nullptr) {
             setError("Unkonwn solver " + solver + ".");
             return false;
         }
+        return solve(*backend, timelimit);
+    }
 
-        string exec = "which " + solver + " >/dev/null 2>&1";
-        if (system(exec.c_str())) {
-            setError("Solver " + solver + " is not available.");
-            return false;
-        }
+    /**
+     * @brief Solves the model with a specific backend.
+     * @param backend The solver backend.
+     * @param timelimit Time limit in seconds. No limit if <= 0.
+     * @return True if successful, and false otherwise.
+     */
+    bool solve(Backend& backend, int timelimit = -1);
 
-        // The solver seems to be working. Let us solve the MILP model.
-        string lpfile = createTempFilename("MILP_lpmodel", ".lp");
-        string outfile = createTempFilename("MILP_solution", ".gsol");
-        string command = writeCommand(solver, lpfile, outfile, timelimit) + " >/dev/null 2>&1";
-        writeLP(lpfile);
+    /**
+     * @brief Enables the on-disk cache of solutions, shared by all models.
+     * Before calling the solver, the solution is searched in the cache using
+     * a hash of the normalized model. When the size of the cache exceeds the
+     * limit, the least recently used solutions are removed.
+     * @param dir Directory of the cache (the cache is disabled if empty).
+     * @param maxBytes Maximum size of the cache in bytes.
+     */
+    static void setCache(const string& dir, long long maxBytes = 256LL << 20);
 
-        int status = system(command.c_str());
+    /**
+     * @brief Defines the observer of all solves (e.g. Milp_TelemetryLog).
+     * @param observer The observer (none if nullptr). It is not owned by the models.
+     */
+    static void setObserver(Observer* observer) {
+        observerPtr() = observer;
+    }
 
-        if (status != 0) {
-            deleteTempFilename(outfile);
-            setError("Error when executing " + solver + ".");
-            return false;
+    /**
+     * @brief Defines a label to identify the model in the telemetry.
+     * @param l The label.
+     */
+    void setLabel(const string& l) {
+        label = l;
+    }
+
+    /**
+     * @return The metrics of the last solve.
+     */
+    const Telemetry& getTelemetry() const {
+        return telemetry;
+    }
+
+    /**
+     * @brief Enables the presolve for all models. Before calling the solver,
+     * the model is reduced (singleton rows, duplicate rows, redundant rows and
+     * fixed variables) and the solution is mapped back to the original model.
+     * @param enable True if the presolve must be applied.
+     */
+    static void setPresolve(bool enable = true) {
+        presolveFlag() = enable;
+    }
+
+    /**
+     * @return The statistics of the presolve of the last solve (empty if
+     * no presolve has been applied).
+     */
+    const string& getPresolveReport() const {
+        return presolveReport;
+    }
+
+    /**
+     * @brief Bypasses the cache of solutions for this model.
+     * @param bypass True if the cache must not be used.
+     */
+    void bypassCache(bool bypass = true) {
+        noCache = bypass;
+    }
+
+    /**
+     * @return True if the last solution was obtained from the cache.
+     */
+    bool isCachedSolution() const {
+        return cachedSolution;
+    }
+
+    /**
+     * @return The name of the backend that found the last solution
+     * (the winner in the case of a portfolio).
+     */
+    const string& getSolverUsed() const {
+        return solverUsed;
+    }
+
+    /**
+     * @brief Normalizes the model and generates its sparse representation.
+     * @param model The sparse model (output).
+     */
+    void getSparseModel(SparseModel& model) {
+        normalize();
+        const double inf = numeric_limits<double>::infinity();
+
+        int nc = Vars.size();
+        model.minimize = MinMax;
+        model.colName.resize(nc);
+        model.colType.resize(nc);
+        model.colLower.resize(nc);
+        model.colUpper.resize(nc);
+        for (int i = 0; i < nc; ++i) {
+            const Var& v = Vars[i];
+            model.colName[i] = v.name;
+            model.colType[i] = relaxed ? REAL : v.type;
+            if (not std::isnan(v.fixed)) {
+                model.colLower[i] = model.colUpper[i] = v.fixed;
+            } else if (v.type == BOOLEAN) {
+                model.colLower[i] = 0;
+                model.colUpper[i] = 1;
+            } else if (v.lower_bound <= v.upper_bound) {
+                model.colLower[i] = v.lower_bound;
+                model.colUpper[i] = v.upper_bound;
+            } else {
+                // Unbounded variables are non-negative (as in the LP format)
+                model.colLower[i] = 0;
+                model.colUpper[i] = inf;
+            }
         }
 
-        if (solver == "cbc") readCbcSolution(outfile);
-        else if (solver == "glpsol") readGlpsolSolution(outfile);
-        else assert(false);
+        model.objective.assign(nc, 0.0);
+        for (const Term& t: Cost) model.objective[t.second] += t.first;
 
-        deleteTempFilename(lpfile);
-        deleteTempFilename(outfile);
-        return true;
+        model.start.clear();
+        if (hasStart and not relaxed) {
+            model.start.resize(nc);
+            for (int i = 0; i < nc; ++i) model.start[i] = Vars[i].start;
+        }
+
+        model.rowName.clear();
+        model.rowType.clear();
+        model.rhs.clear();
+        model.rowStart.assign(1, 0);
+        model.colIndex.clear();
+        model.value.clear();
+        for (const Row& r: Matrix) {
+            if (r.vecRow.empty()) continue;
+            model.rowName.push_back(r.name);
+            model.rowType.push_back(r.type);
+            model.rhs.push_back(r.rhs);
+            for (const Term& t: r.vecRow) {
+                model.colIndex.push_back(t.second);
+                model.value.push_back(t.first);
+            }
+            model.rowStart.push_back(model.colIndex.size());
+        }
     }
 
     /**
@@ -412,14 +837,21 @@ public:
         MinMax=true;
         epsilon=10e-10;
         numRealVars=numIntegerVars=numBooleanVars=0;
-        numEmptyRows = 0;
-        numUsedVars = 0;
         stat=UNKNOWN;
+        hasStart = false;
+        relaxed = false;
+        noCache = false;
+        cachedSolution = false;
+        solverUsed = "";
+        presolveReport = "";
+        label = "";
+        telemetry = Telemetry();
         errorMsg = "";
         Cost.clear();
         Vars.clear();
         Matrix.clear();
         Name2Var.clear();
+        varNamer = nullptr;
         return find_solver(solver);
     }
 
@@ -431,6 +863,8 @@ private:
         double lower_bound;
         double upper_bound; // unbounded if upper_bound < lower_bound
         double value;
+        double start;       // initial value for the MIP start (NaN if undefined)
+        double fixed;       // fixed value (NaN if not fixed)
     };
 
     struct Row {
@@ -445,52 +879,57 @@ private:
     vecTerms Cost;      /// Cost function
     vector<Var> Vars;   /// List of variables (columns)
     vector<Row> Matrix; /// Matrix of constraints
-    int numEmptyRows;   /// Number of empty rows in the matrix
-    vector<int>appearanceOrder; /// Vector to store the indices in order of appearance
-    vector<bool>appeared;       /// Variables already appeared
-    int numUsedVars;            /// Number of used variables
     double epsilon;     /// Epsilon to be considered as zero
     int numRealVars;
     int numIntegerVars;
     int numBooleanVars;
-    map<string, int> Name2Var;  /// Mapping from var names to var indices
+    unordered_map<string, int> Name2Var;  /// Mapping from var names to var indices (named vars)
+    VarNamer varNamer;  /// Names of the unnamed variables (for writeLP)
     Status stat;        /// Status of the solution
     double obj;        /// Value of the cost function
+    bool hasStart;      /// Some variable has an initial value (MIP start)
+    bool relaxed;       /// The LP relaxation is solved instead of the MILP
+    bool noCache;       /// The cache of solutions is bypassed
+    bool cachedSolution; /// The last solution was obtained from the cache
+    string solverUsed;  /// Backend that found the last solution
+    string presolveReport; /// Statistics of the last presolve
+    string label;       /// Label of the model for the telemetry
+    Telemetry telemetry;    /// Metrics of the last solve
     string errorMsg;    /// Error message in case an error is produced.
 
+    /**
+     * @return The flag that enables the presolve (shared by all models).
+     */
+    static atomic<bool>& presolveFlag();
+
+    /**
+     * @return The observer of the solves (shared by all models).
+     */
+    static atomic<Observer*>& observerPtr();
+
     bool find_solver(const string& s) {
 
-        if (not s.empty() and s != "cbc" and s != "glpsol") {
-            setError("Unkonwn solver " + solver + ".");
+        if (not s.empty() and s != "cbc" and s != "glpsol" and
+            s != "cbc-file" and s != "glpsol-file" and s != "portfolio") {
+            setError("Unkonwn solver " + s + ".");
             return false;
         }
 
-        // First try cbc
-        if (s.empty() or s == "cbc") {
-            string exec = "which cbc >/dev/null 2>&1";
-            if (system(exec.c_str()) == 0) {
-                solver = "cbc";
+        if (not s.empty()) {
+            if (solverAvailable(s)) {
+                solver = s;
                 return true;
             }
-
-            if (s == "cbc") {
-                setError("MILP solver cbc not found.");
-                return false;
-            }
+            setError("MILP solver " + s + " not found.");
+            return false;
         }
 
-        // Next try glpsol
-        if (s.empty() or s == "glpsol") {
-            string exec = "which glpsol >/dev/null 2>&1";
-            if (system(exec.c_str()) == 0) {
-                solver = "glpsol";
+        // First try cbc, next try glpsol
+        for (const char* name: {"cbc", "glpsol"}) {
+            if (solverAvailable(name)) {
+                solver = name;
                 return true;
             }
-
-            if (s == "glpsol") {
-                setError("MILP solver glpsol not found.");
-                return false;
-            }
         }
 
         // No more solvers for the moment
@@ -500,20 +939,23 @@ private:
 
     /**
      * @brief Creates a new variables and returns its index.
-     * @param name Name of the variable.
+     * @param name Name of the variable (empty if unnamed).
      * @param type Type of the variable (real, Integer or Boolean).
      * @param lower_bound Lower bound for the variable.
      * @param upper_bound Upper bound for the variable.
      * @return The index of the variable (-1 if error).
      */
     int newVar(const string& name, VarType type, double lower_bound, double upper_bound) {
-        string n = name.empty() ? "x" + to_string(Vars.size()) : name;
-        if (Name2Var.count(n) > 0) {
-            setError("Variable " + n + " multiply defined.");
-            return -1;
+        // The unnamed variables are only named when the model is written (writeLP)
+        if (not name.empty()) {
+            if (Name2Var.count(name) > 0) {
+                setError("Variable " + name + " multiply defined.");
+                return -1;
+            }
+            Name2Var[name] = Vars.size();
         }
-        Name2Var[n] = Vars.size();
-        Vars.push_back(Var {n, type, lower_bound, upper_bound, 0});
+        Vars.push_back(Var {name, type, lower_bound, upper_bound, 0, numeric_limits<double>::quiet_NaN(),
+                           numeric_limits<double>::quiet_NaN()});
         if (type == REAL) numRealVars++;
         else if (type == INTEGER) numIntegerVars++;
         else numBooleanVars++;
@@ -561,244 +1003,766 @@ private:
         }
         r.resize(k);
     }
+};
+
+/**
+ * @class Milp_FileBackend
+ * @brief Backend that executes cbc or glpsol as external processes.
+ * The model is written in CPLEX LP format into a temporary file and
+ * the solution is read back from the file generated by the solver.
+ */
+class Milp_FileBackend : public Milp_Model::Backend
+{
+public:
+
+    using SparseModel = Milp_Model::SparseModel;
+    using Solution = Milp_Model::Solution;
 
     /**
-     * @brief Writes the terms of a linear constraint to f.
-     * @param f The output stream.
-     * @param terms The vector of terms.
+     * @brief Constructor.
+     * @param solver Name of the executable (cbc or glpsol).
+     * @param options Additional options for the solver (e.g. "preprocess off" for cbc).
      */
-    void writeTerms(ofstream& f, const vecTerms& terms) {
-        assert (terms.size() > 0);
-        double coeff = terms[0].first;
-        if (abs(coeff) != 1.0) f << coeff << ' ';
-        else if (coeff < 0) f << '-';
-        int idx = terms[0].second;
-        f << Vars[idx].name;
-        if (not appeared[idx]) {
-            appearanceOrder.push_back(idx);
-            appeared[idx] = true;
-        }
+    Milp_FileBackend(const string& solver, const string& options = "") :
+        solver(solver), options(options) {}
 
-        for (unsigned int i = 1; i < terms.size(); ++i) {
-            coeff = terms[i].first;
-            f << ' ' << (coeff < 0 ? '-' : '+') << ' ';
-            if (abs(coeff) != 1) f << abs(coeff) << ' ';
-            idx = terms[i].second;
-            f << Vars[idx].name;
-            if (not appeared[idx]) {
-                appearanceOrder.push_back(idx);
-                appeared[idx] = true;
-            }
-        }
+    string name() const override {
+        return solver + "-file" + (options.empty() ? "" : " [" + options + "]");
     }
 
-    /**
-     * @brief Writes a row of the constraint matrix into the output stream.
-     * @param f The output stream.
-     * @param r A reference to the row.
-     */
-    void writeRow(ofstream& f, const Row& r) {
-        if (r.vecRow.empty()) {
-            ++numEmptyRows;
-            return;
-        }
-        f << "  ";
-        if (not r.name.empty()) f << r.name << ": ";
-        writeTerms(f, r.vecRow);
-        if (r.type == EQ) f << " = ";
-        else if (r.type == GEQ) f << " >= ";
-        else f << " <= ";
-        f << r.rhs << endl;
+    void cancel() override {
+        cancelled = true;
+    }
+
+    bool cancellable() const override {
+        return true;
     }
 
     /**
-     * @brief Writes the model into an output stream in CPLEX LP format.
-     * @param f The output stream.
+     * @brief Checks whether the executable of a solver is in the path.
+     * @param solver Name of the executable.
+     * @return True if found, and false otherwise.
      */
-    void writeLP(ofstream& f) {
-        normalize();
-        appearanceOrder.clear();
-        appeared = vector<bool>(Vars.size(), false);
-
-        // Cost function: if no cost, create a fake cost function
-        if (Cost.empty()) newCostTerm(0, 0);
+    static bool available(const string& solver) {
+        string exec = "which " + solver + " >/dev/null 2>&1";
+        return system(exec.c_str()) == 0;
+    }
 
-        // Cost function
-        f << (MinMax ? "Minimize" : "Maximize") << endl;
-        f << "  ";
-        writeTerms(f, Cost);
-        f << endl;
+    bool solve(const SparseModel& model, int timelimit, Solution& sol, string& error) override {
 
-        f << "Subject to" << endl;
-        for (const Row& r: Matrix) writeRow(f, r);
+        if (not available(solver)) {
+            error = "Solver " + solver + " is not available.";
+            return false;
+        }
 
-        numUsedVars = 0;
-        for (bool b: appeared) if (b) ++numUsedVars;
+        // The solver seems to be working. Let us solve the MILP model.
+        string lpfile = createTempFilename("MILP_lpmodel", ".lp");
+        string outfile = createTempFilename("MILP_solution", ".gsol");
 
-        bool need_bounds = false;
-        for (const Var& v: Vars) {
-            if (v.type != BOOLEAN and v.lower_bound <= v.upper_bound) {
-                need_bounds = true;
-                break;
-            }
+        // glpsol has no option to read a MIP start
+        string startfile;
+        if (solver == "cbc" and not model.start.empty()) {
+            startfile = createTempFilename("MILP_start", ".sol");
         }
 
-        if (need_bounds) {
-            f << "Bounds" << endl;
-            for (const Var& v: Vars) {
-                if (v.type != BOOLEAN and v.lower_bound <= v.upper_bound) {
-                    f << "  " << v.lower_bound << " <= " << v.name << " <= " << v.upper_bound << endl;
-                }
-            }
+        // The output of the solver is parsed to report the progress
+        string logfile = createTempFilename("MILP_log", ".log");
+        string command = writeCommand(lpfile, outfile, startfile, timelimit) + " >" + logfile + " 2>&1";
+        if (not writeLP(model, lpfile, false) or
+            (not startfile.empty() and not writeStart(model, startfile))) {
+            deleteTempFilename(lpfile);
+            deleteTempFilename(outfile);
+            deleteTempFilename(logfile);
+            if (not startfile.empty()) deleteTempFilename(startfile);
+            error = "Could not write the model of " + solver + ".";
+            return false;
         }
 
-        if (numIntegerVars > 0) {
-            f << "General" << endl << ' ';
-            for (const Var& v: Vars) {
-                if (v.type == INTEGER) f << ' ' << v.name;
-            }
-            f << endl;
-        }
+        LogParser log(logfile, solver == "cbc", model.minimize);
+        int status = runCommand(command, [&]() {
+            if (log.update()) reportProgress(log.getProgress());
+        });
+        if (log.update()) reportProgress(log.getProgress());
+        deleteTempFilename(logfile);
+        if (not startfile.empty()) deleteTempFilename(startfile);
 
-        if (numBooleanVars > 0) {
-            f << "Binary" << endl << ' ';
-            for (const Var& v: Vars) {
-                if (v.type == BOOLEAN) f << ' ' << v.name;
-            }
-            f << endl;
+        if (status != 0) {
+            deleteTempFilename(lpfile);
+            deleteTempFilename(outfile);
+            if (cancelled) error = "Execution of " + solver + " cancelled.";
+            else error = "Error when executing " + solver + ".";
+            return false;
         }
 
-        f << "End" << endl;
+        sol.values.assign(model.numCols(), 0.0);
+        bool ok;
+        if (solver == "cbc") ok = readCbcSolution(model, outfile, sol);
+        else ok = readGlpsolSolution(model, outfile, sol);
+        sol.bound = log.getProgress().bound;
+        sol.nodes = log.getProgress().nodes;
+
+        deleteTempFilename(lpfile);
+        deleteTempFilename(outfile);
+        if (not ok) error = "Could not read the solution of " + solver + ".";
+        return ok;
     }
 
     /**
-     * @brief Reads a line from an ifstream and puts all strings in a vector.
-     * @param f The input stream.
-     * @param values The vector of strings.
-     * @return The number of items read from the stream.
+     * @brief Writes the model into a file in CPLEX LP format.
+     * @param model The sparse model.
+     * @param filename Name of the file.
+     * @param names Indicates whether the names of the model must be used. Otherwise,
+     * compact names are generated from the indices (x<i> for columns, no row names).
+     * @return True if successful, and false otherwise.
      */
-    static int readLine(ifstream& f, vector<string>& items) {
-        string line;
-        getline(f, line);
-        istringstream myStream(line);
-        items.clear();
-        string s;
-        while (myStream >> s) items.push_back(s);
-        return items.size();
+    bool writeLP(const SparseModel& model, const string& filename, bool names = true) {
+        LpBuffer buf(estimateLPSize(model, names));
+        writeLP(buf, model, names);
+        return buf.write(filename);
     }
 
     /**
-     * @brief Reads a solution from the command gsolu of Cbc.
+     * @brief Writes the MIP start in the format read by the command mipstart of cbc
+     * (one line "index name value" per variable with an initial value).
+     * The compact names of the variables are used.
+     * @param model The sparse model.
      * @param filename Name of the file.
-     * @return True if the file has be successfully read, and false otherwise.
+     * @return True if successful, and false otherwise.
      */
-    bool readCbcSolution(const string& filename) {
-        ifstream f;
-        f.open(filename);
-        if (not f.is_open()) return false;
+    static bool writeStart(const SparseModel& model, const string& filename) {
+        LpBuffer buf(32 * model.numCols());
+        for (int i = 0; i < model.numCols(); ++i) {
+            if (std::isnan(model.start[i])) continue;
+            buf.putInt(i);
+            buf.put(' ');
+            buf.putVar(model, i, false);
+            buf.put(' ');
+            buf.putDouble(model.start[i]);
+            buf.put('\n');
+        }
+        return buf.write(filename);
+    }
 
-        vector<string> values;
-        int nv = readLine(f, values);
-        assert(nv == 2);
+private:
 
-        int nrows = stoi(values[0]);
-        int ncols = stoi(values[1]);
+    /**
+     * @brief Output buffer to format LP files. The file is written in a single
+     * system call. The numbers are written with the shortest representation
+     * that reads back to the same value (integers without exponent).
+     */
+    class LpBuffer
+    {
+    public:
+        LpBuffer(size_t size) {
+            buf.reserve(size);
+        }
 
-        assert (nrows == Matrix.size() - numEmptyRows + 1);
-        assert (ncols == numUsedVars);
+        void put(char c) {
+            buf.push_back(c);
+        }
 
-        // This is a tricky function that has to deal with the
-        // fact that cbc sometimes puts three values per line
-        // and sometimes only one (possibly when MILP model).
-        nv = readLine(f, values);
+        void put(const char* s) {
+            buf.append(s);
+        }
 
-        int st = stoi(values[0]);
-        switch (st) {
-        case 1:
-            stat = UNBOUNDED;
-            break;
-        case 2:
-            stat = NONOPTIMAL;
-            break;
-        case 4:
-            stat = UNFEASIBLE;
-            break;
-        case 5:
-            stat = OPTIMAL;
-            break;
-        default:
-            assert(false);
+        void put(const string& s) {
+            buf.append(s);
         }
 
-        if (stat != OPTIMAL and stat != NONOPTIMAL) {
-            f.close();
-            return true;
+        void putInt(long long v) {
+            char tmp[24];
+            char* p = tmp + sizeof(tmp);
+            bool neg = v < 0;
+            unsigned long long u = neg ? -(unsigned long long) v : v;
+            do {
+                *--p = '0' + u % 10;
+                u /= 10;
+            } while (u > 0);
+            if (neg) *--p = '-';
+            buf.append(p, tmp + sizeof(tmp) - p);
         }
 
-        obj = stod(values.back());
-        if (not MinMax) obj = -obj;
+        void putDouble(double v) {
+            if (v == std::trunc(v) and std::abs(v) < 1e15) {
+                putInt((long long) v);
+                return;
+            }
+            char tmp[32];
+            int n = snprintf(tmp, sizeof(tmp), "%.15g", v);
+            if (strtod(tmp, nullptr) != v) n = snprintf(tmp, sizeof(tmp), "%.17g", v);
+            buf.append(tmp, n);
+        }
 
-        // Skip the value of the rows
-        for (unsigned int i = 0; i < nrows; ++i) readLine(f, values);
+        /**
+         * @brief Writes the name of a variable (the model name or x<index>).
+         */
+        void putVar(const SparseModel& model, int i, bool names) {
+            if (names and not model.colName[i].empty()) {
+                buf.append(model.colName[i]);
+            } else {
+                buf.push_back('x');
+                putInt(i);
+            }
+        }
 
-        // Read the variables
-        for (unsigned int i = 0; i < ncols; ++i) {
-            nv = readLine(f, values);
-            int loc = nv > 1 ? 1 : 0;
-            Vars[appearanceOrder[i]].value = stod(values[loc]);
+        /**
+         * @brief Writes the contents of the buffer into a file.
+         * @return True if successful, and false otherwise.
+         */
+        bool write(const string& filename) const {
+            int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) return false;
+            const char* p = buf.data();
+            size_t left = buf.size();
+            while (left > 0) {
+                ssize_t n = ::write(fd, p, left);
+                if (n < 0 and errno == EINTR) continue;
+                if (n <= 0) {
+                    ::close(fd);
+                    return false;
+                }
+                p += n;
+                left -= n;
+            }
+            return ::close(fd) == 0;
+        }
+
+    private:
+        string buf;
+    };
+
+    /**
+     * @brief Read-only view of a file mapped in memory, with a tokenizer
+     * of whitespace-separated items per line.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile(const string& filename) {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat st;
+            if (fstat(fd, &st) == 0) {
+                size = st.st_size;
+                if (size == 0) ok = true;
+                else {
+                    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p != MAP_FAILED) {
+                        data = static_cast<const char*>(p);
+                        ok = true;
+                    }
+                }
+            }
+            ::close(fd);
+            cur = data;
+        }
+
+        ~MappedFile() {
+            if (data != nullptr) munmap(const_cast<char*>(data), size);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @return True if the file has been successfully mapped.
+         */
+        bool isOpen() const {
+            return ok;
+        }
+
+        /**
+         * @brief Reads the next line and splits it into items (pointers to
+         * the beginning of each item in the file).
+         * @param items The items of the line (output).
+         * @return The number of items of the line (-1 at the end of file).
+         */
+        int readLine(vector<const char*>& items) {
+            items.clear();
+            const char* end = data + size;
+            if (cur >= end) return -1;
+            while (cur < end and *cur != '\n') {
+                while (cur < end and (*cur == ' ' or *cur == '\t' or *cur == '\r')) ++cur;
+                if (cur == end or *cur == '\n') break;
+                items.push_back(cur);
+                while (cur < end and not isspace((unsigned char) *cur)) ++cur;
+            }
+            if (cur < end) ++cur;
+            return items.size();
+        }
+
+        /**
+         * @brief Converts an item of a line into a number.
+         * @param item Pointer to the item (obtained from readLine).
+         * @return The value of the item.
+         */
+        double toDouble(const char* item) const {
+            char tmp[64];
+            return strtod(copyItem(item, tmp, sizeof(tmp)), nullptr);
+        }
+
+        long toInt(const char* item) const {
+            char tmp[64];
+            return strtol(copyItem(item, tmp, sizeof(tmp)), nullptr, 10);
+        }
+
+    private:
+        /**
+         * @brief Copies an item into a null-terminated buffer (the mapping
+         * is not null-terminated).
+         */
+        const char* copyItem(const char* item, char* tmp, size_t n) const {
+            const char* end = data + size;
+            size_t i = 0;
+            while (i + 1 < n and item < end and not isspace((unsigned char) *item)) tmp[i++] = *item++;
+            tmp[i] = '\0';
+            return tmp;
+        }
+
+        const char* data = nullptr;     /// Beginning of the mapping
+        const char* cur = nullptr;      /// Current position
+        size_t size = 0;                /// Size of the file
+        bool ok = false;                /// The file is mapped
+    };
+
+    static const int PollPeriod = 50;   /// Iterations (of 2ms) between polls of the log
+
+    /**
+     * @brief Incremental parser of the output of the solvers. It extracts
+     * the incumbent, the bound and the number of nodes from the log lines
+     * of cbc (Cbc0004I, Cbc0010I, Cbc0012I, Cbc0001I) and glpsol ("mip =").
+     */
+    class LogParser
+    {
+    public:
+        LogParser(const string& filename, bool cbc, bool minimize) :
+            filename(filename), cbc(cbc), minimize(minimize) {}
+
+        /**
+         * @brief Reads the new lines of the log.
+         * @return True if the progress has changed.
+         */
+        bool update() {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            bool changed = false;
+            char buf[4096];
+            ssize_t n;
+            while ((n = pread(fd, buf, sizeof(buf), offset)) > 0) {
+                offset += n;
+                for (ssize_t i = 0; i < n; ++i) {
+                    if (buf[i] != '\n') {
+                        line.push_back(buf[i]);
+                        continue;
+                    }
+                    if (parseLine()) changed = true;
+                    line.clear();
+                }
+            }
+            ::close(fd);
+            return changed;
+        }
+
+        /**
+         * @return The last progress found in the log (time not defined).
+         */
+        const Milp_Model::Progress& getProgress() const {
+            return progress;
+        }
+
+    private:
+        string filename;        /// Name of the log file
+        bool cbc;               /// Log of cbc (true) or glpsol (false)
+        bool minimize;          /// Direction of the cost function
+        off_t offset = 0;       /// Bytes already read
+        string line;            /// Current line
+        Milp_Model::Progress progress;
+
+        /**
+         * @brief Reads the number after a pattern of the line.
+         * @return True if the pattern is found and followed by a number.
+         */
+        bool numberAfter(const char* pattern, double& v, size_t from = 0) const {
+            size_t pos = line.find(pattern, from);
+            if (pos == string::npos) return false;
+            const char* p = line.c_str() + pos + strlen(pattern);
+            char* end;
+            v = strtod(p, &end);
+            return end != p;
+        }
+
+        /**
+         * @brief Reads the number before a pattern of the line (e.g. "15 nodes").
+         */
+        bool numberBefore(const char* pattern, double& v) const {
+            size_t pos = line.find(pattern);
+            if (pos == string::npos) return false;
+            size_t start = line.find_last_of(' ', pos > 0 ? pos - 1 : 0);
+            start = start == string::npos ? 0 : start + 1;
+            const char* p = line.c_str() + start;
+            char* end;
+            v = strtod(p, &end);
+            return end != p;
+        }
+
+        bool parseLine() {
+            Milp_Model::Progress old = progress;
+            if (cbc) parseCbc();
+            else parseGlpsol();
+            return not same(old.incumbent, progress.incumbent) or
+                   not same(old.bound, progress.bound) or old.nodes != progress.nodes;
+        }
+
+        static bool same(double a, double b) {
+            return a == b or (std::isnan(a) and std::isnan(b));
+        }
+
+        /**
+         * @brief Parses a line of cbc. Cbc reports the values of the internal
+         * minimization problem (negated for maximization).
+         */
+        void parseCbc() {
+            double sign = minimize ? 1 : -1;
+            double v;
+            if (line.compare(0, 8, "Cbc0004I") == 0 or line.compare(0, 8, "Cbc0012I") == 0) {
+                if (numberAfter("solution of ", v)) progress.incumbent = sign * v;
+                if (numberBefore(" nodes", v)) progress.nodes = v;
+            } else if (line.compare(0, 8, "Cbc0010I") == 0) {
+                if (numberAfter("After ", v)) progress.nodes = v;
+                if (numberBefore(" best solution", v) and v < 1e50) progress.incumbent = sign * v;
+                if (numberAfter("best possible ", v)) progress.bound = sign * v;
+            } else if (line.compare(0, 8, "Cbc0001I") == 0) {
+                if (numberAfter("best objective ", v) and abs(v) < 1e50) progress.incumbent = sign * v;
+                if (numberBefore(" nodes", v)) progress.nodes = v;
+            } else if (numberAfter("Continuous objective value is ", v)) {
+                progress.bound = sign * v;
+            }
+        }
+
+        /**
+         * @brief Parses a line of glpsol, e.g.
+         * "+   150: mip =   3.000000000e+00 >=   2.500000000e+00  16.7% (12; 3)".
+         */
+        void parseGlpsol() {
+            size_t pos = line.find("mip =");
+            if (pos == string::npos) pos = line.find(">>>>>");
+            if (pos == string::npos) return;
+            pos += 5;
+            double v;
+            if (line.find("not found yet", pos) == string::npos and numberAfter("", v, pos)) {
+                progress.incumbent = v;
+            }
+            size_t rel = line.find(minimize ? ">=" : "<=", pos);
+            if (rel != string::npos and numberAfter("", v, rel + 2)) progress.bound = v;
+            double active, done;
+            if (numberAfter("(", active, pos) and numberAfter(";", done, pos)) {
+                progress.nodes = active + done;
+            }
+        }
+    };
+
+    string solver;              /// Name of the executable
+    string options;             /// Additional options of the solver
+    atomic<bool> cancelled{false}; /// The execution must be interrupted
+    vector<int> appearanceOrder; /// Vector to store the indices in order of appearance
+    vector<bool> appeared;       /// Variables already appeared
+    int numUsedVars = 0;         /// Number of used variables
+
+    /**
+     * @brief Writes the terms of a linear constraint to the buffer.
+     * @param buf The output buffer.
+     * @param model The sparse model (to get the names of the variables).
+     * @param index The variables of the terms.
+     * @param coeffs The coefficients of the terms.
+     * @param n Number of terms.
+     * @param names Indicates whether the names of the model must be used.
+     */
+    void writeTerms(LpBuffer& buf, const SparseModel& model,
+                    const int* index, const double* coeffs, int n, bool names) {
+        assert (n > 0);
+        for (int i = 0; i < n; ++i) {
+            double coeff = coeffs[i];
+            if (i == 0) {
+                if (abs(coeff) != 1.0) {
+                    buf.putDouble(coeff);
+                    buf.put(' ');
+                } else if (coeff < 0) buf.put('-');
+            } else {
+                buf.put(coeff < 0 ? " - " : " + ");
+                if (abs(coeff) != 1) {
+                    buf.putDouble(abs(coeff));
+                    buf.put(' ');
+                }
+            }
+            int idx = index[i];
+            buf.putVar(model, idx, names);
+            if (not appeared[idx]) {
+                appearanceOrder.push_back(idx);
+                appeared[idx] = true;
+            }
+        }
+    }
+
+    /**
+     * @brief Estimates the size of the LP file of a model (to reserve the buffer).
+     */
+    static size_t estimateLPSize(const SparseModel& model, bool names) {
+        size_t name_size = 8;
+        if (names) {
+            size_t total = 0;
+            for (const string& s: model.colName) total += s.size();
+            name_size = model.numCols() > 0 ? total / model.numCols() + 1 : 1;
+        }
+        return 256 + (model.value.size() + model.numCols()) * (name_size + 12) + model.numRows() * 24;
+    }
+
+    /**
+     * @brief Writes the model into a buffer in CPLEX LP format.
+     * The solvers report the variables in order of appearance, which
+     * is recorded in appearanceOrder.
+     * @param buf The output buffer.
+     * @param model The sparse model.
+     * @param names Indicates whether the names of the model must be used.
+     */
+    void writeLP(LpBuffer& buf, const SparseModel& model, bool names) {
+        int nc = model.numCols();
+        assert (nc > 0);
+        appearanceOrder.clear();
+        appearanceOrder.reserve(nc);
+        appeared.assign(nc, false);
+
+        // Cost function: if no cost, create a fake cost function
+        vector<int> costIndex;
+        vector<double> costCoeff;
+        for (int i = 0; i < nc; ++i) {
+            if (model.objective[i] == 0) continue;
+            costIndex.push_back(i);
+            costCoeff.push_back(model.objective[i]);
+        }
+        if (costIndex.empty()) {
+            costIndex.push_back(0);
+            costCoeff.push_back(0);
+        }
+
+        // Cost function
+        buf.put(model.minimize ? "Minimize\n" : "Maximize\n");
+        buf.put("  ");
+        writeTerms(buf, model, costIndex.data(), costCoeff.data(), costIndex.size(), names);
+        buf.put('\n');
+
+        buf.put("Subject to\n");
+        for (int r = 0; r < model.numRows(); ++r) {
+            int first = model.rowStart[r];
+            buf.put("  ");
+            if (names and not model.rowName[r].empty()) {
+                buf.put(model.rowName[r]);
+                buf.put(": ");
+            }
+            writeTerms(buf, model, &model.colIndex[first], &model.value[first],
+                       model.rowStart[r+1] - first, names);
+            if (model.rowType[r] == Milp_Model::EQ) buf.put(" = ");
+            else if (model.rowType[r] == Milp_Model::GEQ) buf.put(" >= ");
+            else buf.put(" <= ");
+            buf.putDouble(model.rhs[r]);
+            buf.put('\n');
+        }
+
+        numUsedVars = appearanceOrder.size();
+
+        bool need_bounds = false;
+        for (int i = 0; i < nc; ++i) {
+            if (hasBounds(model, i)) {
+                need_bounds = true;
+                break;
+            }
+        }
+
+        if (need_bounds) {
+            buf.put("Bounds\n");
+            for (int i = 0; i < nc; ++i) {
+                if (not hasBounds(model, i)) continue;
+                buf.put("  ");
+                if (model.colLower[i] == model.colUpper[i]) {
+                    buf.putVar(model, i, names);
+                    buf.put(" = ");
+                    buf.putDouble(model.colLower[i]);
+                } else if (std::isinf(model.colUpper[i])) {
+                    buf.putVar(model, i, names);
+                    buf.put(" >= ");
+                    buf.putDouble(model.colLower[i]);
+                } else {
+                    buf.putDouble(model.colLower[i]);
+                    buf.put(" <= ");
+                    buf.putVar(model, i, names);
+                    buf.put(" <= ");
+                    buf.putDouble(model.colUpper[i]);
+                }
+                buf.put('\n');
+            }
+        }
+
+        bool any = false;
+        for (int i = 0; i < nc; ++i) {
+            if (model.colType[i] != Milp_Model::INTEGER) continue;
+            if (not any) buf.put("General\n ");
+            any = true;
+            buf.put(' ');
+            buf.putVar(model, i, names);
+        }
+        if (any) buf.put('\n');
+
+        any = false;
+        for (int i = 0; i < nc; ++i) {
+            if (model.colType[i] != Milp_Model::BOOLEAN) continue;
+            if (not any) buf.put("Binary\n ");
+            any = true;
+            buf.put(' ');
+            buf.putVar(model, i, names);
+        }
+        if (any) buf.put('\n');
+
+        buf.put("End\n");
+    }
+
+    /**
+     * @brief Indicates whether the bounds of a variable must be written.
+     * Boolean variables and non-negative unbounded variables have no explicit
+     * bounds, unless they are fixed (equal bounds, whatever the type).
+     */
+    static bool hasBounds(const SparseModel& model, int i) {
+        if (model.colLower[i] == model.colUpper[i]) return true;
+        return model.colType[i] != Milp_Model::BOOLEAN and
+               (not std::isinf(model.colUpper[i]) or model.colLower[i] != 0);
+    }
+
+    /**
+     * @brief Reads a solution from the command gsolu of Cbc.
+     * @param model The sparse model.
+     * @param filename Name of the file.
+     * @param sol The solution.
+     * @return True if the file has be successfully read, and false otherwise.
+     */
+    bool readCbcSolution(const SparseModel& model, const string& filename, Solution& sol) {
+        MappedFile f(filename);
+        if (not f.isOpen()) return false;
+
+        vector<const char*> values;
+        int nv = f.readLine(values);
+        if (nv != 2) return false;
+
+        int nrows = f.toInt(values[0]);
+        int ncols = f.toInt(values[1]);
+
+        assert (nrows == model.numRows() + 1);
+        assert (ncols == numUsedVars);
+
+        // This is a tricky function that has to deal with the
+        // fact that cbc sometimes puts three values per line
+        // and sometimes only one (possibly when MILP model).
+        nv = f.readLine(values);
+        if (nv < 1) return false;
+
+        int st = f.toInt(values[0]);
+        switch (st) {
+        case 1:
+            sol.status = Milp_Model::UNBOUNDED;
+            break;
+        case 2:
+            sol.status = Milp_Model::NONOPTIMAL;
+            break;
+        case 4:
+            sol.status = Milp_Model::UNFEASIBLE;
+            break;
+        case 5:
+            sol.status = Milp_Model::OPTIMAL;
+            break;
+        default:
+            assert(false);
+        }
+
+        if (sol.status != Milp_Model::OPTIMAL and sol.status != Milp_Model::NONOPTIMAL) return true;
+
+        sol.obj = f.toDouble(values.back());
+        if (not model.minimize) sol.obj = -sol.obj;
+
+        // Skip the value of the rows
+        for (int i = 0; i < nrows; ++i) f.readLine(values);
+
+        // Read the variables
+        for (int i = 0; i < ncols; ++i) {
+            nv = f.readLine(values);
+            if (nv < 1) return false;
+            int loc = nv > 1 ? 1 : 0;
+            sol.values[appearanceOrder[i]] = f.toDouble(values[loc]);
         }
 
-        f.close();
         return true;
     }
 
     /**
      * @brief Reads a solution from glpsol.
+     * @param model The sparse model.
      * @param filename Name of the file.
+     * @param sol The solution.
      * @return True if the file has be successfully read, and false otherwise.
      */
-    bool readGlpsolSolution(const string& filename) {
-        ifstream f;
-        f.open(filename);
-        if (not f.is_open()) return false;
+    bool readGlpsolSolution(const SparseModel& model, const string& filename, Solution& sol) {
+        MappedFile f(filename);
+        if (not f.isOpen()) return false;
 
         bool cost_read = false;
-        vector<string> line;
+        vector<const char*> line;
 
-        while (readLine(f, line) > 0) {
+        int nv;
+        while ((nv = f.readLine(line)) > 0) {
             char c = line[0][0];
             if (c != 's' and c != 'j') {
                 // Skip line
                 continue;
             } else if (c == 'j') {
                 // Now we can read the value of a variable
-                int nvar = stoi(line[1]);
-                int loc = line.size() == 3 ? 2 : 3;
-                Vars[appearanceOrder[nvar-1]].value = stod(line[loc]);
+                if (nv < 3) return false;
+                int nvar = f.toInt(line[1]);
+                int loc = nv == 3 ? 2 : 3;
+                sol.values[appearanceOrder[nvar-1]] = f.toDouble(line[loc]);
             } else { // c == 's'
                 assert (not cost_read);
+                if (nv < 6) return false;
                 cost_read = true;
                 // Read the cost function
-                int nrows = stoi(line[2]);
-                int ncols = stoi(line[3]);
+                int nrows = f.toInt(line[2]);
+                int ncols = f.toInt(line[3]);
                 char st = line[4][0];
-                obj = stod(line.back());
+                sol.obj = f.toDouble(line.back());
+
+                // Basic solution of an LP (s bas m n pst dst obj): optimal
+                // if both primal and dual are feasible, unbounded if the
+                // dual is infeasible
+                if (strcmp(line[1], "bas") == 0 and nv >= 7) {
+                    char dst = line[5][0];
+                    if (st == 'f' and dst != 'f') st = dst == 'n' ? 'u' : 'f';
+                    else if (st == 'f') st = 'o';
+                    else if (st != 'n') {
+                        sol.status = Milp_Model::UNKNOWN;
+                        continue;
+                    }
+                }
 
-                assert (nrows == Matrix.size() - numEmptyRows);
+                assert (nrows == model.numRows());
                 assert (ncols == numUsedVars);
 
                 switch (st) {
                 case 'u':
-                    stat = UNBOUNDED;
+                    sol.status = Milp_Model::UNBOUNDED;
                     break;
                 case 'f':
-                    stat = NONOPTIMAL;
+                    sol.status = Milp_Model::NONOPTIMAL;
                     break;
                 case 'n':
-                    stat = UNFEASIBLE;
+                    sol.status = Milp_Model::UNFEASIBLE;
                     break;
                 case 'o':
-                    stat = OPTIMAL;
+                    sol.status = Milp_Model::OPTIMAL;
                     break;
                 default:
                     assert(false);
@@ -806,29 +1770,31 @@ private:
             }
         }
 
-        f.close();
         return true;
     }
 
     /**
      * @brief Generates the command to invoke the MILP solver.
-     * @param solver Name of the MILP solver.
      * @param lpfile name of the input file (CPLEX LP format).
      * @param solfile name of the solution file.
+     * @param startfile name of the MIP start file (none if empty).
      * @param timeout Max amount of time to solve the problem (in seconds).
      * @return A string with the command to be executed.
      */
-    string writeCommand(const string& solver, const string& lpfile, const string& solfile,
-                        int timeout = -1) {
+    string writeCommand(const string& lpfile, const string& solfile,
+                        const string& startfile, int timeout = -1) {
         ostringstream command;
         command << solver << ' ';
         if (solver == "cbc") {
             command << lpfile;
+            if (not startfile.empty()) command << " mips " << startfile;
             if (timeout > 0) command << " sec " << timeout;
+            if (not options.empty()) command << ' ' << options;
             command << " solve gsolution " << solfile;
         } else if (solver == "glpsol") {
             command << " --lp " << lpfile;
             if (timeout > 0) command << " --tmlim " << timeout;
+            if (not options.empty()) command << ' ' << options;
             command << " -w " << solfile;
         } else {
             assert(false);
@@ -836,6 +1802,40 @@ private:
         return command.str();
     }
 
+    /**
+     * @brief Executes a shell command in a new process group, so that the
+     * solver can be killed when the execution is cancelled.
+     * @param command The command.
+     * @param poll Function called periodically while the command is running.
+     * @return The exit status of the command (-1 if killed or not executed).
+     */
+    int runCommand(const string& command, const function<void()>& poll) {
+        const char* cmd = command.c_str();
+        pid_t pid = fork();
+        if (pid < 0) return -1;
+        if (pid == 0) {
+            setpgid(0, 0);
+            execl("/bin/sh", "sh", "-c", cmd, (char*) nullptr);
+            _exit(127);
+        }
+        setpgid(pid, pid);
+
+        int status = 0;
+        for (int iter = 1; ; ++iter) {
+            pid_t r = waitpid(pid, &status, WNOHANG);
+            if (r == pid) break;
+            if (r < 0 and errno != EINTR) return -1;
+            if (cancelled) {
+                kill(-pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                return -1;
+            }
+            if (iter % PollPeriod == 0) poll();
+            usleep(2000);
+        }
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
     /**
      * @brief Creates a temporary file name with the format "prefix".XXXXXXsuffix.
      * This format is used with mkstemp to create a temporary file.
@@ -849,6 +1849,7 @@ private:
         if (not suffix.empty()) strcat(fname, suffix.c_str());
         int file = mkstemps(fname, suffix.size());
         if (file == -1) return "";
+        close(file);
         return fname;
     }
 
@@ -860,4 +1861,1474 @@ private:
         unlink(filename.c_str());
     }
 };
+
+#ifdef USE_CBC_LIB
+/**
+ * @class Milp_CbcBackend
+ * @brief In-process backend based on the C interface of the Cbc library.
+ * The sparse model is loaded directly, without intermediate files.
+ */
+class Milp_CbcBackend : public Milp_Model::Backend
+{
+public:
+
+    using SparseModel = Milp_Model::SparseModel;
+    using Solution = Milp_Model::Solution;
+
+    string name() const override {
+        return "cbc";
+    }
+
+    bool solve(const SparseModel& model, int timelimit, Solution& sol, string& error) override {
+        int nc = model.numCols();
+        int nr = model.numRows();
+
+        // Cbc receives the matrix by columns
+        vector<CoinBigIndex> start;
+        vector<int> index;
+        vector<double> value;
+        model.byColumns(start, index, value);
+
+        vector<double> colUpper(model.colUpper);
+        for (double& ub: colUpper) if (std::isinf(ub)) ub = COIN_DBL_MAX;
+
+        vector<double> rowLower(nr), rowUpper(nr);
+        for (int r = 0; r < nr; ++r) {
+            Milp_Model::RowType t = model.rowType[r];
+            rowLower[r] = t == Milp_Model::LEQ ? -COIN_DBL_MAX : model.rhs[r];
+            rowUpper[r] = t == Milp_Model::GEQ ? COIN_DBL_MAX : model.rhs[r];
+        }
+
+        Cbc_Model* cbc = Cbc_newModel();
+        if (cbc == nullptr) {
+            error = "Could not create a Cbc model.";
+            return false;
+        }
+
+        Cbc_loadProblem(cbc, nc, nr, start.data(), index.data(), value.data(),
+                        model.colLower.data(), colUpper.data(), model.objective.data(),
+                        rowLower.data(), rowUpper.data());
+        for (int i = 0; i < nc; ++i) {
+            if (model.colType[i] != Milp_Model::REAL) Cbc_setInteger(cbc, i);
+        }
+        Cbc_setObjSense(cbc, model.minimize ? 1 : -1);
+        Cbc_setLogLevel(cbc, 0);
+        if (timelimit > 0) Cbc_setParameter(cbc, "sec", to_string(timelimit).c_str());
+
+        if (not model.start.empty()) {
+            vector<int> startIndex;
+            vector<double> startValue;
+            for (int i = 0; i < nc; ++i) {
+                if (std::isnan(model.start[i])) continue;
+                startIndex.push_back(i);
+                startValue.push_back(model.start[i]);
+            }
+            Cbc_setMIPStartI(cbc, startIndex.size(), startIndex.data(), startValue.data());
+        }
+
+        Cbc_solve(cbc);
+
+        if (Cbc_isProvenOptimal(cbc)) sol.status = Milp_Model::OPTIMAL;
+        else if (Cbc_isProvenInfeasible(cbc)) sol.status = Milp_Model::UNFEASIBLE;
+        else if (Cbc_isContinuousUnbounded(cbc)) sol.status = Milp_Model::UNBOUNDED;
+        else if (Cbc_bestSolution(cbc) != nullptr) sol.status = Milp_Model::NONOPTIMAL;
+        else sol.status = Milp_Model::UNKNOWN;
+
+        if (sol.status == Milp_Model::OPTIMAL or sol.status == Milp_Model::NONOPTIMAL) {
+            const double* x = Cbc_getColSolution(cbc);
+            sol.values.assign(x, x + nc);
+            sol.obj = Cbc_getObjValue(cbc);
+            sol.bound = Cbc_getBestPossibleObjValue(cbc);
+        }
+        sol.nodes = Cbc_getNodeCount(cbc);
+
+        Cbc_deleteModel(cbc);
+        return true;
+    }
+};
+#endif // USE_CBC_LIB
+
+#ifdef USE_GLPK_LIB
+/**
+ * @class Milp_GlpkBackend
+ * @brief In-process backend based on the GLPK library.
+ * The sparse model is loaded directly, without intermediate files.
+ */
+class Milp_GlpkBackend : public Milp_Model::Backend
+{
+public:
+
+    using SparseModel = Milp_Model::SparseModel;
+    using Solution = Milp_Model::Solution;
+
+    string name() const override {
+        return "glpsol";
+    }
+
+    void cancel() override {
+        cancelled = true;
+    }
+
+    bool cancellable() const override {
+        return true;
+    }
+
+    bool solve(const SparseModel& model, int timelimit, Solution& sol, string& error) override {
+        int nc = model.numCols();
+        int nr = model.numRows();
+
+        glp_term_out(GLP_OFF);
+        glp_prob* lp = glp_create_prob();
+        glp_set_obj_dir(lp, model.minimize ? GLP_MIN : GLP_MAX);
+
+        // GLPK uses indices from 1
+        if (nr > 0) glp_add_rows(lp, nr);
+        for (int r = 0; r < nr; ++r) {
+            Milp_Model::RowType t = model.rowType[r];
+            int type = t == Milp_Model::LEQ ? GLP_UP : (t == Milp_Model::GEQ ? GLP_LO : GLP_FX);
+            glp_set_row_bnds(lp, r + 1, type, model.rhs[r], model.rhs[r]);
+        }
+
+        if (nc > 0) glp_add_cols(lp, nc);
+        for (int i = 0; i < nc; ++i) {
+            double lb = model.colLower[i];
+            double ub = model.colUpper[i];
+            int type = std::isinf(ub) ? GLP_LO : (lb == ub ? GLP_FX : GLP_DB);
+            glp_set_col_bnds(lp, i + 1, type, lb, ub);
+            Milp_Model::VarType vt = model.colType[i];
+            glp_set_col_kind(lp, i + 1, vt == Milp_Model::REAL ? GLP_CV :
+                             (vt == Milp_Model::INTEGER ? GLP_IV : GLP_BV));
+            glp_set_obj_coef(lp, i + 1, model.objective[i]);
+        }
+
+        int ne = model.colIndex.size();
+        vector<int> ia(ne + 1), ja(ne + 1);
+        vector<double> ar(ne + 1);
+        for (int r = 0; r < nr; ++r) {
+            for (int k = model.rowStart[r]; k < model.rowStart[r+1]; ++k) {
+                ia[k+1] = r + 1;
+                ja[k+1] = model.colIndex[k] + 1;
+                ar[k+1] = model.value[k];
+            }
+        }
+        glp_load_matrix(lp, ne, ia.data(), ja.data(), ar.data());
+
+        glp_iocp parm;
+        glp_init_iocp(&parm);
+        parm.presolve = GLP_ON;
+        parm.msg_lev = GLP_MSG_OFF;
+        if (timelimit > 0) parm.tm_lim = timelimit * 1000;
+
+        // The MIP start is given to the solver as a heuristic solution. The
+        // solution must refer to the original problem: the MIP presolver is
+        // disabled and the LP relaxation is solved beforehand.
+        start.clear();
+        if (not model.start.empty()) completeStart(lp, model, start);
+        if (not start.empty()) {
+            glp_smcp sparm;
+            glp_init_smcp(&sparm);
+            sparm.msg_lev = GLP_MSG_OFF;
+            if (glp_simplex(lp, &sparm) == 0 and glp_get_status(lp) == GLP_OPT) {
+                parm.presolve = GLP_OFF;
+            } else {
+                start.clear();
+            }
+        }
+        parm.cb_func = callback;
+        parm.cb_info = this;
+        progress = Milp_Model::Progress();
+
+        int ret = glp_intopt(lp, &parm);
+        if (cancelled) {
+            glp_delete_prob(lp);
+            error = "Execution of glpk cancelled.";
+            return false;
+        }
+        if (ret == GLP_ENOPFS) sol.status = Milp_Model::UNFEASIBLE;
+        else if (ret == GLP_ENODFS) sol.status = Milp_Model::UNBOUNDED;
+        else if (ret != 0 and ret != GLP_ETMLIM and ret != GLP_ESTOP and ret != GLP_EMIPGAP) {
+            glp_delete_prob(lp);
+            error = "Error when executing glpk (code " + to_string(ret) + ").";
+            return false;
+        } else {
+            switch (glp_mip_status(lp)) {
+            case GLP_OPT:
+                sol.status = Milp_Model::OPTIMAL;
+                break;
+            case GLP_FEAS:
+                sol.status = Milp_Model::NONOPTIMAL;
+                break;
+            case GLP_NOFEAS:
+                sol.status = Milp_Model::UNFEASIBLE;
+                break;
+            default:
+                sol.status = Milp_Model::UNKNOWN;
+            }
+        }
+
+        sol.bound = progress.bound;
+        sol.nodes = progress.nodes;
+        if (sol.status == Milp_Model::OPTIMAL or sol.status == Milp_Model::NONOPTIMAL) {
+            sol.values.resize(nc);
+            for (int i = 0; i < nc; ++i) sol.values[i] = glp_mip_col_val(lp, i + 1);
+            sol.obj = glp_mip_obj_val(lp);
+        }
+
+        glp_delete_prob(lp);
+        return true;
+    }
+
+private:
+
+    vector<double> start;           /// MIP start, indexed from 1 (empty if none)
+    Milp_Model::Progress progress;  /// Last progress reported
+    atomic<bool> cancelled{false};  /// The execution must be interrupted
+
+    /**
+     * @brief Completes the MIP start. The integer variables with initial value
+     * are fixed and the values of the rest of variables are obtained from the
+     * LP relaxation.
+     * @param lp The GLPK problem.
+     * @param model The sparse model.
+     * @param start The complete start, indexed from 1 (empty if infeasible).
+     */
+    static void completeStart(glp_prob* lp, const SparseModel& model, vector<double>& start) {
+        int nc = model.numCols();
+        glp_prob* relax = glp_create_prob();
+        glp_copy_prob(relax, lp, GLP_OFF);
+        for (int i = 0; i < nc; ++i) {
+            double v = model.start[i];
+            if (model.colType[i] == Milp_Model::REAL or std::isnan(v)) continue;
+            glp_set_col_bnds(relax, i + 1, GLP_FX, v, v);
+        }
+
+        glp_smcp parm;
+        glp_init_smcp(&parm);
+        parm.msg_lev = GLP_MSG_OFF;
+        parm.presolve = GLP_ON;
+        if (glp_simplex(relax, &parm) == 0 and glp_get_status(relax) == GLP_OPT) {
+            start.assign(nc + 1, 0.0);
+            for (int i = 0; i < nc; ++i) {
+                double x = glp_get_col_prim(relax, i + 1);
+                start[i+1] = model.colType[i] == Milp_Model::REAL ? x : std::round(x);
+            }
+        }
+        glp_delete_prob(relax);
+    }
+
+    /**
+     * @brief Callback of the branch-and-cut. It terminates the search when the
+     * execution is cancelled, reports the progress of the search and provides
+     * the MIP start as a heuristic solution (only once).
+     */
+    static void callback(glp_tree* tree, void* info) {
+        Milp_GlpkBackend* self = static_cast<Milp_GlpkBackend*>(info);
+        if (self->cancelled) {
+            glp_ios_terminate(tree);
+            return;
+        }
+
+        int reason = glp_ios_reason(tree);
+        if (reason == GLP_IBINGO or reason == GLP_ISELECT) self->updateProgress(tree);
+
+        if (reason != GLP_IHEUR or self->start.empty()) return;
+        glp_ios_heur_sol(tree, self->start.data());
+        self->start.clear();
+    }
+
+    /**
+     * @brief Reports the progress when the incumbent or the bound change.
+     */
+    void updateProgress(glp_tree* tree) {
+        Milp_Model::Progress p;
+        glp_prob* lp = glp_ios_get_prob(tree);
+        if (glp_mip_status(lp) == GLP_FEAS) p.incumbent = glp_mip_obj_val(lp);
+        int best = glp_ios_best_node(tree);
+        if (best != 0) p.bound = glp_ios_node_bound(tree, best);
+        int active, current, total;
+        glp_ios_tree_size(tree, &active, &current, &total);
+        p.nodes = total;
+        progress.nodes = p.nodes;
+        auto same = [](double a, double b) { return a == b or (std::isnan(a) and std::isnan(b)); };
+        if (same(p.incumbent, progress.incumbent) and same(p.bound, progress.bound)) return;
+        progress = p;
+        reportProgress(p);
+    }
+};
+#endif // USE_GLPK_LIB
+
+/**
+ * @class Milp_Cache
+ * @brief On-disk cache of MILP solutions. Each solution is stored in a file
+ * named after a hash of the normalized model and the solver. The names of the
+ * variables and rows do not contribute to the hash. The modification time of
+ * the files is used to evict the least recently used solutions.
+ */
+class Milp_Cache
+{
+public:
+
+    using SparseModel = Milp_Model::SparseModel;
+    using Solution = Milp_Model::Solution;
+
+    /**
+     * @brief Defines the directory and the size of the cache.
+     * @param dir Directory of the cache (disabled if empty).
+     * @param maxBytes Maximum size in bytes.
+     */
+    static void configure(const string& dir, long long maxBytes) {
+        Config& c = config();
+        lock_guard<mutex> lock(c.mtx);
+        c.dir = dir;
+        c.maxBytes = maxBytes;
+        if (not dir.empty()) mkdir(dir.c_str(), 0755);
+    }
+
+    /**
+     * @return True if the cache is enabled.
+     */
+    static bool enabled() {
+        return not directory().empty();
+    }
+
+    /**
+     * @brief Calculates the key of a model.
+     * @param model The sparse model.
+     * @param solver Name of the solver.
+     * @return The key (hexadecimal hash followed by the solver name).
+     */
+    static string key(const SparseModel& model, const string& solver) {
+        Hasher h;
+        h.add(model.minimize);
+        h.add(model.numCols());
+        for (int i = 0; i < model.numCols(); ++i) {
+            h.add(model.colType[i]);
+            h.add(model.colLower[i]);
+            h.add(model.colUpper[i]);
+            h.add(model.objective[i]);
+        }
+        h.add(model.numRows());
+        for (int r = 0; r < model.numRows(); ++r) {
+            h.add(model.rowType[r]);
+            h.add(model.rhs[r]);
+            h.add(model.rowStart[r+1] - model.rowStart[r]);
+            for (int k = model.rowStart[r]; k < model.rowStart[r+1]; ++k) {
+                h.add(model.colIndex[k]);
+                h.add(model.value[k]);
+            }
+        }
+
+        ostringstream s;
+        s << hex << setfill('0') << setw(16) << h.h1 << setw(16) << h.h2 << '_' << solver;
+        return s.str();
+    }
+
+    /**
+     * @brief Looks up the solution of a model. Non-optimal solutions are only
+     * reused if they were obtained with a time limit not smaller than the current one.
+     * @param key Key of the model.
+     * @param model The sparse model.
+     * @param timelimit Time limit of the solver (no limit if <= 0).
+     * @param sol The solution (if found).
+     * @return True if the solution was found, and false otherwise.
+     */
+    static bool lookup(const string& key, const SparseModel& model, int timelimit, Solution& sol) {
+        string filename = path(directory(), key);
+        ifstream f(filename);
+        if (not f.is_open()) return false;
+
+        string magic;
+        int status, ncols, nrows, nnz, tlimit;
+        double obj;
+        f >> magic >> status >> obj >> ncols >> nrows >> nnz >> tlimit;
+        if (not f or magic != "MILP_SOLUTION" or ncols != model.numCols() or
+            nrows != model.numRows() or nnz != model.colIndex.size()) return false;
+
+        if (status == Milp_Model::NONOPTIMAL and
+            (tlimit <= 0 or timelimit <= 0 or timelimit > tlimit)) return false;
+
+        vector<double> values(ncols);
+        for (double& v: values) f >> v;
+        if (not f) return false;
+        f.close();
+
+        sol.status = Milp_Model::Status(status);
+        sol.obj = obj;
+        sol.values = move(values);
+
+        // The modification time defines the order of eviction
+        utime(filename.c_str(), nullptr);
+        return true;
+    }
+
+    /**
+     * @brief Stores the solution of a model.
+     * @param key Key of the model.
+     * @param model The sparse model.
+     * @param timelimit Time limit used by the solver.
+     * @param sol The solution.
+     */
+    static void store(const string& key, const SparseModel& model, int timelimit, const Solution& sol) {
+        if (sol.status == Milp_Model::UNKNOWN or sol.status == Milp_Model::ERROR) return;
+        if (sol.values.size() != model.numCols()) return;
+
+        string dir = directory();
+        if (dir.empty()) return;
+        string pattern = dir + "/tmp.XXXXXX";
+        vector<char> buf(pattern.begin(), pattern.end());
+        buf.push_back('\0');
+        int fd = mkstemp(&buf[0]);
+        if (fd == -1) return;
+        close(fd);
+        const char* tmpname = &buf[0];
+
+        ofstream f(tmpname);
+        f << "MILP_SOLUTION " << int(sol.status) << ' ' << setprecision(17) << sol.obj << ' '
+          << model.numCols() << ' ' << model.numRows() << ' ' << model.colIndex.size() << ' '
+          << timelimit << endl;
+        for (double v: sol.values) f << v << endl;
+        f.close();
+
+        // Atomic replacement, in case of concurrent solvers
+        if (not f or rename(tmpname, path(dir, key).c_str()) != 0) {
+            unlink(tmpname);
+            return;
+        }
+        evict();
+    }
+
+private:
+
+    struct Config {
+        string dir;             /// Directory of the cache
+        long long maxBytes = 0; /// Maximum size of the cache
+        mutex mtx;              /// Exclusive access to the configuration and eviction
+    };
+
+    static Config& config() {
+        static Config c;
+        return c;
+    }
+
+    /**
+     * @brief Two 64-bit FNV-style hashes with different multipliers.
+     */
+    struct Hasher {
+        uint64_t h1 = 14695981039346656037ULL;
+        uint64_t h2 = 0x9e3779b97f4a7c15ULL;
+
+        template<typename T>
+        void add(const T& x) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(&x);
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                h1 = (h1 ^ p[i]) * 1099511628211ULL;
+                h2 = (h2 ^ p[i]) * 0xff51afd7ed558ccdULL;
+                h2 ^= h2 >> 29;
+            }
+        }
+    };
+
+    /**
+     * @return The directory of the cache (empty if disabled), copied under the lock.
+     */
+    static string directory() {
+        Config& c = config();
+        lock_guard<mutex> lock(c.mtx);
+        return c.dir;
+    }
+
+    static string path(const string& dir, const string& key) {
+        return dir + "/" + key + ".msol";
+    }
+
+    /**
+     * @brief Removes the least recently used solutions until the size of the
+     * cache is below the limit.
+     */
+    static void evict() {
+        Config& c = config();
+        lock_guard<mutex> lock(c.mtx);
+        DIR* d = opendir(c.dir.c_str());
+        if (d == nullptr) return;
+
+        vector<pair<time_t, pair<string, long long>>> files;
+        long long total = 0;
+        while (struct dirent* e = readdir(d)) {
+            string name = e->d_name;
+            if (name.size() < 5 or name.compare(name.size() - 5, 5, ".msol") != 0) continue;
+            string filename = c.dir + "/" + name;
+            struct stat st;
+            if (stat(filename.c_str(), &st) != 0) continue;
+            files.push_back({st.st_mtime, {filename, (long long) st.st_size}});
+            total += st.st_size;
+        }
+        closedir(d);
+
+        if (total <= c.maxBytes) return;
+        sort(files.begin(), files.end());
+        for (const auto& f: files) {
+            if (total <= c.maxBytes) break;
+            if (unlink(f.second.first.c_str()) == 0) total -= f.second.second;
+        }
+    }
+};
+
+/**
+ * @class Milp_Presolve
+ * @brief Presolve of a sparse model before handing it over to a backend.
+ * The reductions are: singleton rows converted into bounds, removal of
+ * duplicate rows (same terms up to a scaling factor), removal of rows
+ * that cannot be violated within the bounds of the variables, and
+ * substitution of fixed variables (including the variables that do not
+ * appear in any row, fixed at the best bound for the cost function).
+ * The reductions are applied until no more changes are produced. The
+ * solution of the reduced model is mapped back to the original variables.
+ */
+class Milp_Presolve
+{
+public:
+
+    using SparseModel = Milp_Model::SparseModel;
+    using Solution = Milp_Model::Solution;
+
+    /**
+     * @brief Statistics of the reductions.
+     */
+    struct Stats {
+        int rows = 0;           /// Rows of the original model
+        int cols = 0;           /// Columns of the original model
+        int reducedRows = 0;    /// Rows of the reduced model
+        int reducedCols = 0;    /// Columns of the reduced model
+        int singletons = 0;     /// Singleton rows converted into bounds
+        int duplicates = 0;     /// Duplicate rows removed
+        int redundant = 0;      /// Rows that cannot be violated
+        int fixed = 0;          /// Variables substituted by a constant
+        bool infeasible = false;    /// The presolve proved infeasibility
+    };
+
+    /**
+     * @brief Reduces a model.
+     * @param model The original model.
+     * @param reduced The reduced model (output).
+     * @param sol The solution of the original model when it is found by the
+     * presolve, i.e., it is infeasible or all variables have been fixed.
+     * @return True if the reduced model must be solved, and false if the
+     * presolve has already found the solution (in sol).
+     */
+    bool run(const SparseModel& model, SparseModel& reduced, Solution& sol) {
+        load(model);
+        stats.rows = model.numRows();
+        stats.cols = model.numCols();
+
+        bool feasible = true;
+        for (int pass = 0; feasible and pass < MaxPasses; ++pass) {
+            bool changed = false;
+            if (not fixVariables(model, changed) or
+                not reduceRows(model, changed) or
+                not removeDuplicates(changed)) feasible = false;
+            if (not changed) break;
+        }
+
+        if (not feasible) {
+            stats.infeasible = true;
+            sol.status = Milp_Model::UNFEASIBLE;
+            sol.obj = 0;
+            sol.values.clear();
+            return false;
+        }
+
+        build(model, reduced);
+        stats.reducedRows = reduced.numRows();
+        stats.reducedCols = reduced.numCols();
+
+        if (reduced.numCols() > 0) return true;
+
+        // All variables are fixed
+        Solution empty;
+        empty.status = Milp_Model::OPTIMAL;
+        postsolve(empty, sol);
+        return false;
+    }
+
+    /**
+     * @brief Maps the solution of the reduced model back to the original variables.
+     * @param reducedSol The solution of the reduced model.
+     * @param sol The solution of the original model (output).
+     */
+    void postsolve(const Solution& reducedSol, Solution& sol) const {
+        sol.status = reducedSol.status;
+        sol.solver = reducedSol.solver;
+        sol.obj = reducedSol.obj + offset;
+        sol.bound = reducedSol.bound + offset;
+        sol.nodes = reducedSol.nodes;
+        sol.values.clear();
+        if (sol.status != Milp_Model::OPTIMAL and sol.status != Milp_Model::NONOPTIMAL) return;
+        int n = fixed.size();
+        sol.values.assign(n, 0.0);
+        for (int j = 0; j < n; ++j) {
+            if (fixed[j]) sol.values[j] = fixedValue[j];
+            else if (newIndex[j] < reducedSol.values.size()) sol.values[j] = reducedSol.values[newIndex[j]];
+        }
+    }
+
+    /**
+     * @return The constant added to the cost function of the reduced model
+     * by the substitution of fixed variables.
+     */
+    double getOffset() const {
+        return offset;
+    }
+
+    /**
+     * @return The statistics of the reductions.
+     */
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    /**
+     * @return A one-line report of the reductions.
+     */
+    string report() const {
+        ostringstream s;
+        s << "Presolve: " << stats.rows << " rows x " << stats.cols << " cols -> ";
+        if (stats.infeasible) {
+            s << "infeasible";
+            return s.str();
+        }
+        s << stats.reducedRows << " rows x " << stats.reducedCols << " cols (singletons "
+          << stats.singletons << ", duplicates " << stats.duplicates << ", redundant "
+          << stats.redundant << ", fixed " << stats.fixed << ")";
+        return s.str();
+    }
+
+private:
+
+    static constexpr int MaxPasses = 10;
+    static constexpr double Eps = 1e-9;       /// Tolerance to compare values
+    static constexpr double FeasTol = 1e-6;   /// Tolerance for feasibility and integrality
+
+    struct Row {
+        vector<int> col;        /// Variables of the terms (sorted)
+        vector<double> coeff;   /// Coefficients of the terms
+        Milp_Model::RowType type;
+        double rhs;
+        bool alive;
+    };
+
+    vector<Row> rows;               /// Rows of the model
+    vector<vector<int>> colRows;    /// Rows of each variable (possibly dead)
+    vector<double> lower;           /// Lower bounds
+    vector<double> upper;           /// Upper bounds
+    vector<bool> fixed;             /// Fixed variables
+    vector<double> fixedValue;      /// Value of the fixed variables
+    vector<int> newIndex;           /// Index in the reduced model (-1 if removed)
+    double offset = 0;              /// Constant of the cost function
+    Stats stats;
+
+    static bool isInteger(const SparseModel& model, int j) {
+        return model.colType[j] != Milp_Model::REAL;
+    }
+
+    void load(const SparseModel& model) {
+        int nc = model.numCols();
+        int nr = model.numRows();
+        rows.assign(nr, Row());
+        colRows.assign(nc, vector<int>());
+        for (int r = 0; r < nr; ++r) {
+            Row& row = rows[r];
+            row.type = model.rowType[r];
+            row.rhs = model.rhs[r];
+            row.alive = true;
+            for (int k = model.rowStart[r]; k < model.rowStart[r+1]; ++k) {
+                row.col.push_back(model.colIndex[k]);
+                row.coeff.push_back(model.value[k]);
+                colRows[model.colIndex[k]].push_back(r);
+            }
+        }
+        lower = model.colLower;
+        upper = model.colUpper;
+        fixed.assign(nc, false);
+        fixedValue.assign(nc, 0.0);
+        offset = 0;
+        stats = Stats();
+    }
+
+    /**
+     * @brief Tightens the bounds of a variable.
+     * @return False if the bounds become inconsistent.
+     */
+    bool tighten(const SparseModel& model, int j, double lb, double ub) {
+        if (isInteger(model, j)) {
+            lb = ceil(lb - FeasTol);
+            ub = floor(ub + FeasTol);
+        }
+        if (lb > lower[j]) lower[j] = lb;
+        if (ub < upper[j]) upper[j] = ub;
+        return lower[j] <= upper[j] + FeasTol;
+    }
+
+    /**
+     * @brief Substitutes a variable by a constant in all rows and in the cost function.
+     */
+    void fix(const SparseModel& model, int j, double v) {
+        fixed[j] = true;
+        fixedValue[j] = v;
+        offset += model.objective[j] * v;
+        for (int r: colRows[j]) {
+            Row& row = rows[r];
+            if (not row.alive) continue;
+            auto it = lower_bound(row.col.begin(), row.col.end(), j);
+            if (it == row.col.end() or *it != j) continue;
+            int k = it - row.col.begin();
+            row.rhs -= row.coeff[k] * v;
+            row.col.erase(it);
+            row.coeff.erase(row.coeff.begin() + k);
+        }
+        stats.fixed++;
+    }
+
+    /**
+     * @brief Fixes the variables with equal bounds and the variables that
+     * do not appear in any row (at the best bound for the cost function).
+     * @return False if the model is detected to be infeasible.
+     */
+    bool fixVariables(const SparseModel& model, bool& changed) {
+        for (int j = 0; j < fixed.size(); ++j) {
+            if (fixed[j]) continue;
+            if (lower[j] > upper[j] + FeasTol) return false;
+            if (upper[j] - lower[j] <= Eps) {
+                fix(model, j, lower[j]);
+                changed = true;
+                continue;
+            }
+
+            bool used = false;
+            for (int r: colRows[j]) {
+                if (rows[r].alive) {
+                    used = true;
+                    break;
+                }
+            }
+            if (used) continue;
+
+            // The cost function decides the value (in the direction of minimization)
+            double c = model.minimize ? model.objective[j] : -model.objective[j];
+            if (c > 0 or (c == 0 and not std::isinf(lower[j]))) {
+                if (std::isinf(lower[j])) continue;
+                fix(model, j, lower[j]);
+            } else if (c < 0 or not std::isinf(upper[j])) {
+                if (std::isinf(upper[j])) continue;   // Unbounded: let the solver report it
+                fix(model, j, upper[j]);
+            } else continue;
+            changed = true;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes empty rows, converts singleton rows into bounds and
+     * removes the rows that cannot be violated.
+     * @return False if the model is detected to be infeasible.
+     */
+    bool reduceRows(const SparseModel& model, bool& changed) {
+        const double inf = numeric_limits<double>::infinity();
+        for (Row& row: rows) {
+            if (not row.alive) continue;
+            int n = row.col.size();
+
+            if (n == 1) {
+                int j = row.col[0];
+                double a = row.coeff[0];
+                double b = row.rhs / a;
+                bool le = row.type == Milp_Model::LEQ or row.type == Milp_Model::EQ;
+                bool ge = row.type == Milp_Model::GEQ or row.type == Milp_Model::EQ;
+                if (a < 0) swap(le, ge);
+                if (not tighten(model, j, ge ? b : -inf, le ? b : inf)) return false;
+                row.alive = false;
+                stats.singletons++;
+                changed = true;
+                continue;
+            }
+
+            // Bounds of the activity of the row
+            double minAct = 0, maxAct = 0;
+            for (int k = 0; k < n; ++k) {
+                int j = row.col[k];
+                double a = row.coeff[k];
+                minAct += a > 0 ? a * lower[j] : a * upper[j];
+                maxAct += a > 0 ? a * upper[j] : a * lower[j];
+            }
+
+            double tol = FeasTol * max(1.0, abs(row.rhs));
+            bool le_ok = maxAct <= row.rhs + Eps;
+            bool ge_ok = minAct >= row.rhs - Eps;
+            if (row.type != Milp_Model::GEQ and minAct > row.rhs + tol) return false;
+            if (row.type != Milp_Model::LEQ and maxAct < row.rhs - tol) return false;
+
+            bool redundant;
+            if (row.type == Milp_Model::LEQ) redundant = le_ok;
+            else if (row.type == Milp_Model::GEQ) redundant = ge_ok;
+            else redundant = le_ok and ge_ok;
+
+            if (redundant) {
+                row.alive = false;
+                stats.redundant++;
+                changed = true;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes duplicate rows. Two rows are duplicate if they have the
+     * same terms after scaling them to have the first coefficient equal to 1.
+     * The rows of each group are merged into a range lo <= terms <= hi.
+     * @return False if the model is detected to be infeasible.
+     */
+    bool removeDuplicates(bool& changed) {
+        const double inf = numeric_limits<double>::infinity();
+        map<vector<pair<int,double>>, vector<int>> groups;
+        for (int r = 0; r < rows.size(); ++r) {
+            const Row& row = rows[r];
+            if (not row.alive or row.col.size() < 2) continue;
+            vector<pair<int,double>> key(row.col.size());
+            double scale = row.coeff[0];
+            for (int k = 0; k < row.col.size(); ++k) key[k] = {row.col[k], row.coeff[k] / scale};
+            groups[key].push_back(r);
+        }
+
+        for (auto& g: groups) {
+            vector<int>& group = g.second;
+            if (group.size() < 2) continue;
+
+            // Range of the scaled row
+            double lo = -inf, hi = inf;
+            for (int r: group) {
+                const Row& row = rows[r];
+                double scale = row.coeff[0];
+                double b = row.rhs / scale;
+                bool le = row.type == Milp_Model::LEQ or row.type == Milp_Model::EQ;
+                bool ge = row.type == Milp_Model::GEQ or row.type == Milp_Model::EQ;
+                if (scale < 0) swap(le, ge);
+                if (le) hi = min(hi, b);
+                if (ge) lo = max(lo, b);
+            }
+            if (lo > hi + FeasTol * max(1.0, abs(hi))) return false;
+
+            // The first row (scaled) represents the group. If the range is
+            // bounded on both sides, a second row is needed.
+            Row& first = rows[group[0]];
+            double scale = first.coeff[0];
+            for (double& a: first.coeff) a /= scale;
+            int kept = 1;
+            if (lo >= hi - Eps) {
+                first.type = Milp_Model::EQ;
+                first.rhs = hi;
+            } else if (std::isinf(lo)) {
+                first.type = Milp_Model::LEQ;
+                first.rhs = hi;
+            } else {
+                first.type = Milp_Model::GEQ;
+                first.rhs = lo;
+                if (not std::isinf(hi)) {
+                    Row& second = rows[group[1]];
+                    second.coeff = first.coeff;
+                    second.type = Milp_Model::LEQ;
+                    second.rhs = hi;
+                    kept = 2;
+                }
+            }
+            for (int i = kept; i < group.size(); ++i) rows[group[i]].alive = false;
+            if (group.size() > kept) {
+                stats.duplicates += group.size() - kept;
+                changed = true;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Builds the reduced model with the alive rows and the variables not fixed.
+     */
+    void build(const SparseModel& model, SparseModel& reduced) {
+        int nc = model.numCols();
+        newIndex.assign(nc, -1);
+
+        reduced.minimize = model.minimize;
+        reduced.colName.clear();
+        reduced.colType.clear();
+        reduced.colLower.clear();
+        reduced.colUpper.clear();
+        reduced.objective.clear();
+        reduced.start.clear();
+        for (int j = 0; j < nc; ++j) {
+            if (fixed[j]) continue;
+            newIndex[j] = reduced.colName.size();
+            reduced.colName.push_back(model.colName[j]);
+            reduced.colType.push_back(model.colType[j]);
+            reduced.colLower.push_back(lower[j]);
+            reduced.colUpper.push_back(upper[j]);
+            reduced.objective.push_back(model.objective[j]);
+            if (not model.start.empty()) reduced.start.push_back(model.start[j]);
+        }
+
+        reduced.rowName.clear();
+        reduced.rowType.clear();
+        reduced.rhs.clear();
+        reduced.rowStart.assign(1, 0);
+        reduced.colIndex.clear();
+        reduced.value.clear();
+        for (int r = 0; r < rows.size(); ++r) {
+            const Row& row = rows[r];
+            if (not row.alive or row.col.empty()) continue;
+            reduced.rowName.push_back(model.rowName[r]);
+            reduced.rowType.push_back(row.type);
+            reduced.rhs.push_back(row.rhs);
+            for (int k = 0; k < row.col.size(); ++k) {
+                reduced.colIndex.push_back(newIndex[row.col[k]]);
+                reduced.value.push_back(row.coeff[k]);
+            }
+            reduced.rowStart.push_back(reduced.colIndex.size());
+        }
+    }
+};
+
+inline void Milp_Model::setCache(const string& dir, long long maxBytes)
+{
+    Milp_Cache::configure(dir, maxBytes);
+}
+
+inline atomic<bool>& Milp_Model::presolveFlag()
+{
+    static atomic<bool> flag(false);
+    return flag;
+}
+
+inline atomic<Milp_Model::Observer*>& Milp_Model::observerPtr()
+{
+    static atomic<Observer*> observer(nullptr);
+    return observer;
+}
+
+inline bool Milp_Model::solve(Backend& backend, int timelimit)
+{
+    auto start_time = chrono::steady_clock::now();
+    auto elapsed = [&start_time]() {
+        return chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+    };
+
+    telemetry = Telemetry();
+    telemetry.label = label;
+    telemetry.rawCols = Vars.size();
+    telemetry.rawRows = Matrix.size();
+    telemetry.rawTerms = Cost.size();
+    for (const Row& r: Matrix) telemetry.rawTerms += r.vecRow.size();
+
+    SparseModel model;
+    getSparseModel(model);
+    telemetry.rows = model.numRows();
+    telemetry.cols = model.numCols();
+    telemetry.nnz = model.value.size();
+
+    // Progress of the backend. The values of the reduced model are
+    // translated with the constant of the presolve.
+    Observer* observer = observerPtr();
+    mutex progress_mutex;
+    double offset = 0;
+    backend.setProgressCallback([&](const Progress& p) {
+        lock_guard<mutex> lock(progress_mutex);
+        Progress q = p;
+        q.time = elapsed();
+        q.incumbent += offset;
+        q.bound += offset;
+        if (std::isnan(telemetry.timeFirstFeasible) and not std::isnan(q.incumbent)) {
+            telemetry.timeFirstFeasible = q.time;
+        }
+        telemetry.trajectory.push_back(q);
+        if (observer != nullptr) observer->progress(telemetry, q);
+    });
+
+    Solution sol;
+    cachedSolution = false;
+    string cacheKey;
+    if (not noCache and Milp_Cache::enabled()) {
+        cacheKey = Milp_Cache::key(model, backend.name());
+        cachedSolution = Milp_Cache::lookup(cacheKey, model, timelimit, sol);
+    }
+
+    presolveReport = "";
+    bool ok = true;
+    string err;
+    if (not cachedSolution) {
+        if (presolveFlag()) {
+            Milp_Presolve presolve;
+            SparseModel reduced;
+            if (presolve.run(model, reduced, sol)) {
+                telemetry.presolvedRows = reduced.numRows();
+                telemetry.presolvedCols = reduced.numCols();
+                offset = presolve.getOffset();
+                Solution reducedSol;
+                ok = backend.solve(reduced, timelimit, reducedSol, err);
+                if (ok) presolve.postsolve(reducedSol, sol);
+            } else {
+                telemetry.presolvedRows = telemetry.presolvedCols = 0;
+                sol.solver = "presolve";
+            }
+            presolveReport = presolve.report();
+        } else ok = backend.solve(model, timelimit, sol, err);
+
+        if (ok and not cacheKey.empty()) Milp_Cache::store(cacheKey, model, timelimit, sol);
+    }
+    backend.setProgressCallback(nullptr);
+
+    telemetry.time = elapsed();
+    telemetry.cached = cachedSolution;
+    if (not ok) {
+        stat = ERROR;
+        telemetry.solver = backend.name();
+        telemetry.status = ERROR;
+        if (observer != nullptr) observer->finished(telemetry);
+        setError(err);
+        return false;
+    }
+
+    stat = sol.status;
+    obj = sol.obj;
+    solverUsed = sol.solver.empty() ? backend.name() : sol.solver;
+    if (sol.values.size() == Vars.size()) {
+        for (unsigned int i = 0; i < Vars.size(); ++i) Vars[i].value = sol.values[i];
+    }
+
+    telemetry.solver = solverUsed;
+    telemetry.status = stat;
+    telemetry.nodes = sol.nodes;
+    if (stat == OPTIMAL or stat == NONOPTIMAL) {
+        telemetry.obj = obj;
+        telemetry.bound = stat == OPTIMAL ? obj : sol.bound;
+        if (std::isnan(telemetry.bound) and not telemetry.trajectory.empty()) {
+            telemetry.bound = telemetry.trajectory.back().bound;
+        }
+        if (not std::isnan(telemetry.bound) and not std::isinf(telemetry.bound)) {
+            telemetry.gap = abs(obj - telemetry.bound) / max(abs(obj), 1e-10);
+        }
+        if (std::isnan(telemetry.timeFirstFeasible)) telemetry.timeFirstFeasible = telemetry.time;
+    }
+    if (observer != nullptr) observer->finished(telemetry);
+    return true;
+}
+
+/**
+ * @class Milp_PortfolioBackend
+ * @brief Backend that runs several solvers concurrently on the same model.
+ * The first proven result (optimal, infeasible or unbounded) is taken and
+ * the rest of solvers are cancelled. If no solver proves optimality within
+ * the time limit, the best feasible solution is taken. The name of the
+ * winner is reported in the solution. Only backends that can be cancelled
+ * participate (the in-process Cbc library cannot be interrupted).
+ */
+class Milp_PortfolioBackend : public Milp_Model::Backend
+{
+public:
+
+    using SparseModel = Milp_Model::SparseModel;
+    using Solution = Milp_Model::Solution;
+
+    Milp_PortfolioBackend() {
+        if (Milp_FileBackend::available("cbc")) {
+            solvers.emplace_back(new Milp_FileBackend("cbc"));
+            solvers.emplace_back(new Milp_FileBackend("cbc", "preprocess off"));
+        }
+#ifdef USE_GLPK_LIB
+        solvers.emplace_back(new Milp_GlpkBackend());
+#else
+        if (Milp_FileBackend::available("glpsol")) {
+            solvers.emplace_back(new Milp_FileBackend("glpsol"));
+        }
+#endif
+    }
+
+    string name() const override {
+        return "portfolio";
+    }
+
+    /**
+     * @return True if some solver is available.
+     */
+    bool available() const {
+        return not solvers.empty();
+    }
+
+    void cancel() override {
+        for (auto& s: solvers) s->cancel();
+    }
+
+    bool cancellable() const override {
+        return true;
+    }
+
+    bool solve(const SparseModel& model, int timelimit, Solution& sol, string& error) override {
+        int n = solvers.size();
+        if (n == 0) {
+            error = "No MILP solver available for the portfolio.";
+            return false;
+        }
+
+        vector<Solution> sols(n);
+        vector<string> errors(n);
+        vector<bool> ok(n, false);
+        int finished = 0;
+        int winner = -1;
+        mutex mtx;
+        condition_variable cv;
+
+        // The progress of all solvers is forwarded
+        for (auto& s: solvers) {
+            s->setProgressCallback([this](const Milp_Model::Progress& p) { reportProgress(p); });
+        }
+
+        vector<thread> threads;
+        for (int i = 0; i < n; ++i) {
+            threads.emplace_back([&, i]() {
+                bool res = solvers[i]->solve(model, timelimit, sols[i], errors[i]);
+                lock_guard<mutex> lock(mtx);
+                ok[i] = res;
+                ++finished;
+                if (res and winner < 0 and proven(sols[i].status)) winner = i;
+                cv.notify_one();
+            });
+        }
+
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [&]() { return winner >= 0 or finished == n; });
+        }
+
+        // Stop the rest of solvers
+        for (int i = 0; i < n; ++i) {
+            if (i != winner) solvers[i]->cancel();
+        }
+        for (thread& t: threads) t.join();
+        for (auto& s: solvers) s->setProgressCallback(nullptr);
+
+        // No proven result: take the best feasible solution
+        if (winner < 0) {
+            for (int i = 0; i < n; ++i) {
+                if (not ok[i] or sols[i].status != Milp_Model::NONOPTIMAL) continue;
+                if (winner < 0 or (model.minimize ? sols[i].obj < sols[winner].obj
+                                                  : sols[i].obj > sols[winner].obj)) winner = i;
+            }
+        }
+
+        if (winner < 0) {
+            for (int i = 0; i < n; ++i) if (ok[i]) winner = i;
+        }
+
+        if (winner < 0) {
+            error = errors[0];
+            return false;
+        }
+
+        sol = move(sols[winner]);
+        sol.solver = solvers[winner]->name();
+        return true;
+    }
+
+private:
+
+    vector<unique_ptr<Milp_Model::Backend>> solvers;   /// Solvers of the portfolio
+
+    static bool proven(Milp_Model::Status s) {
+        return s == Milp_Model::OPTIMAL or s == Milp_Model::UNFEASIBLE or s == Milp_Model::UNBOUNDED;
+    }
+};
+
+inline unique_ptr<Milp_Model::Backend> Milp_Model::createBackend(const string& solver)
+{
+    if (solver == "cbc") {
+#ifdef USE_CBC_LIB
+        return unique_ptr<Backend>(new Milp_CbcBackend());
+#else
+        return unique_ptr<Backend>(new Milp_FileBackend("cbc"));
+#endif
+    }
+
+    if (solver == "glpsol") {
+#ifdef USE_GLPK_LIB
+        return unique_ptr<Backend>(new Milp_GlpkBackend());
+#else
+        return unique_ptr<Backend>(new Milp_FileBackend("glpsol"));
+#endif
+    }
+
+    if (solver == "portfolio") return unique_ptr<Backend>(new Milp_PortfolioBackend());
+    if (solver == "cbc-file") return unique_ptr<Backend>(new Milp_FileBackend("cbc"));
+    if (solver == "glpsol-file") return unique_ptr<Backend>(new Milp_FileBackend("glpsol"));
+    return nullptr;
+}
+
+inline bool Milp_Model::solverAvailable(const string& solver)
+{
+#ifdef USE_CBC_LIB
+    if (solver == "cbc") return true;
+#endif
+#ifdef USE_GLPK_LIB
+    if (solver == "glpsol") return true;
+#endif
+    if (solver == "cbc" or solver == "cbc-file") return Milp_FileBackend::available("cbc");
+    if (solver == "glpsol" or solver == "glpsol-file") return Milp_FileBackend::available("glpsol");
+    if (solver == "portfolio") return Milp_PortfolioBackend().available();
+    return false;
+}
+
+/**
+ * @class Milp_Budget
+ * @brief Scheduler of a global wall-clock budget shared by a set of MILP solves.
+ * Each solve is registered with a weight. When a solve starts, it receives a
+ * time limit proportional to its weight with respect to the weight of the
+ * pending solves. The available time is the remaining time of the budget for
+ * each job, minus the time reserved by the running solves. The time not used
+ * by the solves that finish early is thus returned to the pool. The scheduler
+ * can be used by concurrent threads.
+ */
+class Milp_Budget
+{
+public:
+
+    /**
+     * @brief Constructor. The clock starts when the object is created.
+     * @param seconds Global budget in seconds (no budget if seconds <= 0).
+     * @param jobs Number of solves that can run concurrently.
+     */
+    Milp_Budget(int seconds = -1, int jobs = 1) :
+        budget(seconds), jobs(jobs < 1 ? 1 : jobs), pendingWeight(0), numPending(0),
+        start(chrono::steady_clock::now()) {}
+
+    /**
+     * @return True if a budget has been defined.
+     */
+    bool enabled() const {
+        return budget > 0;
+    }
+
+    /**
+     * @brief Registers a pending solve.
+     * @param weight Weight of the solve (negative weights are taken as zero).
+     * @return The identifier of the solve.
+     */
+    int add(double weight) {
+        lock_guard<mutex> lock(mtx);
+        weights.push_back(weight < 0 ? 0 : weight);
+        deadlines.push_back(-1);
+        pendingWeight += weights.back();
+        ++numPending;
+        return weights.size() - 1;
+    }
+
+    /**
+     * @brief Starts a solve and removes it from the pending ones.
+     * @param id Identifier of the solve.
+     * @return The time limit for the solve in seconds (at least MinTime).
+     * @note The solve must be released when finished.
+     */
+    int claim(int id) {
+        lock_guard<mutex> lock(mtx);
+        assert(id >= 0 and id < weights.size() and weights[id] >= 0);
+        double now = elapsedTime();
+        double left = max(0.0, budget - now);
+
+        // Time available for the pending solves
+        int running = 0;
+        double reserved = 0;
+        for (double d: deadlines) {
+            if (d < 0) continue;
+            running++;
+            if (d > now) reserved += d - now;
+        }
+        double available = min(jobs, numPending + running) * left - reserved;
+        available = max(0.0, available);
+
+        double w = weights[id];
+        double share;
+        if (pendingWeight > 0) share = available * w / pendingWeight;
+        else share = available / numPending;
+        pendingWeight = max(0.0, pendingWeight - w);
+        --numPending;
+        weights[id] = -1;
+
+        int limit = min(share, left);
+        if (limit < MinTime) limit = MinTime;
+        deadlines[id] = now + limit;
+        return limit;
+    }
+
+    /**
+     * @brief Finishes a solve. The time reserved and not used returns to the pool.
+     * @param id Identifier of the solve.
+     */
+    void release(int id) {
+        lock_guard<mutex> lock(mtx);
+        assert(id >= 0 and id < deadlines.size());
+        deadlines[id] = -1;
+    }
+
+    /**
+     * @return The remaining time of the budget in seconds.
+     */
+    double remainingTime() const {
+        return max(0.0, budget - elapsedTime());
+    }
+
+private:
+
+    /**
+     * @return The time elapsed since the creation of the scheduler in seconds.
+     */
+    double elapsedTime() const {
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    static const int MinTime = 1;   /// Minimum time limit of a solve (seconds)
+
+    int budget;                     /// Global budget (seconds)
+    int jobs;                       /// Number of concurrent solves
+    vector<double> weights;         /// Weights of the solves (negative if claimed)
+    vector<double> deadlines;       /// Deadlines of the running solves (negative if not running)
+    double pendingWeight;           /// Sum of weights of the pending solves
+    int numPending;                 /// Number of pending solves
+    chrono::steady_clock::time_point start;  /// Start of the clock
+    mutable mutex mtx;              /// Lock for concurrent access
+};
+
+/**
+ * @class Milp_TelemetryLog
+ * @brief Observer that writes the metrics of all solves into a JSON file.
+ * The file is rewritten after each solve, so that it is complete even if
+ * the execution is interrupted. It can be used by concurrent solves.
+ */
+class Milp_TelemetryLog : public Milp_Model::Observer
+{
+public:
+
+    using Telemetry = Milp_Model::Telemetry;
+
+    /**
+     * @brief Constructor.
+     * @param filename Name of the JSON file.
+     */
+    Milp_TelemetryLog(const string& filename) : filename(filename) {}
+
+    void finished(const Telemetry& t) override {
+        lock_guard<mutex> lock(mtx);
+        records.push_back(toJson(t));
+        write();
+    }
+
+    /**
+     * @return True if the file could be written in the last solve.
+     */
+    bool good() const {
+        lock_guard<mutex> lock(mtx);
+        return ok;
+    }
+
+private:
+
+    string filename;            /// Name of the JSON file
+    vector<string> records;     /// JSON records of the solves
+    bool ok = true;             /// The file has been written successfully
+    mutable mutex mtx;          /// Lock for concurrent solves
+
+    void write() {
+        ofstream f(filename);
+        if (not f.is_open()) {
+            ok = false;
+            return;
+        }
+        f << "{\n  \"solves\": [";
+        for (unsigned int i = 0; i < records.size(); ++i) {
+            f << (i == 0 ? "\n    " : ",\n    ") << records[i];
+        }
+        f << "\n  ]\n}\n";
+        ok = f.good();
+    }
+
+    static string status(Milp_Model::Status s) {
+        switch (s) {
+        case Milp_Model::OPTIMAL: return "optimal";
+        case Milp_Model::NONOPTIMAL: return "nonoptimal";
+        case Milp_Model::UNFEASIBLE: return "infeasible";
+        case Milp_Model::UNBOUNDED: return "unbounded";
+        case Milp_Model::ERROR: return "error";
+        default: return "unknown";
+        }
+    }
+
+    static string str(const string& s) {
+        string r = "\"";
+        for (char c: s) {
+            if (c == '"' or c == '\\') r += '\\';
+            if ((unsigned char) c < 0x20) {
+                char tmp[8];
+                snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+                r += tmp;
+            } else r += c;
+        }
+        return r + "\"";
+    }
+
+    /**
+     * @brief Converts a number into JSON (null if it is NaN or infinite).
+     */
+    static string num(double v) {
+        if (std::isnan(v) or std::isinf(v)) return "null";
+        char tmp[32];
+        snprintf(tmp, sizeof(tmp), "%.10g", v);
+        return tmp;
+    }
+
+    static string toJson(const Telemetry& t) {
+        ostringstream s;
+        s << "{\"label\": " << str(t.label)
+          << ", \"solver\": " << str(t.solver)
+          << ", \"status\": " << str(status(t.status))
+          << ", \"cached\": " << (t.cached ? "true" : "false")
+          << ", \"raw\": {\"rows\": " << t.rawRows << ", \"cols\": " << t.rawCols << ", \"terms\": " << t.rawTerms << "}"
+          << ", \"normalized\": {\"rows\": " << t.rows << ", \"cols\": " << t.cols << ", \"nnz\": " << t.nnz << "}";
+        if (t.presolvedRows >= 0) {
+            s << ", \"presolved\": {\"rows\": " << t.presolvedRows << ", \"cols\": " << t.presolvedCols << "}";
+        }
+        s << ", \"time\": " << num(t.time)
+          << ", \"time_first_feasible\": " << num(t.timeFirstFeasible)
+          << ", \"obj\": " << num(t.obj)
+          << ", \"bound\": " << num(t.bound)
+          << ", \"gap\": " << num(t.gap)
+          << ", \"nodes\": " << (t.nodes < 0 ? string("null") : to_string(t.nodes))
+          << ", \"trajectory\": [";
+        for (unsigned int i = 0; i < t.trajectory.size(); ++i) {
+            const Milp_Model::Progress& p = t.trajectory[i];
+            if (i > 0) s << ", ";
+            s << "{\"time\": " << num(p.time) << ", \"incumbent\": " << num(p.incumbent)
+              << ", \"bound\": " << num(p.bound) << ", \"nodes\": "
+              << (p.nodes < 0 ? string("null") : to_string(p.nodes)) << "}";
+        }
+        s << "]}";
+        return s.str();
+    }
+};
+
+inline bool Milp_Model::writeLP(const string& filename)
+{
+    SparseModel model;
+    getSparseModel(model);
+    if (varNamer) varNamer(model.colName);
+    Milp_FileBackend writer(solver);
+    if (not writer.writeLP(model, filename)) {
+        setError("Could not open file " + filename + ".");
+        return false;
+    }
+    return true;
+}
+
 #endif // MILP_INTERFACE_H
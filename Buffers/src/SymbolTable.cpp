@@ -0,0 +1,139 @@
+#include "SymbolTable.h"
+
+using namespace std;
+
+/*
+ * Both tables use open addressing with linear probing and a load factor
+ * below 1/2. The size of the tables is a power of two. The entries of the
+ * IdMap are removed by shifting back the entries of the same cluster, so
+ * that no tombstones are needed.
+ */
+
+uint64_t SymbolTable::hash(const string& s)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c: s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+int SymbolTable::find(const string& s) const
+{
+    if (table.empty()) return -1;
+    uint64_t h = hash(s);
+    size_t mask = table.size() - 1;
+    for (size_t i = h & mask; table[i].symbol >= 0; i = (i + 1) & mask) {
+        if (table[i].hash == h and names[table[i].symbol] == s) return table[i].symbol;
+    }
+    return -1;
+}
+
+int SymbolTable::intern(const string& s)
+{
+    int sym = find(s);
+    if (sym >= 0) return sym;
+
+    if (2 * (names.size() + 1) > table.size()) {
+        vector<Entry> old(max<size_t>(16, 2 * table.size()), Entry{0, -1});
+        old.swap(table);
+        size_t mask = table.size() - 1;
+        for (const Entry& e: old) {
+            if (e.symbol < 0) continue;
+            size_t i = e.hash & mask;
+            while (table[i].symbol >= 0) i = (i + 1) & mask;
+            table[i] = e;
+        }
+    }
+
+    uint64_t h = hash(s);
+    size_t mask = table.size() - 1;
+    size_t i = h & mask;
+    while (table[i].symbol >= 0) i = (i + 1) & mask;
+    sym = names.size();
+    table[i] = {h, sym};
+    names.push_back(s);
+    return sym;
+}
+
+size_t SymbolTable::memoryUsage() const
+{
+    size_t bytes = table.capacity() * sizeof(Entry) + names.size() * sizeof(string);
+    for (const string& s: names) {
+        // The short strings are stored inside the string object
+        if (s.capacity() >= sizeof(string)) bytes += s.capacity() + 1;
+    }
+    return bytes;
+}
+
+uint64_t IdMap::hash(uint64_t key)
+{
+    // Finalizer of splitmix64
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+int IdMap::find(uint64_t key) const
+{
+    if (table.empty()) return -1;
+    size_t mask = table.size() - 1;
+    for (size_t i = hash(key) & mask; table[i].id >= 0; i = (i + 1) & mask) {
+        if (table[i].key == key) return table[i].id;
+    }
+    return -1;
+}
+
+void IdMap::insert(uint64_t key, int id)
+{
+    if (not table.empty()) {
+        size_t mask = table.size() - 1;
+        for (size_t i = hash(key) & mask; table[i].id >= 0; i = (i + 1) & mask) {
+            if (table[i].key == key) {
+                table[i].id = id;
+                return;
+            }
+        }
+    }
+
+    if (2 * (count + 1) > table.size()) {
+        vector<Entry> old(max<size_t>(16, 2 * table.size()), Entry{0, -1});
+        old.swap(table);
+        size_t mask = table.size() - 1;
+        for (const Entry& e: old) {
+            if (e.id < 0) continue;
+            size_t i = hash(e.key) & mask;
+            while (table[i].id >= 0) i = (i + 1) & mask;
+            table[i] = e;
+        }
+    }
+
+    size_t mask = table.size() - 1;
+    size_t i = hash(key) & mask;
+    while (table[i].id >= 0) i = (i + 1) & mask;
+    table[i] = {key, id};
+    count++;
+}
+
+void IdMap::erase(uint64_t key)
+{
+    if (table.empty()) return;
+    size_t mask = table.size() - 1;
+    size_t i = hash(key) & mask;
+    while (table[i].id >= 0 and table[i].key != key) i = (i + 1) & mask;
+    if (table[i].id < 0) return;
+
+    // Shift back the following entries of the cluster that cannot be
+    // found from their home position after removing the entry i
+    for (size_t j = (i + 1) & mask; table[j].id >= 0; j = (j + 1) & mask) {
+        size_t home = hash(table[j].key) & mask;
+        bool stays = i <= j ? (i < home and home <= j) : (i < home or home <= j);
+        if (stays) continue;
+        table[i] = table[j];
+        i = j;
+    }
+    table[i].id = -1;
+    count--;
+}
@@ -0,0 +1,114 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @class SymbolTable
+ * @file SymbolTable.h
+ * @brief Pool of interned strings. Each different string is stored once and
+ * identified by a symbol (consecutive integers from 0). The strings are never
+ * moved, so the references returned by name() remain valid while the table
+ * exists. The symbols are never removed.
+ */
+class SymbolTable
+{
+public:
+    /**
+     * @brief Returns the symbol of a string. The string is stored if it was
+     * not in the table.
+     * @param s The string.
+     * @return The symbol.
+     */
+    int intern(const std::string& s);
+
+    /**
+     * @brief Returns the symbol of a string without storing it.
+     * @param s The string.
+     * @return The symbol (-1 if the string is not in the table).
+     */
+    int find(const std::string& s) const;
+
+    /**
+     * @brief Returns the string of a symbol.
+     * @param sym The symbol.
+     * @return The string.
+     */
+    const std::string& name(int sym) const { return names[sym]; }
+
+    /**
+     * @return The number of symbols.
+     */
+    int size() const { return names.size(); }
+
+    /**
+     * @return The memory used by the table (bytes).
+     */
+    size_t memoryUsage() const;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        int symbol;             // -1 if the entry is empty
+    };
+    std::deque<std::string> names;  // Strings of the symbols
+    std::vector<Entry> table;       // Open addressing, linear probing
+
+    static uint64_t hash(const std::string& s);
+};
+
+/**
+ * @class IdMap
+ * @file SymbolTable.h
+ * @brief Map from 64-bit keys to non-negative ids (open addressing with linear
+ * probing). Used as an index of the netlist elements, e.g., with keys that
+ * combine the id of a block and the symbol of a name.
+ */
+class IdMap
+{
+public:
+    /**
+     * @brief Returns the id of a key.
+     * @param key The key.
+     * @return The id (-1 if the key is not in the map).
+     */
+    int find(uint64_t key) const;
+
+    /**
+     * @brief Inserts a key (or replaces its id).
+     * @param key The key.
+     * @param id The id (non-negative).
+     */
+    void insert(uint64_t key, int id);
+
+    /**
+     * @brief Removes a key (nothing is done if it is not in the map).
+     * @param key The key.
+     */
+    void erase(uint64_t key);
+
+    /**
+     * @return The number of keys.
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @return The memory used by the map (bytes).
+     */
+    size_t memoryUsage() const { return table.capacity() * sizeof(Entry); }
+
+private:
+    struct Entry {
+        uint64_t key;
+        int id;                 // -1 if the entry is empty
+    };
+    std::vector<Entry> table;
+    size_t count = 0;
+
+    static uint64_t hash(uint64_t key);
+};
+
+#endif // SYMBOLTABLE_H
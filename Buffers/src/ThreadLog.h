@@ -0,0 +1,77 @@
+#ifndef _THREADLOG_H__
+#define _THREADLOG_H__
+
+#include <mutex>
+#include <string>
+
+/**
+ * @class ThreadLog
+ * @file ThreadLog.h
+ * @brief Logs of the threads. When the output of cout is captured per
+ * thread (e.g., by the library buffering the functions concurrently), the
+ * output of a thread with a log is appended to it. The threads started by a
+ * thread with a log must capture their output with ThreadLog::Nested, so that
+ * it goes to the log of the parent and not to the shared output.
+ */
+class ThreadLog
+{
+public:
+
+    /**
+     * @return The log of the current thread (null if its output is not captured).
+     */
+    static std::string*& current() {
+        static thread_local std::string* log = nullptr;
+        return log;
+    }
+
+    /**
+     * @brief Captures the output of a nested thread. It is constructed in
+     * the nested thread with the log of the parent. The output is appended
+     * to the log of the parent at each flush and at the end, as a whole, so
+     * that the outputs of the nested threads do not interleave. The parent
+     * must not write into its log while the nested threads run.
+     */
+    class Nested
+    {
+    public:
+        /**
+         * @param parent Log of the parent thread (nothing is captured if null).
+         */
+        Nested(std::string* parent) : parent(parent) {
+            if (parent != nullptr) current() = &log;
+        }
+
+        ~Nested() {
+            if (parent == nullptr) return;
+            flush();
+            current() = nullptr;
+        }
+
+        /**
+         * @brief Appends the output captured so far to the log of the parent.
+         */
+        void flush() {
+            if (parent == nullptr or log.empty()) return;
+            std::lock_guard<std::mutex> guard(lock());
+            parent->append(log);
+            log.clear();
+        }
+
+    private:
+        std::string* parent;    // Log of the parent thread
+        std::string log;        // Output of the nested thread
+    };
+
+private:
+
+    /**
+     * @return The lock of the logs of the parents.
+     */
+    static std::mutex& lock() {
+        static std::mutex m;
+        return m;
+    }
+};
+
+#endif // _THREADLOG_H__
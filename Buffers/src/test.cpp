@@ -7,7 +7,10 @@
 #include "MILP_Model.h"
 //#include "Dataflow.h"
 #include "DFnetlist.h"
+#include "DotParser.h"
 #include <sstream>
+#include <chrono>
+#include <fstream>
 
 
 using namespace std;
@@ -61,6 +64,10 @@ int main_help()
     cerr << "Available commands:" << endl;
     cerr << "  dataflow:      handling dataflow netlists." << endl;
     cerr << "  buffers:       add elastic buffers to a netlist." << endl;
+    cerr << "  buffers lib:   add elastic buffers to all the functions of a library." << endl;
+    cerr << "  graph-bench:   time the traversals of a netlist." << endl;
+    cerr << "  dot-bench:     time the readers of dot files and of the binary format." << endl;
+    cerr << "  mem-report:    report the memory used by a netlist." << endl;
     cerr << "  async_synth:   synthesize an asynchronous circuit." << endl;
     cerr << "  solveCSC:      solve state encoding in an asynchronous circuit." << endl;
     cerr << "  hideSignals:   hide signals in an asynchronous specification." << endl;
@@ -68,6 +75,8 @@ int main_help()
     cerr << "  bisimilar:     check whether two LTSs are weakly bisimilar." << endl;
     cerr << "  bbg:           unit test for Basic Block graphs." << endl;
     cerr << "  circuit:       unit test to read and write a circuit." << endl;
+    cerr << "  binary-test:   unit test for the round trip of the binary netlists." << endl;
+    cerr << "  milp-test:     unit test for the bounds of the fixed variables in LP files." << endl;
 }
 
 #include <regex>
@@ -75,11 +84,33 @@ int main_help()
 struct user_input {
     string graph_name;
     string solver;
+    string start;
+    string cache;
+    int cache_size;
+    bool presolve;
+    string telemetry;
+    string relax;
+    int polish;
+    bool analyze;
+    string extraction;
+    bool prune_paths;
+    string incremental;
+    string period_sweep;
+    bool write_pareto;
+    string heuristic;
+    bool heuristic_bound;
+    double target_throughput;
     double period;
     double delay;
     double first;
     int timeout;
+    int budget;
+    int jobs;
+    int lib_jobs;
     bool set;
+    string dot_reader;
+    bool read_binary;
+    bool write_binary;
 };
 
 void clear_input(user_input& input) {
@@ -89,7 +120,29 @@ void clear_input(user_input& input) {
     input.delay = 0.0;
     input.period = 5;
     input.timeout = 180;
+    input.budget = -1;
+    input.jobs = 1;
+    input.lib_jobs = 0;
     input.solver = "cbc";
+    input.start = "";
+    input.cache = "";
+    input.cache_size = 256;
+    input.presolve = false;
+    input.telemetry = "";
+    input.relax = "off";
+    input.polish = 0;
+    input.analyze = false;
+    input.extraction = "milp";
+    input.prune_paths = true;
+    input.incremental = "";
+    input.period_sweep = "";
+    input.write_pareto = false;
+    input.heuristic = "off";
+    input.heuristic_bound = true;
+    input.target_throughput = 1;
+    input.dot_reader = "native";
+    input.read_binary = false;
+    input.write_binary = false;
 }
 
 void print_input(const user_input& input) {
@@ -97,7 +150,36 @@ void print_input(const user_input& input) {
     cout << "dataflow graph name: " << input.graph_name << endl;
     cout << "milp solver: " << input.solver << endl;
     cout << "delay: " << input.delay << ", period: " << input.period << endl;
+    if (not input.period_sweep.empty()) {
+        cout << "period sweep: " << input.period_sweep;
+        if (input.write_pareto) cout << " (writing the Pareto-optimal netlists)";
+        cout << endl;
+    }
     cout << "timeout: " << input.timeout << endl;
+    if (input.budget > 0) cout << "milp budget: " << input.budget << endl;
+    cout << "milp jobs: " << input.jobs << endl;
+    if (command == "buffers lib") cout << "library jobs: " << input.lib_jobs << endl;
+    if (not input.start.empty()) cout << "mip start: " << input.start << endl;
+    if (not input.incremental.empty()) cout << "previous placement: " << input.incremental << endl;
+    if (not input.cache.empty()) cout << "milp cache: " << input.cache << " (" << input.cache_size << " MB)" << endl;
+    cout << "milp presolve: " << (input.presolve ? "true" : "false") << endl;
+    if (not input.telemetry.empty()) cout << "milp telemetry: " << input.telemetry << endl;
+    cout << "lp relaxation: " << input.relax;
+    if (input.polish > 0) cout << " (polish " << input.polish << " s)";
+    cout << endl;
+    cout << "cfdfc extraction: " << input.extraction << endl;
+    cout << "throughput analysis: " << (input.analyze ? "true" : "false") << endl;
+    cout << "path pruning: " << (input.prune_paths ? "true" : "false") << endl;
+    cout << "greedy heuristic: " << input.heuristic;
+    if (input.heuristic != "off") {
+        cout << " (target throughput " << input.target_throughput;
+        if (input.heuristic_bound) cout << ", LP bound";
+        cout << ")";
+    }
+    cout << endl;
+    cout << "dot reader: " << input.dot_reader << endl;
+    cout << "read binary: " << (input.read_binary ? "true" : "false") << endl;
+    cout << "write binary: " << (input.write_binary ? "true" : "false") << endl;
     cout << "set optimization: " << (input.set ? "true" : "false") << endl;
     cout << "first MG optimization: " << (input.first ? "true" : "false") << endl;
     cout << "****************************************" << endl;
@@ -111,6 +193,28 @@ void parse_user_input(const vecParams& params, user_input& input) {
     regex set_regex("(-set=)(.*)");
     regex solver_regex("(-solver=)(.*)");
     regex first_regex("(-first=)(.*)");
+    regex budget_regex("(-budget=)(.*)");
+    regex jobs_regex("(-jobs=)(.*)");
+    regex lib_jobs_regex("(-lib-jobs=)(.*)");
+    regex start_regex("(-start=)(.*)");
+    regex cache_regex("(-cache=)(.*)");
+    regex cache_size_regex("(-cache-size=)(.*)");
+    regex presolve_regex("(-presolve=)(.*)");
+    regex telemetry_regex("(-telemetry=)(.*)");
+    regex relax_regex("(-relax=)(.*)");
+    regex polish_regex("(-polish=)(.*)");
+    regex analyze_regex("(-analyze=)(.*)");
+    regex extraction_regex("(-extraction=)(.*)");
+    regex prune_paths_regex("(-prune-paths=)(.*)");
+    regex incremental_regex("(-incremental=)(.*)");
+    regex period_sweep_regex("(-period-sweep=)(.*)");
+    regex write_pareto_regex("(-write-pareto=)(.*)");
+    regex heuristic_regex("(-heuristic=)(.*)");
+    regex heuristic_bound_regex("(-heuristic-bound=)(.*)");
+    regex target_throughput_regex("(-target-throughput=)(.*)");
+    regex dot_reader_regex("(-dot-reader=)(.*)");
+    regex read_binary_regex("(-read-binary=)(.*)");
+    regex write_binary_regex("(-write-binary=)(.*)");
     for (auto param: params) {
         if (regex_match(param, period_regex)) {
             input.period = atof(param.substr(param.find("=") + 1).c_str());
@@ -128,6 +232,57 @@ void parse_user_input(const vecParams& params, user_input& input) {
         } else if (regex_match(param, first_regex)) {
             string tmp = param.substr(param.find("=") + 1);
             input.first = (tmp == "false") ? false : true;
+        } else if (regex_match(param, budget_regex)) {
+            input.budget = atoi(param.substr(param.find("=") + 1).c_str());
+        } else if (regex_match(param, jobs_regex)) {
+            input.jobs = atoi(param.substr(param.find("=") + 1).c_str());
+        } else if (regex_match(param, lib_jobs_regex)) {
+            input.lib_jobs = atoi(param.substr(param.find("=") + 1).c_str());
+        } else if (regex_match(param, start_regex)) {
+            input.start = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, cache_regex)) {
+            input.cache = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, cache_size_regex)) {
+            input.cache_size = atoi(param.substr(param.find("=") + 1).c_str());
+        } else if (regex_match(param, presolve_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.presolve = (tmp == "false") ? false : true;
+        } else if (regex_match(param, telemetry_regex)) {
+            input.telemetry = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, relax_regex)) {
+            input.relax = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, polish_regex)) {
+            input.polish = atoi(param.substr(param.find("=") + 1).c_str());
+        } else if (regex_match(param, analyze_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.analyze = (tmp == "false") ? false : true;
+        } else if (regex_match(param, extraction_regex)) {
+            input.extraction = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, prune_paths_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.prune_paths = (tmp == "false") ? false : true;
+        } else if (regex_match(param, incremental_regex)) {
+            input.incremental = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, period_sweep_regex)) {
+            input.period_sweep = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, write_pareto_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.write_pareto = (tmp == "false") ? false : true;
+        } else if (regex_match(param, heuristic_regex)) {
+            input.heuristic = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, heuristic_bound_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.heuristic_bound = (tmp == "false") ? false : true;
+        } else if (regex_match(param, target_throughput_regex)) {
+            input.target_throughput = atof(param.substr(param.find("=") + 1).c_str());
+        } else if (regex_match(param, dot_reader_regex)) {
+            input.dot_reader = param.substr(param.find("=") + 1);
+        } else if (regex_match(param, read_binary_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.read_binary = (tmp == "false") ? false : true;
+        } else if (regex_match(param, write_binary_regex)) {
+            string tmp = param.substr(param.find("=") + 1);
+            input.write_binary = (tmp == "false") ? false : true;
         } else {
             cout << param << " is invalid argument" << endl;
             assert(false);
@@ -143,14 +298,67 @@ void show_help_shab() {
     cout << "\tdefault value is 3" << endl;
     cout << "-delay: the units' delay" << endl;
     cout << "\tdefault value is 0.0" << endl;
-    cout << "-solver: the milp solver" << endl;
+    cout << "-solver: the milp solver (cbc, glpsol, cbc-file, glpsol-file or portfolio)" << endl;
+    cout << "\tcbc and glpsol run in-process when linked, the -file variants always use LP files" << endl;
     cout << "\tdefault value is cbc" << endl;
     cout << "-timeout: the milp timeout. If -1, no limit will be applied" << endl;
     cout << "\tdefault value is -1" << endl;
+    cout << "-budget: global time budget in seconds for all the milps (only with -set=true)" << endl;
+    cout << "\tdistributed according to the weight of each MG, -timeout is ignored" << endl;
+    cout << "\tby default, no budget is used" << endl;
     cout << "-set: whether set optimization should be applied or not" << endl;
     cout << "\tdefault value is false" << endl;
     cout << "-first: whether the milp should only consider the throughput for the first MG or not" << endl;
     cout << "\tdefault value is false" << endl;
+    cout << "-jobs: number of MILPs of the disjoint MGs solved in parallel (only with -set=true)" << endl;
+    cout << "\tdefault value is 1" << endl;
+    cout << "-lib-jobs: number of functions buffered in parallel (only with buffers lib)" << endl;
+    cout << "\tdefault value is 0 (number of cores)" << endl;
+    cout << "-start: buffered netlist (e.g. a previous <filename>_graph_buf.dot) used as MIP start" << endl;
+    cout << "\tused with and without -set, only by cbc and the in-process GLPK. By default, no MIP start is used" << endl;
+    cout << "-incremental: filename of a previous run, whose <filename>_graph_buf.dot and <filename>_bbgraph_buf.dot are read" << endl;
+    cout << "\tthe disjoint sets of MGs that have not changed keep their buffers (only with -set=true)" << endl;
+    cout << "\tby default, all the MILPs are solved" << endl;
+    cout << "-cache: directory of the cache of MILP solutions" << endl;
+    cout << "\tby default, no cache is used" << endl;
+    cout << "-cache-size: maximum size of the cache in MB (least recently used solutions are removed)" << endl;
+    cout << "\tdefault value is 256" << endl;
+    cout << "-presolve: whether the milps are reduced before calling the solver or not" << endl;
+    cout << "\tdefault value is false" << endl;
+    cout << "-telemetry: JSON file with the metrics of all milps (sizes, times, incumbent and bound over time)" << endl;
+    cout << "\tby default, no file is written" << endl;
+    cout << "-relax: use of the LP relaxation with rounding (off, fallback or always)" << endl;
+    cout << "\tfallback: only when a milp finds no solution, always: the milps are not solved" << endl;
+    cout << "\tdefault value is off" << endl;
+    cout << "-polish: time limit in seconds of the milp on the fractional channels of the rounded LP" << endl;
+    cout << "\tby default, the rounded solution is not polished" << endl;
+    cout << "-extraction: method to extract the CFDFCs (milp, graph or compare)" << endl;
+    cout << "\tgraph: longest cycles of the BB graph without milps, compare: both methods (the milp is used)" << endl;
+    cout << "\tdefault value is milp" << endl;
+    cout << "-analyze: whether the throughput of the buffered MGs is computed (critical cycles) or not" << endl;
+    cout << "\tdefault value is false" << endl;
+    cout << "-prune-paths: whether the ports without critical paths (static timing) are removed from the milps or not" << endl;
+    cout << "\tdefault value is true" << endl;
+    cout << "-period-sweep: periods min:max:step explored with a single model (-period and -set are ignored)" << endl;
+    cout << "\tprints the throughput and buffers of each period and the Pareto-optimal ones" << endl;
+    cout << "\tby default, only -period is used" << endl;
+    cout << "-write-pareto: whether <filename>_p<period>_graph_buf.dot is written for each Pareto-optimal period of the sweep" << endl;
+    cout << "\tdefault value is false" << endl;
+    cout << "-heuristic: greedy buffer placement without milps (off, only or start)" << endl;
+    cout << "\tonly: the greedy buffers are the result, start: they are the MIP start of the milps" << endl;
+    cout << "\tdefault value is off" << endl;
+    cout << "-heuristic-bound: whether the gap of the greedy placement to the LP relaxation is reported or not" << endl;
+    cout << "\tdefault value is true" << endl;
+    cout << "-target-throughput: throughput of the MGs at which the greedy placement stops moving buffers" << endl;
+    cout << "\tdefault value is 1" << endl;
+    cout << "-dot-reader: reader of the dot files (native or cgraph)" << endl;
+    cout << "\tcgraph is only available when compiled with USE_GRAPHVIZ" << endl;
+    cout << "\tdefault value is native" << endl;
+    cout << "-read-binary: whether the netlist is read from <filename>.dfb (binary format) instead of the dot files" << endl;
+    cout << "\tthe BB graph is read from <filename>_bbgraph.dot if the binary netlist has none" << endl;
+    cout << "\tdefault value is false" << endl;
+    cout << "-write-binary: whether <filename>_graph_buf.dfb (binary format) is also written" << endl;
+    cout << "\tdefault value is false" << endl;
 }
 int main_shab(const vecParams& params){
     if (params.size() == 1 && params[0] == "-help") {
@@ -162,7 +370,13 @@ int main_shab(const vecParams& params){
     parse_user_input(params, input);
     print_input(input);
 
-    DFnetlist DF(input.graph_name + ".dot", input.graph_name + "_bbgraph.dot");
+    if (not DFnetlist::setDotReader(input.dot_reader)) {
+        cerr << "Dot reader " << input.dot_reader << " is not available" << endl;
+        return 1;
+    }
+
+    string netlist_name = input.graph_name + (input.read_binary ? ".dfb" : ".dot");
+    DFnetlist DF(netlist_name, input.graph_name + "_bbgraph.dot");
     //DF.cleanElasticBuffers();
 
     if (DF.hasError()) {
@@ -173,21 +387,451 @@ int main_shab(const vecParams& params){
     cout << "Adding elastic buffers with period=" << input.period << " and buffer_delay=" << input.delay << endl;
     cout << endl;
     DF.setMilpSolver(input.solver);
+    DF.setMilpJobs(input.jobs);
+    DF.setMilpBudget(input.budget);
+    DF.setMilpPathPruning(input.prune_paths);
+    Milp_Model::setCache(input.cache, (long long) input.cache_size << 20);
+    Milp_Model::setPresolve(input.presolve);
+    if (not DF.setCFDFCExtraction(input.extraction) or
+        not DF.setMilpRelaxation(input.relax, input.polish)) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
+    unique_ptr<Milp_TelemetryLog> telemetry;
+    if (not input.telemetry.empty()) {
+        telemetry.reset(new Milp_TelemetryLog(input.telemetry));
+        Milp_Model::setObserver(telemetry.get());
+    }
+    if (not input.start.empty() and not DF.setMilpStart(input.start)) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
+    if (not input.incremental.empty() and
+        not DF.setPreviousPlacement(input.incremental + "_graph_buf.dot", input.incremental + "_bbgraph_buf.dot")) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
+
+    if (not input.period_sweep.empty()) {
+        double min_period, max_period, step;
+        if (sscanf(input.period_sweep.c_str(), "%lf:%lf:%lf", &min_period, &max_period, &step) != 3) {
+            cerr << "Invalid period sweep " << input.period_sweep << " (expected min:max:step)" << endl;
+            return 1;
+        }
+        string prefix = input.write_pareto ? input.graph_name : "";
+        if (not DF.addElasticBuffersSweep(min_period, max_period, step, input.delay, input.timeout, input.first, prefix)) {
+            cerr << DF.getError() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (input.heuristic != "off" and input.heuristic != "only" and input.heuristic != "start") {
+        cerr << "Unknown heuristic " << input.heuristic << " (expected off, only or start)" << endl;
+        return 1;
+    }
+    if (input.heuristic != "off" and
+        not DF.addElasticBuffersGreedy(input.period, input.delay, input.target_throughput,
+                                       input.heuristic_bound, input.heuristic == "start")) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
 
     bool stat;
-    if (input.set) {
+    if (input.heuristic == "only") {
+        stat = true;
+    } else if (input.set) {
         stat = DF.addElasticBuffersBB_sc(input.period, input.delay, true, 1, input.timeout, input.first);
     } else {
         stat = DF.addElasticBuffersBB(input.period, input.delay, true, 1, input.timeout, input.first);
     }
+    if (stat and input.analyze) {
+        vector<ThroughputInfo> throughput;
+        if (DF.analyzeThroughput(throughput)) {
+            for (int i = 0; i < throughput.size(); ++i) {
+                const ThroughputInfo& th = throughput[i];
+                cout << "Throughput of MG " << i << ": " << fixed << setprecision(3) << th.throughput;
+                cout << " (" << th.tokens << " tokens, latency " << th.latency << ")" << endl;
+                cout << "  Critical cycle:";
+                for (channelID c: th.criticalCycle) cout << " " << DF.getChannelName(c);
+                cout << endl;
+            }
+        } else cerr << DF.getError() << endl;
+    }
     if (stat) {
         DF.instantiateElasticBuffers();
     }
+    if (telemetry) {
+        Milp_Model::setObserver(nullptr);
+        if (not telemetry->good()) cerr << "Could not write " << input.telemetry << endl;
+    }
     DF.writeDot(input.graph_name + "_graph_buf.dot");
     DF.writeDotBB(input.graph_name + "_bbgraph_buf.dot");
+    if (input.write_binary and not DF.writeBinary(input.graph_name + "_graph_buf.dfb")) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
     return 0;
 }
 
+int main_buffers_lib(const vecParams& params)
+{
+    if (params.size() == 1 && params[0] == "-help") {
+        show_help_shab();
+        return 1;
+    }
+
+    user_input input{};
+    parse_user_input(params, input);
+    print_input(input);
+
+    if (input.heuristic != "off" or not input.period_sweep.empty() or not input.start.empty()
+        or not input.incremental.empty()) {
+        cerr << "Options -heuristic, -period-sweep, -start and -incremental are not supported for libraries" << endl;
+        return 1;
+    }
+
+    if (not DFnetlist::setDotReader(input.dot_reader)) {
+        cerr << "Dot reader " << input.dot_reader << " is not available" << endl;
+        return 1;
+    }
+
+    DFlib lib(input.graph_name + ".dot");
+    if (lib.hasError() or not lib.addBB(input.graph_name + "_bbgraph.dot")) {
+        cerr << lib.getError() << endl;
+        return 1;
+    }
+
+    Milp_Model::setCache(input.cache, (long long) input.cache_size << 20);
+    Milp_Model::setPresolve(input.presolve);
+    for (funcID id = 0; id < lib.numFuncs(); ++id) {
+        DFnetlist& DF = lib[id];
+        DF.setMilpSolver(input.solver);
+        DF.setMilpJobs(input.jobs);
+        DF.setMilpBudget(input.budget);
+        DF.setMilpPathPruning(input.prune_paths);
+        if (not DF.setCFDFCExtraction(input.extraction) or
+            not DF.setMilpRelaxation(input.relax, input.polish)) {
+            cerr << DF.getError() << endl;
+            return 1;
+        }
+    }
+    unique_ptr<Milp_TelemetryLog> telemetry;
+    if (not input.telemetry.empty()) {
+        telemetry.reset(new Milp_TelemetryLog(input.telemetry));
+        Milp_Model::setObserver(telemetry.get());
+    }
+
+    cout << "Adding elastic buffers to " << lib.numFuncs() << " functions with period=" << input.period
+         << " and buffer_delay=" << input.delay << endl;
+    bool stat = lib.addElasticBuffers(input.period, input.delay, input.set, input.timeout, input.first,
+                                      input.lib_jobs, input.graph_name + "_report.txt");
+    if (not stat) cerr << lib.getError() << endl;
+
+    if (telemetry) {
+        Milp_Model::setObserver(nullptr);
+        if (not telemetry->good()) cerr << "Could not write " << input.telemetry << endl;
+    }
+    lib.writeDot(input.graph_name + "_graph_buf.dot");
+    lib.writeDotBB(input.graph_name + "_bbgraph_buf.dot");
+    return stat ? 0 : 1;
+}
+
+int main_graph_bench(const vecParams& params)
+{
+    if (params.size() < 1 or params.size() > 2) {
+        cerr << "Usage: " + exec + ' ' + command + " infile [iterations]" << endl;
+        return 1;
+    }
+
+    DFnetlist DF(params[0]);
+
+    if (DF.hasError()) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
+
+    DF.benchmarkGraph(params.size() > 1 ? atoi(params[1].c_str()) : 10);
+    return 0;
+}
+
+int main_dot_bench(const vecParams& params)
+{
+    if (params.size() < 1 or params.size() > 2) {
+        cerr << "Usage: " + exec + ' ' + command + " infile [iterations]" << endl;
+        return 1;
+    }
+
+    const string& filename = params[0];
+    int iterations = params.size() > 1 ? max(1, atoi(params[1].c_str())) : 10;
+    using clock = chrono::steady_clock;
+    auto elapsed = [](clock::time_point start) {
+        return chrono::duration<double, milli>(clock::now() - start).count();
+    };
+
+    // Parsing only (native reader)
+    double parse_time = 0;
+    int nodes = 0, edges = 0;
+    for (int i = 0; i < iterations; ++i) {
+        FILE* f = fopen(filename.c_str(), "r");
+        if (f == nullptr) {
+            cerr << "Error opening " << filename << endl;
+            return 1;
+        }
+        DotGraph G;
+        auto start = clock::now();
+        bool ok = G.read(f);
+        parse_time += elapsed(start);
+        fclose(f);
+        if (not ok) {
+            cerr << (G.hasError() ? G.getError() : "No graph in " + filename) << endl;
+            return 1;
+        }
+        nodes = G.numNodes();
+        edges = G.numEdges();
+    }
+    cout << "Graph with " << nodes << " nodes and " << edges << " edges" << endl;
+    cout << "parse (native): " << parse_time / iterations << " ms" << endl;
+
+    // Netlist construction with each available reader
+    for (const string reader: {"native", "cgraph"}) {
+        if (not DFnetlist::setDotReader(reader)) {
+            cout << "netlist (" << reader << "): not available" << endl;
+            continue;
+        }
+        double time = 0;
+        for (int i = 0; i < iterations; ++i) {
+            auto start = clock::now();
+            DFnetlist DF(filename);
+            time += elapsed(start);
+            if (DF.hasError()) {
+                cerr << DF.getError() << endl;
+                return 1;
+            }
+        }
+        cout << "netlist (" << reader << "): " << time / iterations << " ms" << endl;
+    }
+    DFnetlist::setDotReader("native");
+
+    // Netlist construction from the binary format
+    string binary = filename + ".dfb";
+    {
+        DFnetlist DF(filename);
+        if (DF.hasError() or not DF.writeBinary(binary)) {
+            cerr << DF.getError() << endl;
+            return 1;
+        }
+    }
+    double time = 0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = clock::now();
+        DFnetlist DF(binary);
+        time += elapsed(start);
+        if (DF.hasError()) {
+            cerr << DF.getError() << endl;
+            remove(binary.c_str());
+            return 1;
+        }
+    }
+    cout << "netlist (binary): " << time / iterations << " ms" << endl;
+    remove(binary.c_str());
+    return 0;
+}
+
+int main_mem_report(const vecParams& params)
+{
+    if (params.size() != 1) {
+        cerr << "Usage: " + exec + ' ' + command + " infile" << endl;
+        return 1;
+    }
+
+    DFnetlist DF(params[0]);
+
+    if (DF.hasError()) {
+        cerr << DF.getError() << endl;
+        return 1;
+    }
+
+    DF.reportMemoryUsage(cout);
+    return 0;
+}
+
+static string readFileText(const string& filename)
+{
+    ifstream f(filename, ios::binary);
+    stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+int main_binary_test(const vecParams& params)
+{
+    if (params.size() > 1) {
+        cerr << "Usage: " + exec + ' ' + command + " [dir]" << endl;
+        return 1;
+    }
+
+    // Netlist with negative, 1-bit and 8-bit constants
+    string prefix = (params.empty() ? string(".") : params[0]) + "/binary_test";
+    string dot = prefix + ".dot", a = prefix + "_a.dfb", b = prefix + "_b.dfb";
+    string d = prefix + "_d.dfb";
+    string dot_a = prefix + "_a.dot", dot_c = prefix + "_c.dot", dot_d = prefix + "_d.dot";
+    const vector<pair<string, long long>> constants = {
+        {"cst_0", -5}, {"cst_1", -1}, {"cst_2", -128}, {"cst_3", 2147483647}, {"cst_4", 0}
+    };
+    ofstream of(dot);
+    of << "Digraph G {" << endl
+       << "  start_0 [type=Entry, in=\"in1:0\", out=\"out1:0\", bbID=0, control=\"true\"];" << endl
+       << "  fork_0 [type=Fork, in=\"in1:0\", out=\"out1:0 out2:0 out3:0 out4:0 out5:0\", bbID=0];" << endl
+       << "  cst_0 [type=Constant, in=\"in1:0\", out=\"out1:32\", bbID=0, value=\"0xFFFFFFFB\"];" << endl
+       << "  cst_1 [type=Constant, in=\"in1:0\", out=\"out1:1\", bbID=0, value=\"0x1\"];" << endl
+       << "  cst_2 [type=Constant, in=\"in1:0\", out=\"out1:8\", bbID=0, value=\"0x80\"];" << endl
+       << "  cst_3 [type=Constant, in=\"in1:0\", out=\"out1:32\", bbID=0, value=\"0x7FFFFFFF\"];" << endl
+       << "  cst_4 [type=Constant, in=\"in1:0\", out=\"out1:1\", bbID=0, value=\"0x0\"];" << endl;
+    for (int i = 0; i < constants.size(); ++i) {
+        of << "  sink_" << i << " [type=Sink, in=\"in1:32\", bbID=0];" << endl;
+    }
+    of << "  start_0 -> fork_0 [from=out1, to=in1];" << endl;
+    for (int i = 0; i < constants.size(); ++i) {
+        of << "  fork_0 -> cst_" << i << " [from=out" << i + 1 << ", to=in1];" << endl;
+        of << "  cst_" << i << " -> sink_" << i << " [from=out1, to=in1];" << endl;
+    }
+    of << "}" << endl;
+    of.close();
+
+    // Checks
+    bool ok = true;
+    auto fail = [&ok](const string& msg) {
+        cerr << "binary-test: " << msg << endl;
+        ok = false;
+    };
+    auto checkConstants = [&](DFnetlist& DF, const string& what) {
+        for (const auto& c: constants) {
+            blockID id = DF.getBlock(c.first);
+            if (id == invalidDataflowID) fail(what + ": block " + c.first + " not found");
+            else if (DF.DFI->getValue(id) != c.second) {
+                fail(what + ": " + c.first + " is " + to_string(DF.DFI->getValue(id)) +
+                     " instead of " + to_string(c.second));
+            }
+        }
+    };
+
+    auto channelList = [](DFnetlist& DF) {
+        ostringstream s;
+        for (channelID c: DF.DFI->allChannels) {
+            s << c << ' ' << DF.DFI->getBlockName(DF.DFI->getSrcBlock(c)) << " -> "
+              << DF.DFI->getBlockName(DF.DFI->getDstBlock(c)) << endl;
+        }
+        return s.str();
+    };
+
+    // a: binary netlist in the order of the dot reader.
+    // d: binary netlist with the channels out of order (start_0 -> fork_0
+    //    and fork_0 -> cst_0 are recreated).
+    string channels_dot;
+    DFnetlist A(dot);
+    if (A.hasError()) fail(A.getError());
+    else {
+        checkConstants(A, "dot");
+        channels_dot = channelList(A);
+        A.writeDot(dot_a);
+        if (not A.writeBinary(a)) fail(A.getError());
+        DFnetlist_Impl& I = *A.DFI;
+        channelID c0 = invalidDataflowID, c1 = invalidDataflowID;
+        for (channelID c: I.allChannels) {
+            if (I.getSrcBlock(c) == I.getBlock("start_0")) c0 = c;
+            if (I.getDstBlock(c) == I.getBlock("cst_0")) c1 = c;
+        }
+        portID src0 = I.getSrcPort(c0), dst0 = I.getDstPort(c0);
+        portID src1 = I.getSrcPort(c1), dst1 = I.getDstPort(c1);
+        I.removeChannel(c0);
+        I.removeChannel(c1);
+        I.createChannel(src0, dst0);
+        I.createChannel(src1, dst1);
+        if (ok and not A.writeBinary(d)) fail(A.getError());
+    }
+
+    // dot -> a -> b -> dot
+    if (ok) {
+        DFnetlist B(a);
+        if (B.hasError()) fail(B.getError());
+        else {
+            checkConstants(B, "binary");
+            if (not B.writeBinary(b)) fail(B.getError());
+        }
+    }
+    if (ok) {
+        DFnetlist C(b);
+        if (C.hasError()) fail(C.getError());
+        else {
+            checkConstants(C, "binary (second round)");
+            C.writeDot(dot_c);
+        }
+    }
+    if (ok and readFileText(a) != readFileText(b)) fail(a + " and " + b + " are different");
+    if (ok and readFileText(dot_a) != readFileText(dot_c)) fail(dot_a + " and " + dot_c + " are different");
+
+    // d must give the same netlist as the dot file
+    if (ok) {
+        DFnetlist D(d);
+        if (D.hasError()) fail(D.getError());
+        else {
+            if (channelList(D) != channels_dot) fail("the channels of " + d + " are not in the order of the dot reader");
+            D.writeDot(dot_d);
+            if (not D.writeBinary(d)) fail(D.getError());
+        }
+    }
+    if (ok and readFileText(a) != readFileText(d)) fail(a + " and " + d + " are different");
+    if (ok and readFileText(dot_a) != readFileText(dot_d)) fail(dot_a + " and " + dot_d + " are different");
+
+    for (const string& file: {dot, a, b, d, dot_a, dot_c, dot_d}) remove(file.c_str());
+    if (ok) cout << "binary-test: OK" << endl;
+    return ok ? 0 : 1;
+}
+
+int main_milp_test(const vecParams& params)
+{
+    if (params.size() > 1) {
+        cerr << "Usage: " + exec + ' ' + command + " [dir]" << endl;
+        return 1;
+    }
+
+    // Fixed variables of all types must be bounded in the LP file
+    string lpfile = (params.empty() ? string(".") : params[0]) + "/milp_test.lp";
+    Milp_Model milp;
+    milp.init();        // The LP file is written without solver
+    int b = milp.newBooleanVar("b");
+    int free_b = milp.newBooleanVar("free_b");
+    int x = milp.newIntegerVar("x", 0, 10);
+    int y = milp.newRealVar("y");
+    milp.newRow({{1, b}, {1, free_b}, {1, x}, {-1, y}}, '<', 5);
+    milp.newCostTerm(1, y);
+    milp.setMaximize();
+    milp.fixVar(b, 0);
+    milp.fixVar(x, 2);
+    milp.fixVar(y, 1.5);
+
+    bool ok = milp.writeLP(lpfile);
+    if (not ok) cerr << "milp-test: " << milp.getError() << endl;
+    string lp = readFileText(lpfile);
+    remove(lpfile.c_str());
+
+    size_t bounds = lp.find("Bounds\n");
+    for (const string& bound: {"  b = 0\n", "  x = 2\n", "  y = 1.5\n"}) {
+        if (ok and (bounds == string::npos or lp.find(bound, bounds) == string::npos)) {
+            cerr << "milp-test: bound \"" << bound.substr(2, bound.size() - 3) << "\" not found" << endl;
+            ok = false;
+        }
+    }
+    if (ok and lp.find("free_b", bounds) < lp.find("Binar", bounds)) {
+        cerr << "milp-test: the free Boolean variable is bounded" << endl;
+        ok = false;
+    }
+
+    if (ok) cout << "milp-test: OK" << endl;
+    return ok ? 0 : 1;
+}
+
 int main_test(const vecParams& params){
     DFnetlist DF(params[0], params[1]);
 //    DF.computeSCC(false);
@@ -211,8 +855,17 @@ int main(int argc, char *argv[])
     for (int i = 2; i < argc; ++i) params.push_back(argv[i]);
 
     if (command == "buffers_old") return main_buffers(params);
+    if (command == "buffers" and not params.empty() and params[0] == "lib") {
+        command = "buffers lib";
+        return main_buffers_lib(vecParams(params.begin() + 1, params.end()));
+    }
     if (command == "buffers") return main_shab(params);
     if (command == "test") return main_test(params);
+    if (command == "graph-bench") return main_graph_bench(params);
+    if (command == "dot-bench") return main_dot_bench(params);
+    if (command == "mem-report") return main_mem_report(params);
+    if (command == "binary-test") return main_binary_test(params);
+    if (command == "milp-test") return main_milp_test(params);
 
 #if 0
     if (command == "dataflow") return main_dataflow(params);
@@ -90,6 +90,11 @@ void arguments_parser ( int argc, char *argv[] )
 
 
 
+bool is_dfb_filename ( string filename )
+{
+    return filename.size() > 4 && filename.compare( filename.size() - 4, 4, ".dfb" ) == 0;
+}
+
 int main( int argc, char* argv[] )
 {
    
@@ -104,16 +109,34 @@ int main( int argc, char* argv[] )
     dot_input_files = (argc-1);
             
     top_level_filename = argv[1];
+    if ( is_dfb_filename ( top_level_filename ) )
+    {
+        top_level_filename.resize( top_level_filename.size() - 4 );
+    }
 
     for ( int indx = 0; indx < dot_input_files; indx++ )
     {
         
         input_filename[indx] = argv[indx+1];
-        output_filename[indx] = argv[indx+1];
 
-        cout << "Parsing "<< input_filename[indx] << ".dot" << endl;
-        
-        parse_dot ( input_filename[indx] );
+        // name.dfb: netlist in binary format (from buffers -write-binary)
+        if ( is_dfb_filename ( input_filename[indx] ) )
+        {
+            input_filename[indx].resize( input_filename[indx].size() - 4 );
+            output_filename[indx] = input_filename[indx];
+
+            cout << "Parsing "<< input_filename[indx] << ".dfb" << endl;
+
+            parse_dfb ( input_filename[indx] );
+        }
+        else
+        {
+            output_filename[indx] = input_filename[indx];
+
+            cout << "Parsing "<< input_filename[indx] << ".dot" << endl;
+
+            parse_dot ( input_filename[indx] );
+        }
         
         check_netlist ( );
         
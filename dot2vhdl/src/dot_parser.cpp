@@ -24,6 +24,7 @@
 #include "vhdl_writer.h"
 #include <stdlib.h>     /* exit, EXIT_FAILURE */
 #include "string_utils.h"
+#include "DFbinary.h"
 
 using namespace std;
 
@@ -627,6 +628,146 @@ string check_comments ( string line  )
 
 }
 
+void set_component_slots ( int node_id, int slots )
+{
+    nodes[node_id].slots = slots;
+
+    //cout << "nodes[node_id].slots" << nodes[node_id].slots;
+
+    switch ( nodes[node_id].slots )
+    {
+        case 1: //if slots = 1
+//                                 if ( nodes[node_id].trasparent )
+//                                 {
+//                                      // if transparent = true -> put TEHB
+//                                     nodes[node_id].type = "TEHB";
+//                                 }
+//                                 else
+//                                 {
+//                                     // if transparent = false -> put OEHB
+//                                     nodes[node_id].type = "OEHB";
+// 
+//                                 }
+//                                 break;
+        case 2: //put elasticBuffer (ignore transparent parameter)
+        case 0: //put elasticBuffer (ignore transparent parameter)
+            ;
+            break;
+        default: // > 2
+            nodes[node_id].type = "Fifo";
+            nodes[node_id].component_operator = nodes[node_id].type; // For the component without an operator, sets the entity type                               
+            break;
+    }
+}
+
+void set_component_bbcount ( int node_id, int bbcount )
+{
+    nodes[node_id].bbcount = bbcount;
+
+    //cout << nodes[node_id].name << " bbcount " << nodes[node_id].bbcount << endl;
+    //cout << nodes[node_id].name << " inputs.size " << nodes[node_id].inputs.size << endl;
+
+    if ( nodes[node_id].bbcount == 0 )
+    {
+        nodes[node_id].bbcount = 1;
+        nodes[node_id].inputs.size += 1;
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].type = "c";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].bit_size = 32;
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].info_type = "fake"; //Andrea 20200128 Try to force 0 to inputs.
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].port = 0; //Andrea 20200211 
+
+    }
+
+    //cout << nodes[node_id].name << " inputs.size " << nodes[node_id].inputs.size << endl;
+}
+
+void set_component_ldcount ( int node_id, int ldcount )
+{
+    nodes[node_id].load_count = ldcount;
+    if ( nodes[node_id].load_count == 0 )
+    {
+        nodes[node_id].load_count = 1;
+        nodes[node_id].inputs.size += 1;
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].type = "l";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].info_type = "a";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].bit_size = 32;
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].port = 0; //Andrea 20200424
+//                     nodes[node_id].inputs.size += 1;
+//                     nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].type = "l";
+//                     nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].info_type = "d";
+//                     
+
+        nodes[node_id].outputs.size += 1;
+        nodes[node_id].outputs.output[nodes[node_id].outputs.size-1].type = "l";
+        nodes[node_id].outputs.output[nodes[node_id].outputs.size-1].info_type = "a";
+        nodes[node_id].outputs.output[nodes[node_id].outputs.size-1].bit_size = 32;
+        nodes[node_id].outputs.output[nodes[node_id].outputs.size-1].port = 0; //Andrea 20200424
+
+
+
+    }
+}
+
+void set_component_stcount ( int node_id, int stcount )
+{
+    nodes[node_id].store_count = stcount;
+    if ( nodes[node_id].store_count == 0 )
+    {
+        nodes[node_id].store_count = 1;
+        nodes[node_id].inputs.size += 1;
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].type = "s";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].info_type = "a";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].port = 0; //Andrea 20200424
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].bit_size = 32; //Andrea 20200424
+
+
+        nodes[node_id].inputs.size += 1;
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].type = "s";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].info_type = "d";
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].port = 0; //Andrea 20200424
+        nodes[node_id].inputs.input[nodes[node_id].inputs.size-1].bit_size = 32; //Andrea 20200424
+
+
+    }
+}
+
+void set_component_buffer_type ( int node_id )
+{
+    if ( nodes[node_id].type == "Buffer" && nodes[node_id].slots == 1 )
+    {
+        if ( nodes[node_id].trasparent )
+        {
+            nodes[node_id].type = "TEHB";
+        }
+        else
+        {
+            //nodes[node_id].type = "OEHB";
+        }
+        nodes[node_id].component_operator = nodes[node_id].type;
+    }
+    if ( nodes[node_id].type == "Buffer" && nodes[node_id].slots == 2 )
+    {
+        if ( nodes[node_id].trasparent )
+        {
+            nodes[node_id].type = "tFifo";
+        }
+        nodes[node_id].component_operator = nodes[node_id].type;
+    }
+
+    if ( nodes[node_id].type == "Fifo")
+    {
+        if ( nodes[node_id].trasparent )
+        {
+            nodes[node_id].type = "tFifo";
+        }
+        else
+        {
+            nodes[node_id].type = "nFifo";
+        }
+        nodes[node_id].component_operator = nodes[node_id].type;
+    }
+}
+
 void parse_components ( string v_0, string v_1 )
 {
     vector<string> parameters;
@@ -680,34 +821,7 @@ void parse_components ( string v_0, string v_1 )
             }
             if ( parameter.find("slots") != std::string::npos )
             {
-                nodes[components_in_netlist].slots = get_component_slots( parameters[indx] );
-
-                //cout << "nodes[components_in_netlist].slots" << nodes[components_in_netlist].slots;
-                
-                switch ( nodes[components_in_netlist].slots )
-                {
-                    case 1: //if slots = 1
-//                                 if ( nodes[components_in_netlist].trasparent )
-//                                 {
-//                                      // if transparent = true -> put TEHB
-//                                     nodes[components_in_netlist].type = "TEHB";
-//                                 }
-//                                 else
-//                                 {
-//                                     // if transparent = false -> put OEHB
-//                                     nodes[components_in_netlist].type = "OEHB";
-// 
-//                                 }
-//                                 break;
-                    case 2: //put elasticBuffer (ignore transparent parameter)
-                    case 0: //put elasticBuffer (ignore transparent parameter)
-                        ;
-                        break;
-                    default: // > 2
-                        nodes[components_in_netlist].type = "Fifo";
-                        nodes[components_in_netlist].component_operator = nodes[components_in_netlist].type; // For the component without an operator, sets the entity type                               
-                        break;
-                }
+                set_component_slots ( components_in_netlist, get_component_slots( parameters[indx] ) );
 
             }
             if ( parameter.find("transparent") != std::string::npos )
@@ -720,72 +834,15 @@ void parse_components ( string v_0, string v_1 )
             }
             if ( parameter.find("bbcount") != std::string::npos )
             {
-                nodes[components_in_netlist].bbcount = get_component_bbcount (parameters[indx] );
-                
-                //cout << nodes[components_in_netlist].name << " bbcount " << nodes[components_in_netlist].bbcount << endl;
-                //cout << nodes[components_in_netlist].name << " inputs.size " << nodes[components_in_netlist].inputs.size << endl;
-                
-                if ( nodes[components_in_netlist].bbcount == 0 )
-                {
-                    nodes[components_in_netlist].bbcount = 1;
-                    nodes[components_in_netlist].inputs.size += 1;
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].type = "c";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].bit_size = 32;
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].info_type = "fake"; //Andrea 20200128 Try to force 0 to inputs.
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].port = 0; //Andrea 20200211 
-
-                }
-                
-                //cout << nodes[components_in_netlist].name << " inputs.size " << nodes[components_in_netlist].inputs.size << endl;
-
+                set_component_bbcount ( components_in_netlist, get_component_bbcount (parameters[indx] ) );
             }
             if ( parameter.find("ldcount") != std::string::npos )
             {
-                nodes[components_in_netlist].load_count = get_component_bbcount (parameters[indx] );
-                if ( nodes[components_in_netlist].load_count == 0 )
-                {
-                    nodes[components_in_netlist].load_count = 1;
-                    nodes[components_in_netlist].inputs.size += 1;
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].type = "l";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].info_type = "a";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].bit_size = 32;
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].port = 0; //Andrea 20200424
-//                     nodes[components_in_netlist].inputs.size += 1;
-//                     nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].type = "l";
-//                     nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].info_type = "d";
-//                     
-                    
-                    nodes[components_in_netlist].outputs.size += 1;
-                    nodes[components_in_netlist].outputs.output[nodes[components_in_netlist].outputs.size-1].type = "l";
-                    nodes[components_in_netlist].outputs.output[nodes[components_in_netlist].outputs.size-1].info_type = "a";
-                    nodes[components_in_netlist].outputs.output[nodes[components_in_netlist].outputs.size-1].bit_size = 32;
-                    nodes[components_in_netlist].outputs.output[nodes[components_in_netlist].outputs.size-1].port = 0; //Andrea 20200424
-
-                    
-
-                }
+                set_component_ldcount ( components_in_netlist, get_component_bbcount (parameters[indx] ) );
             }
             if ( parameter.find("stcount") != std::string::npos )
             {
-                nodes[components_in_netlist].store_count = get_component_bbcount (parameters[indx] );
-                if ( nodes[components_in_netlist].store_count == 0 )
-                {
-                    nodes[components_in_netlist].store_count = 1;
-                    nodes[components_in_netlist].inputs.size += 1;
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].type = "s";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].info_type = "a";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].port = 0; //Andrea 20200424
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].bit_size = 32; //Andrea 20200424
-
-                    
-                    nodes[components_in_netlist].inputs.size += 1;
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].type = "s";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].info_type = "d";
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].port = 0; //Andrea 20200424
-                    nodes[components_in_netlist].inputs.input[nodes[components_in_netlist].inputs.size-1].bit_size = 32; //Andrea 20200424
-
-
-                }
+                set_component_stcount ( components_in_netlist, get_component_bbcount (parameters[indx] ) );
             }
             if ( parameter.find("mem_address") != std::string::npos )
             {
@@ -860,41 +917,7 @@ void parse_components ( string v_0, string v_1 )
         
         
         
-        if ( nodes[components_in_netlist].type == "Buffer" && nodes[components_in_netlist].slots == 1 )
-        {
-            if ( nodes[components_in_netlist].trasparent )
-            {
-                nodes[components_in_netlist].type = "TEHB";
-            }
-            else
-            {
-                //nodes[components_in_netlist].type = "OEHB";
-            }
-            nodes[components_in_netlist].component_operator = nodes[components_in_netlist].type;
-        }
-        if ( nodes[components_in_netlist].type == "Buffer" && nodes[components_in_netlist].slots == 2 )
-        {
-            if ( nodes[components_in_netlist].trasparent )
-            {
-                nodes[components_in_netlist].type = "tFifo";
-            }
-            nodes[components_in_netlist].component_operator = nodes[components_in_netlist].type;
-        }
-        
-        if ( nodes[components_in_netlist].type == "Fifo")
-        {
-            if ( nodes[components_in_netlist].trasparent )
-            {
-                nodes[components_in_netlist].type = "tFifo";
-            }
-            else
-            {
-                nodes[components_in_netlist].type = "nFifo";
-            }
-            nodes[components_in_netlist].component_operator = nodes[components_in_netlist].type;
-        }
-        
-        
+        set_component_buffer_type ( components_in_netlist );
         
         components_in_netlist++;
         if ( components_in_netlist >= MAX_NODES )
@@ -956,3 +979,235 @@ void parse_dot ( string filename )
 }
 
 
+template <typename T>
+void set_dfb_port ( T& port, const DFbinary::Port& record, string suffix )
+{
+    // Same fields as the "inN:width*suffix" descriptions of the dot export
+    port.bit_size = ( record.width == 0 ) ? 1 : record.width; // if 0 force to 1!!
+    port.type = "u";
+    port.port = 0;
+    port.info_type = "u";
+
+    size_t star = suffix.find('*');
+    if ( star != std::string::npos && star + 1 < suffix.size() )
+    {
+        string info = suffix.substr( star + 1 );
+        port.type = info.at(0);
+        if ( info.size() > 1 )
+        {
+            port.port = stoi_p ( info.substr(1, 1) );
+        }
+        if ( info.size() > 2 )
+        {
+            port.info_type = info.at(2);
+        }
+    }
+}
+
+int get_dfb_port_index ( string name, string prefix )
+{
+    // Index of the port in the inputs (outputs) of the node, as in the connections of the dot export
+    if ( name.compare(0, prefix.size(), prefix) != 0 )
+    {
+        return COMPONENT_NOT_FOUND;
+    }
+    return stoi_p ( name.substr( prefix.size() ) ) - 1;
+}
+
+void parse_dfb_error ( string filename, string error )
+{
+    cout << "Netlist Error" << endl;
+    cout << filename << ": " << error << endl;
+    cout << "Exiting without producing netlist" << endl;
+    exit ( EXIT_FAILURE );
+}
+
+void parse_dfb ( string filename )
+{
+    // The nodes are filled with the attributes that parse_dot reads from the
+    // dot export of the netlist (writeDot in Buffers). The dot export writes
+    // bbID and portID, which are not read (parse_dot expects bbId and portId).
+    string input_filename = filename + ".dfb";
+    DFbinary::File dfb;
+
+    components_in_netlist = 0;
+
+    if ( !dfb.open( input_filename ) )
+    {
+        cout << dfb.getError() << endl << endl<< endl;
+        exit ( EXIT_FAILURE );
+    }
+
+    const DFbinary::Header& header = dfb.header();
+    if ( header.numBlocks > MAX_NODES )
+    {
+        parse_dfb_error ( input_filename, "the number of components exceeds the maximum allowed " + to_string(MAX_NODES) );
+    }
+
+    for ( uint32_t b = 0; b < header.numBlocks; b++ )
+    {
+        const DFbinary::Block& block = dfb.block(b);
+        NODE_T& node = nodes[components_in_netlist];
+
+        DFbinary::Extra extra;
+        memset( &extra, 0, sizeof(extra) );
+        if ( block.extra != DFbinary::NONE )
+        {
+            extra = dfb.extra( block.extra );
+        }
+
+        node.name = get_component_name ( dfb.getString( block.name ) );
+        node.type = dfb.getString( block.type );
+        node.component_type = COMPONENT_GENERIC;
+        node.component_operator = node.type;
+        if ( node.type == "LSQ" )
+        {
+            node.lsq_indx = lsqs_in_netlist;
+            lsqs_in_netlist++;
+        }
+
+        node.inputs = IN_T();
+        node.outputs = OUT_T();
+        node.inputs.size = 0;
+        node.outputs.size = 0;
+        int out_width = 0;
+        for ( uint32_t p = block.firstPort; p < block.firstPort + block.numPorts; p++ )
+        {
+            const DFbinary::Port& record = dfb.port(p);
+            string suffix = dfb.getString( record.memSuffix );
+            if ( record.flags & DFbinary::PORT_INPUT )
+            {
+                if ( node.inputs.size == MAX_INPUTS )
+                {
+                    parse_dfb_error ( input_filename, "too many inputs in " + node.name );
+                }
+                INPUT_T& input = node.inputs.input[node.inputs.size++];
+                set_dfb_port ( input, record, suffix );
+                if ( input.info_type == "a" )
+                {
+                    node.address_size = input.bit_size;
+                }
+                if ( input.info_type == "d" )
+                {
+                    node.data_size = input.bit_size;
+                }
+            }
+            else
+            {
+                if ( node.outputs.size == MAX_OUTPUTS )
+                {
+                    parse_dfb_error ( input_filename, "too many outputs in " + node.name );
+                }
+                set_dfb_port ( node.outputs.output[node.outputs.size++], record, suffix );
+                if ( node.outputs.size == 1 )
+                {
+                    out_width = record.width;
+                }
+            }
+        }
+
+        string operation = dfb.getString( block.operation );
+        if ( node.type == "Operator" && !operation.empty() )
+        {
+            node.component_operator = operation;
+        }
+        if ( node.type == "Operator" && ( operation == "mc_load_op" || operation == "mc_store_op" ||
+                                          operation == "lsq_load_op" || operation == "lsq_store_op" ) )
+        {
+            node.offset = extra.memOffset;
+        }
+        if ( node.type == "Operator" && operation == "getelementptr_op" )
+        {
+            node.constants = extra.getPtrConst;
+        }
+
+        if ( node.type == "Constant" )
+        {
+            // Hexadecimal value of the dot export
+            if ( out_width == 1 )
+            {
+                node.component_value = ( block.value != 0 );
+            }
+            else if ( block.value < 1000 && block.value > -1000 )
+            {
+                node.component_value = (unsigned long int) block.value;
+            }
+            else
+            {
+                node.component_value = block.value & ( ( (long long) 1 << out_width ) - 1 );
+            }
+        }
+
+        if ( node.type == "Buffer" )
+        {
+            node.trasparent = block.transparent;
+            set_component_slots ( components_in_netlist, block.slots );
+        }
+
+        if ( node.type == "MC" || node.type == "LSQ" )
+        {
+            node.memory = string_clean ( dfb.getString( extra.memName ) );
+            set_component_bbcount ( components_in_netlist, extra.memBBCount );
+            set_component_ldcount ( components_in_netlist, extra.memLdCount );
+            set_component_stcount ( components_in_netlist, extra.memStCount );
+        }
+
+        if ( node.type == "LSQ" )
+        {
+            // The strings keep the quotes of the dot attributes
+            node.fifodepth = extra.fifoDepth;
+            node.numLoads = " \"" + string( dfb.getString( extra.numLoads ) ) + "\"";
+            node.numStores = " \"" + string( dfb.getString( extra.numStores ) ) + "\"";
+            node.loadOffsets = " \"" + string( dfb.getString( extra.loadOffsets ) ) + "\"";
+            node.storeOffsets = " \"" + string( dfb.getString( extra.storeOffsets ) ) + "\"";
+            node.loadPorts = " \"" + string( dfb.getString( extra.loadPorts ) ) + "\"";
+            node.storePorts = stripExtension( " \"" + string( dfb.getString( extra.storePorts ) ) + "\"", "];" );
+        }
+
+        if ( node.type == "Selector" )
+        {
+            // Pairs (BB, number of indices) followed by the indices
+            node.orderings.clear();
+            uint32_t indx = extra.firstOrdering;
+            while ( indx + 1 < extra.firstOrdering + extra.numOrderingInts )
+            {
+                int size = dfb.getInt( indx + 1 );
+                vector<int> int_indices;
+                for ( int k = 0; k < size && indx + 2 + k < extra.firstOrdering + extra.numOrderingInts; k++ )
+                {
+                    int_indices.push_back( dfb.getInt( indx + 2 + k ) );
+                }
+                if ( !int_indices.empty() )
+                {
+                    node.orderings.push_back( int_indices );
+                }
+                indx += 2 + ( size > 0 ? size : 0 );
+            }
+        }
+
+        set_component_buffer_type ( components_in_netlist );
+
+        components_in_netlist++;
+    }
+
+    for ( uint32_t c = 0; c < header.numChannels; c++ )
+    {
+        const DFbinary::Channel& channel = dfb.channel(c);
+        const DFbinary::Port& src = dfb.port( channel.src );
+        const DFbinary::Port& dst = dfb.port( channel.dst );
+
+        int current_node_id = src.block;
+        int next_node_id = dst.block;
+        int output_indx = get_dfb_port_index ( dfb.getString( src.name ), "out" );
+        int input_indx = get_dfb_port_index ( dfb.getString( dst.name ), "in" );
+
+        if ( output_indx < 0 || output_indx >= MAX_OUTPUTS || input_indx < 0 || input_indx >= MAX_INPUTS )
+        {
+            parse_dfb_error ( input_filename, "invalid connection from " + nodes[current_node_id].name + " to " + nodes[next_node_id].name );
+        }
+
+        nodes[current_node_id].outputs.output[output_indx].next_nodes_id = next_node_id;
+        nodes[current_node_id].outputs.output[output_indx].next_nodes_port = input_indx;
+        nodes[next_node_id].inputs.input[input_indx].prev_nodes_id = current_node_id;
+    }
+}
@@ -99,6 +99,7 @@ typedef struct node
 #define MAX_NODES 16384//4096
 
 void parse_dot ( string filename );
+void parse_dfb ( string filename );
 
 extern NODE_T nodes[MAX_NODES];
 
@@ -88,7 +88,7 @@ blockID addForkAfterPhi(DFnetlist &df, set<blockID> blocks_in_bb) {
 }
 
 blockID predecessor(DFnetlist &df, blockID current) {
-	set<portID> allPorts = df.DFI->getPorts(current, INPUT_PORTS);
+	const blockPorts& allPorts = df.DFI->getPorts(current, INPUT_PORTS);
 	set<portID> ctrlPorts { };
 	for (auto port : allPorts) {
 		if (df.DFI->getPortWidth(port) == 0) {